@@ -92,6 +92,7 @@ struct RelayMessageFunctorType {
   std::function<void(const T& /*message*/)> message_received;
 };
 
+// Functors receiving typed messages should read each message's payload with Message::payload().
 struct TypedMessageAndCachingFunctor {  // New API
   MessageAndCachingFunctorsType<SingleToSingleMessage> single_to_single;
   MessageAndCachingFunctorsType<SingleToGroupMessage> single_to_group;
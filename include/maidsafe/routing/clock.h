@@ -0,0 +1,115 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_CLOCK_H_
+#define MAIDSAFE_ROUTING_CLOCK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include "boost/asio/basic_waitable_timer.hpp"
+#include "boost/asio/io_service.hpp"
+#include "boost/system/error_code.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+// The clock behind all of routing's timers.  It reads std::chrono::steady_clock unless
+// VirtualClock is enabled, in which case time only moves when VirtualClock is advanced.
+struct Clock {
+  typedef std::chrono::steady_clock::duration duration;
+  typedef duration::rep rep;
+  typedef duration::period period;
+  typedef std::chrono::time_point<Clock, duration> time_point;
+  static const bool is_steady = true;
+  static time_point now();
+};
+
+// Converts the time until a timer's expiry into a real wait for asio.  In virtual time the wait is
+// capped, so that an asio thread notices an advance of the clock promptly.
+struct ClockWaitTraits {
+  static Clock::duration to_wait_duration(const Clock::duration& duration);
+};
+
+// Process-wide virtual time for discrete-event simulations.  Enable it before creating any routing
+// objects; Clock then starts from the real time of enabling and stands still until advanced.
+class VirtualClock {
+ public:
+  static void Enable();
+  static void Disable();
+  static bool enabled();
+  // Moves time forward to 'time_point', or does nothing if that isn't in the future.
+  static void AdvanceTo(const Clock::time_point& time_point);
+  static void Advance(const Clock::duration& duration);
+  // Returns the earliest expiry of any SteadyTimer waiting in virtual time, or
+  // Clock::time_point::max() if there is none.
+  static Clock::time_point NextExpiry();
+
+  friend class SteadyTimer;
+
+ private:
+  // Registers a pending wait until the last copy of the returned pointer is destroyed.
+  static std::shared_ptr<void> RegisterExpiry(const Clock::time_point& expiry);
+};
+
+// Drop-in replacement for boost::asio::steady_timer which follows Clock.  While VirtualClock is
+// enabled, each pending wait is registered so that a simulation can jump straight to it.
+class SteadyTimer {
+ public:
+  typedef Clock::duration duration;
+  typedef Clock::time_point time_point;
+
+  explicit SteadyTimer(boost::asio::io_service& io_service) : timer_(io_service) {}
+  SteadyTimer(boost::asio::io_service& io_service, const duration& expiry_time)
+      : timer_(io_service, expiry_time) {}
+
+  std::size_t expires_from_now(const duration& expiry_time) {
+    return timer_.expires_from_now(expiry_time);
+  }
+  std::size_t expires_at(const time_point& expiry_time) { return timer_.expires_at(expiry_time); }
+  time_point expires_at() const { return timer_.expires_at(); }
+  std::size_t cancel() { return timer_.cancel(); }
+
+  template <typename WaitHandler>
+  void async_wait(WaitHandler handler) {
+    if (!VirtualClock::enabled()) {
+      timer_.async_wait(handler);
+      return;
+    }
+    // The registration ends with the handler, whether it is invoked or discarded with the timer.
+    std::shared_ptr<void> registration(VirtualClock::RegisterExpiry(timer_.expires_at()));
+    timer_.async_wait([registration, handler](const boost::system::error_code& error) mutable {
+      handler(error);
+    });
+  }
+
+ private:
+  SteadyTimer(const SteadyTimer&);
+  SteadyTimer(const SteadyTimer&&);
+  SteadyTimer& operator=(const SteadyTimer&);
+
+  boost::asio::basic_waitable_timer<Clock, ClockWaitTraits> timer_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_CLOCK_H_
@@ -19,8 +19,10 @@
 #ifndef MAIDSAFE_ROUTING_CLOSE_NODES_CHANGE_H_
 #define MAIDSAFE_ROUTING_CLOSE_NODES_CHANGE_H_
 
+#include <cstddef>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "maidsafe/common/config.h"
@@ -34,6 +36,7 @@ namespace routing {
 
 namespace test {
 class CloseNodesChangeTest_BEH_CheckHolders_Test;
+class CloseNodesChangeTest_BEH_BulkCheckHolders_Test;
 class SingleCloseNodesChangeTest_BEH_ChoosePmidNode_Test;
 }
 
@@ -58,6 +61,12 @@ class CloseNodesChange {
   CloseNodesChange& operator=(CloseNodesChange other);
 
   CheckHoldersResult CheckHolders(const NodeId& target) const;
+  // Equivalent to calling CheckHolders for each of 'targets', which must be sorted in ascending
+  // order, but only returns those targets whose holders have changed.  Ranges of the keyspace which
+  // can't be affected by this change are skipped without visiting their targets, and large inputs
+  // are shared across threads.
+  std::vector<std::pair<NodeId, CheckHoldersResult>> CheckHolders(
+      const std::vector<NodeId>& targets) const;
   NodeId ChoosePmidNode(const std::set<NodeId>& online_pmids, const NodeId& target) const;
   NodeId lost_node() const { return lost_node_; }
   NodeId new_node() const { return new_node_; }
@@ -68,12 +77,21 @@ class CloseNodesChange {
   friend void swap(CloseNodesChange& lhs, CloseNodesChange& rhs) MAIDSAFE_NOEXCEPT;
   friend class RoutingTable;
   friend class test::CloseNodesChangeTest_BEH_CheckHolders_Test;
+  friend class test::CloseNodesChangeTest_BEH_BulkCheckHolders_Test;
   friend class test::SingleCloseNodesChangeTest_BEH_ChoosePmidNode_Test;
 
  private:
   CloseNodesChange(NodeId this_node_id, const std::vector<NodeId>& old_close_nodes,
                const std::vector<NodeId>& new_close_nodes);
 
+  struct BulkCheck;
+  typedef std::vector<NodeId>::const_iterator TargetIterator;
+
+  CheckHoldersResult DoCheckHolders(const NodeId& target, bool& holders_changed) const;
+  void CheckHolders(const BulkCheck& bulk_check, TargetIterator begin, TargetIterator end,
+                    size_t bit, std::vector<size_t> closer,
+                    std::vector<std::pair<NodeId, CheckHoldersResult>>& changed) const;
+
   NodeId node_id_;
   std::vector<NodeId> old_close_nodes_, new_close_nodes_;
   NodeId lost_node_, new_node_;
@@ -20,6 +20,7 @@
 #define MAIDSAFE_ROUTING_MESSAGE_H_
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -40,6 +41,9 @@ enum class Cacheable : int {
   kPut = 2
 };
 
+// A received payload, shared with the parsed message it arrived in rather than copied out of it.
+typedef std::shared_ptr<const std::string> SharedContents;
+
 struct GroupSource {
   GroupSource();
   GroupSource(GroupId group_id_in, SingleId sender_id_in);
@@ -85,10 +89,19 @@ struct Message {
   Message(Message&& other);
   Message& operator=(Message other);
 
+  // The message's payload: 'shared_contents' if set, otherwise 'contents'.  Read the payload of a
+  // received message through this, since 'contents' is empty unless
+  // Parameters::copy_message_contents is set.
+  const std::string& payload() const;
+
+  // Set this, rather than 'shared_contents', to give a message to be sent its payload.
   std::string contents;
   Sender sender;
   Receiver receiver;
   Cacheable cacheable;
+  // Set instead of 'contents' on received messages if Parameters::copy_message_contents is clear.
+  // Reset it before editing 'contents' of such a message, e.g. to send it on.
+  SharedContents shared_contents;
 };
 
 template <typename Sender, typename Receiver>
@@ -140,7 +153,7 @@ bool operator==(const Relay<T>& lhs, const Relay<T>& rhs) {
 
 template <typename Sender, typename Receiver>
 Message<Sender, Receiver>::Message()
-    : contents(), sender(), receiver(), cacheable(Cacheable::kNone) {}
+    : contents(), sender(), receiver(), cacheable(Cacheable::kNone), shared_contents() {}
 
 template <typename Sender, typename Receiver>
 Message<Sender, Receiver>::Message(std::string contents_in, Sender sender_in, Receiver receiver_in,
@@ -148,21 +161,24 @@ Message<Sender, Receiver>::Message(std::string contents_in, Sender sender_in, Re
     : contents(std::move(contents_in)),
       sender(std::move(sender_in)),
       receiver(std::move(receiver_in)),
-      cacheable(cacheable_in) {}
+      cacheable(cacheable_in),
+      shared_contents() {}
 
 template <typename Sender, typename Receiver>
 Message<Sender, Receiver>::Message(const Message& other)
     : contents(other.contents),
       sender(other.sender),
       receiver(other.receiver),
-      cacheable(other.cacheable) {}
+      cacheable(other.cacheable),
+      shared_contents(other.shared_contents) {}
 
 template <typename Sender, typename Receiver>
 Message<Sender, Receiver>::Message(Message&& other)
     : contents(std::move(other.contents)),
       sender(std::move(other.sender)),
       receiver(std::move(other.receiver)),
-      cacheable(std::move(other.cacheable)) {}
+      cacheable(std::move(other.cacheable)),
+      shared_contents(std::move(other.shared_contents)) {}
 
 template <typename Sender, typename Receiver>
 Message<Sender, Receiver>& Message<Sender, Receiver>::operator=(Message other) {
@@ -170,6 +186,11 @@ Message<Sender, Receiver>& Message<Sender, Receiver>::operator=(Message other) {
   return *this;
 }
 
+template <typename Sender, typename Receiver>
+const std::string& Message<Sender, Receiver>::payload() const {
+  return shared_contents ? *shared_contents : contents;
+}
+
 template <typename Sender, typename Receiver>
 void swap(Message<Sender, Receiver>& lhs, Message<Sender, Receiver>& rhs) {
   using std::swap;
@@ -177,6 +198,7 @@ void swap(Message<Sender, Receiver>& lhs, Message<Sender, Receiver>& rhs) {
   swap(lhs.sender, rhs.sender);
   swap(lhs.receiver, rhs.receiver);
   swap(lhs.cacheable, rhs.cacheable);
+  swap(lhs.shared_contents, rhs.shared_contents);
 }
 
 typedef Message<SingleSource, SingleId> SingleToSingleMessage;
@@ -35,13 +35,34 @@ struct Parameters {
   static unsigned int closest_nodes_size;
   static unsigned int group_size;
   static unsigned int proximity_factor;
+  // When enabled, the next hop is chosen among the proximity_routing_candidates closest peers which
+  // still make strict XOR progress, by hop ack round trip time and outstanding sends.
+  static bool proximity_routing;
+  static unsigned int proximity_routing_candidates;
   static unsigned int max_routing_table_size;  // max size of RoutingTable owned by vault
   static unsigned int routing_table_size_threshold;
   static unsigned int max_routing_table_size_for_client;  // max size of RoutingTable in client
   static unsigned int max_client_routing_table_size;      // max size of ClientRoutingTable
+  // Well-provisioned vaults may raise max_routing_table_size to hundreds or thousands of peers,
+  // which shortens routes (see routing_hop_sim).  A bucket_target_size above 1 then keeps buckets
+  // balanced: a newcomer to a bucket holding fewer nodes than this displaces the furthest node of
+  // the fullest bucket, if that holds more.
   static unsigned int bucket_target_size;
   static uint32_t max_data_size;
+  // While this is set (the default), typed messages delivered to the upper layer carry a copy of
+  // the received payload in Message::contents.  Clearing it saves that copy per message: the
+  // payload is then shared through Message::shared_contents instead, leaving contents empty.
+  // Message::payload() returns the payload either way.
+  static bool copy_message_contents;
   static std::chrono::steady_clock::duration default_response_timeout;
+  // When enabled, a SendDirect expecting a response which hasn't been answered after the
+  // hedge_delay_percentile of recently observed response times (bounded below by hedge_min_delay,
+  // or hedge_initial_delay until enough responses have been observed) is duplicated via an
+  // alternate first hop.  The first response wins.
+  static bool hedge_direct_sends;
+  static unsigned int hedge_delay_percentile;
+  static std::chrono::steady_clock::duration hedge_min_delay;
+  static std::chrono::steady_clock::duration hedge_initial_delay;
   static std::chrono::seconds find_node_interval;
   static std::chrono::seconds recovery_time_lag;
   static std::chrono::seconds re_bootstrap_time_lag;
@@ -51,16 +72,60 @@ struct Parameters {
   static unsigned int max_route_history;
   static unsigned int hops_to_live;
   static unsigned int unidirectional_interest_range;
+  // The close_standby_size peers next closest after the closest_nodes_size closest are never
+  // evicted, so that a lost close node is replaced by a peer which is already connected and
+  // validated.  The promotion is reported as a close nodes change and to connected clients.  Losing
+  // a close or standby peer starts a search for enough nodes to refill the standby.
+  static unsigned int close_standby_size;
   static std::chrono::steady_clock::duration local_retreival_timeout;
   static unsigned int routing_table_ready_to_response;
   static unsigned int accepted_distance_tolerance;
   static boost::posix_time::time_duration connect_rpc_prune_timeout;
   static unsigned int max_send_retry;
   static unsigned int ack_timeout;
+  // Hop acks to a connected peer are held for up to ack_batch_delay, or until max_acks_per_batch
+  // are pending, and then sent together; meanwhile they ride along on any other message to that
+  // peer.  A zero delay sends each ack on its own.
+  static std::chrono::steady_clock::duration ack_batch_delay;
+  static unsigned int max_acks_per_batch;
   static unsigned int firewall_history_cleanup_factor;
   static std::chrono::seconds firewall_message_life;
   static unsigned int public_key_holding_time;
   static bool caching;
+  // Received routing control messages (including acks) and node-level data are queued separately;
+  // while both are waiting, up to control_lane_weight control messages are handled for each data
+  // message, or control messages only if it is 0.
+  static unsigned int control_lane_weight;
+  // Data messages beyond this many in flight to a single peer are held by routing, so that control
+  // messages to that peer don't queue behind them in rudp.  0 disables the limit.  At most
+  // max_held_data_sends_per_peer are held; beyond that, sends fail with rudp::kSendFailure.
+  static unsigned int max_data_sends_per_peer;
+  static unsigned int max_held_data_sends_per_peer;
+  // Token-bucket admission control for node-level requests delivered to this node, per previous
+  // hop: messages per second and burst size, separately for clients and vaults.  A rate of 0
+  // disables the limit, which is the default.
+  static unsigned int admission_client_rate;
+  static unsigned int admission_client_burst;
+  static unsigned int admission_vault_rate;
+  static unsigned int admission_vault_burst;
+  // Calls into the upper layer's message and cache functors run on a pool of upcall_threads, with
+  // up to max_queued_upcalls waiting; requests arriving while the queue is full are dropped.  With
+  // 0 threads, upcalls run inline on the routing threads.
+  static unsigned int upcall_threads;
+  static unsigned int max_queued_upcalls;
+  // GetGroup results are cached for up to group_cache_ttl, or until a routing table change within
+  // the group's range, for at most max_group_cache_size groups.  Only remote groups are cached, and
+  // churn there is mostly unseen by this node, so group_cache_ttl bounds how stale a cached group
+  // can be.  A zero ttl disables the cache.
+  static std::chrono::steady_clock::duration group_cache_ttl;
+  static unsigned int max_group_cache_size;
+  // Routing log statements below this level are skipped without evaluating their arguments.  The
+  // default, kLogLevelFromFilter, takes the level maidsafe::log's filter sets for routing.
+  static int min_log_level;
+  // Records routing events in per-thread binary rings (see flight_recorder.h).  If the signal is
+  // non-zero, receiving it dumps each node's records to the temp directory.
+  static bool flight_recorder;
+  static int flight_recorder_dump_signal;
 
  private:
   Parameters();
@@ -40,6 +40,7 @@
 
 #include "boost/asio/ip/udp.hpp"
 #include "boost/date_time/posix_time/posix_time_config.hpp"
+#include "boost/filesystem/path.hpp"
 
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/common/rsa.h"
@@ -47,14 +48,18 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_host.h"
 
 namespace maidsafe {
 
 namespace routing {
 
 struct NodeInfo;
+class RoutingAccess;
 
-namespace test { class GenericNode; }
+namespace test {
+class GenericNode;
+}
 
 namespace detail {
 
@@ -87,6 +92,18 @@ class Routing {
     InitialisePimpl(detail::is_client<FobType>::value, NodeId(fob.name()->string()), keys);
   }
 
+  // As above, but the node runs on the threads of 'host' rather than its own, so that many nodes
+  // can be hosted in one process.  'host' must outlive this object.
+  template <typename FobType>
+  Routing(const FobType& fob, RoutingHost& host)
+      : pimpl_() {
+    asymm::Keys keys;
+    keys.private_key = fob.private_key();
+    keys.public_key = fob.public_key();
+    InitialisePimpl(detail::is_client<FobType>::value, NodeId(fob.name()->string()), keys,
+                    &host);
+  }
+
   ~Routing();
   // Joins the network. Valid method for requesting public key must be provided by the functor,
   // otherwise no node will be added to the routing table and node will fail to join the network.
@@ -97,6 +114,7 @@ class Routing {
                     const boost::asio::ip::udp::endpoint& peer_endpoint, const NodeInfo& peer_info);
 
   // Sends message to a known destnation. (Typed Message API)
+  // The payload sent is message.payload().
   // Throws on invalid paramaters
   template <typename T>
   void Send(const T& message);
@@ -146,13 +164,29 @@ class Routing {
   // Checks if client routing table contains given node id
   bool IsConnectedClient(const NodeId& node_id);
 
+  // Returns a text snapshot, in the Prometheus exposition format, of this node's routing metrics:
+  // per message type counters, drops by reason, ack retries and timeouts, cache hits and latency
+  // histograms.
+  std::string MetricsSnapshot() const;
+
+  // Sends MetricsSnapshot() to 'path' if that is an existing Unix domain socket, otherwise writes
+  // it to 'path' as a file.  Returns false on failure.
+  bool DumpMetrics(const boost::filesystem::path& path) const;
+
+  // Writes this node's flight recorder records (recent received, sent, delivered and dropped
+  // messages) to 'path' in the binary format read by routing_flight_recorder_decoder.  Returns
+  // false on failure.
+  bool DumpFlightRecorder(const boost::filesystem::path& path) const;
+
   friend class test::GenericNode;
+  friend class RoutingAccess;
 
  private:
   Routing(const Routing&);
   Routing(const Routing&&);
   Routing& operator=(const Routing&);
-  void InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  void InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                       RoutingHost* host = nullptr);
 
   class Impl;
   std::shared_ptr<Impl> pimpl_;
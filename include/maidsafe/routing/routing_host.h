@@ -0,0 +1,86 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_HOST_H_
+#define MAIDSAFE_ROUTING_ROUTING_HOST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace maidsafe {
+
+class AsioService;
+
+namespace routing {
+
+class Routing;
+class RoutingAccess;
+class UpcallExecutor;
+
+// Threads shared by several Routing objects in one process, e.g. many vaults hosted on a single
+// machine.  A Routing object constructed with a host runs its handlers and timers on the host's
+// threads, and its calls into the upper layer on the host's upcall pool, instead of starting
+// threads of its own.  Each node's routing tables, connections, queued messages, pending responses
+// and metrics remain its own.  The host must outlive every Routing object constructed with it.
+//
+// A host holds one or more AsioServices.  Each hosted node is assigned one of them in turn and
+// keeps it for life, so all of that node's handlers, timers and received messages for its
+// connections run on the same service.
+class RoutingHost {
+ public:
+  // Handlers and timers run on 'thread_count' threads, and upcalls on Parameters::upcall_threads
+  // more, with up to Parameters::max_queued_upcalls waiting across all hosted nodes.
+  explicit RoutingHost(unsigned int thread_count);
+  // As above, but with one single-threaded service per entry of 'cores', its thread pinned to that
+  // core where the platform supports it.  A node's work then stays on one core and its routing
+  // table and connection state stay in that core's cache.  List a core more than once to run more
+  // threads on it, or only the cores of one NUMA node to keep the nodes' memory local to it.
+  explicit RoutingHost(const std::vector<unsigned int>& cores);
+  // Hosted nodes run on the embedder's own services rather than threads started by the host.  The
+  // services must keep running until every node hosted on them has been destroyed.
+  explicit RoutingHost(const std::vector<std::shared_ptr<AsioService>>& asio_services);
+  ~RoutingHost();
+
+  // Number of the host's threads pinned to a core; zero unless constructed with 'cores'.
+  size_t pinned_thread_count() const { return pinned_thread_count_; }
+
+  friend class Routing;
+  friend class RoutingAccess;
+
+ private:
+  RoutingHost(const RoutingHost&);
+  RoutingHost(const RoutingHost&&);
+  RoutingHost& operator=(const RoutingHost&);
+
+  // Returns the service for the next hosted node, cycling through asio_services_.
+  AsioService& NextAsioService();
+
+  std::vector<std::shared_ptr<AsioService>> asio_services_;
+  std::atomic<size_t> next_asio_service_;
+  size_t pinned_thread_count_;
+  // Declared after asio_services_ so that upcall threads, which may post to them, are joined first.
+  std::unique_ptr<UpcallExecutor> upcall_executor_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_HOST_H_
@@ -0,0 +1,89 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_LOG_H_
+#define MAIDSAFE_ROUTING_ROUTING_LOG_H_
+
+#include <atomic>
+#include <limits>
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/parameters.h"
+
+// Lowest log level compiled into the routing library.  Release builds drop kVerbose and kInfo
+// statements entirely; define MAIDSAFE_ROUTING_MIN_LOG_LEVEL to override.
+#ifndef MAIDSAFE_ROUTING_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define MAIDSAFE_ROUTING_MIN_LOG_LEVEL maidsafe::log::kSuccess
+#else
+#define MAIDSAFE_ROUTING_MIN_LOG_LEVEL maidsafe::log::kVerbose
+#endif
+#endif
+
+// Drop-in replacement for LOG(level) in routing code.  The streamed arguments are only evaluated
+// if 'level' is compiled in and at or above Parameters::min_log_level (by default, the level
+// maidsafe::log's filter sets for routing), so expensive ones such as PrintRoutingTable() or
+// PrintMessage() cost nothing when the statement is disabled.  The empty if-branch keeps a
+// following 'else' bound correctly when used as the body of an unbraced 'if'.
+#define ROUTING_LOG(level)                                                     \
+  if (!maidsafe::routing::detail::LogEnabled(maidsafe::log::level)) {          \
+  } else                                                                       \
+    LOG(level)
+
+namespace maidsafe {
+
+namespace routing {
+
+// The default Parameters::min_log_level, which defers to maidsafe::log's filter.
+const int kLogLevelFromFilter(std::numeric_limits<int>::min());
+
+namespace detail {
+
+// The lowest level maidsafe::log's filter lets through for routing: its "routing" entry, else its
+// "*" entry.  Until logging is initialised with a filter, only kAlways passes.  The first non-empty
+// filter seen is cached, so later changes to it aren't picked up here.
+inline int LogFilterLevel() {
+  static std::atomic<bool> resolved(false);
+  static std::atomic<int> filter_level(log::kAlways);
+  if (resolved)
+    return filter_level;
+  const auto kFilter(log::Logging::Instance().Filter());
+  if (kFilter.empty())
+    return log::kAlways;
+  auto itr(kFilter.find("routing"));
+  if (itr == kFilter.end())
+    itr = kFilter.find("*");
+  filter_level = (itr == kFilter.end()) ? log::kAlways : itr->second;
+  resolved = true;
+  return filter_level;
+}
+
+inline bool LogEnabled(int level) {
+  return level >= MAIDSAFE_ROUTING_MIN_LOG_LEVEL &&
+         level >= (Parameters::min_log_level == kLogLevelFromFilter ? LogFilterLevel()
+                                                                    : Parameters::min_log_level);
+}
+
+}  // namespace detail
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_LOG_H_
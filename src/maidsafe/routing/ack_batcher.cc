@@ -0,0 +1,146 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/ack_batcher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "boost/asio/error.hpp"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/wire_format_lite.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+AckBatcher::AckBatcher(boost::asio::io_service& io_service, FlushFunctor flush)
+    : state_(std::make_shared<State>(io_service, flush)) {}
+
+AckBatcher::~AckBatcher() { Stop(); }
+
+void AckBatcher::Add(const NodeId& peer_id, const NodeId& peer_connection_id, int32_t ack_id) {
+  Batch full_batch;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->stopped)
+      return;
+    auto& batch(state_->batches[peer_connection_id]);
+    if (batch.ack_ids.empty()) {
+      batch.peer_id = peer_id;
+      batch.due = Clock::now() +
+                  std::chrono::duration_cast<Clock::duration>(Parameters::ack_batch_delay);
+      if (!state_->timer_armed)
+        ArmTimer(state_, batch.due);
+    }
+    batch.ack_ids.push_back(ack_id);
+    if (batch.ack_ids.size() < std::max(Parameters::max_acks_per_batch, 1U))
+      return;
+    full_batch = std::move(batch);
+    state_->batches.erase(peer_connection_id);
+  }
+  std::lock_guard<std::recursive_mutex> flush_lock(state_->flush_mutex);
+  if (!state_->stopped)
+    state_->flush(full_batch.peer_id, peer_connection_id, full_batch.ack_ids);
+}
+
+std::vector<int32_t> AckBatcher::Take(const NodeId& peer_connection_id, NodeId& peer_id) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  auto itr(state_->batches.find(peer_connection_id));
+  if (itr == state_->batches.end())
+    return std::vector<int32_t>();
+  peer_id = itr->second.peer_id;
+  std::vector<int32_t> ack_ids(std::move(itr->second.ack_ids));
+  state_->batches.erase(itr);
+  return ack_ids;
+}
+
+void AckBatcher::Stop() {
+  std::lock_guard<std::recursive_mutex> flush_lock(state_->flush_mutex);
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->stopped = true;
+  state_->batches.clear();
+  state_->timer.cancel();
+}
+
+size_t AckBatcher::pending() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  size_t count(0);
+  for (const auto& batch : state_->batches)
+    count += batch.second.ack_ids.size();
+  return count;
+}
+
+void AckBatcher::ArmTimer(const std::shared_ptr<State>& state, const Clock::time_point& expiry) {
+  state->timer_armed = true;
+  state->timer.expires_at(expiry);
+  state->timer.async_wait([state](const boost::system::error_code& error) {
+    OnTimer(state, error);
+  });
+}
+
+void AckBatcher::OnTimer(const std::shared_ptr<State>& state,
+                         const boost::system::error_code& error) {
+  std::lock_guard<std::recursive_mutex> flush_lock(state->flush_mutex);
+  std::map<NodeId, Batch> due_batches;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->timer_armed = false;
+    if (state->stopped || error == boost::asio::error::operation_aborted)
+      return;
+    const auto kNow(Clock::now());
+    auto next_due(Clock::time_point::max());
+    for (auto itr(state->batches.begin()); itr != state->batches.end();) {
+      if (itr->second.due <= kNow) {
+        due_batches.insert(std::move(*itr));
+        itr = state->batches.erase(itr);
+      } else {
+        next_due = std::min(next_due, itr->second.due);
+        ++itr;
+      }
+    }
+    if (next_due != Clock::time_point::max())
+      ArmTimer(state, next_due);
+  }
+  for (const auto& batch : due_batches)
+    state->flush(batch.second.peer_id, batch.first, batch.second.ack_ids);
+}
+
+void AppendAckIds(const std::vector<int32_t>& ack_ids, std::string& serialised_message) {
+  using google::protobuf::internal::WireFormatLite;
+  using google::protobuf::io::CodedOutputStream;
+  uint32_t size(0);
+  for (const auto& ack_id : ack_ids)
+    size += static_cast<uint32_t>(CodedOutputStream::VarintSize32SignExtended(ack_id));
+  // The output stream appends to the string, and trims any unused space when destroyed.
+  google::protobuf::io::StringOutputStream string_stream(&serialised_message);
+  CodedOutputStream coded_stream(&string_stream);
+  coded_stream.WriteTag(WireFormatLite::MakeTag(protobuf::Message::kAckIdsFieldNumber,
+                                                WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  coded_stream.WriteVarint32(size);
+  for (const auto& ack_id : ack_ids)
+    coded_stream.WriteVarint32SignExtended(ack_id);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
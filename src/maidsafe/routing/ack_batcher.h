@@ -0,0 +1,104 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ACK_BATCHER_H_
+#define MAIDSAFE_ROUTING_ACK_BATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "boost/asio/io_service.hpp"
+#include "boost/system/error_code.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Collects hop acks bound for connected peers, so that each peer gets one ack message per
+// Parameters::ack_batch_delay (or per Parameters::max_acks_per_batch acks) rather than one per
+// message it passed on.  Pending acks can instead be taken to ride along on other outgoing traffic.
+class AckBatcher {
+ public:
+  typedef std::function<void(const NodeId& peer_id, const NodeId& peer_connection_id,
+                             const std::vector<int32_t>& ack_ids)> FlushFunctor;
+
+  // 'flush' sends one batch.  It is invoked either by Add, when a batch fills, or on 'io_service'.
+  AckBatcher(boost::asio::io_service& io_service, FlushFunctor flush);
+  ~AckBatcher();
+  void Add(const NodeId& peer_id, const NodeId& peer_connection_id, int32_t ack_id);
+  // Removes and returns any acks pending for the peer on 'peer_connection_id', setting 'peer_id' to
+  // that peer's ID if there are any.
+  std::vector<int32_t> Take(const NodeId& peer_connection_id, NodeId& peer_id);
+  // Discards pending acks.  Once this returns, 'flush' will not be invoked again.
+  void Stop();
+  size_t pending() const;
+
+ private:
+  AckBatcher(const AckBatcher&);
+  AckBatcher(const AckBatcher&&);
+  AckBatcher& operator=(const AckBatcher&);
+
+  struct Batch {
+    Batch() : peer_id(), ack_ids(), due() {}
+    NodeId peer_id;
+    std::vector<int32_t> ack_ids;
+    Clock::time_point due;
+  };
+
+  // Shared with the timer's handler, which may run after this object has gone.
+  struct State {
+    State(boost::asio::io_service& io_service, FlushFunctor flush_in)
+        : flush_mutex(), mutex(), stopped(false), batches(), timer(io_service), timer_armed(false),
+          flush(flush_in) {}
+    // Held while 'flush' runs, so that Stop can wait for it.  Recursive, since sending a batch can
+    // complete other sends whose acks fill another one.
+    std::recursive_mutex flush_mutex;
+    mutable std::mutex mutex;
+    bool stopped;
+    std::map<NodeId, Batch> batches;  // by connection ID
+    SteadyTimer timer;
+    bool timer_armed;
+    FlushFunctor flush;
+  };
+
+  // Requires state->mutex to be held.
+  static void ArmTimer(const std::shared_ptr<State>& state, const Clock::time_point& expiry);
+  static void OnTimer(const std::shared_ptr<State>& state, const boost::system::error_code& error);
+
+  const std::shared_ptr<State> state_;
+};
+
+// Appends 'ack_ids' to a serialised protobuf::Message as its packed ack_ids field.  Parsers merge
+// repeated fields appended like this, so a message needn't be copied to carry taken acks.
+void AppendAckIds(const std::vector<int32_t>& ack_ids, std::string& serialised_message);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ACK_BATCHER_H_
@@ -19,6 +19,7 @@
 #include "maidsafe/routing/acknowledgement.h"
 
 #include <algorithm>
+#include <iterator>
 
 #include "maidsafe/common/asio_service.h"
 #include "boost/date_time.hpp"
@@ -26,14 +27,16 @@
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 
 namespace maidsafe {
 
 namespace routing {
 
-Acknowledgement::Acknowledgement(const NodeId& local_node_id, AsioService& io_service)
+Acknowledgement::Acknowledgement(const NodeId& local_node_id, AsioService& io_service,
+                                 RoutingMetrics* metrics)
     : kNodeId_(local_node_id), ack_id_(RandomInt32()), mutex_(), stop_handling_(false),
-      io_service_(io_service), queue_() {}
+      io_service_(io_service), metrics_(metrics), round_trip_functor_(), queue_() {}
 
 Acknowledgement::~Acknowledgement() {
   stop_handling_ = true;
@@ -48,9 +51,9 @@ void Acknowledgement::RemoveAll() {
       ack_ids.push_back(timer.ack_id);
     }
   }
-  LOG(kVerbose) << "Size of list: " << ack_ids.size();
+  ROUTING_LOG(kVerbose) << "Size of list: " << ack_ids.size();
   for (const auto& ack_id : ack_ids) {
-    LOG(kVerbose) << "still in list: " << ack_id;
+    ROUTING_LOG(kVerbose) << "still in list: " << ack_id;
     Remove(ack_id);
   }
 }
@@ -60,7 +63,8 @@ AckId Acknowledgement::GetId() {
   return ++ack_id_;
 }
 
-void Acknowledgement::Add(const protobuf::Message& message, Handler handler, int timeout) {
+void Acknowledgement::Add(const protobuf::Message& message, Handler handler, int timeout,
+                          const NodeId& peer_connection_id) {
   std::lock_guard<std::mutex> lock(mutex_);
   assert(message.has_ack_id() && "non-existing ack id");
   assert((message.ack_id() != 0) && "invalid ack id");
@@ -72,17 +76,20 @@ void Acknowledgement::Add(const protobuf::Message& message, Handler handler, int
                                return ack_id == timer.ack_id;
                              }));
   if (it == std::end(queue_)) {
-    TimerPointer timer(new asio::deadline_timer(io_service_.service(),
-                                                boost::posix_time::seconds(timeout)));
+    TimerPointer timer(new SteadyTimer(io_service_.service(), std::chrono::seconds(timeout)));
     timer->async_wait(handler);
-    queue_.emplace_back(AckTimer(ack_id, message, timer, 0));
-    LOG(kVerbose) << "AddAck added an ack, with id: " << ack_id;
+    queue_.emplace_back(AckTimer(ack_id, message, timer, 0, peer_connection_id));
+    ROUTING_LOG(kVerbose) << "AddAck added an ack, with id: " << ack_id;
   } else {
-    LOG(kVerbose) << "Acknowledgement re-sends " << message.id();
+    ROUTING_LOG(kVerbose) << "Acknowledgement re-sends " << message.id();
+    if (metrics_)
+      metrics_->AddAckRetry();
     it->quantity++;
-    it->timer->expires_from_now(boost::posix_time::seconds(timeout));
+    it->timer->expires_from_now(std::chrono::seconds(timeout));
     if (it->quantity == Parameters::max_send_retry) {
-      it->timer->async_wait([=](const boost::system::error_code&) {
+      it->timer->async_wait([=](const boost::system::error_code& error) {
+                              if (!error && metrics_)
+                                metrics_->AddAckTimeout();
                               Remove(ack_id);
                             });
      } else {
@@ -100,16 +107,50 @@ void Acknowledgement::Remove(AckId ack_id) {
   if (it != std::end(queue_)) {
     it->timer->cancel();
     queue_.erase(it);
-    LOG(kVerbose) << "After ack with id: " << ack_id << " queue size: " << queue_.size();
+    ROUTING_LOG(kVerbose) << "After ack with id: " << ack_id << " queue size: " << queue_.size();
   } else {
-    LOG(kVerbose) << "Non existiing ack id" << ack_id << " queue size: " << queue_.size();
+    ROUTING_LOG(kVerbose) << "Non existiing ack id" << ack_id << " queue size: " << queue_.size();
   }
 }
 
 void Acknowledgement::HandleMessage(AckId ack_id) {
   assert((ack_id != 0) && "Invalid acknowledgement id");
-  LOG(kVerbose) << "MessageHandler::HandleAckMessage " << ack_id;
-  Remove(ack_id);
+  ROUTING_LOG(kVerbose) << "MessageHandler::HandleAckMessage " << ack_id;
+  HandleMessage(std::vector<AckId>(1, ack_id));
+}
+
+void Acknowledgement::HandleMessage(std::vector<AckId> ack_ids) {
+  std::sort(ack_ids.begin(), ack_ids.end());
+  std::vector<std::pair<NodeId, Clock::duration>> round_trips;
+  RoundTripFunctor round_trip_functor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Clock::time_point kNow(Clock::now());
+    auto removed(std::remove_if(std::begin(queue_), std::end(queue_),
+                                [&](const AckTimer& timer)->bool {
+                                  if (!std::binary_search(ack_ids.begin(), ack_ids.end(),
+                                                          timer.ack_id))
+                                    return false;
+                                  timer.timer->cancel();
+                                  if (timer.quantity == 0 && !timer.peer_connection_id.IsZero())
+                                    round_trips.push_back(std::make_pair(timer.peer_connection_id,
+                                                                         kNow - timer.sent_at));
+                                  return true;
+                                }));
+    ROUTING_LOG(kVerbose) << "Batch of " << ack_ids.size() << " acks matched "
+                          << std::distance(removed, std::end(queue_)) << " pending";
+    queue_.erase(removed, std::end(queue_));
+    round_trip_functor = round_trip_functor_;
+  }
+  if (!round_trip_functor)
+    return;
+  for (const auto& round_trip : round_trips)
+    round_trip_functor(round_trip.first, round_trip.second);
+}
+
+void Acknowledgement::set_round_trip_functor(RoundTripFunctor round_trip_functor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  round_trip_functor_ = round_trip_functor;
 }
 
 bool Acknowledgement::IsSendingAckRequired(const protobuf::Message& message,
@@ -121,7 +162,7 @@ bool Acknowledgement::IsSendingAckRequired(const protobuf::Message& message,
 }
 
 bool Acknowledgement::NeedsAck(const protobuf::Message& message, const NodeId& node_id) {
-  LOG(kVerbose) << "node_id: " << HexSubstr(node_id.string());
+  ROUTING_LOG(kVerbose) << "node_id: " << HexSubstr(node_id.string());
 
   if (message.ack_id() == 0)
     return false;
@@ -144,12 +185,12 @@ bool Acknowledgement::NeedsAck(const protobuf::Message& message, const NodeId& n
   if (message.source_id().empty())
     return false;
 
-  LOG(kVerbose) << PrintMessage(message);
+  ROUTING_LOG(kVerbose) << PrintMessage(message);
   return true;
 }
 
 void Acknowledgement::AdjustAckHistory(protobuf::Message& message) {
-  LOG(kVerbose) << "size of acks "  << message.ack_node_ids_size();
+  ROUTING_LOG(kVerbose) << "size of acks "  << message.ack_node_ids_size();
   if (message.relay_id() == kNodeId_.string())
     return;
   assert((message.ack_node_ids_size() <= 2) && "size of ack list must be smaller than 3");
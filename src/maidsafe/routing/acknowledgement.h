@@ -30,7 +30,9 @@
 #include "boost/asio.hpp"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/clock.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/routing_metrics.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/rudp/managed_connections.h"
 #include "maidsafe/common/asio_service.h"
@@ -50,8 +52,10 @@ namespace test {
   class GenericNode;
 }
 
-typedef std::shared_ptr<asio::deadline_timer> TimerPointer;
+typedef std::shared_ptr<SteadyTimer> TimerPointer;
 typedef std::function<void(const boost::system::error_code& error)> Handler;
+typedef std::function<void(const NodeId& peer_connection_id, Clock::duration round_trip)>
+    RoundTripFunctor;
 
 enum class GroupMessageAckStatus {
   kPending = 0,
@@ -61,17 +65,22 @@ enum class GroupMessageAckStatus {
 
 struct AckTimer {
   AckTimer(AckId ack_id_in, const protobuf::Message& message_in, TimerPointer timer_in,
-           unsigned int quantity_in)
-    : ack_id(ack_id_in), message(message_in), timer(timer_in), quantity(quantity_in) {}
+           unsigned int quantity_in, const NodeId& peer_connection_id_in)
+    : ack_id(ack_id_in), message(message_in), timer(timer_in), quantity(quantity_in),
+      peer_connection_id(peer_connection_id_in), sent_at(Clock::now()) {}
   AckId ack_id;
   protobuf::Message message;
   TimerPointer timer;
   unsigned int quantity;
+  NodeId peer_connection_id;
+  Clock::time_point sent_at;
 };
 
 class Acknowledgement {
  public:
-  Acknowledgement(const NodeId& local_node_id, AsioService& io_service);
+  // 'metrics', if provided, must outlive this object.
+  Acknowledgement(const NodeId& local_node_id, AsioService& io_service,
+                  RoutingMetrics* metrics = nullptr);
   Acknowledgement& operator=(const Acknowledgement&) = delete;
   Acknowledgement& operator=(const Acknowledgement&&) = delete;
   Acknowledgement(const Acknowledgement&) = delete;
@@ -79,9 +88,16 @@ class Acknowledgement {
 
   ~Acknowledgement();
   AckId GetId();
-  void Add(const protobuf::Message& message, Handler handler, int timeout);
+  // 'peer_connection_id' is the hop the message was sent to, whose ack is awaited.
+  void Add(const protobuf::Message& message, Handler handler, int timeout,
+           const NodeId& peer_connection_id = NodeId());
   void Remove(AckId ack_id);
   void HandleMessage(AckId ack_id);
+  // Removes all of 'ack_ids' in one pass, e.g. for a batch of acks from one peer.
+  void HandleMessage(std::vector<AckId> ack_ids);
+  // Called, outside any lock, with the time from sending a message to a peer until its ack arrived.
+  // Messages which were re-sent aren't reported, since it isn't known which send was acked.
+  void set_round_trip_functor(RoundTripFunctor round_trip_functor);
   bool NeedsAck(const protobuf::Message& message, const NodeId& node_id);
   bool IsSendingAckRequired(const protobuf::Message& message, const NodeId& local_node_id);
   void SetAsFailedPeer(AckId ack_id, const NodeId& node_id);
@@ -96,6 +112,8 @@ class Acknowledgement {
   std::mutex mutex_;
   bool stop_handling_;
   AsioService& io_service_;
+  RoutingMetrics* metrics_;
+  RoundTripFunctor round_trip_functor_;
   std::vector<AckTimer> queue_;
 };
 
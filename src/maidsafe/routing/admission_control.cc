@@ -0,0 +1,95 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/admission_control.h"
+
+#include <algorithm>
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kMinPruneThreshold(4096);
+
+double Refill(double tokens, const Clock::duration& elapsed, unsigned int rate,
+              unsigned int burst) {
+  double seconds(std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count());
+  return std::min(static_cast<double>(burst), tokens + seconds * rate);
+}
+
+}  // unnamed namespace
+
+AdmissionControl::AdmissionControl()
+    : mutex_(), client_buckets_(), vault_buckets_(), prune_threshold_(kMinPruneThreshold) {}
+
+bool AdmissionControl::Admit(const NodeId& sender, bool client) {
+  const unsigned int kRate(client ? Parameters::admission_client_rate
+                                  : Parameters::admission_vault_rate);
+  if (kRate == 0)
+    return true;
+  const unsigned int kBurst(std::max(client ? Parameters::admission_client_burst
+                                            : Parameters::admission_vault_burst, 1U));
+  const Clock::time_point kNow(Clock::now());
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Admit(client ? client_buckets_ : vault_buckets_, sender, kRate, kBurst, kNow);
+}
+
+bool AdmissionControl::Admit(Buckets& buckets, const NodeId& sender, unsigned int rate,
+                             unsigned int burst, const Clock::time_point& now) {
+  auto itr(buckets.find(sender));
+  if (itr == buckets.end()) {
+    if (client_buckets_.size() + vault_buckets_.size() >= prune_threshold_) {
+      Prune(buckets, rate, burst, now);
+      prune_threshold_ = std::max(kMinPruneThreshold,
+                                  2 * (client_buckets_.size() + vault_buckets_.size()));
+    }
+    buckets.insert(std::make_pair(sender, Bucket(burst - 1.0, now)));
+    return true;
+  }
+  Bucket& bucket(itr->second);
+  bucket.tokens = Refill(bucket.tokens, now - bucket.refill_time, rate, burst);
+  bucket.refill_time = now;
+  if (bucket.tokens < 1.0)
+    return false;
+  bucket.tokens -= 1.0;
+  return true;
+}
+
+void AdmissionControl::Prune(Buckets& buckets, unsigned int rate, unsigned int burst,
+                             const Clock::time_point& now) {
+  // A full bucket carries no state beyond a fresh one, so it can be forgotten.
+  for (auto itr(buckets.begin()); itr != buckets.end();) {
+    if (Refill(itr->second.tokens, now - itr->second.refill_time, rate, burst) >= burst)
+      itr = buckets.erase(itr);
+    else
+      ++itr;
+  }
+}
+
+size_t AdmissionControl::tracked_senders() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return client_buckets_.size() + vault_buckets_.size();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
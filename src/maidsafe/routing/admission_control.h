@@ -0,0 +1,73 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ADMISSION_CONTROL_H_
+#define MAIDSAFE_ROUTING_ADMISSION_CONTROL_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Per-peer token buckets for node-level requests delivered to this node, keyed on the previous hop,
+// with separate budgets for clients and vaults (Parameters::admission_*).  A sender's bucket holds
+// up to 'burst' tokens and refills at 'rate' tokens per second; each admitted message takes one.
+// Buckets which have refilled are discarded once too many senders are tracked, so a flood of fresh
+// IDs can't grow this unbounded.
+class AdmissionControl {
+ public:
+  AdmissionControl();
+  // Returns false if 'sender' has no tokens left, in which case the message should be shed.
+  bool Admit(const NodeId& sender, bool client);
+  size_t tracked_senders() const;
+
+ private:
+  AdmissionControl(const AdmissionControl&);
+  AdmissionControl(const AdmissionControl&&);
+  AdmissionControl& operator=(const AdmissionControl&);
+
+  struct Bucket {
+    Bucket(double tokens_in, const Clock::time_point& refill_time_in)
+        : tokens(tokens_in), refill_time(refill_time_in) {}
+    double tokens;
+    Clock::time_point refill_time;
+  };
+  typedef std::map<NodeId, Bucket> Buckets;
+
+  bool Admit(Buckets& buckets, const NodeId& sender, unsigned int rate, unsigned int burst,
+             const Clock::time_point& now);
+  void Prune(Buckets& buckets, unsigned int rate, unsigned int burst,
+             const Clock::time_point& now);
+
+  mutable std::mutex mutex_;
+  Buckets client_buckets_, vault_buckets_;
+  size_t prune_threshold_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ADMISSION_CONTROL_H_
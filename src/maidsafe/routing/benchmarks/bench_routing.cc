@@ -0,0 +1,641 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Micro-benchmarks for the routing internals which sit on the message hot path.  Results are
+// written as JSON by default (to stdout, or to the file named by --benchmark_out) so that runs can
+// be compared across commits, e.g. with google-benchmark's tools/compare.py.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/config.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/acknowledgement.h"
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/close_nodes_change.h"
+#include "maidsafe/routing/firewall.h"
+#include "maidsafe/routing/flight_recorder.h"
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/network.h"
+#include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_access.h"
+#include "maidsafe/routing/routing_host.h"
+#include "maidsafe/routing/routing_log.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/utils.h"
+
+namespace {
+
+// Every heap allocation in the process is counted, so that benchmarks can report allocations per
+// iteration alongside their timings.
+std::atomic<std::uint64_t> g_allocation_count(0);
+
+}  // unnamed namespace
+
+void* operator new(std::size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) MAIDSAFE_NOEXCEPT { std::free(pointer); }
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const int kMaxTableSize(1024);
+
+// RSA key generation dominates any table operation, and the routing table insists on unique public
+// keys, so a single pool of nodes is generated on first use and shared by every benchmark.
+const std::vector<NodeInfo>& NodePool() {
+  static const std::vector<NodeInfo> pool([] {
+    std::vector<NodeInfo> nodes;
+    nodes.reserve(kMaxTableSize + 1);
+    for (int i(0); i != kMaxTableSize + 1; ++i) {
+      NodeInfo node;
+      node.id = NodeId(NodeId::IdType::kRandomId);
+      node.connection_id = node.id;
+      node.public_key = asymm::GenerateKeyPair().public_key;
+      nodes.push_back(node);
+    }
+    return nodes;
+  }());
+  return pool;
+}
+
+// Builds a table holding the first 'size' nodes of the pool.  The table's maximum size is fixed at
+// construction, so Parameters::max_routing_table_size is raised only for the duration of that.
+std::unique_ptr<RoutingTable> MakeRoutingTable(int size) {
+  const auto& pool(NodePool());
+  auto max_size(Parameters::max_routing_table_size);
+  Parameters::max_routing_table_size =
+      std::max(max_size, static_cast<unsigned int>(size + 1));
+  std::unique_ptr<RoutingTable> routing_table(
+      new RoutingTable(false, NodeId(NodeId::IdType::kRandomId), asymm::GenerateKeyPair()));
+  Parameters::max_routing_table_size = max_size;
+  for (int i(0); i != size; ++i)
+    routing_table->AddNode(pool[i]);
+  return routing_table;
+}
+
+// Builds a table of maximum size 'size' which is filled from the pool, so further additions must
+// evict.
+std::unique_ptr<RoutingTable> MakeFullRoutingTable(int size) {
+  const auto& pool(NodePool());
+  auto max_size(Parameters::max_routing_table_size);
+  Parameters::max_routing_table_size = static_cast<unsigned int>(size);
+  std::unique_ptr<RoutingTable> routing_table(
+      new RoutingTable(false, NodeId(NodeId::IdType::kRandomId), asymm::GenerateKeyPair()));
+  Parameters::max_routing_table_size = max_size;
+  for (int i(0); routing_table->size() != static_cast<size_t>(size); ++i)
+    routing_table->AddNode(pool[i]);
+  return routing_table;
+}
+
+// Reports the heap allocations made since 'start' as a per-iteration average.
+void SetAllocationsPerIteration(benchmark::State& state, std::uint64_t start) {
+  state.counters["allocs_per_iter"] = benchmark::Counter(
+      static_cast<double>(g_allocation_count - start), benchmark::Counter::kAvgIterations);
+}
+
+std::vector<NodeId> RandomIds(int count) {
+  std::vector<NodeId> ids;
+  ids.reserve(count);
+  for (int i(0); i != count; ++i)
+    ids.push_back(NodeId(NodeId::IdType::kRandomId));
+  return ids;
+}
+
+protobuf::Message MakeNodeLevelMessage(const NodeId& source_id, const NodeId& destination_id,
+                                       size_t data_size) {
+  protobuf::Message message;
+  message.set_source_id(source_id.string());
+  message.set_destination_id(destination_id.string());
+  message.set_routing_message(false);
+  message.add_data(RandomString(data_size));
+  message.set_direct(true);
+  message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+  message.set_cacheable(static_cast<int32_t>(Cacheable::kNone));
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_replication(1);
+  message.set_ack_id(1);
+  message.set_id(0);
+  for (int i(0); i != 4; ++i)
+    message.add_route_history(NodeId(NodeId::IdType::kRandomId).string());
+  return message;
+}
+
+// ================================ RoutingTable ================================================ //
+
+void BM_RoutingTableAddDrop(benchmark::State& state) {
+  auto size(static_cast<int>(state.range(0)));
+  auto routing_table(MakeRoutingTable(size - 1));
+  const NodeInfo& node(NodePool()[size - 1]);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(routing_table->AddNode(node));
+    routing_table->DropNode(node.id, true);
+  }
+}
+BENCHMARK(BM_RoutingTableAddDrop)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+// Deciding whether a full table would evict one of its nodes for a newcomer.
+void BM_RoutingTableCheckNodeFull(benchmark::State& state) {
+  auto routing_table(MakeFullRoutingTable(static_cast<int>(state.range(0))));
+  const NodeInfo& node(NodePool()[kMaxTableSize]);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(routing_table->CheckNode(node));
+}
+BENCHMARK(BM_RoutingTableCheckNodeFull)->RangeMultiplier(2)->Range(64, kMaxTableSize);
+
+void BM_RoutingTableGetClosestNodes(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(routing_table->GetClosestNodes(
+        targets[index++ % targets.size()], Parameters::closest_nodes_size));
+  }
+  SetAllocationsPerIteration(state, allocations);
+}
+BENCHMARK(BM_RoutingTableGetClosestNodes)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+void BM_RoutingTableGetClosestPeers(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  std::vector<PeerView> peers;
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state) {
+    routing_table->GetClosestPeers(targets[index++ % targets.size()],
+                                   Parameters::closest_nodes_size, peers);
+    benchmark::DoNotOptimize(peers.data());
+  }
+  SetAllocationsPerIteration(state, allocations);
+}
+BENCHMARK(BM_RoutingTableGetClosestPeers)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+void BM_RoutingTableGetClosestNode(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(routing_table->GetClosestNode(targets[index++ % targets.size()]));
+  SetAllocationsPerIteration(state, allocations);
+}
+BENCHMARK(BM_RoutingTableGetClosestNode)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+void BM_RoutingTableGetClosestPeer(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(routing_table->GetClosestPeer(targets[index++ % targets.size()]));
+  SetAllocationsPerIteration(state, allocations);
+}
+BENCHMARK(BM_RoutingTableGetClosestPeer)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+void BM_RoutingTableIsThisNodeInRange(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(routing_table->IsThisNodeInRange(targets[index++ % targets.size()],
+                                                              Parameters::group_size));
+  }
+}
+BENCHMARK(BM_RoutingTableIsThisNodeInRange)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+// The table queries a message handler used to make for one routed message, versus the single
+// RouteDecision which now replaces them.
+void BM_RoutingTableSeparateQueries(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  for (auto _ : state) {
+    const NodeId& target(targets[index++ % targets.size()]);
+    benchmark::DoNotOptimize(routing_table->IsThisNodeInRange(target,
+                                                              Parameters::closest_nodes_size));
+    benchmark::DoNotOptimize(routing_table->IsThisNodeClosestTo(target));
+    benchmark::DoNotOptimize(routing_table->Contains(target));
+    benchmark::DoNotOptimize(routing_table->GetClosestNode(target, false));
+  }
+}
+BENCHMARK(BM_RoutingTableSeparateQueries)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+void BM_RoutingTableRouteDecision(benchmark::State& state) {
+  auto routing_table(MakeRoutingTable(static_cast<int>(state.range(0))));
+  auto targets(RandomIds(256));
+  size_t index(0);
+  for (auto _ : state) {
+    auto route_decision(routing_table->GetRouteDecision(targets[index++ % targets.size()]));
+    benchmark::DoNotOptimize(route_decision.ClosestNode(false));
+  }
+}
+BENCHMARK(BM_RoutingTableRouteDecision)->RangeMultiplier(2)->Range(8, kMaxTableSize);
+
+// ================================ Firewall ==================================================== //
+
+void BM_FirewallAdd(benchmark::State& state) {
+  Firewall firewall;
+  auto sources(RandomIds(64));
+  int32_t message_id(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(firewall.Add(sources[message_id % sources.size()], message_id));
+    ++message_id;
+  }
+}
+BENCHMARK(BM_FirewallAdd);
+
+// ================================ Acknowledgement ============================================= //
+
+void BM_AcknowledgementAddRemove(benchmark::State& state) {
+  AsioService asio_service(1);
+  Acknowledgement acknowledgement(NodeId(NodeId::IdType::kRandomId), asio_service);
+  auto message(MakeNodeLevelMessage(NodeId(NodeId::IdType::kRandomId),
+                                    NodeId(NodeId::IdType::kRandomId), 64));
+  for (auto _ : state) {
+    auto ack_id(acknowledgement.GetId());
+    message.set_ack_id(ack_id);
+    acknowledgement.Add(message, [](const boost::system::error_code&) {},
+                        Parameters::ack_timeout);
+    acknowledgement.Remove(ack_id);
+  }
+  acknowledgement.RemoveAll();
+  asio_service.Stop();
+}
+BENCHMARK(BM_AcknowledgementAddRemove);
+
+// ================================ Timer ======================================================= //
+
+void BM_TimerAddTaskAddResponse(benchmark::State& state) {
+  AsioService asio_service(1);
+  Timer<std::string> timer(asio_service);
+  std::atomic<int> responses(0);
+  const std::string response("response");
+  for (auto _ : state) {
+    auto task_id(timer.NewTaskId());
+    timer.AddTask(std::chrono::seconds(10), [&](std::string) { ++responses; }, 1, task_id);
+    timer.AddResponse(task_id, response);
+  }
+  timer.CancelAll();
+  asio_service.Stop();
+}
+BENCHMARK(BM_TimerAddTaskAddResponse);
+
+// ================================ Protobuf ==================================================== //
+
+void BM_MessageSerialise(benchmark::State& state) {
+  auto message(MakeNodeLevelMessage(NodeId(NodeId::IdType::kRandomId),
+                                    NodeId(NodeId::IdType::kRandomId),
+                                    static_cast<size_t>(state.range(0))));
+  std::string serialised;
+  for (auto _ : state) {
+    message.SerializeToString(&serialised);
+    benchmark::DoNotOptimize(serialised.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * serialised.size());
+}
+BENCHMARK(BM_MessageSerialise)->Arg(64)->Arg(1024)->Arg(64 * 1024);
+
+void BM_MessageParse(benchmark::State& state) {
+  auto serialised(MakeNodeLevelMessage(NodeId(NodeId::IdType::kRandomId),
+                                       NodeId(NodeId::IdType::kRandomId),
+                                       static_cast<size_t>(state.range(0))).SerializeAsString());
+  protobuf::Message message;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(message.ParseFromString(serialised));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * serialised.size());
+}
+BENCHMARK(BM_MessageParse)->Arg(64)->Arg(1024)->Arg(64 * 1024);
+
+// Delivering a typed message: with Parameters::copy_message_contents the payload is copied into
+// Message::contents, otherwise the received buffer is shared.
+void BM_CreateSingleToSingleMessage(benchmark::State& state) {
+  const bool kCopy(state.range(1) != 0);
+  auto message(MakeNodeLevelMessage(NodePool()[0].id, NodePool()[1].id, 0));
+  SharedContents contents(
+      std::make_shared<const std::string>(RandomString(static_cast<size_t>(state.range(0)))));
+  auto copy_message_contents(Parameters::copy_message_contents);
+  Parameters::copy_message_contents = kCopy;
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(CreateSingleToSingleMessage(message, contents));
+  SetAllocationsPerIteration(state, allocations);
+  Parameters::copy_message_contents = copy_message_contents;
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateSingleToSingleMessage)
+    ->Args({1024, 1})
+    ->Args({1024, 0})
+    ->Args({1024 * 1024, 1})
+    ->Args({1024 * 1024, 0});
+
+// ================================ CloseNodesChange ============================================ //
+
+// CloseNodesChange can only be made by a RoutingTable, so one is taken from the notification sent
+// when a table's full close group gains a closer node.
+CloseNodesChange MakeCloseNodesChange() {
+  const auto& pool(NodePool());
+  RoutingTable routing_table(false, NodeId(NodeId::IdType::kRandomId), asymm::GenerateKeyPair());
+  std::shared_ptr<CloseNodesChange> close_nodes_change;
+  routing_table.InitialiseFunctors([&](const RoutingTableChange& routing_table_change) {
+    close_nodes_change = routing_table_change.close_nodes_change;
+  });
+  size_t index(0);
+  while (routing_table.size() != Parameters::closest_nodes_size)
+    routing_table.AddNode(pool.at(index++));
+  close_nodes_change.reset();
+  while (!close_nodes_change)
+    routing_table.AddNode(pool.at(index++));
+  return *close_nodes_change;
+}
+
+void BM_CloseNodesChangeCheckHolders(benchmark::State& state) {
+  auto close_nodes_change(MakeCloseNodesChange());
+  auto targets(RandomIds(256));
+  size_t index(0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(close_nodes_change.CheckHolders(targets[index++ % targets.size()]));
+}
+BENCHMARK(BM_CloseNodesChangeCheckHolders);
+
+// Re-replication after a close group change: every stored key checked one at a time, against the
+// bulk CheckHolders which skips the parts of the keyspace the change can't affect.
+std::vector<NodeId> SortedRandomIds(int count) {
+  auto ids(RandomIds(count));
+  std::sort(std::begin(ids), std::end(ids));
+  return ids;
+}
+
+void BM_CloseNodesChangeCheckHoldersLoop(benchmark::State& state) {
+  auto close_nodes_change(MakeCloseNodesChange());
+  auto targets(SortedRandomIds(static_cast<int>(state.range(0))));
+  for (auto _ : state) {
+    std::vector<std::pair<NodeId, CheckHoldersResult>> changed;
+    for (const auto& target : targets) {
+      auto result(close_nodes_change.CheckHolders(target));
+      if (!result.new_holder.IsZero())
+        changed.emplace_back(target, result);
+    }
+    benchmark::DoNotOptimize(changed);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CloseNodesChangeCheckHoldersLoop)
+    ->Arg(1 << 16)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CloseNodesChangeCheckHoldersBulk(benchmark::State& state) {
+  auto close_nodes_change(MakeCloseNodesChange());
+  auto targets(SortedRandomIds(static_cast<int>(state.range(0))));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(close_nodes_change.CheckHolders(targets));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CloseNodesChangeCheckHoldersBulk)
+    ->Arg(1 << 16)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ================================ FlightRecorder ============================================== //
+
+// Cost of one hop event with the recorder off (arg 0) and on (arg 1).
+void BM_FlightRecorderAdd(benchmark::State& state) {
+  auto message(MakeNodeLevelMessage(NodePool()[0].id, NodePool()[1].id, 1024));
+  uint64_t node(FlightRecorder::Prefix(NodePool()[2].id.string()));
+  bool enabled(Parameters::flight_recorder);
+  Parameters::flight_recorder = (state.range(0) != 0);
+  for (auto _ : state)
+    FlightRecorder::Add(FlightEvent::kReceived, node, message);
+  Parameters::flight_recorder = enabled;
+}
+BENCHMARK(BM_FlightRecorderAdd)->Arg(0)->Arg(1);
+
+// ================================ RoutingHost ================================================= //
+
+// Many nodes on one host, each node's work posted to the service the host assigned it: the shared
+// pool, where a node's table is touched from whichever thread is free, against one pinned thread
+// per core, where it always stays on the same core.  Each node answers a burst of closest-peer
+// lookups per iteration, as it would for a burst of messages arriving over its connections.
+void BM_HostedNodeWork(benchmark::State& state) {
+  const bool kPinned(state.range(0) != 0);
+  const int kNodeCount(static_cast<int>(state.range(1)));
+  const int kLookupsPerNode(256);
+  unsigned int thread_count(std::max(2U, std::thread::hardware_concurrency()));
+  std::vector<unsigned int> cores;
+  for (unsigned int core(0); core != thread_count; ++core)
+    cores.push_back(core);
+  std::unique_ptr<RoutingHost> host(kPinned ? new RoutingHost(cores)
+                                            : new RoutingHost(thread_count));
+
+  std::vector<std::unique_ptr<RoutingTable>> routing_tables;
+  std::vector<AsioService*> asio_services;
+  for (int i(0); i != kNodeCount; ++i) {
+    routing_tables.push_back(MakeRoutingTable(64));
+    asio_services.push_back(&RoutingAccess::NextAsioService(*host));
+  }
+  auto targets(RandomIds(kLookupsPerNode));
+
+  for (auto _ : state) {
+    std::atomic<int> remaining(kNodeCount);
+    std::promise<void> done;
+    for (int i(0); i != kNodeCount; ++i) {
+      RoutingTable* routing_table(routing_tables[i].get());
+      asio_services[i]->service().post([&, routing_table] {
+        for (const auto& target : targets)
+          benchmark::DoNotOptimize(routing_table->GetClosestPeer(target));
+        if (--remaining == 0)
+          done.set_value();
+      });
+    }
+    done.get_future().wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kNodeCount * kLookupsPerNode);
+  state.counters["pinned_threads"] = static_cast<double>(host->pinned_thread_count());
+}
+BENCHMARK(BM_HostedNodeWork)
+    ->Args({0, 16})
+    ->Args({1, 16})
+    ->Args({0, 128})
+    ->Args({1, 128})
+    ->UseRealTime();
+
+// ================================ MessageHandler ============================================== //
+
+// A network whose sends are no-ops, so that only the handler's dispatch cost is measured.
+class NullNetwork : public Network {
+ public:
+  NullNetwork(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+              Acknowledgement& acknowledgement)
+      : Network(routing_table, client_routing_table, acknowledgement) {}
+  virtual void SendToDirect(protobuf::Message& /*message*/, const NodeId& /*peer_node_id*/,
+                            const NodeId& /*peer_connection_id*/) {}
+  virtual void SendToClosestNode(const protobuf::Message& /*message*/) {}
+  virtual void SendToClosestNode(const protobuf::Message& /*message*/,
+                                 const RouteDecision& /*route_decision*/) {}
+
+ private:
+  NullNetwork(const NullNetwork&);
+  NullNetwork(const NullNetwork&&);
+  NullNetwork& operator=(const NullNetwork&);
+};
+
+// Mirrors the MessageHandlerTest fixture: a real routing table and handler in front of a
+// NullNetwork.
+class MessageHandlerBench {
+ public:
+  explicit MessageHandlerBench(int table_size)
+      : asio_service_(2),
+        timer_(asio_service_),
+        routing_table_(MakeRoutingTable(table_size)),
+        client_routing_table_(routing_table_->kNodeId()),
+        network_utils_(routing_table_->kNodeId(), asio_service_),
+        network_(*routing_table_, client_routing_table_, network_utils_.acknowledgement_),
+        message_handler_(*routing_table_, client_routing_table_, network_, timer_, network_utils_,
+                         asio_service_) {
+    MessageAndCachingFunctors functors;
+    functors.message_received = [](const std::string&, ReplyFunctor) {};
+    message_handler_.set_message_and_caching_functor(functors);
+  }
+
+  ~MessageHandlerBench() {
+    network_utils_.acknowledgement_.RemoveAll();
+    timer_.CancelAll();
+    asio_service_.Stop();
+  }
+
+  MessageHandler& message_handler() { return message_handler_; }
+  NodeId kNodeId() const { return routing_table_->kNodeId(); }
+
+ private:
+  AsioService asio_service_;
+  Timer<std::string> timer_;
+  std::unique_ptr<RoutingTable> routing_table_;
+  ClientRoutingTable client_routing_table_;
+  NetworkUtils network_utils_;
+  NullNetwork network_;
+  MessageHandler message_handler_;
+};
+
+void BM_MessageHandlerForwardAsFarNode(benchmark::State& state) {
+  MessageHandlerBench bench(static_cast<int>(state.range(0)));
+  // A destination at maximal distance from this node is never within its close group.
+  auto destination_id(bench.kNodeId() ^ NodeId(std::string(NodeId::kSize, '\xff')));
+  auto message(MakeNodeLevelMessage(NodePool()[0].id, destination_id, 1024));
+  int32_t message_id(0);
+  auto allocations(g_allocation_count.load());
+  for (auto _ : state) {
+    protobuf::Message copy(message);
+    copy.set_id(message_id++);
+    bench.message_handler().HandleMessage(copy);
+  }
+  SetAllocationsPerIteration(state, allocations);
+}
+BENCHMARK(BM_MessageHandlerForwardAsFarNode)->RangeMultiplier(4)->Range(16, kMaxTableSize);
+
+// Forwarding with routing log statements ungated, as before ROUTING_LOG, so that every compiled-in
+// one builds its arguments (0), against the default gate (1).  Logging isn't initialised here, so
+// maidsafe::log discards them either way.  Release builds compile out kVerbose and kInfo, leaving
+// little to gate.
+void BM_MessageHandlerForwardLogGate(benchmark::State& state) {
+  const int kMinLogLevel(Parameters::min_log_level);
+  Parameters::min_log_level = state.range(0) ? kLogLevelFromFilter : log::kVerbose;
+  MessageHandlerBench bench(64);
+  auto destination_id(bench.kNodeId() ^ NodeId(std::string(NodeId::kSize, '\xff')));
+  auto message(MakeNodeLevelMessage(NodePool()[0].id, destination_id, 1024));
+  int32_t message_id(0);
+  for (auto _ : state) {
+    protobuf::Message copy(message);
+    copy.set_id(message_id++);
+    bench.message_handler().HandleMessage(copy);
+  }
+  Parameters::min_log_level = kMinLogLevel;
+}
+BENCHMARK(BM_MessageHandlerForwardLogGate)->Arg(0)->Arg(1);
+
+void BM_MessageHandlerDeliverToThisNode(benchmark::State& state) {
+  MessageHandlerBench bench(static_cast<int>(state.range(0)));
+  auto message(MakeNodeLevelMessage(NodePool()[0].id, bench.kNodeId(), 1024));
+  int32_t message_id(0);
+  for (auto _ : state) {
+    protobuf::Message copy(message);
+    copy.set_id(message_id++);  // distinct ids so that the firewall doesn't drop repeats
+    bench.message_handler().HandleMessage(copy);
+  }
+}
+BENCHMARK(BM_MessageHandlerDeliverToThisNode)->RangeMultiplier(4)->Range(16, kMaxTableSize);
+
+}  // unnamed namespace
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+// Unless the caller chose a console format, results go out as JSON for machine comparison.
+int main(int argc, char** argv) {
+  std::vector<char*> args(argv, argv + argc);
+  char json_format[] = "--benchmark_format=json";
+  if (std::none_of(std::begin(args), std::end(args), [](const char* arg) {
+        return std::strncmp(arg, "--benchmark_format", 18) == 0;
+      })) {
+    args.push_back(json_format);
+  }
+  int arg_count(static_cast<int>(args.size()));
+  benchmark::Initialize(&arg_count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(arg_count, args.data()))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
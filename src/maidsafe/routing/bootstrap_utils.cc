@@ -22,6 +22,8 @@
 
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/routing_log.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -58,8 +60,8 @@ BootstrapContacts GetBootstrapContacts(bool is_client) {
   try {
     bootstrap_contacts = ReadBootstrapContacts(kCurrentBootstrapFilePath);
   } catch (const std::exception& error) {
-    LOG(kWarning) << "Failed to read bootstrap file at : " << kCurrentBootstrapFilePath
-                  << " . Error : " << boost::diagnostic_information(error);
+    ROUTING_LOG(kWarning) << "Failed to read bootstrap file at : " << kCurrentBootstrapFilePath
+                          << " . Error : " << boost::diagnostic_information(error);
   }
 
   if (kCurrentBootstrapFilePath == (is_client ? detail::GetDefaultBootstrapFilePath<true>() :
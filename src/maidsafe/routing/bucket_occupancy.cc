@@ -0,0 +1,145 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/bucket_occupancy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+BucketOccupancy::BucketOccupancy(const NodeId& this_node_id)
+    : kNodeId_(this_node_id), buckets_(), size_(0) {}
+
+int32_t BucketOccupancy::BucketIndex(const NodeId& this_node_id, const NodeId& node_id) {
+  const std::string& holder_raw_id(this_node_id.string());
+  const std::string& node_raw_id(node_id.string());
+  for (int32_t byte_index(0); byte_index != NodeId::kSize; ++byte_index) {
+    unsigned int difference(static_cast<unsigned char>(holder_raw_id[byte_index]) ^
+                            static_cast<unsigned char>(node_raw_id[byte_index]));
+    if (difference != 0) {
+      int32_t bit_index(0);
+      while ((difference & 0x80) == 0) {
+        difference <<= 1;
+        ++bit_index;
+      }
+      return (8 * (NodeId::kSize - byte_index)) - bit_index - 1;
+    }
+  }
+  return 0;
+}
+
+void BucketOccupancy::Add(const NodeId& node_id, int32_t bucket) {
+  auto members(buckets_.find(bucket));
+  if (members == std::end(buckets_))
+    members = buckets_.insert(std::make_pair(bucket,
+                                             BucketMembers(CloserToThisNode(kNodeId_)))).first;
+  if (members->second.insert(node_id).second)
+    ++size_;
+}
+
+void BucketOccupancy::Remove(const NodeId& node_id, int32_t bucket) {
+  auto members(buckets_.find(bucket));
+  if (members == std::end(buckets_))
+    return;
+  size_ -= members->second.erase(node_id);
+  if (members->second.empty())
+    buckets_.erase(members);
+}
+
+size_t BucketOccupancy::BucketSize(int32_t bucket) const {
+  auto members(buckets_.find(bucket));
+  return members == std::end(buckets_) ? 0 : members->second.size();
+}
+
+const NodeId& BucketOccupancy::Furthest() const {
+  assert(!buckets_.empty());
+  return *buckets_.rbegin()->second.rbegin();
+}
+
+bool BucketOccupancy::ChooseEviction(const NodeId& node_id, int32_t bucket,
+                                     NodeId& evictee) const {
+  // Buckets are visited closest first.  The unidirectional_interest_range closest nodes, and at
+  // least the close nodes and their standby, are never evicted, so they're left out of the counts;
+  // the first node after them is 'interest_boundary'.
+  unsigned int skip_count(
+      std::max(Parameters::unidirectional_interest_range,
+               Parameters::closest_nodes_size + Parameters::close_standby_size));
+  const NodeId* interest_boundary(nullptr);
+  int32_t max_bucket(0);
+  size_t max_bucket_count(1);
+  for (const auto& members : buckets_) {
+    size_t count(members.second.size());
+    if (skip_count >= count) {
+      skip_count -= static_cast<unsigned int>(count);
+      continue;
+    }
+    if (!interest_boundary)
+      interest_boundary = &*std::next(std::begin(members.second), skip_count);
+    count -= skip_count;
+    skip_count = 0;
+    // Where buckets are equally full, the further one is chosen.
+    if (count >= max_bucket_count) {
+      max_bucket = members.first;
+      max_bucket_count = count;
+    }
+  }
+  assert(interest_boundary);
+  if (!interest_boundary)
+    return false;
+
+  ROUTING_LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] max_bucket " << max_bucket << " count "
+                        << max_bucket_count;
+
+  // The candidate for eviction is the furthest node in the fullest bucket.
+  const NodeId& furthest_in_bucket(*buckets_.at(max_bucket).rbegin());
+  if ((Parameters::bucket_target_size > 1) && (bucket != NodeInfo::kInvalidBucket) &&
+      (bucket != max_bucket) && (max_bucket_count > Parameters::bucket_target_size) &&
+      (BucketSize(bucket) < Parameters::bucket_target_size)) {
+    evictee = furthest_in_bucket;
+    return true;
+  }
+
+  // If no duplicate bucket exists, prioirity is given to closer nodes.
+  if ((max_bucket_count == 1) && (buckets_.rbegin()->first < bucket))
+    return false;
+
+  if (NodeId::CloserToTarget(*interest_boundary, node_id, kNodeId_))
+    return false;
+
+  if ((max_bucket == bucket) && !NodeId::CloserToTarget(node_id, furthest_in_bucket, kNodeId_))
+    return false;
+
+  evictee = furthest_in_bucket;
+  return true;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,94 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_BUCKET_OCCUPANCY_H_
+#define MAIDSAFE_ROUTING_BUCKET_OCCUPANCY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Orders ids by their distance to 'target', closest first.
+class CloserToThisNode {
+ public:
+  explicit CloserToThisNode(const NodeId& target) : target_(target) {}
+  bool operator()(const NodeId& lhs, const NodeId& rhs) const {
+    return NodeId::CloserToTarget(lhs, rhs, target_);
+  }
+
+ private:
+  NodeId target_;
+};
+
+// The ids in a routing table grouped by bucket index, kept up to date as nodes are added and
+// removed so that choosing a node to evict needn't sort the table.  Higher buckets are further from
+// this node and each bucket is ordered closest first.  Not thread-safe; the owner must synchronise
+// access.
+class BucketOccupancy {
+ public:
+  explicit BucketOccupancy(const NodeId& this_node_id);
+  // The index of the first bit in which 'node_id' differs from 'this_node_id', counting down from
+  // 511 for the most significant bit.  Identical ids are given bucket 0.
+  static int32_t BucketIndex(const NodeId& this_node_id, const NodeId& node_id);
+
+  void Add(const NodeId& node_id, int32_t bucket);
+  void Remove(const NodeId& node_id, int32_t bucket);
+  size_t BucketSize(int32_t bucket) const;
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  // The furthest node held.  Must not be called when empty.
+  const NodeId& Furthest() const;
+
+  /** Decides whether a full vault routing table should take 'node_id' (in 'bucket'), returning
+   * true and setting 'evictee' to the node it displaces if so:
+   * - the Parameters::unidirectional_interest_range closest nodes, and never fewer than
+   *    closest_nodes_size + close_standby_size, are never evicted, and a newcomer must be closer
+   *    than the first node beyond them
+   * - the candidate is the furthest node in the fullest bucket, not counting those closest nodes,
+   *    with ties going to the further bucket
+   * - if every bucket holds a single node, a newcomer further than all of them is refused
+   * - a newcomer to the candidate's own bucket must be closer than the candidate
+   * - if Parameters::bucket_target_size is above 1, a newcomer to a bucket holding fewer than
+   *    bucket_target_size nodes is taken whenever the fullest bucket holds more, so that large
+   *    tables keep their buckets balanced **/
+  bool ChooseEviction(const NodeId& node_id, int32_t bucket, NodeId& evictee) const;
+
+ private:
+  BucketOccupancy(const BucketOccupancy&);
+  BucketOccupancy(const BucketOccupancy&&);
+  BucketOccupancy& operator=(const BucketOccupancy&);
+
+  typedef std::set<NodeId, CloserToThisNode> BucketMembers;
+
+  const NodeId kNodeId_;
+  std::map<int32_t, BucketMembers> buckets_;
+  size_t size_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BUCKET_OCCUPANCY_H_
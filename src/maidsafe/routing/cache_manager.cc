@@ -23,6 +23,7 @@
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/utils.h"
 
 
@@ -59,7 +60,7 @@ void CacheManager::AddToCache(const protobuf::Message& message) {
   if (message_and_caching_functors_.store_cache_data) {
     message_and_caching_functors_.store_cache_data(message.data(0));
   } else {
-    LOG(kVerbose) << "CacheManager::AddToCache";
+    ROUTING_LOG(kVerbose) << "CacheManager::AddToCache";
     TypedMessageAddtoCache(message);
   }
 }
@@ -101,18 +102,18 @@ bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
   auto future(cache_hit->get_future());
   if (message_and_caching_functors_.have_cache_data) {
     if (IsRequest(message)) {
-      LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : "
-                    << MessageTypeString(message) << " from "
-                    << HexSubstr(message.source_id())
-                    << "   (id: " << message.id() << ")  --NodeLevel-- caching";
+      ROUTING_LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : "
+                            << MessageTypeString(message) << " from "
+                            << HexSubstr(message.source_id())
+                            << "   (id: " << message.id() << ")  --NodeLevel-- caching";
       ReplyFunctor response_functor = [=](const std::string& reply_message) {
           if (reply_message.empty()) {
-            LOG(kVerbose) << "No cache available, passing on the original request";
+            ROUTING_LOG(kVerbose) << "No cache available, passing on the original request";
             cache_hit->set_value(false);
             return;
           }
 
-          LOG(kVerbose) << "Cache contents: " << reply_message;
+          ROUTING_LOG(kVerbose) << "Cache contents: " << reply_message;
 
           //  Responding with cached response
           protobuf::Message message_out;
@@ -133,7 +134,7 @@ bool CacheManager::HandleGetFromCache(protobuf::Message& message) {
           if (message.has_id())
             message_out.set_id(message.id());
           else
-            LOG(kInfo) << "Message to be sent back had no ID.";
+            ROUTING_LOG(kInfo) << "Message to be sent back had no ID.";
 
           if (message.has_relay_id())
             message_out.set_relay_id(message.relay_id());
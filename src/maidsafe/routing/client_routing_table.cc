@@ -22,6 +22,7 @@
 
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_log.h"
 
 namespace maidsafe {
 
@@ -52,8 +53,8 @@ bool ClientRoutingTable::AddOrCheckNode(NodeInfo& node, const NodeId& furthest_c
   if (CheckRangeForNodeToBeAdded(node, furthest_close_node_id, add)) {
     if (add) {
       nodes_.push_back(node);
-      LOG(kInfo) << "Added to ClientRoutingTable :" << node.id;
-      LOG(kVerbose) << PrintClientRoutingTable();
+      ROUTING_LOG(kInfo) << "Added to ClientRoutingTable :" << node.id;
+      ROUTING_LOG(kVerbose) << PrintClientRoutingTable();
     }
     return true;
   }
@@ -75,6 +76,15 @@ std::vector<NodeInfo> ClientRoutingTable::DropNodes(const NodeId& node_to_drop)
   return nodes_info;
 }
 
+void ClientRoutingTable::GetPeers(const NodeId& node_id, std::vector<PeerView>& peers) const {
+  peers.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& node : nodes_) {
+    if (node_id == NodeId() || node.id == node_id)
+      peers.emplace_back(node);
+  }
+}
+
 NodeInfo ClientRoutingTable::DropConnection(const NodeId& connection_to_drop) {
   NodeInfo node_info;
   std::lock_guard<std::mutex> lock(mutex_);
@@ -118,7 +128,7 @@ size_t ClientRoutingTable::size() const {
 bool ClientRoutingTable::CheckValidParameters(const NodeInfo& node) const {
   // bucket index is not used in ClientRoutingTable
   if (node.bucket != NodeInfo::kInvalidBucket) {
-    LOG(kInfo) << "Invalid bucket index.";
+    ROUTING_LOG(kInfo) << "Invalid bucket index.";
     return false;
   }
   return CheckParametersAreUnique(node);
@@ -129,7 +139,7 @@ bool ClientRoutingTable::CheckParametersAreUnique(const NodeInfo& node) const {
   if (std::find_if(nodes_.begin(), nodes_.end(), [node](const NodeInfo & node_info) {
         return (node_info.connection_id == node.connection_id);
       }) != nodes_.end()) {
-    LOG(kInfo) << "Already have node with this connection_id.";
+    ROUTING_LOG(kInfo) << "Already have node with this connection_id.";
     return false;
   }
 
@@ -150,12 +160,12 @@ bool ClientRoutingTable::CheckRangeForNodeToBeAdded(NodeInfo& node,
                                                     const NodeId& furthest_close_node_id,
                                                     bool add) const {
   if (nodes_.size() >= Parameters::max_client_routing_table_size) {
-    LOG(kInfo) << "ClientRoutingTable full.";
+    ROUTING_LOG(kInfo) << "ClientRoutingTable full.";
     return false;
   }
 
   if (add && !CheckValidParameters(node)) {
-    LOG(kInfo) << "Invalid Parameters.";
+    ROUTING_LOG(kInfo) << "Invalid Parameters.";
     return false;
   }
 
@@ -30,6 +30,7 @@
 #include "maidsafe/common/rsa.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/peer_view.h"
 
 namespace maidsafe {
 
@@ -57,6 +58,8 @@ class ClientRoutingTable {
   std::vector<NodeInfo> DropNodes(const NodeId& node_to_drop);
   NodeInfo DropConnection(const NodeId& connection_to_drop);
   std::vector<NodeInfo> GetNodesInfo(const NodeId& node_id = NodeId()) const;
+  // As GetNodesInfo, but without copying the nodes' public keys.  'peers' is cleared first.
+  void GetPeers(const NodeId& node_id, std::vector<PeerView>& peers) const;
   bool Contains(const NodeId& node_id) const;
   bool IsConnected(const NodeId& node_id) const;
   size_t size() const;
@@ -0,0 +1,102 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Longest real wait asio is given while in virtual time.
+const Clock::duration kMaxVirtualWait(std::chrono::milliseconds(1));
+
+std::atomic<bool> g_virtual(false);
+std::atomic<Clock::rep> g_virtual_now(0);
+
+std::mutex& ExpiriesMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::multiset<Clock::time_point>& Expiries() {
+  static std::multiset<Clock::time_point> expiries;
+  return expiries;
+}
+
+}  // unnamed namespace
+
+const bool Clock::is_steady;
+
+Clock::time_point Clock::now() {
+  if (g_virtual)
+    return time_point(duration(g_virtual_now.load()));
+  return time_point(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+Clock::duration ClockWaitTraits::to_wait_duration(const Clock::duration& duration) {
+  if (duration <= Clock::duration::zero())
+    return Clock::duration::zero();
+  return g_virtual ? std::min(duration, kMaxVirtualWait) : duration;
+}
+
+void VirtualClock::Enable() {
+  if (g_virtual)
+    return;
+  g_virtual_now = std::chrono::steady_clock::now().time_since_epoch().count();
+  g_virtual = true;
+}
+
+void VirtualClock::Disable() { g_virtual = false; }
+
+bool VirtualClock::enabled() { return g_virtual; }
+
+void VirtualClock::AdvanceTo(const Clock::time_point& time_point) {
+  Clock::rep target(time_point.time_since_epoch().count());
+  Clock::rep now(g_virtual_now.load());
+  while (now < target && !g_virtual_now.compare_exchange_weak(now, target)) {
+  }
+}
+
+void VirtualClock::Advance(const Clock::duration& duration) {
+  AdvanceTo(Clock::now() + duration);
+}
+
+Clock::time_point VirtualClock::NextExpiry() {
+  std::lock_guard<std::mutex> lock(ExpiriesMutex());
+  return Expiries().empty() ? Clock::time_point::max() : *Expiries().begin();
+}
+
+std::shared_ptr<void> VirtualClock::RegisterExpiry(const Clock::time_point& expiry) {
+  std::lock_guard<std::mutex> lock(ExpiriesMutex());
+  auto itr(Expiries().insert(expiry));
+  return std::shared_ptr<void>(nullptr, [itr](void*) {
+    std::lock_guard<std::mutex> lock(ExpiriesMutex());
+    Expiries().erase(itr);
+  });
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -18,8 +18,14 @@
 
 #include "maidsafe/routing/close_nodes_change.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <future>
+#include <iterator>
 #include <limits>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include "cereal/cereal.hpp"
@@ -27,12 +33,43 @@
 #include "cereal/types/vector.hpp"
 
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
 
 namespace routing {
 
+namespace {
+
+const size_t kBitCount(NodeId::kSize * 8);
+// Ranges of targets at or below this size are checked individually rather than split further.
+const std::ptrdiff_t kMinBulkRange(8);
+// Ranges of targets below this size are not worth handing to another thread.
+const std::ptrdiff_t kMinParallelRange(1 << 14);
+
+size_t BitAt(const NodeId& node_id, size_t bit) {
+  return (static_cast<unsigned char>(node_id.string()[bit / 8]) >> (7 - bit % 8)) & 1U;
+}
+
+size_t FirstDifferingBit(const NodeId& lhs, const NodeId& rhs) {
+  const std::string kLhs(lhs.string()), kRhs(rhs.string());
+  for (size_t byte(0); byte != kLhs.size(); ++byte) {
+    auto difference(static_cast<unsigned char>(kLhs[byte] ^ kRhs[byte]));
+    if (difference == 0)
+      continue;
+    size_t bit(byte * 8);
+    while ((difference & 0x80U) == 0) {
+      difference = static_cast<unsigned char>(difference << 1);
+      ++bit;
+    }
+    return bit;
+  }
+  return kBitCount;
+}
+
+}  // unnamed namespace
+
 CloseNodesChange::CloseNodesChange()
     : node_id_(), old_close_nodes_(), new_close_nodes_(), lost_node_(), new_node_(), radius_() {}
 
@@ -117,11 +154,17 @@ CloseNodesChange::CloseNodesChange(NodeId this_node_id, const std::vector<NodeId
   stream << "\n old_nodes : ";
   for (const auto& node_id : old_close_nodes_)
     stream << "\t[ " << node_id << " ]";
-  LOG(kVerbose) << stream.str();
+  ROUTING_LOG(kVerbose) << stream.str();
 #endif
 }
 
 CheckHoldersResult CloseNodesChange::CheckHolders(const NodeId& target) const {
+  bool holders_changed(false);
+  return DoCheckHolders(target, holders_changed);
+}
+
+CheckHoldersResult CloseNodesChange::DoCheckHolders(const NodeId& target,
+                                                    bool& holders_changed) const {
   // Handle cases of lower number of group close_nodes nodes
   size_t group_size_adjust(Parameters::group_size + 1U);
   size_t old_holders_size = std::min(old_close_nodes_.size(), group_size_adjust);
@@ -189,10 +232,11 @@ CheckHoldersResult CloseNodesChange::CheckHolders(const NodeId& target) const {
   stream << "\n diff_new_holders : ";
   for (const auto& node_id : diff_new_holders)
     stream << "\t[ " << node_id << " ]";
-  LOG(kVerbose) << stream.str();
+  ROUTING_LOG(kVerbose) << stream.str();
 #endif
   //   holders_result.new_holders = new_holders;
   //   holders_result.old_holders = old_holders;
+  holders_changed = !diff_new_holders.empty() || (new_holders.size() != old_holders.size());
   if (diff_new_holders.size() > 0)
     holders_result.new_holder = diff_new_holders.front();
   // in case the new_holder is the node itself, it shall be ignored
@@ -201,17 +245,121 @@ CheckHoldersResult CloseNodesChange::CheckHolders(const NodeId& target) const {
   return holders_result;
 }
 
+// For each node in only one of the old and new close nodes, 'divergence[node][bit][value]' counts
+// the unchanged close nodes which first differ from that node at 'bit' and have 'value' there.
+// Such an unchanged node is closer than the changed one to any target which has 'value' at 'bit'.
+struct CloseNodesChange::BulkCheck {
+  std::vector<std::vector<std::array<size_t, 2>>> divergence;
+  std::vector<size_t> last_bit;
+  size_t parallel_bits;
+};
+
+std::vector<std::pair<NodeId, CheckHoldersResult>> CloseNodesChange::CheckHolders(
+    const std::vector<NodeId>& targets) const {
+  assert(std::is_sorted(std::begin(targets), std::end(targets)));
+  std::vector<std::pair<NodeId, CheckHoldersResult>> changed;
+  std::vector<NodeId> old_close_nodes(old_close_nodes_), new_close_nodes(new_close_nodes_),
+      unchanged_nodes, changed_nodes;
+  std::sort(std::begin(old_close_nodes), std::end(old_close_nodes));
+  std::sort(std::begin(new_close_nodes), std::end(new_close_nodes));
+  std::set_intersection(std::begin(old_close_nodes), std::end(old_close_nodes),
+                        std::begin(new_close_nodes), std::end(new_close_nodes),
+                        std::back_inserter(unchanged_nodes));
+  std::set_symmetric_difference(std::begin(old_close_nodes), std::end(old_close_nodes),
+                                std::begin(new_close_nodes), std::end(new_close_nodes),
+                                std::back_inserter(changed_nodes));
+
+  // Pruning relies on at least group_size + 1 unchanged nodes being closer than each changed one.
+  if (unchanged_nodes.size() <= Parameters::group_size) {
+    for (const auto& target : targets) {
+      bool holders_changed(false);
+      auto result(DoCheckHolders(target, holders_changed));
+      if (holders_changed)
+        changed.emplace_back(target, result);
+    }
+    return changed;
+  }
+
+  BulkCheck bulk_check;
+  for (const auto& changed_node : changed_nodes) {
+    bulk_check.divergence.emplace_back(kBitCount, std::array<size_t, 2>{{0, 0}});
+    bulk_check.last_bit.push_back(0);
+    for (const auto& unchanged_node : unchanged_nodes) {
+      auto bit(FirstDifferingBit(changed_node, unchanged_node));
+      ++bulk_check.divergence.back()[bit][BitAt(unchanged_node, bit)];
+      bulk_check.last_bit.back() = std::max(bulk_check.last_bit.back(), bit + 1);
+    }
+  }
+  bulk_check.parallel_bits = 0;
+  while ((1U << bulk_check.parallel_bits) < std::thread::hardware_concurrency())
+    ++bulk_check.parallel_bits;
+
+  CheckHolders(bulk_check, std::begin(targets), std::end(targets), 0,
+               std::vector<size_t>(changed_nodes.size(), 0), changed);
+  return changed;
+}
+
+// All of [begin, end) share their first 'bit' bits.  'closer' holds, for each changed node, how
+// many unchanged nodes are known from those bits to be closer than it to every target in range.
+void CloseNodesChange::CheckHolders(
+    const BulkCheck& bulk_check, TargetIterator begin, TargetIterator end, size_t bit,
+    std::vector<size_t> closer, std::vector<std::pair<NodeId, CheckHoldersResult>>& changed) const {
+  if (begin == end)
+    return;
+  bool affected(false), resolved(true);
+  for (size_t i(0); i != closer.size(); ++i) {
+    if (closer[i] > Parameters::group_size)
+      continue;  // can't be among the group_size + 1 closest to any target in range
+    affected = true;
+    if (bit < bulk_check.last_bit[i])
+      resolved = false;
+  }
+  if (!affected)
+    return;
+
+  if (resolved || (std::distance(begin, end) <= kMinBulkRange) || (bit == kBitCount)) {
+    for (auto itr(begin); itr != end; ++itr) {
+      bool holders_changed(false);
+      auto result(DoCheckHolders(*itr, holders_changed));
+      if (holders_changed)
+        changed.emplace_back(*itr, result);
+    }
+    return;
+  }
+
+  auto middle(std::partition_point(begin, end,
+                                   [bit](const NodeId& target) { return !BitAt(target, bit); }));
+  std::vector<size_t> lower_closer(closer), upper_closer(std::move(closer));
+  for (size_t i(0); i != lower_closer.size(); ++i) {
+    lower_closer[i] += bulk_check.divergence[i][bit][0];
+    upper_closer[i] += bulk_check.divergence[i][bit][1];
+  }
+
+  if ((bit < bulk_check.parallel_bits) && (std::distance(begin, end) >= kMinParallelRange)) {
+    std::vector<std::pair<NodeId, CheckHoldersResult>> upper_changed;
+    auto upper(std::async(std::launch::async, [&] {
+      CheckHolders(bulk_check, middle, end, bit + 1, std::move(upper_closer), upper_changed);
+    }));
+    CheckHolders(bulk_check, begin, middle, bit + 1, std::move(lower_closer), changed);
+    upper.get();
+    std::move(std::begin(upper_changed), std::end(upper_changed), std::back_inserter(changed));
+  } else {
+    CheckHolders(bulk_check, begin, middle, bit + 1, std::move(lower_closer), changed);
+    CheckHolders(bulk_check, middle, end, bit + 1, std::move(upper_closer), changed);
+  }
+}
+
 NodeId CloseNodesChange::ChoosePmidNode(const std::set<NodeId>& online_pmids,
                                         const NodeId& target) const {
   if (online_pmids.empty())
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
 
-  LOG(kInfo) << " new close nodes : ";
+  ROUTING_LOG(kInfo) << " new close nodes : ";
   for (const auto& node_id : new_close_nodes_)
-    LOG(kInfo) << "\t new close nodes ids     ---  " << node_id;
-  LOG(kInfo) << "\t target : " << target << " and following online pmids : ";
+    ROUTING_LOG(kInfo) << "\t new close nodes ids     ---  " << node_id;
+  ROUTING_LOG(kInfo) << "\t target : " << target << " and following online pmids : ";
   for (const auto& pmid : online_pmids)
-    LOG(kInfo) << "\tonline pmids    ---  " << pmid;
+    ROUTING_LOG(kInfo) << "\tonline pmids    ---  " << pmid;
 
   // In case storing to PublicPmid, the data shall not be stored on the Vault itself
   // However, the vault will appear in DM's routing table and affect result
@@ -220,9 +368,9 @@ NodeId CloseNodesChange::ChoosePmidNode(const std::set<NodeId>& online_pmids,
                          std::end(temp), [&target](const NodeId& lhs, const NodeId& rhs) {
     return NodeId::CloserToTarget(lhs, rhs, target);
   });
-  LOG(kInfo) << " own id : " << node_id_ << " and closest + 1 to the target are : ";
+  ROUTING_LOG(kInfo) << " own id : " << node_id_ << " and closest + 1 to the target are : ";
   for (const auto& node : temp)
-    LOG(kInfo) << "   sorted neighbours   ---  " << node;
+    ROUTING_LOG(kInfo) << "   sorted neighbours   ---  " << node;
 
   auto temp_itr(std::begin(temp));
   auto pmids_itr(std::begin(online_pmids));
@@ -230,13 +378,14 @@ NodeId CloseNodesChange::ChoosePmidNode(const std::set<NodeId>& online_pmids,
     ++temp_itr;
     //     assert(temp_itr != std::end(temp));
     if (temp_itr == std::end(temp)) {
-      LOG(kError) << "node_id_ not listed in group range having " << temp.size() << " nodes";
+      ROUTING_LOG(kError) << "node_id_ not listed in group range having " << temp.size()
+                          << " nodes";
       break;
     }
     if (++pmids_itr == std::end(online_pmids))
       pmids_itr = std::begin(online_pmids);
   }
-  LOG(kVerbose) << "Chosen pmid " << *pmids_itr;
+  ROUTING_LOG(kVerbose) << "Chosen pmid " << *pmids_itr;
   return *pmids_itr;
 }
 
@@ -260,7 +409,7 @@ void CloseNodesChange::Print() const {
 
   stream << "\n\t\tentry in lost_node\t------\t" << lost_node_;
   stream << "\n\t\tentry in new_node\t------\t" << new_node_;
-  LOG(kInfo) << stream.str();
+  ROUTING_LOG(kInfo) << stream.str();
 }
 
 std::string CloseNodesChange::ReportConnection() const {
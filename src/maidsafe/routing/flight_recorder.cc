@@ -0,0 +1,205 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/flight_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kRecordWords(sizeof(FlightRecord) / sizeof(uint64_t));
+static_assert(sizeof(FlightRecord) % sizeof(uint64_t) == 0, "FlightRecord must pack into words");
+static_assert((FlightRecorder::kRingSize & (FlightRecorder::kRingSize - 1)) == 0,
+              "kRingSize must be a power of two");
+
+// Each slot is a seqlock: the owning thread makes 'sequence' odd while writing and even (and unique
+// to the write) once done, so a reader can detect and discard a slot it raced with.
+struct Slot {
+  std::atomic<uint64_t> sequence;
+  std::array<std::atomic<uint64_t>, kRecordWords> words;
+};
+
+struct Ring {
+  explicit Ring(uint16_t index_in) : slots(), head(0), index(index_in), in_use(true) {
+    for (auto& slot : slots)
+      slot.sequence.store(0, std::memory_order_relaxed);
+  }
+  std::array<Slot, FlightRecorder::kRingSize> slots;
+  uint64_t head;  // only touched by the owning thread
+  const uint16_t index;
+  std::atomic<bool> in_use;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Ring>> rings;
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+// Rings outlive their threads so that a dump still shows what an exited thread did; they are
+// reused by later threads rather than freed.
+Ring* AcquireRing() {
+  Registry& registry(GetRegistry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& ring : registry.rings) {
+    if (!ring->in_use.load(std::memory_order_relaxed)) {
+      ring->in_use.store(true, std::memory_order_relaxed);
+      return ring.get();
+    }
+  }
+  registry.rings.emplace_back(new Ring(static_cast<uint16_t>(registry.rings.size())));
+  return registry.rings.back().get();
+}
+
+struct ThreadRing {
+  ThreadRing() : ring(AcquireRing()) {}
+  ~ThreadRing() { ring->in_use.store(false, std::memory_order_relaxed); }
+  Ring* ring;
+};
+
+int64_t SteadyNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // unnamed namespace
+
+const uint32_t FlightRecordHeader::kMagic;
+const uint32_t FlightRecordHeader::kVersion;
+const size_t FlightRecorder::kRingSize;
+
+uint64_t FlightRecorder::Prefix(const std::string& id) {
+  uint64_t prefix(0);
+  for (size_t i(0); i != std::min(id.size(), sizeof(prefix)); ++i)
+    prefix = (prefix << 8) | static_cast<unsigned char>(id[i]);
+  return prefix;
+}
+
+void FlightRecorder::Add(FlightEvent event, uint64_t node, const protobuf::Message& message,
+                         uint64_t next_hop, DropReason drop_reason) {
+  if (!Parameters::flight_recorder)
+    return;
+  FlightRecord record;
+  record.timestamp = SteadyNow();
+  record.message_id = message.id();
+  record.message_type = message.type();
+  record.node = node;
+  record.source = Prefix(message.has_source_id() ? message.source_id() : message.relay_id());
+  record.destination = Prefix(message.destination_id());
+  record.next_hop = next_hop;
+  record.event = event;
+  record.drop_reason = static_cast<uint8_t>(drop_reason);
+  record.thread = 0;
+  record.padding = 0;
+  Add(record);
+}
+
+void FlightRecorder::Add(const FlightRecord& record) {
+  static thread_local ThreadRing thread_ring;
+  Ring& ring(*thread_ring.ring);
+  std::array<uint64_t, kRecordWords> words;
+  std::memcpy(words.data(), &record, sizeof(record));
+  uint64_t position(ring.head++);
+  Slot& slot(ring.slots[position & (kRingSize - 1)]);
+  slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i(0); i != kRecordWords; ++i)
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  slot.sequence.store(2 * position + 2, std::memory_order_release);
+}
+
+std::vector<FlightRecord> FlightRecorder::Records(uint64_t node) {
+  std::vector<FlightRecord> records;
+  Registry& registry(GetRegistry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& ring : registry.rings) {
+    for (const auto& slot : ring->slots) {
+      uint64_t sequence(slot.sequence.load(std::memory_order_acquire));
+      if (sequence == 0 || sequence % 2 != 0)
+        continue;
+      std::array<uint64_t, kRecordWords> words;
+      for (size_t i(0); i != kRecordWords; ++i)
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        continue;
+      FlightRecord record;
+      std::memcpy(&record, words.data(), sizeof(record));
+      if (node != 0 && record.node != node)
+        continue;
+      record.thread = ring->index;
+      records.push_back(record);
+    }
+  }
+  std::stable_sort(std::begin(records), std::end(records),
+                   [](const FlightRecord& lhs, const FlightRecord& rhs) {
+                     return lhs.timestamp < rhs.timestamp;
+                   });
+  return records;
+}
+
+bool FlightRecorder::Dump(const boost::filesystem::path& path, uint64_t node) {
+  std::vector<FlightRecord> records(Records(node));
+  FlightRecordHeader header;
+  header.magic = FlightRecordHeader::kMagic;
+  header.version = FlightRecordHeader::kVersion;
+  header.record_size = sizeof(FlightRecord);
+  header.padding = 0;
+  header.record_count = records.size();
+  header.steady_time = SteadyNow();
+  header.system_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+  std::ofstream stream(path.string(), std::ios::binary | std::ios::trunc);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!records.empty()) {
+    stream.write(reinterpret_cast<const char*>(records.data()),
+                 static_cast<std::streamsize>(records.size() * sizeof(FlightRecord)));
+  }
+  stream.close();
+  if (!stream) {
+    ROUTING_LOG(kError) << "Failed to write flight recorder dump to " << path;
+    return false;
+  }
+  ROUTING_LOG(kInfo) << "Wrote " << records.size() << " flight recorder records to " << path;
+  return true;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,101 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_FLIGHT_RECORDER_H_
+#define MAIDSAFE_ROUTING_FLIGHT_RECORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/routing/routing_metrics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+enum class FlightEvent : uint8_t {
+  kReceived = 0,   // parsed off the wire
+  kDelivered = 1,  // accepted by this node as destination, after any filtering
+  kSent = 2,       // handed to rudp for next_hop
+  kDropped = 3     // discarded; drop_reason says why
+};
+
+// Fixed-layout binary record.  Node ids are reduced to their leading 8 bytes.  Dump files are a
+// FlightRecordHeader followed by 'record_count' records, in host byte order.
+struct FlightRecord {
+  int64_t timestamp;  // steady_clock nanoseconds
+  uint32_t message_id;
+  int32_t message_type;
+  uint64_t node;
+  uint64_t source;
+  uint64_t destination;
+  uint64_t next_hop;
+  FlightEvent event;
+  uint8_t drop_reason;
+  uint16_t thread;
+  uint32_t padding;
+};
+
+struct FlightRecordHeader {
+  static const uint32_t kMagic = 0x5246534d;  // "MSFR"
+  static const uint32_t kVersion = 1;
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t padding;
+  uint64_t record_count;
+  int64_t steady_time;  // steady_clock and system_clock nanoseconds at the time of the dump,
+  int64_t system_time;  // which allow record timestamps to be converted to wall clock time.
+};
+
+// Process-wide recorder of routing events.  Each thread writes to its own fixed-size ring without
+// locking, overwriting its oldest records; a dump copies out whichever records are consistent at
+// that moment.  Formatting happens only in the decoder (tools/flight_recorder_decoder.cc).
+class FlightRecorder {
+ public:
+  static const size_t kRingSize = 2048;  // records per thread; must be a power of two
+
+  static uint64_t Prefix(const std::string& id);
+  static void Add(FlightEvent event, uint64_t node, const protobuf::Message& message,
+                  uint64_t next_hop = 0, DropReason drop_reason = DropReason::kParseFailure);
+  static void Add(const FlightRecord& record);
+  // Returns the currently held records, oldest first.  If 'node' is non-zero, only records made by
+  // that node are returned.
+  static std::vector<FlightRecord> Records(uint64_t node = 0);
+  static bool Dump(const boost::filesystem::path& path, uint64_t node = 0);
+
+ private:
+  FlightRecorder();
+  ~FlightRecorder();
+  FlightRecorder(const FlightRecorder&);
+  FlightRecorder(const FlightRecorder&&);
+  FlightRecorder& operator=(const FlightRecorder&);
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_FLIGHT_RECORDER_H_
@@ -0,0 +1,92 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/group_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+GroupCache::GroupCache() : mutex_(), entries_() {}
+
+bool GroupCache::Get(const NodeId& group_id, std::vector<NodeId>& group) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(group_id));
+  if (itr == entries_.end())
+    return false;
+  if (itr->second.expiry_time <= Clock::now()) {
+    entries_.erase(itr);
+    return false;
+  }
+  group = itr->second.group;
+  return true;
+}
+
+void GroupCache::Add(const NodeId& group_id, const std::vector<NodeId>& group) {
+  if (Parameters::group_cache_ttl == Clock::duration::zero() ||
+      Parameters::max_group_cache_size == 0 || group.empty())
+    return;
+  const Clock::time_point kNow(Clock::now());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(group_id));
+  if (itr != entries_.end()) {
+    itr->second = Entry(group, kNow + Parameters::group_cache_ttl);
+    return;
+  }
+  if (entries_.size() >= Parameters::max_group_cache_size) {
+    auto evict(std::min_element(entries_.begin(), entries_.end(),
+                                [](const std::pair<const NodeId, Entry>& lhs,
+                                   const std::pair<const NodeId, Entry>& rhs) {
+      return lhs.second.expiry_time < rhs.second.expiry_time;
+    }));
+    entries_.erase(evict);
+  }
+  entries_.insert(std::make_pair(group_id, Entry(group, kNow + Parameters::group_cache_ttl)));
+}
+
+void GroupCache::Invalidate(const NodeId& node_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto itr(entries_.begin()); itr != entries_.end();) {
+    const NodeId& kGroupId(itr->first);
+    const std::vector<NodeId>& kGroup(itr->second.group);
+    auto furthest(std::max_element(kGroup.begin(), kGroup.end(),
+                                   [&kGroupId](const NodeId& lhs, const NodeId& rhs) {
+      return NodeId::CloserToTarget(lhs, rhs, kGroupId);
+    }));
+    if (kGroup.size() < Parameters::group_size ||
+        std::find(kGroup.begin(), kGroup.end(), node_id) != kGroup.end() ||
+        NodeId::CloserToTarget(node_id, *furthest, kGroupId))
+      itr = entries_.erase(itr);
+    else
+      ++itr;
+  }
+}
+
+size_t GroupCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
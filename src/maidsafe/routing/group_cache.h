@@ -0,0 +1,71 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_GROUP_CACHE_H_
+#define MAIDSAFE_ROUTING_GROUP_CACHE_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Recent GetGroup results keyed by group id.  Each entry expires after Parameters::group_cache_ttl
+// and is dropped early when a node joins or leaves within the group's range, i.e. when the node is
+// a member or is closer to the group id than the furthest member.  Only changes to this node's own
+// routing table are seen, so for a group far from this node an entry can be up to the ttl stale.  At most
+// Parameters::max_group_cache_size groups are held; the one nearest to expiry is evicted first.
+class GroupCache {
+ public:
+  GroupCache();
+  // Returns false if 'group_id' has no live entry.
+  bool Get(const NodeId& group_id, std::vector<NodeId>& group);
+  void Add(const NodeId& group_id, const std::vector<NodeId>& group);
+  // Drops entries for which 'node_id' joining or leaving the network could change the group.
+  void Invalidate(const NodeId& node_id);
+  size_t size() const;
+
+ private:
+  GroupCache(const GroupCache&);
+  GroupCache(const GroupCache&&);
+  GroupCache& operator=(const GroupCache&);
+
+  struct Entry {
+    Entry(std::vector<NodeId> group_in, const Clock::time_point& expiry_time_in)
+        : group(std::move(group_in)), expiry_time(expiry_time_in) {}
+    std::vector<NodeId> group;
+    Clock::time_point expiry_time;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<NodeId, Entry> entries_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_GROUP_CACHE_H_
@@ -0,0 +1,64 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/handler_fence.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+HandlerFence::Scope::Scope(HandlerFence& fence) : fence_(fence), entered_(fence.Enter()) {}
+
+HandlerFence::Scope::~Scope() {
+  if (entered_)
+    fence_.Leave();
+}
+
+HandlerFence::HandlerFence() : mutex_(), all_left_(), closed_(false), inside_() {}
+
+void HandlerFence::Close() {
+  const std::thread::id kThisThread(std::this_thread::get_id());
+  std::unique_lock<std::mutex> lock(mutex_);
+  closed_ = true;
+  all_left_.wait(lock, [&] { return inside_.size() == inside_.count(kThisThread); });
+}
+
+bool HandlerFence::closed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return closed_;
+}
+
+bool HandlerFence::Enter() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_)
+    return false;
+  inside_.insert(std::this_thread::get_id());
+  return true;
+}
+
+void HandlerFence::Leave() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inside_.erase(inside_.find(std::this_thread::get_id()));
+  }
+  all_left_.notify_all();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,77 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_HANDLER_FENCE_H_
+#define MAIDSAFE_ROUTING_HANDLER_FENCE_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Counts the handlers of one node which are running on an AsioService it may share with other
+// nodes, so that the node can be stopped without stopping the service.  Each such handler holds a
+// Scope while it uses the node; once Close has returned, no Scope is entered again, so handlers
+// still queued must return without touching the node.
+class HandlerFence {
+ public:
+  class Scope {
+   public:
+    explicit Scope(HandlerFence& fence);
+    ~Scope();
+    // False if the fence was closed, in which case the handler should return at once.
+    bool entered() const { return entered_; }
+
+   private:
+    Scope(const Scope&);
+    Scope(const Scope&&);
+    Scope& operator=(const Scope&);
+
+    HandlerFence& fence_;
+    const bool entered_;
+  };
+
+  HandlerFence();
+  // Stops further Scopes being entered and waits for those already entered to be left, other than
+  // any held by the calling thread, so a handler may close its own node's fence.
+  void Close();
+  bool closed() const;
+
+ private:
+  HandlerFence(const HandlerFence&);
+  HandlerFence(const HandlerFence&&);
+  HandlerFence& operator=(const HandlerFence&);
+
+  bool Enter();
+  void Leave();
+
+  mutable std::mutex mutex_;
+  std::condition_variable all_left_;
+  bool closed_;
+  std::multiset<std::thread::id> inside_;  // one per entered Scope
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_HANDLER_FENCE_H_
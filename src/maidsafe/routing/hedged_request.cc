@@ -0,0 +1,98 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include "maidsafe/routing/hedged_request.h"
+
+#include <algorithm>
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+const size_t HedgedRequest::kMinLatencySamples(20);
+
+HedgedRequest::HedgedRequest(boost::asio::io_service& io_service,
+                             LatencyTracker& latency_tracker, ResponseFunctor response_functor)
+    : latency_tracker_(latency_tracker),
+      response_functor_(response_functor),
+      kSendTime_(Clock::now()),
+      mutex_(),
+      timer_(io_service),
+      send_copy_(),
+      responded_(false),
+      hedged_(false) {}
+
+void HedgedRequest::Hedge(std::function<void()> send_copy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (responded_)
+    return;
+  send_copy_ = send_copy;
+  timer_.expires_from_now(Delay(latency_tracker_));
+  auto this_ptr(shared_from_this());
+  timer_.async_wait([this_ptr](const boost::system::error_code& error) {
+    this_ptr->OnTimer(error);
+  });
+}
+
+void HedgedRequest::OnTimer(const boost::system::error_code& error) {
+  std::function<void()> send_copy;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error || responded_)
+      return;
+    hedged_ = true;
+    send_copy.swap(send_copy_);
+  }
+  send_copy();
+}
+
+void HedgedRequest::OnResponse(std::string response) {
+  ResponseFunctor response_functor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (responded_)
+      return;
+    responded_ = true;
+    timer_.cancel();
+    send_copy_ = nullptr;
+    response_functor.swap(response_functor_);
+  }
+  if (!response.empty())
+    latency_tracker_.Add(Clock::now() - kSendTime_);
+  if (response_functor)
+    response_functor(response);
+}
+
+bool HedgedRequest::hedged() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hedged_;
+}
+
+std::chrono::steady_clock::duration HedgedRequest::Delay(const LatencyTracker& latency_tracker) {
+  if (latency_tracker.size() < kMinLatencySamples)
+    return Parameters::hedge_initial_delay;
+  return std::max(Parameters::hedge_min_delay,
+                  latency_tracker.Percentile(Parameters::hedge_delay_percentile));
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
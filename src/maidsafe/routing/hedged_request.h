@@ -0,0 +1,82 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#ifndef MAIDSAFE_ROUTING_HEDGED_REQUEST_H_
+#define MAIDSAFE_ROUTING_HEDGED_REQUEST_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "boost/asio/io_service.hpp"
+#include "boost/system/error_code.hpp"
+
+#include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/latency_tracker.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// One request which is sent again, via an alternate route, if no response has arrived within the
+// hedge delay.  Only the first response is passed on, so the caller sees a single response however
+// many copies are answered, and its round trip is added to the LatencyTracker which sets the delay
+// of later requests.  'latency_tracker' must outlive this object.
+class HedgedRequest : public std::enable_shared_from_this<HedgedRequest> {
+ public:
+  // The number of round trips required before their Parameters::hedge_delay_percentile replaces
+  // Parameters::hedge_initial_delay.
+  static const size_t kMinLatencySamples;
+
+  HedgedRequest(boost::asio::io_service& io_service, LatencyTracker& latency_tracker,
+                ResponseFunctor response_functor);
+  // Arms the hedge timer, to run 'send_copy' after Delay() unless a response has arrived by then.
+  // Should be called once the original request has been sent.
+  void Hedge(std::function<void()> send_copy);
+  // Passes the first response to the response functor and cancels the hedge.  Later responses are
+  // dropped.  An empty response (a timeout) is passed on but not counted as a round trip.
+  void OnResponse(std::string response);
+  bool hedged() const;
+  static std::chrono::steady_clock::duration Delay(const LatencyTracker& latency_tracker);
+
+ private:
+  HedgedRequest(const HedgedRequest&);
+  HedgedRequest(const HedgedRequest&&);
+  HedgedRequest& operator=(const HedgedRequest&);
+
+  void OnTimer(const boost::system::error_code& error);
+
+  LatencyTracker& latency_tracker_;
+  ResponseFunctor response_functor_;
+  const Clock::time_point kSendTime_;
+  mutable std::mutex mutex_;
+  SteadyTimer timer_;
+  std::function<void()> send_copy_;
+  bool responded_, hedged_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_HEDGED_REQUEST_H_
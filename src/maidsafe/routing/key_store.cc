@@ -0,0 +1,93 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/key_store.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kMinPurgeThreshold(64);
+
+}  // unnamed namespace
+
+KeyFingerprint Fingerprint(const asymm::PublicKey& public_key) {
+  auto digest(crypto::Hash<crypto::SHA256>(asymm::EncodeKey(public_key)->string()).string());
+  KeyFingerprint fingerprint;
+  assert(digest.size() == fingerprint.size());
+  std::copy(std::begin(digest), std::end(digest), std::begin(fingerprint));
+  return fingerprint;
+}
+
+size_t KeyFingerprintHash::operator()(const KeyFingerprint& fingerprint) const {
+  // The fingerprint is already uniformly distributed, so any of its bytes will do.
+  size_t hash;
+  std::memcpy(&hash, fingerprint.data(), sizeof(hash));
+  return hash;
+}
+
+KeyStore::KeyStore() : mutex_(), keys_(), purge_threshold_(kMinPurgeThreshold) {}
+
+std::shared_ptr<const asymm::PublicKey> KeyStore::Intern(const asymm::PublicKey& public_key) {
+  auto fingerprint(Fingerprint(public_key));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry(keys_[fingerprint]);
+  auto shared_key(entry.lock());
+  if (!shared_key) {
+    shared_key = std::make_shared<const asymm::PublicKey>(public_key);
+    entry = shared_key;
+    if (keys_.size() >= purge_threshold_)
+      PurgeExpired();
+  }
+  return shared_key;
+}
+
+std::shared_ptr<const asymm::PublicKey> KeyStore::Find(const KeyFingerprint& fingerprint) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(keys_.find(fingerprint));
+  return itr == std::end(keys_) ? nullptr : itr->second.lock();
+}
+
+size_t KeyStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<size_t>(std::count_if(std::begin(keys_), std::end(keys_),
+                                           [](const decltype(keys_)::value_type& entry) {
+                                             return !entry.second.expired();
+                                           }));
+}
+
+void KeyStore::PurgeExpired() {
+  for (auto itr(std::begin(keys_)); itr != std::end(keys_);) {
+    if (itr->second.expired())
+      itr = keys_.erase(itr);
+    else
+      ++itr;
+  }
+  // Purging again only once the store has doubled keeps the cost amortised constant per Intern.
+  purge_threshold_ = std::max(kMinPurgeThreshold, 2 * keys_.size());
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,81 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_KEY_STORE_H_
+#define MAIDSAFE_ROUTING_KEY_STORE_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "maidsafe/common/crypto.h"
+#include "maidsafe/common/rsa.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class KeyStoreTest_BEH_PurgeReleasedKeys_Test;
+}
+
+// A SHA-256 digest of a public key's DER encoding.  Keys with equal fingerprints are treated as the
+// same key, so keys can be indexed and checked for uniqueness without comparing them whole.
+typedef std::array<unsigned char, crypto::SHA256::DIGESTSIZE> KeyFingerprint;
+
+KeyFingerprint Fingerprint(const asymm::PublicKey& public_key);
+
+struct KeyFingerprintHash {
+  size_t operator()(const KeyFingerprint& fingerprint) const;
+};
+
+// Interns public keys so that every holder of a given key shares a single copy of it.  The store
+// only holds weak references: a key is freed once the last holder releases it, and its entry is
+// purged lazily as the store grows.
+class KeyStore {
+ public:
+  KeyStore();
+  // Returns the shared copy of 'public_key', adding one if no holder currently has it.
+  std::shared_ptr<const asymm::PublicKey> Intern(const asymm::PublicKey& public_key);
+  // Returns the shared copy of the key with 'fingerprint', or null if no holder currently has it.
+  std::shared_ptr<const asymm::PublicKey> Find(const KeyFingerprint& fingerprint) const;
+  // The number of distinct keys currently held.
+  size_t size() const;
+
+ private:
+  KeyStore(const KeyStore&);
+  KeyStore(const KeyStore&&);
+  KeyStore& operator=(const KeyStore&);
+
+  void PurgeExpired();
+
+  friend class test::KeyStoreTest_BEH_PurgeReleasedKeys_Test;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<KeyFingerprint, std::weak_ptr<const asymm::PublicKey>, KeyFingerprintHash>
+      keys_;
+  size_t purge_threshold_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_KEY_STORE_H_
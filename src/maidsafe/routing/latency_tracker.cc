@@ -0,0 +1,64 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/latency_tracker.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace maidsafe {
+
+namespace routing {
+
+LatencyTracker::LatencyTracker(size_t capacity)
+    : kCapacity_(capacity), mutex_(), samples_(), next_index_(0) {
+  assert(kCapacity_ > 0);
+  samples_.reserve(kCapacity_);
+}
+
+void LatencyTracker::Add(std::chrono::steady_clock::duration latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (samples_.size() < kCapacity_)
+    samples_.push_back(latency);
+  else
+    samples_[next_index_] = latency;
+  next_index_ = (next_index_ + 1) % kCapacity_;
+}
+
+size_t LatencyTracker::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return samples_.size();
+}
+
+std::chrono::steady_clock::duration LatencyTracker::Percentile(unsigned int percentile) const {
+  std::vector<std::chrono::steady_clock::duration> samples;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples = samples_;
+  }
+  if (samples.empty())
+    return std::chrono::steady_clock::duration::zero();
+  size_t index(std::min(samples.size() - 1,
+                        (samples.size() * std::min(percentile, 100U)) / 100));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples.at(index);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
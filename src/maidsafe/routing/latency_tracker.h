@@ -0,0 +1,56 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_LATENCY_TRACKER_H_
+#define MAIDSAFE_ROUTING_LATENCY_TRACKER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Holds the most recent 'capacity' latency samples, e.g. request-response round trips, and reports
+// percentiles over them.
+class LatencyTracker {
+ public:
+  explicit LatencyTracker(size_t capacity);
+  void Add(std::chrono::steady_clock::duration latency);
+  size_t size() const;
+  // Returns the sample at the given percentile (0 to 100) of those held, or zero if none are held.
+  std::chrono::steady_clock::duration Percentile(unsigned int percentile) const;
+
+ private:
+  LatencyTracker(const LatencyTracker&);
+  LatencyTracker(const LatencyTracker&&);
+  LatencyTracker& operator=(const LatencyTracker&);
+
+  const size_t kCapacity_;
+  mutable std::mutex mutex_;
+  std::vector<std::chrono::steady_clock::duration> samples_;
+  size_t next_index_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_LATENCY_TRACKER_H_
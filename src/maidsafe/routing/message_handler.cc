@@ -18,6 +18,7 @@
 
 #include "maidsafe/routing/message_handler.h"
 
+#include <memory>
 #include <vector>
 
 #include "maidsafe/common/log.h"
@@ -27,7 +28,9 @@
 #include "maidsafe/routing/message.h"
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/service.h"
 #include "maidsafe/routing/utils.h"
@@ -39,7 +42,8 @@ namespace routing {
 MessageHandler::MessageHandler(RoutingTable& routing_table,
                                ClientRoutingTable& client_routing_table, Network& network,
                                Timer<std::string>& timer, NetworkUtils& network_utils,
-                               AsioService& asio_service)
+                               AsioService& asio_service, UpcallExecutor* upcall_executor,
+                               std::shared_ptr<HandlerFence> handler_fence)
     : routing_table_(routing_table),
       client_routing_table_(client_routing_table),
       network_utils_(network_utils),
@@ -48,12 +52,22 @@ MessageHandler::MessageHandler(RoutingTable& routing_table,
                          ? nullptr
                          : (new CacheManager(routing_table_.kNodeId(), network_))),
       timer_(timer),
-      public_key_holder_(asio_service, network),
+      public_key_holder_(asio_service, network, routing_table.key_store()),
+      admission_control_(),
       response_handler_(new ResponseHandler(routing_table, client_routing_table, network_,
                                             public_key_holder_)),
       service_(new Service(routing_table, client_routing_table, network_, public_key_holder_)),
       message_received_functor_(),
-      typed_message_received_functors_() {}
+      typed_message_received_functors_(),
+      kFlightRecorderId_(FlightRecorder::Prefix(routing_table_.kNodeId().string())),
+      handler_fence_(handler_fence ? handler_fence : std::make_shared<HandlerFence>()),
+      own_upcall_executor_(upcall_executor
+                               ? nullptr
+                               : new UpcallExecutor(Parameters::upcall_threads,
+                                                    Parameters::max_queued_upcalls)),
+      upcalls_(upcall_executor ? *upcall_executor : *own_upcall_executor_) {}
+
+MessageHandler::~MessageHandler() { handler_fence_->Close(); }
 
 void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
   bool request(message.request());
@@ -79,7 +93,13 @@ void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
                         : response_handler_->GetGroup(timer_, message);
       break;
     case MessageType::kAcknowledgement:
-      network_utils_.acknowledgement_.HandleMessage(message.ack_id());
+      if (message.ack_ids_size() == 0) {
+        network_utils_.acknowledgement_.HandleMessage(message.ack_id());
+      } else {
+        std::vector<AckId> ack_ids(message.ack_ids().begin(), message.ack_ids().end());
+        ack_ids.push_back(message.ack_id());
+        network_utils_.acknowledgement_.HandleMessage(ack_ids);
+      }
       message.Clear();
       break;
     case MessageType::kInformClientOfNewCloseNode:
@@ -107,20 +127,34 @@ void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
 }
 
 void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& message) {
+  if (IsRequest(message) && !AdmitNodeLevelRequest(message))
+    return;
+  FlightRecorder::Add(FlightEvent::kDelivered, kFlightRecorderId_, message);
   if (IsRequest(message) &&
       !IsClientToClientMessageWithDifferentNodeIds(message, routing_table_.client_mode())) {
-    LOG(kSuccess) << " [" << DebugId(routing_table_.kNodeId())
-                  << "] rcvd : " << MessageTypeString(message) << " from "
-                  << HexSubstr(message.source_id()) << "   (id: " << message.id()
-                  << ")  --NodeLevel--";
+    ROUTING_LOG(kSuccess) << " [" << DebugId(routing_table_.kNodeId())
+                          << "] rcvd : " << MessageTypeString(message) << " from "
+                          << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                          << ")  --NodeLevel--";
+    // 'message' isn't used once delivered, so its payload is moved out rather than copied, and is
+    // then shared with the upper layer.  The closures below copy only the remaining header fields.
+    auto payload(std::make_shared<std::string>());
+    if (message.data_size() != 0)
+      payload->swap(*message.mutable_data(0));
+    SharedContents contents(std::move(payload));
+    std::shared_ptr<HandlerFence> fence(handler_fence_);
     ReplyFunctor response_functor = [=](const std::string & reply_message) {
+      HandlerFence::Scope scope(*fence);
+      if (!scope.entered())
+        return;
       if (reply_message.empty()) {
-        LOG(kInfo) << "Empty response for message id :" << message.id();
+        ROUTING_LOG(kInfo) << "Empty response for message id :" << message.id();
         return;
       }
-      LOG(kSuccess) << " [" << routing_table_.kNodeId() << "] repl : "
-                    << MessageTypeString(message) << " from " << HexSubstr(message.source_id())
-                    << "   (id: " << message.id() << ")  --NodeLevel Replied--";
+      ROUTING_LOG(kSuccess) << " [" << routing_table_.kNodeId() << "] repl : "
+                            << MessageTypeString(message) << " from "
+                            << HexSubstr(message.source_id())
+                            << "   (id: " << message.id() << ")  --NodeLevel Replied--";
       protobuf::Message message_out;
       message_out.set_request(false);
       message_out.set_ack_id(RandomUint32());
@@ -140,7 +174,7 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
       if (message.has_id())
         message_out.set_id(message.id());
       else
-        LOG(kInfo) << "Message to be sent back had no ID.";
+        ROUTING_LOG(kInfo) << "Message to be sent back had no ID.";
 
       if (message.has_relay_id())
         message_out.set_relay_id(message.relay_id());
@@ -156,41 +190,50 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
       if (routing_table_.kNodeId().string() != message_out.destination_id()) {
         network_.SendToClosestNode(message_out);
       } else {
-        LOG(kInfo) << "Sending response to self." << " id: " << message.id();
+        ROUTING_LOG(kInfo) << "Sending response to self." << " id: " << message.id();
         HandleMessage(message_out);
       }
     };
-    if (message_received_functor_) {
-      LOG(kVerbose) << "calling message_received_functor_ " << " id: " << message.id();
-      message_received_functor_(message.data(0), response_functor);
-    } else {
-      LOG(kVerbose) << "calling InvokeTypedMessageReceivedFunctor " << " id: " << message.id();
-      try {
-        InvokeTypedMessageReceivedFunctor(message);  // typed message received
-      } catch (...) {
-        LOG(kError) << "InvokeTypedMessageReceivedFunctor error";
+    auto upcall([this, message, contents, response_functor] {
+      if (message_received_functor_) {
+        ROUTING_LOG(kVerbose) << "calling message_received_functor_ " << " id: " << message.id();
+        message_received_functor_(*contents, response_functor);
+      } else {
+        ROUTING_LOG(kVerbose) << "calling InvokeTypedMessageReceivedFunctor " << " id: "
+                              << message.id();
+        try {
+          InvokeTypedMessageReceivedFunctor(message, contents);  // typed message received
+        } catch (...) {
+          ROUTING_LOG(kError) << "InvokeTypedMessageReceivedFunctor error";
+        }
       }
+    });
+    if (!upcalls_.Post(upcall)) {
+      ROUTING_LOG(kWarning) << "Upcall queue full; dropping request " << message.id() << " from "
+                            << HexSubstr(message.source_id());
+      RecordDrop(message, DropReason::kUpcallOverload);
     }
   } else if (IsResponse(message)) {                // response
-    LOG(kInfo) << "[" << DebugId(routing_table_.kNodeId())
-               << "] rcvd : " << MessageTypeString(message) << " from "
-               << HexSubstr(message.source_id()) << "   (id: " << message.id()
-               << ")  --NodeLevel--";
+    ROUTING_LOG(kInfo) << "[" << DebugId(routing_table_.kNodeId())
+                       << "] rcvd : " << MessageTypeString(message) << " from "
+                       << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                       << ")  --NodeLevel--";
     try {
       if (!message.has_id() || message.data_size() != 1)
         BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
       timer_.AddResponse(message.id(), message.data(0));
     }
     catch (const maidsafe_error& e) {
-      LOG(kError) << e.what();
+      ROUTING_LOG(kError) << e.what();
       return;
     }
     if (message.has_average_distace())
       network_utils_.statistics_.UpdateNetworkAverageDistance(NodeId(message.average_distace()));
   } else {
-    LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
-                  << " Dropping message as client to client message not allowed."
-                  << PrintMessage(message);
+    ROUTING_LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
+                          << " Dropping message as client to client message not allowed."
+                          << PrintMessage(message);
+    RecordDrop(message, DropReason::kClientToClient);
     message.Clear();
   }
 }
@@ -199,46 +242,57 @@ void MessageHandler::HandleMessageForThisNode(protobuf::Message& message) {
   if (RelayDirectMessageIfNeeded(message))
     return;
 
-  LOG(kVerbose) << "Message for this node."
-                << " id: " << message.id();
-  if (IsRoutingMessage(message))
+  ROUTING_LOG(kVerbose) << "Message for this node."
+                        << " id: " << message.id();
+  if (IsRoutingMessage(message)) {
+    FlightRecorder::Add(FlightEvent::kDelivered, kFlightRecorderId_, message);
     HandleRoutingMessage(message);
-  else
+  } else {
     HandleNodeLevelMessageForThisNode(message);
+  }
+}
+
+RouteDecision MessageHandler::MakeRouteDecision(const protobuf::Message& message) {
+  NodeId destination_id(message.destination_id());
+  auto route_decision(routing_table_.GetRouteDecision(destination_id));
+  if (!destination_id.IsZero())
+    client_routing_table_.GetPeers(destination_id, route_decision.client_nodes);
+  return route_decision;
 }
 
-void MessageHandler::HandleMessageAsClosestNode(protobuf::Message& message) {
-  LOG(kVerbose) << "This node is in closest proximity to this message destination ID [ "
-                << HexSubstr(message.destination_id()) << " ]."
-                << " id: " << message.id();
+void MessageHandler::HandleMessageAsClosestNode(protobuf::Message& message,
+                                                const RouteDecision& route_decision) {
+  ROUTING_LOG(kVerbose) << "This node is in closest proximity to this message destination ID [ "
+                        << HexSubstr(message.destination_id()) << " ]."
+                        << " id: " << message.id();
   if (IsDirect(message)) {
-    return HandleDirectMessageAsClosestNode(message);
+    return HandleDirectMessageAsClosestNode(message, route_decision);
   } else {
-    return HandleGroupMessageAsCloseNode(message);
+    return HandleGroupMessageAsCloseNode(message, route_decision);
   }
 }
 
-void MessageHandler::HandleDirectMessageAsClosestNode(protobuf::Message& message) {
+void MessageHandler::HandleDirectMessageAsClosestNode(protobuf::Message& message,
+                                                      const RouteDecision& route_decision) {
   assert(message.direct());
   // Dropping direct messages if this node is closest and destination node is not in routing_table_
   // or client_routing_table_.
-  NodeId destination_node_id(message.destination_id());
-  if (routing_table_.IsThisNodeClosestTo(destination_node_id)) {
-    if (routing_table_.Contains(destination_node_id) ||
-        client_routing_table_.Contains(destination_node_id)) {
-      return network_.SendToClosestNode(message);
+  if (route_decision.closest) {
+    if (route_decision.contains_target || !route_decision.client_nodes.empty()) {
+      return network_.SendToClosestNode(message, route_decision);
     } else if (!message.has_visited() || !message.visited()) {
       message.set_visited(true);
-      return network_.SendToClosestNode(message);
+      return network_.SendToClosestNode(message, route_decision);
     } else {
       network_utils_.acknowledgement_.AdjustAckHistory(message);
       network_.SendAck(message);
-      LOG(kWarning) << "Dropping message. This node [" << routing_table_.kNodeId()
-                    << "] is the closest but is not connected to destination node ["
-                    << HexSubstr(message.destination_id())
-                    << "], Src ID: " << HexSubstr(message.source_id())
-                    << ", Relay ID: " << HexSubstr(message.relay_id()) << " id: " << message.id()
-                    << PrintMessage(message);
+      ROUTING_LOG(kWarning) << "Dropping message. This node [" << routing_table_.kNodeId()
+                            << "] is the closest but is not connected to destination node ["
+                            << HexSubstr(message.destination_id())
+                            << "], Src ID: " << HexSubstr(message.source_id())
+                            << ", Relay ID: " << HexSubstr(message.relay_id()) << " id: "
+                            << message.id()
+                            << PrintMessage(message);
       return;
     }
   } else {
@@ -247,18 +301,19 @@ void MessageHandler::HandleDirectMessageAsClosestNode(protobuf::Message& message
     // else if (IsCacheableResponse(message))
     //   StoreCacheCopy(message);  //  Upper layer should take this on seperate thread
 
-    return network_.SendToClosestNode(message);
+    return network_.SendToClosestNode(message, route_decision);
   }
 }
 
-void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
+void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message,
+                                                   const RouteDecision& route_decision) {
   assert(!message.direct());
 
   NodeId destination_id(message.destination_id());
-  auto close_nodes(routing_table_.GetClosestNodes(destination_id, Parameters::group_size + 1));
+  auto close_nodes(route_decision.ClosestNodes(Parameters::group_size + 1));
   close_nodes.erase(std::remove_if(std::begin(close_nodes), std::end(close_nodes),
-                                   [&destination_id](const NodeInfo& node_info) {
-                                     return node_info.id == destination_id;
+                                   [&destination_id](const PeerView& peer) {
+                                     return peer.id == destination_id;
                                    }), std::end(close_nodes));
   while (close_nodes.size() > Parameters::group_size)
     close_nodes.pop_back();
@@ -275,22 +330,18 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
   std::string group_id(message.destination_id());
   for (const auto& i : close_nodes)
     group_members += std::string("[" + DebugId(i.id) + "]");
-  LOG(kInfo) << "Group nodes for group_id " << HexSubstr(group_id) << " : " << group_members;
+  ROUTING_LOG(kInfo) << "Group nodes for group_id " << HexSubstr(group_id) << " : "
+                     << group_members;
 
   for (const auto& i : close_nodes) {
-    LOG(kInfo) << "[" << routing_table_.kNodeId() << "] - "
-               << "Replicating message to : " << HexSubstr(i.id.string())
-               << " [ group_id : " << HexSubstr(group_id) << "]"
-               << " id: " << message.id();
+    ROUTING_LOG(kInfo) << "[" << routing_table_.kNodeId() << "] - "
+                       << "Replicating message to : " << HexSubstr(i.id.string())
+                       << " [ group_id : " << HexSubstr(group_id) << "]"
+                       << " id: " << message.id();
     message.clear_ack_node_ids();
     message.set_ack_id(0);
     message.set_destination_id(i.id.string());
-    NodeInfo node;
-    if (routing_table_.GetNodeInfo(i.id, node)) {
-      network_.SendToDirect(message, node.id, node.connection_id);
-    } else {
-      network_.SendToClosestNode(message);
-    }
+    network_.SendToDirect(message, i.id, i.connection_id);
   }
 
   if (!network_utils_.firewall_.Add(NodeId(group_id), message.id())) {
@@ -305,10 +356,10 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
     message.set_destination_id(routing_table_.kNodeId().string());
 
     if (IsRoutingMessage(message)) {
-      LOG(kVerbose) << "HandleGroupMessageAsClosestNode if, msg id: " << message.id();
+      ROUTING_LOG(kVerbose) << "HandleGroupMessageAsClosestNode if, msg id: " << message.id();
       HandleRoutingMessage(message);
     } else {
-      LOG(kVerbose) << "HandleGroupMessageAsCloseNode else, msg id: " << message.id();
+      ROUTING_LOG(kVerbose) << "HandleGroupMessageAsCloseNode else, msg id: " << message.id();
       HandleNodeLevelMessageForThisNode(message);
     }
   } else {
@@ -316,27 +367,32 @@ void MessageHandler::HandleGroupMessageAsCloseNode(protobuf::Message& message) {
   }
 }
 
-void MessageHandler::HandleMessageAsFarNode(protobuf::Message& message) {
-  LOG(kVerbose) << "[" << routing_table_.kNodeId()
-                << "] is not in closest proximity to this message destination ID [ "
-                << HexSubstr(message.destination_id()) << " ]; sending on."
-                << " id: " << message.id();
-  network_.SendToClosestNode(message);
+void MessageHandler::HandleMessageAsFarNode(protobuf::Message& message,
+                                            const RouteDecision& route_decision) {
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId()
+                        << "] is not in closest proximity to this message destination ID [ "
+                        << HexSubstr(message.destination_id()) << " ]; sending on."
+                        << " id: " << message.id();
+  network_.SendToClosestNode(message, route_decision);
 }
 
 void MessageHandler::HandleMessage(protobuf::Message& message) {
-  LOG(kVerbose) << "[" << routing_table_.kNodeId() << "]"
-                << " MessageHandler::HandleMessage handle message with id: " << message.id();
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId() << "]"
+                        << " MessageHandler::HandleMessage handle message with id: "
+                        << message.id();
   if (!message.source_id().empty() && !IsAck(message) &&
       (message.destination_id() != message.source_id()) &&
       (message.destination_id() == routing_table_.kNodeId().string()) &&
       !network_utils_.firewall_.Add(NodeId(message.source_id()), message.id())) {
-    LOG(kVerbose) << "Filtered " << NodeId(message.source_id()) << ", " << message.id();
+    ROUTING_LOG(kVerbose) << "Filtered " << NodeId(message.source_id()) << ", " << message.id();
+    RecordDrop(message, DropReason::kFirewall);
     return;
   }
 
   if (!ValidateMessage(message)) {
-    LOG(kWarning) << "Validate message failed， id: " << message.id();
+    ROUTING_LOG(kWarning) << "Validate message failed， id: " << message.id();
+    RecordDrop(message, message.hops_to_live() <= 0 ? DropReason::kHopsToLive
+                                                    : DropReason::kInvalidMessage);
     BOOST_ASSERT_MSG((message.hops_to_live() > 0),
                      "Message has traversed maximum number of hops allowed");
     return;
@@ -345,90 +401,102 @@ void MessageHandler::HandleMessage(protobuf::Message& message) {
   // Decrement hops_to_live
   message.set_hops_to_live(message.hops_to_live() - 1);
 
-  if (IsValidCacheableGet(message) && HandleCacheLookup(message))
-    return;  // forwarding message is done by cache manager or vault
+  if (IsValidCacheableGet(message))
+    return HandleCacheLookup(message);
+
+  HandleUncachedMessage(message);
+}
+
+void MessageHandler::HandleUncachedMessage(protobuf::Message& message) {
   if (IsValidCacheablePut(message)) {
-    LOG(kVerbose) << "StoreCacheCopy: " << message.id();
-    StoreCacheCopy(message);  // Upper layer should take this on seperate thread
+    ROUTING_LOG(kVerbose) << "StoreCacheCopy: " << message.id();
+    StoreCacheCopy(message);
   }
 
   // If group message request to self id
   if (IsGroupMessageRequestToSelfId(message)) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleGroupMessageToSelfId";
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleGroupMessageToSelfId";
     return HandleGroupMessageToSelfId(message);
   }
 
   // If this node is a client
   if (routing_table_.client_mode()) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleClientMessage";
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleClientMessage";
     return HandleClientMessage(message);
   }
 
   // Relay mode message
   if (message.source_id().empty()) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleRelayRequest";
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleRelayRequest";
     return HandleRelayRequest(message);
   }
 
   // Invalid source id, unknown message
   if (NodeId(message.source_id()).IsZero()) {
-    LOG(kWarning) << "Stray message dropped, need valid source ID for processing."
-                  << " id: " << message.id();
+    ROUTING_LOG(kWarning) << "Stray message dropped, need valid source ID for processing."
+                          << " id: " << message.id();
     return;
   }
 
   // Direct message
   if (message.destination_id() == routing_table_.kNodeId().string()) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageForThisNode";
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleMessageForThisNode";
     return HandleMessageForThisNode(message);
   }
 
   if (IsRelayResponseForThisNode(message)) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleRoutingMessage";
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleRoutingMessage";
     return HandleRoutingMessage(message);
   }
 
-  if (client_routing_table_.Contains(NodeId(message.destination_id())) && IsDirect(message)) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
-               << " HandleMessageForNonRoutingNodes";
-    return HandleMessageForNonRoutingNodes(message);
+  auto route_decision(MakeRouteDecision(message));
+  if (!route_decision.client_nodes.empty() && IsDirect(message)) {
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleMessageForNonRoutingNodes";
+    return HandleMessageForNonRoutingNodes(message, route_decision);
   }
 
   // This node is in closest proximity to this message
-  if (routing_table_.IsThisNodeInRange(NodeId(message.destination_id()),
-                                       Parameters::closest_nodes_size)) {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageAsClosestNode";
-    return HandleMessageAsClosestNode(message);
+  if (route_decision.in_range) {
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleMessageAsClosestNode";
+    return HandleMessageAsClosestNode(message, route_decision);
   } else {
-    LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageAsFarNode";
-    return HandleMessageAsFarNode(message);
+    ROUTING_LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
+                       << " HandleMessageAsFarNode";
+    return HandleMessageAsFarNode(message, route_decision);
   }
 }
 
-void MessageHandler::HandleMessageForNonRoutingNodes(protobuf::Message& message) {
-  auto client_routing_nodes(client_routing_table_.GetNodesInfo(NodeId(message.destination_id())));
-  assert(!client_routing_nodes.empty() && message.direct());
+void MessageHandler::HandleMessageForNonRoutingNodes(protobuf::Message& message,
+                                                     const RouteDecision& route_decision) {
+  assert(!route_decision.client_nodes.empty() && message.direct());
 // Below bit is not needed currently as SendToClosestNode will do this check anyway
 // TODO(Team) consider removing the check from SendToClosestNode() after
 // adding more client tests
   if (IsClientToClientMessageWithDifferentNodeIds(message, true)) {
-    LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
-                  << " Dropping message as client to client message not allowed."
-                  << PrintMessage(message);
+    ROUTING_LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
+                          << " Dropping message as client to client message not allowed."
+                          << PrintMessage(message);
+    RecordDrop(message, DropReason::kClientToClient);
     network_utils_.acknowledgement_.AdjustAckHistory(message);
     network_.SendAck(message);
     return;
   }
-  LOG(kInfo) << "This node has message destination in its ClientRoutingTable. Dest id : "
-             << HexSubstr(message.destination_id()) << " message id: " << message.id();
-  return network_.SendToClosestNode(message);
+  ROUTING_LOG(kInfo) << "This node has message destination in its ClientRoutingTable. Dest id : "
+                     << HexSubstr(message.destination_id()) << " message id: " << message.id();
+  return network_.SendToClosestNode(message, route_decision);
 }
 
 void MessageHandler::HandleRelayRequest(protobuf::Message& message) {
   assert(!message.has_source_id());
   if ((message.destination_id() == routing_table_.kNodeId().string()) && IsRequest(message)) {
-    LOG(kVerbose) << "Relay request with this node's ID as destination ID"
-                  << " id: " << message.id();
+    ROUTING_LOG(kVerbose) << "Relay request with this node's ID as destination ID"
+                          << " id: " << message.id();
     // If group message request to this node's id sent by relay requester node
     if ((message.destination_id() == routing_table_.kNodeId().string()) && message.request() &&
         !message.direct()) {
@@ -440,54 +508,53 @@ void MessageHandler::HandleRelayRequest(protobuf::Message& message) {
   }
 
   // This node may be closest for group messages.
-  if (message.request() && message.direct() &&
-      routing_table_.IsThisNodeClosestTo(NodeId(message.destination_id()))) {
-    return HandleDirectRelayRequestMessageAsClosestNode(message);
-  } else if (!message.direct() &&
-             routing_table_.IsThisNodeInRange(NodeId(message.destination_id()),
-                                              Parameters::closest_nodes_size)) {
-    return HandleGroupRelayRequestMessageAsCloseNode(message);
+  auto route_decision(MakeRouteDecision(message));
+  if (message.request() && message.direct() && route_decision.closest) {
+    return HandleDirectRelayRequestMessageAsClosestNode(message, route_decision);
+  } else if (!message.direct() && route_decision.in_range) {
+    return HandleGroupRelayRequestMessageAsCloseNode(message, route_decision);
   }
 
   // This node is now the src ID for the relay message and will send back response to original node.
   message.set_source_id(routing_table_.kNodeId().string());
-  network_.SendToClosestNode(message);
+  network_.SendToClosestNode(message, route_decision);
 }
 
-void MessageHandler::HandleDirectRelayRequestMessageAsClosestNode(protobuf::Message& message) {
+void MessageHandler::HandleDirectRelayRequestMessageAsClosestNode(
+    protobuf::Message& message, const RouteDecision& route_decision) {
   assert(message.direct());
   // Dropping direct messages if this node is closest and destination node is not in routing_table_
   // or client_routing_table_.
-  NodeId destination_node_id(message.destination_id());
-  if (routing_table_.IsThisNodeClosestTo(destination_node_id)) {
-    if (routing_table_.Contains(destination_node_id) ||
-        client_routing_table_.Contains(destination_node_id)) {
+  if (route_decision.closest) {
+    if (route_decision.contains_target || !route_decision.client_nodes.empty()) {
       message.set_source_id(routing_table_.kNodeId().string());
-      return network_.SendToClosestNode(message);
+      return network_.SendToClosestNode(message, route_decision);
     } else {
-      LOG(kWarning) << "Dropping message. This node [" << DebugId(routing_table_.kNodeId())
-                    << "] is the closest but is not connected to destination node ["
-                    << HexSubstr(message.destination_id())
-                    << "], Src ID: " << HexSubstr(message.source_id())
-                    << ", Relay ID: " << HexSubstr(message.relay_id()) << " id: " << message.id()
-                    << PrintMessage(message);
+      ROUTING_LOG(kWarning) << "Dropping message. This node [" << DebugId(routing_table_.kNodeId())
+                            << "] is the closest but is not connected to destination node ["
+                            << HexSubstr(message.destination_id())
+                            << "], Src ID: " << HexSubstr(message.source_id())
+                            << ", Relay ID: " << HexSubstr(message.relay_id()) << " id: "
+                            << message.id()
+                            << PrintMessage(message);
       return;
     }
   } else {
-    return network_.SendToClosestNode(message);
+    return network_.SendToClosestNode(message, route_decision);
   }
 }
 
-void MessageHandler::HandleGroupRelayRequestMessageAsCloseNode(protobuf::Message& message) {
+void MessageHandler::HandleGroupRelayRequestMessageAsCloseNode(
+    protobuf::Message& message, const RouteDecision& route_decision) {
   message.set_source_id(routing_table_.kNodeId().string());
-  HandleGroupMessageAsCloseNode(message);
+  HandleGroupMessageAsCloseNode(message, route_decision);
 }
 
 // Special case when response of a relay comes through an alternative route.
 bool MessageHandler::IsRelayResponseForThisNode(protobuf::Message& message) {
   if (IsRoutingMessage(message) && message.has_relay_id() &&
       (message.relay_id() == routing_table_.kNodeId().string())) {
-    LOG(kVerbose) << "Relay response through alternative route";
+    ROUTING_LOG(kVerbose) << "Relay response through alternative route";
     return true;
   } else {
     return false;
@@ -505,8 +572,8 @@ bool MessageHandler::RelayDirectMessageIfNeeded(protobuf::Message& message) {
           (message.destination_id() != message.relay_id())) {
     message.clear_destination_id();
     message.clear_actual_destination_is_relay_id();  // so that it is picked currectly at recepient
-    LOG(kVerbose) << "Relaying request to " << HexSubstr(message.relay_id())
-                  << " id: " << message.id();
+    ROUTING_LOG(kVerbose) << "Relaying request to " << HexSubstr(message.relay_id())
+                          << " id: " << message.id();
     network_.SendToClosestNode(message);
     return true;
   }
@@ -514,8 +581,8 @@ bool MessageHandler::RelayDirectMessageIfNeeded(protobuf::Message& message) {
   // Only direct responses need to be relayed
   if (IsResponse(message) && (message.destination_id() != message.relay_id())) {
     message.clear_destination_id();  // to allow network util to identify it as relay message
-    LOG(kVerbose) << "Relaying response to " << HexSubstr(message.relay_id())
-                  << " id: " << message.id();
+    ROUTING_LOG(kVerbose) << "Relaying response to " << HexSubstr(message.relay_id())
+                          << " id: " << message.id();
     network_.SendToClosestNode(message);
     return true;
   }
@@ -528,21 +595,23 @@ bool MessageHandler::RelayDirectMessageIfNeeded(protobuf::Message& message) {
 void MessageHandler::HandleClientMessage(protobuf::Message& message) {
   assert(routing_table_.client_mode() && "Only client node should handle client messages");
   if (message.source_id().empty()) {  // No relays allowed on client.
-    LOG(kWarning) << "Stray message at client node. No relays allowed."
-                  << " id: " << message.id();
+    ROUTING_LOG(kWarning) << "Stray message at client node. No relays allowed."
+                          << " id: " << message.id();
     return;
   }
   if (IsRoutingMessage(message)) {
-    LOG(kVerbose) << "Client Routing Response for " << DebugId(routing_table_.kNodeId())
-                  << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
+    if (message.destination_id() == routing_table_.kNodeId().string())
+      FlightRecorder::Add(FlightEvent::kDelivered, kFlightRecorderId_, message);
+    ROUTING_LOG(kVerbose) << "Client Routing Response for " << DebugId(routing_table_.kNodeId())
+                          << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
     HandleRoutingMessage(message);
   } else if ((message.destination_id() == routing_table_.kNodeId().string())) {
-    LOG(kVerbose) << "Client NodeLevel Response for " << DebugId(routing_table_.kNodeId())
-                  << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
+    ROUTING_LOG(kVerbose) << "Client NodeLevel Response for " << DebugId(routing_table_.kNodeId())
+                          << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
     HandleNodeLevelMessageForThisNode(message);
   } else {
-    LOG(kWarning) << DebugId(routing_table_.kNodeId()) << " silently drop message "
-                  << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
+    ROUTING_LOG(kWarning) << DebugId(routing_table_.kNodeId()) << " silently drop message "
+                          << " from " << HexSubstr(message.source_id()) << " id: " << message.id();
   }
 }
 
@@ -558,28 +627,33 @@ void MessageHandler::HandleGroupMessageToSelfId(protobuf::Message& message) {
   assert(message.destination_id() == routing_table_.kNodeId().string());
   assert(message.request());
   assert(!message.direct());
-  HandleGroupMessageAsCloseNode(message);
+  HandleGroupMessageAsCloseNode(message, MakeRouteDecision(message));
 }
 
-void MessageHandler::InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message) {
+void MessageHandler::InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message,
+                                                       const SharedContents& contents) {
   if ((!proto_message.has_group_source() && !proto_message.has_group_destination()) &&
       typed_message_received_functors_.single_to_single) {  // Single to Single
-    typed_message_received_functors_.single_to_single(CreateSingleToSingleMessage(proto_message));
+    typed_message_received_functors_.single_to_single(
+        CreateSingleToSingleMessage(proto_message, contents));
   } else if ((!proto_message.has_group_source() && proto_message.has_group_destination()) &&
              typed_message_received_functors_.single_to_group) {
     // Single to Group
     if (proto_message.has_relay_id() && proto_message.has_relay_connection_id()) {
       typed_message_received_functors_.single_to_group_relay(
-          CreateSingleToGroupRelayMessage(proto_message));
+          CreateSingleToGroupRelayMessage(proto_message, contents));
     } else {
-      typed_message_received_functors_.single_to_group(CreateSingleToGroupMessage(proto_message));
+      typed_message_received_functors_.single_to_group(
+          CreateSingleToGroupMessage(proto_message, contents));
     }
   } else if ((proto_message.has_group_source() && !proto_message.has_group_destination()) &&
              typed_message_received_functors_.group_to_single) {
-    typed_message_received_functors_.group_to_single(CreateGroupToSingleMessage(proto_message));
+    typed_message_received_functors_.group_to_single(
+        CreateGroupToSingleMessage(proto_message, contents));
   } else if ((proto_message.has_group_source() && proto_message.has_group_destination()) &&
              typed_message_received_functors_.group_to_group) {  // Group to Group
-    typed_message_received_functors_.group_to_group(CreateGroupToGroupMessage(proto_message));
+    typed_message_received_functors_.group_to_group(
+        CreateGroupToGroupMessage(proto_message, contents));
   } else {
     assert(false);
   }
@@ -610,16 +684,56 @@ void MessageHandler::set_request_public_key_functor(
   service_->set_request_public_key_functor(request_public_key_functor);
 }
 
-bool MessageHandler::HandleCacheLookup(protobuf::Message& message) {
+// The lookup calls into the upper layer and may wait up to Parameters::local_retreival_timeout for
+// its reply, so it runs on the upcall executor; on a miss, that thread carries on routing the
+// request.  If the executor is overloaded, the cache is skipped rather than the request dropped.
+void MessageHandler::HandleCacheLookup(protobuf::Message& message) {
   assert(!routing_table_.client_mode());
   assert(IsCacheableGet(message));
-  return cache_manager_->HandleGetFromCache(message);
+  auto lookup(std::make_shared<protobuf::Message>(message));
+  if (upcalls_.Post([this, lookup] {
+        bool hit(cache_manager_->HandleGetFromCache(*lookup));
+        network_utils_.metrics_.AddCacheLookup(hit);
+        if (!hit)
+          HandleUncachedMessage(*lookup);
+      }))
+    return;
+  ROUTING_LOG(kVerbose) << "Upcall queue full; not looking up " << message.id() << " in cache";
+  HandleUncachedMessage(message);
+}
+
+// Sheds node-level requests delivered to this node, before the upcall, if the peer which handed
+// them over is over its admission budget.  Requests only passing through are left alone, and the
+// budget is charged to the previous hop rather than the claimed source, so that a peer relaying
+// for many sources can be throttled and a forged source ID can't exhaust another node's budget.
+// Responses are never shed, as that would only turn a request which has already been served into a
+// timeout.
+bool MessageHandler::AdmitNodeLevelRequest(protobuf::Message& message) {
+  const std::string kPreviousHop(PreviousHop(message, routing_table_.kNodeId()));
+  const bool kClient(!message.relay_connection_id().empty() &&
+                     kPreviousHop == message.relay_connection_id());
+  if (!CheckId(kPreviousHop) || kPreviousHop == routing_table_.kNodeId().string() ||
+      admission_control_.Admit(NodeId(kPreviousHop), kClient))
+    return true;
+  ROUTING_LOG(kVerbose) << "Shedding request " << message.id() << " from "
+                        << HexSubstr(kPreviousHop) << ", which is over its admission budget.";
+  RecordDrop(message, kClient ? DropReason::kClientOverBudget : DropReason::kVaultOverBudget);
+  network_utils_.acknowledgement_.AdjustAckHistory(message);
+  network_.SendAck(message);
+  return false;
+}
+
+void MessageHandler::RecordDrop(const protobuf::Message& message, DropReason reason) {
+  network_utils_.metrics_.AddDropped(reason);
+  FlightRecorder::Add(FlightEvent::kDropped, kFlightRecorderId_, message, 0, reason);
 }
 
 void MessageHandler::StoreCacheCopy(const protobuf::Message& message) {
   assert(!routing_table_.client_mode());
   assert(IsCacheablePut(message));
-  cache_manager_->AddToCache(message);
+  auto copy(std::make_shared<protobuf::Message>(message));
+  if (!upcalls_.Post([this, copy] { cache_manager_->AddToCache(*copy); }))
+    ROUTING_LOG(kVerbose) << "Upcall queue full; not caching " << message.id();
 }
 
 bool MessageHandler::IsValidCacheableGet(const protobuf::Message& message) {
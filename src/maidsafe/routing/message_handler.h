@@ -23,11 +23,15 @@
 
 #include "maidsafe/rudp/managed_connections.h"
 
+#include "maidsafe/routing/admission_control.h"
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/cache_manager.h"
+#include "maidsafe/routing/flight_recorder.h"
+#include "maidsafe/routing/handler_fence.h"
 #include "maidsafe/routing/response_handler.h"
 #include "maidsafe/routing/service.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/upcall_executor.h"
 #include "maidsafe/routing/utils.h"
 #include "maidsafe/routing/network_utils.h"
 
@@ -64,6 +68,7 @@ class Network;
 struct NetworkUtils;
 class ClientRoutingTable;
 class RoutingTable;
+struct RouteDecision;
 class NetworkStatistics;
 
 enum class MessageType : int32_t {
@@ -81,9 +86,14 @@ enum class MessageType : int32_t {
 
 class MessageHandler {
  public:
+  // Reply functors handed to the upper layer do nothing once 'handler_fence' (a private one if
+  // null) is closed, which happens at the latest on destruction.
   MessageHandler(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
                  Network& network, Timer<std::string>& timer,
-                 NetworkUtils& network_utils, AsioService& asio_service);
+                 NetworkUtils& network_utils, AsioService& asio_service,
+                 UpcallExecutor* upcall_executor = nullptr,
+                 std::shared_ptr<HandlerFence> handler_fence = nullptr);
+  ~MessageHandler();
   void HandleMessage(protobuf::Message& message);
   void set_typed_message_and_caching_functor(TypedMessageAndCachingFunctor functors);
   void set_message_and_caching_functor(MessageAndCachingFunctors functors);
@@ -97,24 +107,35 @@ class MessageHandler {
   void HandleRoutingMessage(protobuf::Message& message);
   void HandleNodeLevelMessageForThisNode(protobuf::Message& message);
   void HandleMessageForThisNode(protobuf::Message& message);
-  void HandleMessageAsClosestNode(protobuf::Message& message);
-  void HandleDirectMessageAsClosestNode(protobuf::Message& message);
-  void HandleGroupMessageAsCloseNode(protobuf::Message& message);
-  void HandleMessageAsFarNode(protobuf::Message& message);
+  // Queries the routing and client routing tables once for the message's destination.
+  RouteDecision MakeRouteDecision(const protobuf::Message& message);
+  void HandleMessageAsClosestNode(protobuf::Message& message, const RouteDecision& route_decision);
+  void HandleDirectMessageAsClosestNode(protobuf::Message& message,
+                                        const RouteDecision& route_decision);
+  void HandleGroupMessageAsCloseNode(protobuf::Message& message,
+                                     const RouteDecision& route_decision);
+  void HandleMessageAsFarNode(protobuf::Message& message, const RouteDecision& route_decision);
   void HandleRelayRequest(protobuf::Message& message);
   void HandleGroupMessageToSelfId(protobuf::Message& message);
   bool IsRelayResponseForThisNode(protobuf::Message& message);
   bool IsGroupMessageRequestToSelfId(protobuf::Message& message);
   bool RelayDirectMessageIfNeeded(protobuf::Message& message);
   void HandleClientMessage(protobuf::Message& message);
-  void HandleMessageForNonRoutingNodes(protobuf::Message& message);
-  void HandleDirectRelayRequestMessageAsClosestNode(protobuf::Message& message);
-  void HandleGroupRelayRequestMessageAsCloseNode(protobuf::Message& message);
-  bool HandleCacheLookup(protobuf::Message& message);
+  void HandleMessageForNonRoutingNodes(protobuf::Message& message,
+                                       const RouteDecision& route_decision);
+  void HandleDirectRelayRequestMessageAsClosestNode(protobuf::Message& message,
+                                                    const RouteDecision& route_decision);
+  void HandleGroupRelayRequestMessageAsCloseNode(protobuf::Message& message,
+                                                 const RouteDecision& route_decision);
+  void HandleCacheLookup(protobuf::Message& message);
+  void HandleUncachedMessage(protobuf::Message& message);
   void StoreCacheCopy(const protobuf::Message& message);
   bool IsValidCacheableGet(const protobuf::Message& message);
   bool IsValidCacheablePut(const protobuf::Message& message);
-  void InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message);
+  void InvokeTypedMessageReceivedFunctor(const protobuf::Message& proto_message,
+                                         const SharedContents& contents);
+  bool AdmitNodeLevelRequest(protobuf::Message& message);
+  void RecordDrop(const protobuf::Message& message, DropReason reason);
   friend class test::MessageHandlerTest;
   friend class test::MessageHandlerTest_BEH_HandleInvalidMessage_Test;
   friend class test::MessageHandlerTest_BEH_HandleRelay_Test;
@@ -131,10 +152,18 @@ class MessageHandler {
   std::unique_ptr<CacheManager> cache_manager_;
   Timer<std::string>& timer_;
   PublicKeyHolder public_key_holder_;
+  AdmissionControl admission_control_;
   std::shared_ptr<ResponseHandler> response_handler_;
   std::shared_ptr<Service> service_;
   MessageReceivedFunctor message_received_functor_;
   detail::TypedMessageRecievedFunctors typed_message_received_functors_;
+  const uint64_t kFlightRecorderId_;
+  std::shared_ptr<HandlerFence> handler_fence_;
+  // Declared last so that upcalls have finished, and own_upcall_executor_'s threads are joined,
+  // before anything an upcall might touch is gone.  'upcall_executor', if provided, is used instead
+  // of own_upcall_executor_ and may be shared with other nodes.
+  std::unique_ptr<UpcallExecutor> own_upcall_executor_;
+  UpcallScope upcalls_;
 };
 
 }  // namespace routing
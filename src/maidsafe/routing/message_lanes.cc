@@ -0,0 +1,153 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/message_lanes.h"
+
+#include <cstdint>
+
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// protobuf::Message's 'routing_message' field, and the wire types used by its preceding fields.
+const uint64_t kRoutingMessageField(3);
+const uint64_t kVarintWireType(0), kLengthDelimitedWireType(2);
+
+bool ReadVarint(const std::string& input, size_t& position, uint64_t& value) {
+  value = 0;
+  for (unsigned int shift(0); position != input.size() && shift < 64; shift += 7) {
+    uint8_t byte(static_cast<uint8_t>(input[position++]));
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+}  // unnamed namespace
+
+MessageLane ClassifyMessage(const protobuf::Message& message) {
+  return IsRoutingMessage(message) ? MessageLane::kControl : MessageLane::kData;
+}
+
+MessageLane ClassifyMessage(const std::string& serialised_message) {
+  // Fields are serialised in field number order, so only source_id and destination_id (both
+  // length-delimited) can precede routing_message.
+  size_t position(0);
+  uint64_t tag(0), value(0);
+  while (ReadVarint(serialised_message, position, tag)) {
+    const uint64_t kField(tag >> 3), kWireType(tag & 7);
+    if (kField == kRoutingMessageField && kWireType == kVarintWireType)
+      return ReadVarint(serialised_message, position, value) && value != 0 ? MessageLane::kControl
+                                                                          : MessageLane::kData;
+    if (kField > kRoutingMessageField || kWireType != kLengthDelimitedWireType ||
+        !ReadVarint(serialised_message, position, value) ||
+        value > serialised_message.size() - position)
+      break;
+    position += static_cast<size_t>(value);
+  }
+  return MessageLane::kData;
+}
+
+PeerSendQueue::PeerSendQueue() : mutex_(), peers_() {}
+
+void PeerSendQueue::Send(const NodeId& peer_id, MessageLane lane, const SendFunctor& send,
+                         const rudp::MessageSentFunctor& message_sent_functor) {
+  const unsigned int kLimit(Parameters::max_data_sends_per_peer);
+  if (lane == MessageLane::kControl || kLimit == 0) {
+    send(message_sent_functor);
+    return;
+  }
+  bool overflow(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Peer& peer(peers_[peer_id]);
+    if (peer.in_flight >= kLimit) {
+      overflow = peer.held.size() >= Parameters::max_held_data_sends_per_peer;
+      if (!overflow) {
+        peer.held.push_back(std::make_pair(send, message_sent_functor));
+        return;
+      }
+    } else {
+      ++peer.in_flight;
+    }
+  }
+  if (overflow) {
+    if (message_sent_functor)
+      message_sent_functor(kSendQueueFull);
+    return;
+  }
+  Dispatch(peer_id, std::make_pair(send, message_sent_functor));
+}
+
+void PeerSendQueue::Dispatch(const NodeId& peer_id, const PendingSend& pending_send) {
+  rudp::MessageSentFunctor message_sent_functor(pending_send.second);
+  pending_send.first([this, peer_id, message_sent_functor](int message_sent) {
+    OnSent(peer_id);
+    if (message_sent_functor)
+      message_sent_functor(message_sent);
+  });
+}
+
+void PeerSendQueue::OnSent(const NodeId& peer_id) {
+  PendingSend next;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(peers_.find(peer_id));
+    if (itr == peers_.end())
+      return;  // removed while the send was in flight
+    if (itr->second.held.empty()) {
+      if (--itr->second.in_flight == 0)
+        peers_.erase(itr);
+      return;
+    }
+    next = itr->second.held.front();
+    itr->second.held.pop_front();
+  }
+  Dispatch(peer_id, next);
+}
+
+void PeerSendQueue::Remove(const NodeId& peer_id) {
+  std::deque<PendingSend> held;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(peers_.find(peer_id));
+    if (itr == peers_.end())
+      return;
+    held.swap(itr->second.held);
+    peers_.erase(itr);
+  }
+  for (const auto& pending_send : held)
+    pending_send.first(pending_send.second);
+}
+
+size_t PeerSendQueue::queued(const NodeId& peer_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(peers_.find(peer_id));
+  return itr == peers_.end() ? 0 : itr->second.held.size();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
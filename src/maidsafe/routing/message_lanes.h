@@ -0,0 +1,134 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_MESSAGE_LANES_H_
+#define MAIDSAFE_ROUTING_MESSAGE_LANES_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+// Routing control messages (join, repair and acks) are kept ahead of bulk node-level data.
+enum class MessageLane {
+  kControl,
+  kData
+};
+
+MessageLane ClassifyMessage(const protobuf::Message& message);
+// Classifies a serialised protobuf::Message by reading only its leading fields' tags, without
+// parsing or copying its data.  Malformed input is classed as data.
+MessageLane ClassifyMessage(const std::string& serialised_message);
+
+// Two FIFO queues served by weighted priority: while both hold items, up to
+// Parameters::control_lane_weight control items are popped for each data item (or control items
+// only, if the weight is 0).
+template <typename T>
+class PriorityLanes {
+ public:
+  PriorityLanes() : mutex_(), control_(), data_(), control_run_(0) {}
+  void Push(MessageLane lane, T item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (lane == MessageLane::kControl ? control_ : data_).push_back(std::move(item));
+  }
+  // Returns false if both lanes are empty.
+  bool Pop(T& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const unsigned int kWeight(Parameters::control_lane_weight);
+    bool take_control(!control_.empty() &&
+                      (data_.empty() || kWeight == 0 || control_run_ < kWeight));
+    if (!take_control && data_.empty())
+      return false;
+    auto& lane(take_control ? control_ : data_);
+    item = std::move(lane.front());
+    lane.pop_front();
+    control_run_ = take_control ? control_run_ + 1 : 0;
+    return true;
+  }
+  size_t size(MessageLane lane) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (lane == MessageLane::kControl ? control_ : data_).size();
+  }
+
+ private:
+  PriorityLanes(const PriorityLanes&);
+  PriorityLanes(const PriorityLanes&&);
+  PriorityLanes& operator=(const PriorityLanes&);
+
+  mutable std::mutex mutex_;
+  std::deque<T> control_, data_;
+  unsigned int control_run_;
+};
+
+// Limits each peer to Parameters::max_data_sends_per_peer data messages in flight in the
+// transport, holding up to Parameters::max_held_data_sends_per_peer further ones here in order and
+// failing any more with kSendQueueFull.  Control messages are passed straight through, so they
+// never wait behind more than that many data messages to the same peer.
+class PeerSendQueue {
+ public:
+  // Performs the send, arranging for the given functor to be called with the result.
+  typedef std::function<void(const rudp::MessageSentFunctor&)> SendFunctor;
+
+  PeerSendQueue();
+  void Send(const NodeId& peer_id, MessageLane lane, const SendFunctor& send,
+            const rudp::MessageSentFunctor& message_sent_functor);
+  // Releases the peer's held messages to the transport, which reports their failure as for any
+  // other send to an unknown peer.  Call after removing the peer from the transport.
+  void Remove(const NodeId& peer_id);
+  size_t queued(const NodeId& peer_id) const;
+
+ private:
+  PeerSendQueue(const PeerSendQueue&);
+  PeerSendQueue(const PeerSendQueue&&);
+  PeerSendQueue& operator=(const PeerSendQueue&);
+
+  typedef std::pair<SendFunctor, rudp::MessageSentFunctor> PendingSend;
+  struct Peer {
+    Peer() : in_flight(0), held() {}
+    unsigned int in_flight;
+    std::deque<PendingSend> held;
+  };
+
+  void Dispatch(const NodeId& peer_id, const PendingSend& pending_send);
+  void OnSent(const NodeId& peer_id);
+
+  mutable std::mutex mutex_;
+  std::map<NodeId, Peer> peers_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MESSAGE_LANES_H_
@@ -18,6 +18,10 @@
 
 #include "maidsafe/routing/network.h"
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
 #include "boost/date_time/posix_time/posix_time_config.hpp"
 #include "boost/filesystem/path.hpp"
 
@@ -28,9 +32,11 @@
 #include "maidsafe/routing/bootstrap_file_operations.h"
 #include "maidsafe/routing/bootstrap_utils.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/flight_recorder.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/utils.h"
 #include "maidsafe/routing/acknowledgement.h"
@@ -49,7 +55,9 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 namespace routing {
 
 Network::Network(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-                 Acknowledgement& acknowledgement)
+                 Acknowledgement& acknowledgement, std::unique_ptr<Transport> transport,
+                 AsioService* asio_service, RoutingMetrics* metrics,
+                 std::shared_ptr<HandlerFence> handler_fence)
     : running_(true),
       running_mutex_(),
       bootstrap_attempt_(0),
@@ -58,12 +66,43 @@ Network::Network(RoutingTable& routing_table, ClientRoutingTable& client_routing
       routing_table_(routing_table),
       client_routing_table_(client_routing_table),
       acknowledgement_(acknowledgement),
+      kFlightRecorderId_(FlightRecorder::Prefix(routing_table.kNodeId().string())),
       nat_type_(rudp::NatType::kUnknown),
-      rudp_() {}
+      peer_statistics_(),
+      peer_send_queue_(),
+      transport_(transport ? std::move(transport)
+                           : std::unique_ptr<Transport>(new RudpTransport)),
+      ack_batcher_(),
+      metrics_(metrics),
+      handler_fence_(handler_fence ? handler_fence : std::make_shared<HandlerFence>()) {
+  if (asio_service) {
+    ack_batcher_.reset(new AckBatcher(
+        asio_service->service(), [this](const NodeId& peer_id, const NodeId& peer_connection_id,
+                                        const std::vector<int32_t>& ack_ids) {
+          SendAckBatch(peer_id, peer_connection_id, ack_ids);
+        }));
+  }
+  // Hop acks time the whole round trip to the peer, including its processing and queueing, which
+  // rudp's sent functor doesn't.
+  std::shared_ptr<HandlerFence> fence(handler_fence_);
+  acknowledgement_.set_round_trip_functor([this, fence](const NodeId& peer_connection_id,
+                                                        Clock::duration round_trip) {
+    HandlerFence::Scope scope(*fence);
+    if (scope.entered())
+      peer_statistics_.AddRoundTrip(peer_connection_id, round_trip);
+  });
+}
 
 Network::~Network() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  running_ = false;
+  {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    running_ = false;
+  }
+  // Outside the lock, since a batch being sent may be waiting for it.
+  if (ack_batcher_)
+    ack_batcher_->Stop();
+  acknowledgement_.set_round_trip_functor(nullptr);
+  handler_fence_->Close();
 }
 
 int Network::Bootstrap(const rudp::MessageReceivedFunctor& message_received_functor,
@@ -90,26 +129,24 @@ int Network::DoBootstrap(const rudp::MessageReceivedFunctor& message_received_fu
       return kNetworkShuttingDown;
   }
 
-  if (bootstrap_contacts.empty())
-    return kInvalidBootstrapContacts;
-
   assert(connection_lost_functor && "Must provide a valid functor");
   assert(bootstrap_connection_id_.IsZero() && "bootstrap_connection_id_ must be empty");
   auto private_key(std::make_shared<asymm::PrivateKey>(routing_table_.kPrivateKey()));
   auto public_key(std::make_shared<asymm::PublicKey>(routing_table_.kPublicKey()));
 
-  int result(rudp_.Bootstrap(/* sorted_ */ bootstrap_contacts, message_received_functor,
-                             connection_lost_functor, routing_table_.kConnectionId(), private_key,
-                             public_key, bootstrap_connection_id_, nat_type_, local_endpoint));
+  int result(transport_->Bootstrap(/* sorted_ */ bootstrap_contacts, message_received_functor,
+                                   connection_lost_functor, routing_table_.kConnectionId(),
+                                   private_key, public_key, bootstrap_connection_id_, nat_type_,
+                                   local_endpoint));
   // RUDP will return a kZeroId for zero state !!
   if (result != kSuccess || bootstrap_connection_id_.IsZero()) {
-    LOG(kError) << "No Online Bootstrap Node found.";
+    ROUTING_LOG(kError) << "No Online Bootstrap Node found.";
     return kNoOnlineBootstrapContacts;
   }
 
   this_node_relay_connection_id_ = routing_table_.kConnectionId();
-  LOG(kInfo) << "Bootstrap successful, bootstrap connection id - "
-             << DebugId(bootstrap_connection_id_);
+  ROUTING_LOG(kInfo) << "Bootstrap successful, bootstrap connection id - "
+                     << DebugId(bootstrap_connection_id_);
   return kSuccess;
 }
 
@@ -122,7 +159,8 @@ int Network::GetAvailableEndpoint(const NodeId& peer_id,
     if (!running_)
       return kNetworkShuttingDown;
   }
-  return rudp_.GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair, this_nat_type);
+  return transport_->GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair,
+                                          this_nat_type);
 }
 
 int Network::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
@@ -132,7 +170,10 @@ int Network::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_
     if (!running_)
       return kNetworkShuttingDown;
   }
-  return rudp_.Add(peer_id, peer_endpoint_pair, validation_data);
+  int result(transport_->Add(peer_id, peer_endpoint_pair, validation_data));
+  if (result == kSuccess)
+    peer_statistics_.Add(peer_id);
+  return result;
 }
 
 int Network::MarkConnectionAsValid(const NodeId& peer_id) {
@@ -142,9 +183,11 @@ int Network::MarkConnectionAsValid(const NodeId& peer_id) {
       return kNetworkShuttingDown;
   }
   Endpoint new_bootstrap_endpoint;
-  int ret_val(rudp_.MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
+  int ret_val(transport_->MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
+  if (ret_val == kSuccess)
+    peer_statistics_.Add(peer_id);
   if ((ret_val == kSuccess) && !new_bootstrap_endpoint.address().is_unspecified()) {
-    LOG(kVerbose) << "Found usable endpoint for bootstrapping : " << new_bootstrap_endpoint;
+    ROUTING_LOG(kVerbose) << "Found usable endpoint for bootstrapping : " << new_bootstrap_endpoint;
     InsertOrUpdateBootstrapContact(new_bootstrap_endpoint, routing_table_.client_mode());
   }
   return ret_val;
@@ -156,7 +199,9 @@ void Network::Remove(const NodeId& peer_id) {
     if (!running_)
       return;
   }
-  rudp_.Remove(peer_id);
+  peer_statistics_.Remove(peer_id);
+  transport_->Remove(peer_id);
+  peer_send_queue_.Remove(peer_id);
 }
 
 void Network::RudpSend(const NodeId& peer_id, const protobuf::Message& message,
@@ -166,10 +211,49 @@ void Network::RudpSend(const NodeId& peer_id, const protobuf::Message& message,
     if (!running_)
       return;
   }
-  rudp_.Send(peer_id, message.SerializeAsString(), message_sent_functor);
-  LOG(kVerbose) << "  [" << routing_table_.kNodeId()
-                << "] send : " << MessageTypeString(message) << " to " << peer_id
-                << "   (id: " << message.id() << ")" << " --To Rudp--";
+  auto serialised_message(std::make_shared<std::string>(message.SerializeAsString()));
+  NodeId ack_peer_id;
+  std::vector<int32_t> ack_ids;
+  if (ack_batcher_ && !IsAck(message))
+    ack_ids = ack_batcher_->Take(peer_id, ack_peer_id);
+  rudp::MessageSentFunctor send_result_functor(message_sent_functor);
+  if (!ack_ids.empty()) {
+    AppendAckIds(ack_ids, *serialised_message);
+    // Acks which didn't reach the peer go back to be batched again.
+    std::shared_ptr<HandlerFence> fence(handler_fence_);
+    send_result_functor = [this, fence, peer_id, ack_peer_id, ack_ids,
+                           message_sent_functor](int message_sent) {
+      HandlerFence::Scope scope(*fence);
+      if (!scope.entered())
+        return;
+      if (message_sent != rudp::kSuccess && ack_batcher_) {
+        for (const auto& ack_id : ack_ids)
+          ack_batcher_->Add(ack_peer_id, peer_id, ack_id);
+      }
+      if (message_sent_functor)
+        message_sent_functor(message_sent);
+    };
+  }
+  auto send([this, peer_id, serialised_message](const rudp::MessageSentFunctor& sent_functor) {
+    if (!Parameters::proximity_routing) {
+      transport_->Send(peer_id, *serialised_message, sent_functor);
+      return;
+    }
+    peer_statistics_.AddSendStart(peer_id);
+    std::shared_ptr<HandlerFence> fence(handler_fence_);
+    transport_->Send(peer_id, *serialised_message, [=](int message_sent) {
+      HandlerFence::Scope scope(*fence);
+      if (!scope.entered())
+        return;
+      peer_statistics_.AddSendResult(peer_id);
+      if (sent_functor)
+        sent_functor(message_sent);
+    });
+  });
+  peer_send_queue_.Send(peer_id, ClassifyMessage(message), send, send_result_functor);
+  ROUTING_LOG(kVerbose) << "  [" << routing_table_.kNodeId()
+                        << "] send : " << MessageTypeString(message) << " to " << peer_id
+                        << "   (id: " << message.id() << ")" << " --To Rudp--";
 }
 
 void Network::SendToDirect(const protobuf::Message& message, const NodeId& peer_connection_id,
@@ -190,34 +274,12 @@ void Network::SendToDirectAdjustedRoute(protobuf::Message& message, const NodeId
 }
 
 void Network::SendToClosestNode(const protobuf::Message& message) {
+  CountForward(message);
   // Normal messages
   if (message.has_destination_id() && !message.destination_id().empty()) {
-    auto client_routing_nodes(client_routing_table_.GetNodesInfo(NodeId(message.destination_id())));
-    // have the destination ID in non-routing table
-    if (!client_routing_nodes.empty() && message.direct()) {
-      if (IsClientToClientMessageWithDifferentNodeIds(message, true)) {
-        LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
-                      << " Dropping message as client to client message not allowed."
-                      << PrintMessage(message);
-        return;
-      }
-      LOG(kVerbose) << "This node [" << routing_table_.kNodeId() << "] has "
-                    << client_routing_nodes.size()
-                    << " destination node(s) in its non-routing table."
-                    << " id: " << message.id();
-
-      for (const auto& i : client_routing_nodes) {
-        LOG(kVerbose) << "Sending message to NRT node with ID " << message.id() << " node_id "
-                      << DebugId(i.id) << " connection id " << DebugId(i.connection_id);
-        SendTo(message, i.id, i.connection_id);
-      }
-    } else if (routing_table_.size() > 0) {  // getting closer nodes from routing table
-      RecursiveSendOn(message);
-    } else {
-      LOG(kError) << " No endpoint to send to; aborting send.  Attempt to send a type "
-                  << MessageTypeString(message) << " message to " << HexSubstr(message.source_id())
-                  << " from " << DebugId(routing_table_.kNodeId()) << " id: " << message.id();
-    }
+    std::vector<PeerView> client_nodes;
+    client_routing_table_.GetPeers(NodeId(message.destination_id()), client_nodes);
+    SendOn(message, client_nodes, nullptr);
     return;
   }
 
@@ -228,32 +290,92 @@ void Network::SendToClosestNode(const protobuf::Message& message) {
     SendTo(relay_message, NodeId(relay_message.relay_id()),
            NodeId(relay_message.relay_connection_id()));
   } else {
-    LOG(kError) << "Unable to work out destination; aborting send."
-                << " id: " << message.id() << " message.has_relay_id() ; " << std::boolalpha
-                << message.has_relay_id() << " Isresponse(message) : " << std::boolalpha
-                << IsResponse(message) << " message.has_relay_connection_id() : " << std::boolalpha
-                << message.has_relay_connection_id();
+    ROUTING_LOG(kError) << "Unable to work out destination; aborting send."
+                        << " id: " << message.id() << " message.has_relay_id() ; " << std::boolalpha
+                        << message.has_relay_id() << " Isresponse(message) : " << std::boolalpha
+                        << IsResponse(message) << " message.has_relay_connection_id() : "
+                        << std::boolalpha
+                        << message.has_relay_connection_id();
+  }
+}
+
+void Network::SendToClosestNode(const protobuf::Message& message,
+                                const RouteDecision& route_decision) {
+  assert(message.destination_id() == route_decision.target.string());
+  CountForward(message);
+  SendOn(message, route_decision.client_nodes, &route_decision);
+}
+
+void Network::SendOn(const protobuf::Message& message, const std::vector<PeerView>& client_nodes,
+                     const RouteDecision* route_decision) {
+  // have the destination ID in non-routing table
+  if (!client_nodes.empty() && message.direct()) {
+    if (IsClientToClientMessageWithDifferentNodeIds(message, true)) {
+      ROUTING_LOG(kWarning) << "This node [" << DebugId(routing_table_.kNodeId())
+                            << " Dropping message as client to client message not allowed."
+                            << PrintMessage(message);
+      return;
+    }
+    ROUTING_LOG(kVerbose) << "This node [" << routing_table_.kNodeId() << "] has "
+                          << client_nodes.size()
+                          << " destination node(s) in its non-routing table."
+                          << " id: " << message.id();
+
+    for (const auto& i : client_nodes) {
+      ROUTING_LOG(kVerbose) << "Sending message to NRT node with ID " << message.id()
+                            << " node_id "
+                            << DebugId(i.id) << " connection id " << DebugId(i.connection_id);
+      SendTo(message, i.id, i.connection_id);
+    }
+  } else if (route_decision ? !route_decision->closest_nodes.empty()
+                            : routing_table_.size() > 0) {  // getting closer nodes from table
+    RecursiveSendOn(message, PeerView(), 0, std::vector<std::string>(), route_decision);
+  } else {
+    ROUTING_LOG(kError) << " No endpoint to send to; aborting send.  Attempt to send a type "
+                        << MessageTypeString(message) << " message to "
+                        << HexSubstr(message.source_id())
+                        << " from " << DebugId(routing_table_.kNodeId()) << " id: "
+                        << message.id();
   }
 }
 
+NodeId Network::SendToClosestNode(protobuf::Message& message,
+                                  const std::vector<NodeId>& exclude) {
+  assert(message.has_destination_id() && !message.destination_id().empty());
+  std::vector<std::string> excluded;
+  for (const auto& node_id : exclude)
+    excluded.push_back(node_id.string());
+  return RecursiveSendOn(message, PeerView(), 0, excluded);
+}
+
 void Network::SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
                           const NodeId& peer_connection_id,  bool no_ack_timer) {
+  FlightRecorder::Add(FlightEvent::kSent, kFlightRecorderId_, message,
+                      FlightRecorder::Prefix(peer_node_id.string()));
   const std::string kThisId(routing_table_.kNodeId().string());
+  std::shared_ptr<HandlerFence> fence(handler_fence_);
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
+    HandlerFence::Scope scope(*fence);
+    if (!scope.entered())
+      return;
     if (rudp::kSuccess == message_sent) {
       SendAck(message);
-      LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
-                    << " to   " << peer_node_id << "   (id: " << message.id() << ")";
+      ROUTING_LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : "
+                            << MessageTypeString(message)
+                            << " to   " << peer_node_id << "   (id: " << message.id() << ")";
     } else {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
-                  << HexSubstr(kThisId) << " to " << peer_node_id << " failed with code "
-                  << message_sent << " id: " << message.id();
+      ROUTING_LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+                          << HexSubstr(kThisId) << " to " << peer_node_id << " failed with code "
+                          << message_sent << " id: " << message.id();
     }
   };
 
   if (!no_ack_timer && acknowledgement_.NeedsAck(message, peer_connection_id)) {
     acknowledgement_.Add(message,
                          [=](const boost::system::error_code& error) {
+                           HandlerFence::Scope scope(*fence);
+                           if (!scope.entered())
+                             return;
                            {
                              std::lock_guard<std::mutex> lock(running_mutex_);
                              if (!running_)
@@ -261,31 +383,36 @@ void Network::SendTo(const protobuf::Message& message, const NodeId& peer_node_i
                            }
                            if (!error)
                              SendTo(message, peer_node_id, peer_connection_id);
-                         }, Parameters::ack_timeout);
+                         }, Parameters::ack_timeout, peer_connection_id);
   }
-  LOG(kVerbose) << " >>>>>>>>> rudp send message to connection id " << DebugId(peer_connection_id);
+  ROUTING_LOG(kVerbose) << " >>>>>>>>> rudp send message to connection id "
+                        << DebugId(peer_connection_id);
   RudpSend(peer_connection_id, message, message_sent_functor);
 }
 
-void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted,
-                                   int attempt_count) {
+NodeId Network::RecursiveSendOn(protobuf::Message message, PeerView last_node_attempted,
+                                int attempt_count, std::vector<std::string> exclude,
+                                const RouteDecision* route_decision) {
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
-      return;
+      return NodeId();
   }
   if (attempt_count >= 3) {
-    LOG(kWarning) << " Retry attempts failed to send to ["
-                  << HexSubstr(last_node_attempted.id.string())
-                  << "] will drop this node now and try with another node."
-                  << " id: " << message.id();
+    ROUTING_LOG(kWarning) << " Retry attempts failed to send to ["
+                          << HexSubstr(last_node_attempted.id.string())
+                          << "] will drop this node now and try with another node."
+                          << " id: " << message.id();
     attempt_count = 0;
     {
       std::lock_guard<std::mutex> lock(running_mutex_);
       if (!running_)
-        return;
-      rudp_.Remove(last_node_attempted.connection_id);
-      LOG(kWarning) << " Routing -> removing connection " << last_node_attempted.id.string();
+        return NodeId();
+      peer_statistics_.Remove(last_node_attempted.connection_id);
+      transport_->Remove(last_node_attempted.connection_id);
+      peer_send_queue_.Remove(last_node_attempted.connection_id);
+      ROUTING_LOG(kWarning) << " Routing -> removing connection "
+                            << last_node_attempted.id.string();
       // FIXME Should we remove this node or let rudp handle that?
       routing_table_.DropNode(last_node_attempted.connection_id, false);
       client_routing_table_.DropConnection(last_node_attempted.connection_id);
@@ -298,63 +425,95 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
   const std::string kThisId(routing_table_.kNodeId().string());
   bool ignore_exact_match(!IsDirect(message));
   std::vector<std::string> route_history;
-  NodeInfo peer;
+  PeerView peer;
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
-      return;
+      return NodeId();
     if (message.route_history().size() > 1)
       route_history = std::vector<std::string>(
           message.route_history().begin(), message.route_history().end());
     else if ((message.route_history().size() == 1) &&
              (message.route_history(0) != routing_table_.kNodeId().string()))
       route_history.push_back(message.route_history(0));
+    route_history.insert(route_history.end(), exclude.begin(), exclude.end());
 
-    peer = routing_table_.GetClosestNode(NodeId(message.destination_id()), ignore_exact_match,
-                                         route_history);
+    if (Parameters::proximity_routing)
+      peer = GetProximityPeer(NodeId(message.destination_id()), ignore_exact_match, route_history);
+    if (peer.id == NodeId()) {
+      peer = route_decision
+                 ? route_decision->ClosestNode(ignore_exact_match, route_history)
+                 : routing_table_.GetClosestPeer(NodeId(message.destination_id()),
+                                                  ignore_exact_match, route_history);
+    }
+    if (peer.id == NodeId() && !exclude.empty()) {
+      ROUTING_LOG(kInfo) << "No alternative to excluded nodes; aborting send.  id: "
+                         << message.id();
+      return NodeId();
+    }
     if (peer.id == NodeId() && routing_table_.size() != 0) {
-      peer = routing_table_.GetClosestNode(NodeId(message.destination_id()), ignore_exact_match);
+      peer = routing_table_.GetClosestPeer(NodeId(message.destination_id()), ignore_exact_match);
     }
     if (peer.id == NodeId()) {
-      LOG(kError) << "This node's routing table is empty now.  Need to re-bootstrap.";
-      return;
+      ROUTING_LOG(kError) << "This node's routing table is empty now.  Need to re-bootstrap.";
+      return NodeId();
     }
     AdjustRouteHistory(message);
   }
+  FlightRecorder::Add(FlightEvent::kSent, kFlightRecorderId_, message,
+                      FlightRecorder::Prefix(peer.id.string()));
 
+  std::shared_ptr<HandlerFence> fence(handler_fence_);
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
+    HandlerFence::Scope scope(*fence);
+    if (!scope.entered())
+      return;
     {
       std::lock_guard<std::mutex> lock(running_mutex_);
       if (!running_)
         return;
     }
     if (rudp::kSuccess == message_sent) {
-      LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
-                    << " to   " << HexSubstr(peer.id.string()) << "   (id: " << message.id()
-                    << ")"
-                    << " dst : " << HexSubstr(message.destination_id());
+      ROUTING_LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : "
+                            << MessageTypeString(message)
+                            << " to   " << HexSubstr(peer.id.string()) << "   (id: " << message.id()
+                            << ")"
+                            << " dst : " << HexSubstr(message.destination_id());
       SendAck(message);
     } else if (rudp::kSendFailure == message_sent) {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
-                  << HexSubstr(routing_table_.kNodeId().string()) << " to "
-                  << HexSubstr(peer.id.string()) << " with destination ID "
-                  << HexSubstr(message.destination_id()) << " failed with code " << message_sent
-                  << ".  Will retry to Send.  Attempt count = " << attempt_count + 1
-                  << " id: " << message.id();
-      RecursiveSendOn(message, peer, attempt_count + 1);
+      ROUTING_LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+                          << HexSubstr(routing_table_.kNodeId().string()) << " to "
+                          << HexSubstr(peer.id.string()) << " with destination ID "
+                          << HexSubstr(message.destination_id()) << " failed with code "
+                          << message_sent
+                          << ".  Will retry to Send.  Attempt count = " << attempt_count + 1
+                          << " id: " << message.id();
+      RecursiveSendOn(message, peer, attempt_count + 1, exclude);
+    } else if (kSendQueueFull == message_sent) {
+      // The peer is healthy but has a full backlog, so neither retry now nor drop it.  If the
+      // message awaits an ack, its timer re-sends it as for any other lost message.
+      ROUTING_LOG(kWarning) << "Send queue to " << HexSubstr(peer.id.string())
+                            << " is full; shedding type " << MessageTypeString(message)
+                            << " message.  id: " << message.id();
+      if (metrics_)
+        metrics_->AddDropped(DropReason::kSendQueueFull);
+      FlightRecorder::Add(FlightEvent::kDropped, kFlightRecorderId_, message, 0,
+                          DropReason::kSendQueueFull);
     } else {
-      LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
-                  << HexSubstr(kThisId) << " to " << HexSubstr(peer.id.string())
-                  << " with destination ID " << HexSubstr(message.destination_id())
-                  << " failed with code " << message_sent << "  Will remove node."
-                  << " message id: " << message.id();
+      ROUTING_LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
+                          << HexSubstr(kThisId) << " to " << HexSubstr(peer.id.string())
+                          << " with destination ID " << HexSubstr(message.destination_id())
+                          << " failed with code " << message_sent << "  Will remove node."
+                          << " message id: " << message.id();
       {
         std::lock_guard<std::mutex> lock(running_mutex_);
         if (!running_)
           return;
-        rudp_.Remove(last_node_attempted.connection_id);
+        peer_statistics_.Remove(peer.connection_id);
+        transport_->Remove(peer.connection_id);
+        peer_send_queue_.Remove(peer.connection_id);
       }
-      LOG(kWarning) << " Routing-> removing connection " << DebugId(peer.connection_id);
+      ROUTING_LOG(kWarning) << " Routing-> removing connection " << DebugId(peer.connection_id);
       routing_table_.DropNode(peer.id, false);
       client_routing_table_.DropConnection(peer.connection_id);
       RecursiveSendOn(message);
@@ -364,12 +523,53 @@ void Network::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_atte
   if (acknowledgement_.NeedsAck(message, peer.id)) {
     acknowledgement_.Add(message,
                         [=](const boost::system::error_code& error) {
-                          if (error.value() == boost::system::errc::success)
+                          HandlerFence::Scope scope(*fence);
+                          if (scope.entered() && error.value() == boost::system::errc::success)
                             RecursiveSendOn(message);
-                        }, Parameters::ack_timeout);
+                        }, Parameters::ack_timeout, peer.connection_id);
   }
-  LOG(kVerbose) << "Rudp recursive send message to " << peer.connection_id;
+  ROUTING_LOG(kVerbose) << "Rudp recursive send message to " << peer.connection_id;
   RudpSend(peer.connection_id, message, message_sent_functor);
+  return peer.id;
+}
+
+PeerView Network::GetProximityPeer(const NodeId& target_id, bool ignore_exact_match,
+                                   const std::vector<std::string>& exclude) {
+  std::vector<PeerView> closest_peers, candidates;
+  routing_table_.GetClosestPeers(
+      target_id,
+      Parameters::proximity_routing_candidates + static_cast<unsigned int>(exclude.size()),
+      closest_peers, ignore_exact_match);
+  for (const auto& peer : closest_peers) {
+    if (std::find(exclude.begin(), exclude.end(), peer.id.string()) != exclude.end())
+      continue;
+    // The destination itself always wins, and any alternative must still get closer than this node
+    // to the target, so that every hop makes strict progress and routes cannot loop.
+    if (peer.id == target_id)
+      return peer;
+    if (!NodeId::CloserToTarget(peer.id, routing_table_.kNodeId(), target_id))
+      break;
+    candidates.push_back(peer);
+    if (candidates.size() == Parameters::proximity_routing_candidates)
+      break;
+  }
+  if (candidates.empty())
+    return PeerView();
+
+  std::vector<NodeId> connection_ids;
+  for (const auto& candidate : candidates)
+    connection_ids.push_back(candidate.connection_id);
+  return candidates.at(peer_statistics_.SelectLowestCost(connection_ids));
+}
+
+// Messages which originated here, including relayed requests from this node while it is joining,
+// aren't forwards.
+void Network::CountForward(const protobuf::Message& message) {
+  if (!metrics_)
+    return;
+  const std::string& origin(message.has_source_id() ? message.source_id() : message.relay_id());
+  if (origin != routing_table_.kNodeId().string())
+    metrics_->AddForwarded(message.type());
 }
 
 void Network::AdjustRouteHistory(protobuf::Message& message) {
@@ -419,7 +619,7 @@ maidsafe::NodeId Network::this_node_relay_connection_id() const {
 rudp::NatType Network::nat_type() const { return nat_type_; }
 
 void Network::SendAck(const protobuf::Message& message) {
-  LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] SendAck " << message.ack_id();
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] SendAck " << message.ack_id();
   if (message.ack_id() == 0)
     return;
 
@@ -438,7 +638,7 @@ void Network::SendAck(const protobuf::Message& message) {
     return;
 
   for (const auto& hop : ack_node_ids)
-    LOG(kVerbose) << " hop in history: " << HexSubstr(hop) << "ack id:" << message.ack_id();
+    ROUTING_LOG(kVerbose) << " hop in history: " << HexSubstr(hop) << "ack id:" << message.ack_id();
 
   if ((message.relay_id() == routing_table_.kNodeId().string()) ||
       message.source_id() == routing_table_.kNodeId().string())
@@ -449,12 +649,27 @@ void Network::SendAck(const protobuf::Message& message) {
     acknowledgement_.Remove(message.ack_id());
   }
 
-  protobuf::Message ack_message(rpcs::Ack(NodeId(message.ack_node_ids(0)), routing_table_.kNodeId(),
+  NodeId ack_node_id(message.ack_node_ids(0));
+  PeerView peer;
+  if (ack_batcher_ && Parameters::ack_batch_delay > std::chrono::steady_clock::duration::zero() &&
+      routing_table_.GetPeer(ack_node_id, peer)) {
+    ack_batcher_->Add(ack_node_id, peer.connection_id, message.ack_id());
+    return;
+  }
+  protobuf::Message ack_message(rpcs::Ack(ack_node_id, routing_table_.kNodeId(),
                                           message.ack_id()));
-  LOG(kVerbose) << "Network::SendAck";
+  ROUTING_LOG(kVerbose) << "Network::SendAck";
   SendToClosestNode(ack_message);
 }
 
+void Network::SendAckBatch(const NodeId& peer_id, const NodeId& peer_connection_id,
+                           const std::vector<int32_t>& ack_ids) {
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] sending " << ack_ids.size()
+                        << " acks to " << peer_id;
+  protobuf::Message ack_message(rpcs::Ack(peer_id, routing_table_.kNodeId(), ack_ids));
+  SendToDirect(ack_message, peer_id, peer_connection_id);
+}
+
 }  // namespace routing
 
 }  // namespace maidsafe
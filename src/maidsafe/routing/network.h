@@ -19,19 +19,28 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_H_
 #define MAIDSAFE_ROUTING_NETWORK_H_
 
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
 
+#include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/rudp/managed_connections.h"
 
+#include "maidsafe/routing/ack_batcher.h"
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/bootstrap_file_operations.h"
+#include "maidsafe/routing/handler_fence.h"
+#include "maidsafe/routing/message_lanes.h"
 #include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/peer_statistics.h"
+#include "maidsafe/routing/peer_view.h"
+#include "maidsafe/routing/routing_metrics.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
 
 namespace maidsafe {
 
@@ -43,6 +52,7 @@ class Message;
 
 class ClientRoutingTable;
 class RoutingTable;
+struct RouteDecision;
 class Acknowledgement;
 
 namespace test {
@@ -52,8 +62,15 @@ class MockNetwork;
 
 class Network {
  public:
+  // If 'transport' is null, the network runs over rudp.  Hop acks are only batched if
+  // 'asio_service' is provided; it must outlive this object.  If 'metrics' is provided, messages
+  // which this node passes on towards their destination are counted there as forwarded.  Timer and
+  // send handlers only run inside 'handler_fence' (a private one if null), which is closed at the
+  // latest by the destructor.
   Network(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
-          Acknowledgement& acknowledgement);
+          Acknowledgement& acknowledgement, std::unique_ptr<Transport> transport = nullptr,
+          AsioService* asio_service = nullptr, RoutingMetrics* metrics = nullptr,
+          std::shared_ptr<HandlerFence> handler_fence = nullptr);
   virtual ~Network();
   int Bootstrap(const rudp::MessageReceivedFunctor& message_received_functor,
                 const rudp::ConnectionLostFunctor& connection_lost_functor);
@@ -81,7 +98,14 @@ class Network {
   // Handles relay response messages.  Also leave destination ID empty if needs to send as a relay
   // response message
   virtual void SendToClosestNode(const protobuf::Message& message);
-  void SendToClosestNode(protobuf::Message& message, const std::vector<NodeId>& exclude);
+  // As above, for a message whose destination is 'route_decision.target', reusing the decision
+  // rather than querying the routing tables again.
+  virtual void SendToClosestNode(const protobuf::Message& message,
+                                 const RouteDecision& route_decision);
+  // Sends via the closest node which isn't in 'exclude' (nor the route history), returning the ID
+  // of the first hop tried, or a zero ID if there was none.  Unlike the overload above, doesn't
+  // fall back to an excluded node if there's no alternative.
+  NodeId SendToClosestNode(protobuf::Message& message, const std::vector<NodeId>& exclude);
   void AddToBootstrapFile(const boost::asio::ip::udp::endpoint& endpoint);
   void clear_bootstrap_connection_info();
   NodeId bootstrap_connection_id() const;
@@ -105,9 +129,20 @@ class Network {
                 const rudp::MessageSentFunctor& message_sent_functor);
   void SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
               const NodeId& peer_connection_id, bool no_ack_timer = false);
-  void RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted = NodeInfo(),
-                       int attempt_count = 0);
+  void SendOn(const protobuf::Message& message, const std::vector<PeerView>& client_nodes,
+              const RouteDecision* route_decision);
+  // 'route_decision', if provided, picks the first peer to try; retries query the routing table.
+  // Returns the ID of the peer sent to, or a zero ID if the message wasn't sent.
+  NodeId RecursiveSendOn(protobuf::Message message, PeerView last_node_attempted = PeerView(),
+                         int attempt_count = 0,
+                         std::vector<std::string> exclude = std::vector<std::string>(),
+                         const RouteDecision* route_decision = nullptr);
+  PeerView GetProximityPeer(const NodeId& target_id, bool ignore_exact_match,
+                            const std::vector<std::string>& exclude);
   void AdjustRouteHistory(protobuf::Message& message);
+  void CountForward(const protobuf::Message& message);
+  void SendAckBatch(const NodeId& peer_id, const NodeId& peer_connection_id,
+                    const std::vector<int32_t>& ack_ids);
 
   bool running_;
   std::mutex running_mutex_;
@@ -117,8 +152,14 @@ class Network {
   RoutingTable& routing_table_;
   ClientRoutingTable& client_routing_table_;
   Acknowledgement& acknowledgement_;
+  const uint64_t kFlightRecorderId_;
   rudp::NatType nat_type_;
-  rudp::ManagedConnections rudp_;
+  PeerStatistics peer_statistics_;
+  PeerSendQueue peer_send_queue_;
+  std::unique_ptr<Transport> transport_;
+  std::unique_ptr<AckBatcher> ack_batcher_;
+  RoutingMetrics* const metrics_;
+  std::shared_ptr<HandlerFence> handler_fence_;
 };
 
 }  // namespace routing
@@ -23,7 +23,10 @@ namespace maidsafe {
 namespace routing {
 
 NetworkUtils::NetworkUtils(const NodeId& local_node_id, AsioService& asio_service)
-    : acknowledgement_(local_node_id, asio_service), firewall_(), statistics_(local_node_id) {}
+    : metrics_(),
+      acknowledgement_(local_node_id, asio_service, &metrics_),
+      firewall_(),
+      statistics_(local_node_id) {}
 
 }  // namespace routing
 
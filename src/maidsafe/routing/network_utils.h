@@ -22,6 +22,7 @@
 #include "maidsafe/routing/acknowledgement.h"
 #include "maidsafe/routing/firewall.h"
 #include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/routing_metrics.h"
 
 namespace maidsafe {
 
@@ -33,6 +34,7 @@ struct NetworkUtils {
   NetworkUtils(const NetworkUtils&) = delete;
   NetworkUtils(const NetworkUtils&&) = delete;
 
+  RoutingMetrics metrics_;
   Acknowledgement acknowledgement_;
   Firewall firewall_;
   NetworkStatistics statistics_;
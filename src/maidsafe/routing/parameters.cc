@@ -21,6 +21,8 @@
 #include "maidsafe/rudp/parameters.h"
 #include "maidsafe/rudp/managed_connections.h"
 
+#include "maidsafe/routing/routing_log.h"
+
 namespace bptime = boost::posix_time;
 
 namespace maidsafe {
@@ -32,12 +34,18 @@ unsigned int Parameters::num_chunks_to_cache(100);
 unsigned int Parameters::closest_nodes_size(16);
 unsigned int Parameters::group_size(4);
 unsigned int Parameters::proximity_factor(2);
+bool Parameters::proximity_routing(false);
+unsigned int Parameters::proximity_routing_candidates(3);
 unsigned int Parameters::max_routing_table_size(64);
 unsigned int Parameters::routing_table_size_threshold(max_routing_table_size / 4);
 unsigned int Parameters::max_routing_table_size_for_client(8);
 unsigned int Parameters::max_client_routing_table_size(max_routing_table_size);
 unsigned int Parameters::bucket_target_size(1);
 std::chrono::steady_clock::duration Parameters::default_response_timeout(std::chrono::seconds(20));
+bool Parameters::hedge_direct_sends(false);
+unsigned int Parameters::hedge_delay_percentile(95);
+std::chrono::steady_clock::duration Parameters::hedge_min_delay(std::chrono::milliseconds(50));
+std::chrono::steady_clock::duration Parameters::hedge_initial_delay(std::chrono::seconds(1));
 std::chrono::seconds Parameters::find_node_interval(10);
 std::chrono::seconds Parameters::recovery_time_lag(5);
 std::chrono::seconds Parameters::re_bootstrap_time_lag(10);
@@ -49,18 +57,36 @@ unsigned int Parameters::hops_to_live(50);
 unsigned int Parameters::accepted_distance_tolerance(1);
 unsigned int Parameters::max_send_retry(3);
 unsigned int Parameters::ack_timeout(5);
+std::chrono::steady_clock::duration Parameters::ack_batch_delay(std::chrono::milliseconds(20));
+unsigned int Parameters::max_acks_per_batch(64);
 unsigned int Parameters::firewall_history_cleanup_factor(5000);
 std::chrono::seconds Parameters::firewall_message_life(300);
 unsigned int Parameters::public_key_holding_time(30);
 unsigned int Parameters::unidirectional_interest_range(Parameters::closest_nodes_size * 2);
+unsigned int Parameters::close_standby_size(4);
 std::chrono::steady_clock::duration Parameters::local_retreival_timeout(std::chrono::seconds(2));
 unsigned int Parameters::routing_table_ready_to_response(Parameters::max_routing_table_size / 2);
 bptime::time_duration Parameters::connect_rpc_prune_timeout(
     rudp::Parameters::rendezvous_connect_timeout * 2);
 // 10 KB of book keeping data for Routing
 uint32_t Parameters::max_data_size(rudp::ManagedConnections::kMaxMessageSize() - 10240);
+bool Parameters::copy_message_contents(true);
 // TODO(Prakash): BEFORE_RELEASE enable caching after persona tests are passing
 bool Parameters::caching(true);
+unsigned int Parameters::control_lane_weight(8);
+unsigned int Parameters::max_data_sends_per_peer(4);
+unsigned int Parameters::max_held_data_sends_per_peer(256);
+unsigned int Parameters::admission_client_rate(0);
+unsigned int Parameters::admission_client_burst(0);
+unsigned int Parameters::admission_vault_rate(0);
+unsigned int Parameters::admission_vault_burst(0);
+unsigned int Parameters::upcall_threads(2);
+unsigned int Parameters::max_queued_upcalls(1024);
+std::chrono::steady_clock::duration Parameters::group_cache_ttl(std::chrono::seconds(10));
+unsigned int Parameters::max_group_cache_size(1024);
+int Parameters::min_log_level(kLogLevelFromFilter);
+bool Parameters::flight_recorder(true);
+int Parameters::flight_recorder_dump_signal(0);
 }  // namespace routing
 
 }  // namespace maidsafe
@@ -0,0 +1,109 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/peer_statistics.h"
+
+#include <limits>
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Weight given to each new sample, as for TCP's smoothed RTT (RFC 6298).
+const int kSmoothingDivisor(8);
+
+}  // unnamed namespace
+
+PeerStatistics::PeerStatistics() : mutex_(), entries_() {}
+
+void PeerStatistics::Add(const NodeId& connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.insert(std::make_pair(connection_id, Entry()));
+}
+
+void PeerStatistics::AddSendStart(const NodeId& connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(connection_id));
+  if (itr != std::end(entries_))
+    ++itr->second.outstanding_sends;
+}
+
+void PeerStatistics::AddSendResult(const NodeId& connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(connection_id));
+  if (itr != std::end(entries_) && itr->second.outstanding_sends > 0)
+    --itr->second.outstanding_sends;
+}
+
+void PeerStatistics::AddRoundTrip(const NodeId& connection_id,
+                                  std::chrono::steady_clock::duration round_trip) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(connection_id));
+  if (itr == std::end(entries_))
+    return;
+  Entry& entry(itr->second);
+  auto sample(std::chrono::duration_cast<std::chrono::microseconds>(round_trip));
+  if (entry.sampled) {
+    entry.smoothed_round_trip += (sample - entry.smoothed_round_trip) / kSmoothingDivisor;
+  } else {
+    entry.smoothed_round_trip = sample;
+    entry.sampled = true;
+  }
+}
+
+void PeerStatistics::Remove(const NodeId& connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(connection_id);
+}
+
+size_t PeerStatistics::SelectLowestCost(const std::vector<NodeId>& connection_ids) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<const Entry*> entries;
+  entries.reserve(connection_ids.size());
+  auto best_measured(std::chrono::microseconds::max());
+  for (const auto& connection_id : connection_ids) {
+    auto itr(entries_.find(connection_id));
+    const Entry* entry(itr == std::end(entries_) ? nullptr : &itr->second);
+    if (entry && entry->sampled)
+      best_measured = std::min(best_measured, entry->smoothed_round_trip);
+    entries.push_back(entry);
+  }
+  if (best_measured == std::chrono::microseconds::max())
+    best_measured = std::chrono::microseconds(1);
+
+  size_t selected(0);
+  auto lowest_cost(std::numeric_limits<std::chrono::microseconds::rep>::max());
+  for (size_t index(0); index != entries.size(); ++index) {
+    const Entry* entry(entries[index]);
+    auto round_trip((entry && entry->sampled) ? entry->smoothed_round_trip : best_measured);
+    auto cost(std::max(round_trip.count(), std::chrono::microseconds::rep(1)) *
+              (1 + (entry ? entry->outstanding_sends : 0)));
+    if (cost < lowest_cost) {
+      lowest_cost = cost;
+      selected = index;
+    }
+  }
+  return selected;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
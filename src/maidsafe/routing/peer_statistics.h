@@ -0,0 +1,79 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PEER_STATISTICS_H_
+#define MAIDSAFE_ROUTING_PEER_STATISTICS_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class PeerStatisticsTest_BEH_SmoothedRoundTripTime_Test;
+}
+
+// Tracks, per peer connection, a smoothed round trip time of hop acks (measured from sending a
+// message to the peer until the peer's ack for it arrives) and the number of rudp sends still
+// outstanding.  Used to choose between near-equivalent next hops when Parameters::proximity_routing
+// is enabled.
+class PeerStatistics {
+ public:
+  PeerStatistics();
+  // Starts tracking 'connection_id'.  Sends to peers which aren't tracked, including those already
+  // removed, are ignored.
+  void Add(const NodeId& connection_id);
+  void AddSendStart(const NodeId& connection_id);
+  void AddSendResult(const NodeId& connection_id);
+  void AddRoundTrip(const NodeId& connection_id, std::chrono::steady_clock::duration round_trip);
+  void Remove(const NodeId& connection_id);
+  // Returns the index of the candidate with the lowest expected cost, i.e. smoothed round trip time
+  // scaled by outstanding sends.  Peers with no samples yet are costed at the best measured round
+  // trip time, so they get probed.  Ties favour the lower index (candidates are expected to be
+  // passed in XOR order).  Returns 0 if |connection_ids| is empty.
+  size_t SelectLowestCost(const std::vector<NodeId>& connection_ids) const;
+
+  friend class test::PeerStatisticsTest_BEH_SmoothedRoundTripTime_Test;
+
+ private:
+  PeerStatistics(const PeerStatistics&);
+  PeerStatistics(const PeerStatistics&&);
+  PeerStatistics& operator=(const PeerStatistics&);
+
+  struct Entry {
+    Entry() : smoothed_round_trip(), outstanding_sends(0), sampled(false) {}
+    std::chrono::microseconds smoothed_round_trip;
+    unsigned int outstanding_sends;
+    bool sampled;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<NodeId, Entry> entries_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PEER_STATISTICS_H_
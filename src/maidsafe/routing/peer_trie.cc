@@ -0,0 +1,149 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/peer_trie.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+const int PeerTrie::kLeaf(NodeId::kSize * 8);
+
+PeerTrie::Node::Node() : bit(kLeaf), key(), peer(), children() {}
+
+PeerTrie::PeerTrie() : root_(), size_(0) {}
+
+bool PeerTrie::Insert(const PeerView& peer) {
+  Key key(ToKey(peer.id));
+  std::unique_ptr<Node> leaf(new Node);
+  leaf->key = key;
+  leaf->peer = peer;
+  if (!root_) {
+    root_ = std::move(leaf);
+    ++size_;
+    return true;
+  }
+
+  int differing_bit(FirstDifferingBit(key, FindLeaf(key)->key));
+  if (differing_bit == kLeaf)
+    return false;
+
+  // The new leaf branches off above the first node which tests a later bit.
+  std::unique_ptr<Node>* slot(&root_);
+  while ((*slot)->bit < differing_bit)
+    slot = &(*slot)->children[Bit(key, (*slot)->bit)];
+  std::unique_ptr<Node> branch(new Node);
+  branch->bit = differing_bit;
+  int side(Bit(key, differing_bit));
+  branch->children[side] = std::move(leaf);
+  branch->children[1 - side] = std::move(*slot);
+  *slot = std::move(branch);
+  ++size_;
+  return true;
+}
+
+bool PeerTrie::Erase(const NodeId& peer_id) {
+  if (!root_)
+    return false;
+  Key key(ToKey(peer_id));
+  std::unique_ptr<Node>* parent(nullptr);
+  std::unique_ptr<Node>* slot(&root_);
+  while ((*slot)->bit != kLeaf) {
+    parent = slot;
+    slot = &(*slot)->children[Bit(key, (*slot)->bit)];
+  }
+  if ((*slot)->key != key)
+    return false;
+
+  if (parent) {
+    // The leaf's sibling takes its parent's place.
+    std::unique_ptr<Node> sibling(std::move((*parent)->children[1 - Bit(key, (*parent)->bit)]));
+    *parent = std::move(sibling);
+  } else {
+    root_.reset();
+  }
+  --size_;
+  return true;
+}
+
+const PeerView* PeerTrie::Find(const NodeId& peer_id) const {
+  if (!root_)
+    return nullptr;
+  Key key(ToKey(peer_id));
+  const Node* leaf(FindLeaf(key));
+  return leaf->key == key ? &leaf->peer : nullptr;
+}
+
+void PeerTrie::GetClosest(const NodeId& target, size_t count, std::vector<PeerView>& peers) const {
+  if (root_ && count != 0)
+    Collect(*root_, ToKey(target), peers.size() + count, peers);
+}
+
+PeerTrie::Key PeerTrie::ToKey(const NodeId& node_id) {
+  Key key;
+  const std::string& raw_id(node_id.string());
+  std::copy(raw_id.begin(), raw_id.begin() + key.size(), key.begin());
+  return key;
+}
+
+int PeerTrie::Bit(const Key& key, int index) {
+  return (key[index / 8] >> (7 - index % 8)) & 1;
+}
+
+int PeerTrie::FirstDifferingBit(const Key& lhs, const Key& rhs) {
+  for (size_t i(0); i != lhs.size(); ++i) {
+    unsigned int difference(lhs[i] ^ rhs[i]);
+    if (difference != 0) {
+      int bit(static_cast<int>(i) * 8);
+      while ((difference & 0x80) == 0) {
+        difference <<= 1;
+        ++bit;
+      }
+      return bit;
+    }
+  }
+  return kLeaf;
+}
+
+// Peers sharing the target's value of 'bit' are all closer to it than those which don't, so taking
+// the matching subtree first yields the peers in order of distance.
+void PeerTrie::Collect(const Node& node, const Key& target, size_t limit,
+                       std::vector<PeerView>& peers) {
+  if (node.bit == kLeaf) {
+    peers.push_back(node.peer);
+    return;
+  }
+  int side(Bit(target, node.bit));
+  Collect(*node.children[side], target, limit, peers);
+  if (peers.size() < limit)
+    Collect(*node.children[1 - side], target, limit, peers);
+}
+
+const PeerTrie::Node* PeerTrie::FindLeaf(const Key& key) const {
+  const Node* node(root_.get());
+  while (node->bit != kLeaf)
+    node = node->children[Bit(key, node->bit)].get();
+  return node;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,84 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PEER_TRIE_H_
+#define MAIDSAFE_ROUTING_PEER_TRIE_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/peer_view.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// A binary trie of peers keyed on their ids, with single-child paths collapsed.  Walking it towards
+// a target visits the peers in order of XOR distance from the target, so the closest k are found
+// in O(k log n) without sorting the whole set.  Not thread-safe; the owner must synchronise access.
+class PeerTrie {
+ public:
+  PeerTrie();
+  // Returns false if a peer with the same id is already held.
+  bool Insert(const PeerView& peer);
+  bool Erase(const NodeId& peer_id);
+  // Returns null if no peer with this id is held.
+  const PeerView* Find(const NodeId& peer_id) const;
+  // Appends up to 'count' peers to 'peers', closest to 'target' first.
+  void GetClosest(const NodeId& target, size_t count, std::vector<PeerView>& peers) const;
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  typedef std::array<unsigned char, NodeId::kSize> Key;
+  // Leaves hold a peer; other nodes hold the index of the first bit in which their two subtrees
+  // differ.  Bits are numbered from the most significant.
+  struct Node {
+    Node();
+    int bit;
+    Key key;
+    PeerView peer;
+    std::unique_ptr<Node> children[2];
+  };
+
+  PeerTrie(const PeerTrie&);
+  PeerTrie(const PeerTrie&&);
+  PeerTrie& operator=(const PeerTrie&);
+
+  static Key ToKey(const NodeId& node_id);
+  static int Bit(const Key& key, int index);
+  static int FirstDifferingBit(const Key& lhs, const Key& rhs);
+  static void Collect(const Node& node, const Key& target, size_t limit,
+                      std::vector<PeerView>& peers);
+  const Node* FindLeaf(const Key& key) const;
+
+  // Greater than any real bit index, so that descending "while bit < n" always stops at a leaf.
+  static const int kLeaf;
+  std::unique_ptr<Node> root_;
+  size_t size_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PEER_TRIE_H_
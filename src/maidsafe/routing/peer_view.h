@@ -0,0 +1,49 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PEER_VIEW_H_
+#define MAIDSAFE_ROUTING_PEER_VIEW_H_
+
+#include <cstdint>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// The parts of a NodeInfo needed to forward a message to a peer.  Unlike NodeInfo it holds no
+// public key or dimension list, so the routing tables can copy these out cheaply for every message.
+// Paths which validate or hand out peers' keys still use NodeInfo.
+struct PeerView {
+  PeerView() : id(), connection_id(), bucket(NodeInfo::kInvalidBucket) {}
+  explicit PeerView(const NodeInfo& node_info)
+      : id(node_info.id), connection_id(node_info.connection_id), bucket(node_info.bucket) {}
+
+  NodeId id;
+  NodeId connection_id;
+  int32_t bucket;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PEER_VIEW_H_
@@ -24,8 +24,9 @@ namespace maidsafe {
 
 namespace routing {
 
-PublicKeyHolder::PublicKeyHolder(AsioService& io_service, Network &network)
-    : mutex_(), io_service_(io_service), network_(network), elements_() {}
+PublicKeyHolder::PublicKeyHolder(AsioService& io_service, Network &network,
+                                 KeyStore& key_store)
+    : mutex_(), io_service_(io_service), network_(network), key_store_(key_store), elements_() {}
 
 PublicKeyHolder::~PublicKeyHolder() {
   std::for_each(std::begin(elements_), std::end(elements_),
@@ -36,14 +37,15 @@ PublicKeyHolder::~PublicKeyHolder() {
 }
 
 bool PublicKeyHolder::Add(const NodeId& peer, const asymm::PublicKey& public_key) {
+  auto shared_key(key_store_.Intern(public_key));
   std::lock_guard<std::mutex> lock(mutex_);
   if (std::any_of(std::begin(elements_), std::end(elements_),
                   [&](const PublicKeyInfo& info) {
                     return info.peer == peer;
                   }))
     return false;
-  auto timer(std::make_shared<boost::asio::deadline_timer>(
-      io_service_.service(), boost::posix_time::seconds(Parameters::public_key_holding_time)));
+  auto timer(std::make_shared<SteadyTimer>(
+      io_service_.service(), std::chrono::seconds(Parameters::public_key_holding_time)));
   timer->async_wait([peer, this](const boost::system::error_code& error) {
                       {
                         std::lock_guard<std::mutex> lock(mutex_);
@@ -57,21 +59,17 @@ bool PublicKeyHolder::Add(const NodeId& peer, const asymm::PublicKey& public_key
                         this->network_.Remove(peer);
                       }
                     });
-  elements_.emplace_back(PublicKeyInfo(peer, public_key, timer));
+  elements_.emplace_back(PublicKeyInfo(peer, shared_key, timer));
   return true;
 }
 
-boost::optional<asymm::PublicKey> PublicKeyHolder::Find(const NodeId& peer) const {
-  boost::optional<asymm::PublicKey> public_key;
-
+std::shared_ptr<const asymm::PublicKey> PublicKeyHolder::Find(const NodeId& peer) const {
   std::lock_guard<std::mutex> lock(mutex_);
   auto iter(std::find_if(std::begin(elements_), std::end(elements_),
                          [&](const PublicKeyInfo& info) {
                            return info.peer == peer;
                          }));
-  if (iter != std::end(elements_))
-    public_key.reset(iter->public_key);
-  return public_key;
+  return iter == std::end(elements_) ? nullptr : iter->public_key;
 }
 
 void PublicKeyHolder::Remove(const NodeId& peer) {
@@ -19,15 +19,15 @@
 #ifndef MAIDSAFE_ROUTING_PUBLIC_KEY_HOLDER_H_
 #define MAIDSAFE_ROUTING_PUBLIC_KEY_HOLDER_H_
 
+#include <memory>
 #include <vector>
 #include <mutex>
 
-#include "boost/asio/deadline_timer.hpp"
-#include "boost/optional.hpp"
-
 #include "maidsafe/common/rsa.h"
 #include "maidsafe/common/asio_service.h"
 
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/key_store.h"
 #include "maidsafe/routing/parameters.h"
 
 
@@ -37,33 +37,36 @@ namespace routing {
 
 class Network;
 
-typedef std::shared_ptr<boost::asio::deadline_timer> TimerPointer;
+typedef std::shared_ptr<SteadyTimer> TimerPointer;
 typedef std::function<void(const boost::system::error_code& error)> Handler;
 
 struct PublicKeyInfo {
-  PublicKeyInfo(const NodeId& peer_in, const asymm::PublicKey public_key_in, TimerPointer timer_in)
+  PublicKeyInfo(const NodeId& peer_in, std::shared_ptr<const asymm::PublicKey> public_key_in,
+                TimerPointer timer_in)
       : peer(peer_in), public_key(public_key_in), timer(timer_in) {}
   NodeId peer;
-  asymm::PublicKey public_key;
+  std::shared_ptr<const asymm::PublicKey> public_key;  // interned in the KeyStore
   TimerPointer timer;
 };
 
 class PublicKeyHolder {
  public:
-  explicit PublicKeyHolder(AsioService& asio_service, Network& network);
+  PublicKeyHolder(AsioService& asio_service, Network& network, KeyStore& key_store);
   PublicKeyHolder(const PublicKeyHolder&) = delete;
   PublicKeyHolder& operator=(const PublicKeyHolder&) = delete;
   PublicKeyHolder(const PublicKeyHolder&&) = delete;
   PublicKeyHolder& operator=(const PublicKeyHolder&&) = delete;
   ~PublicKeyHolder();
   bool Add(const NodeId& peer, const asymm::PublicKey& public_key);
-  boost::optional<asymm::PublicKey> Find(const NodeId& peer) const;
+  // Returns null if no key is held for 'peer'.
+  std::shared_ptr<const asymm::PublicKey> Find(const NodeId& peer) const;
   void Remove(const NodeId& peer);
 
  private:
   mutable std::mutex mutex_;
   AsioService& io_service_;
   Network& network_;
+  KeyStore& key_store_;
   std::vector<PublicKeyInfo> elements_;
 };
 
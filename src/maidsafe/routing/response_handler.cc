@@ -32,6 +32,7 @@
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/rpcs.h"
 #include "maidsafe/routing/utils.h"
@@ -70,30 +71,30 @@ void ResponseHandler::Connect(protobuf::Message& message) {
   protobuf::ConnectResponse connect_response;
   protobuf::ConnectRequest connect_request;
   if (!connect_response.ParseFromString(message.data(0))) {
-    LOG(kError) << "Could not parse connect response";
+    ROUTING_LOG(kError) << "Could not parse connect response";
     return;
   }
 
   if (!connect_request.ParseFromString(connect_response.original_request())) {
-    LOG(kError) << "Could not parse original connect request"
-                << " id: " << message.id();
+    ROUTING_LOG(kError) << "Could not parse original connect request"
+                        << " id: " << message.id();
     return;
   }
 
   if (connect_response.answer() == protobuf::ConnectResponseType::kRejected) {
-    LOG(kInfo) << "Peer rejected this node's connection request."
-               << " id: " << message.id();
+    ROUTING_LOG(kInfo) << "Peer rejected this node's connection request."
+                       << " id: " << message.id();
     return;
   }
 
   if (connect_response.answer() == protobuf::ConnectResponseType::kConnectAttemptAlreadyRunning) {
-    LOG(kInfo) << "Already ongoing connection attempt with : "
-               << HexSubstr(connect_response.contact().node_id());
+    ROUTING_LOG(kInfo) << "Already ongoing connection attempt with : "
+                       << HexSubstr(connect_response.contact().node_id());
     return;
   }
 
   if (NodeId(connect_response.contact().node_id()).IsZero()) {
-    LOG(kError) << "Invalid contact details";
+    ROUTING_LOG(kError) << "Invalid contact details";
     return;
   }
 
@@ -109,19 +110,19 @@ void ResponseHandler::Connect(protobuf::Message& message) {
 
     if (peer_endpoint_pair.external.address().is_unspecified() &&
         peer_endpoint_pair.local.address().is_unspecified()) {
-      LOG(kError) << "Invalid peer endpoint details";
+      ROUTING_LOG(kError) << "Invalid peer endpoint details";
       return;
     }
 
     NodeId peer_node_id(connect_response.contact().node_id());
     NodeId peer_connection_id(connect_response.contact().connection_id());
 
-    LOG(kVerbose) << "This node [" << routing_table_.kNodeId()
-                  << "] received connect response from " << peer_node_id
-                  << " connection_id: " << peer_connection_id << " id: " << message.id();
+    ROUTING_LOG(kVerbose) << "This node [" << routing_table_.kNodeId()
+                          << "] received connect response from " << peer_node_id
+                          << " connection_id: " << peer_connection_id << " id: " << message.id();
 
     if (!public_key_holder_.Find(peer_node_id)) {
-      LOG(kError)  << "missing public key ";
+      ROUTING_LOG(kError)  << "missing public key ";
       message.Clear();
       return;
     }
@@ -130,7 +131,7 @@ void ResponseHandler::Connect(protobuf::Message& message) {
                           peer_node_id, peer_connection_id, peer_endpoint_pair, true,  // requestor
                           routing_table_.client_mode()));
     if (result != kSuccess)
-      LOG(kVerbose) << "Already added node";
+      ROUTING_LOG(kVerbose) << "Already added node";
   }
 }
 
@@ -138,18 +139,18 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
   protobuf::FindNodesResponse find_nodes_response;
   protobuf::FindNodesRequest find_nodes_request;
   if (!find_nodes_response.ParseFromString(message.data(0))) {
-    LOG(kError) << "Could not parse find node response";
+    ROUTING_LOG(kError) << "Could not parse find node response";
     return;
   }
   if (!find_nodes_request.ParseFromString(find_nodes_response.original_request())) {
-    LOG(kError) << "Could not parse original find node request";
+    ROUTING_LOG(kError) << "Could not parse original find node request";
     return;
   }
 
   if (find_nodes_request.num_nodes_requested() == 1) {  // detect collision
     if ((find_nodes_response.nodes_size() == 1) &&
         find_nodes_response.nodes(0) == routing_table_.kNodeId().string()) {
-      LOG(kWarning) << "Collision detected";
+      ROUTING_LOG(kWarning) << "Collision detected";
       // TODO(Prakash): FIXME handle collision and return kIdCollision on join()
       return;
     }
@@ -161,15 +162,15 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
   //    return;  // we never requested this
   //  }
 
-  LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] received FindNodes response from "
-                << HexSubstr(message.source_id()) << " id: " << message.id();
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] received FindNodes response from "
+                        << HexSubstr(message.source_id()) << " id: " << message.id();
   std::string find_node_result =
       "FindNodes from " + HexSubstr(message.source_id()) + " returned :\n";
   for (int i = 0; i < find_nodes_response.nodes_size(); ++i) {
     find_node_result += "[" + HexSubstr(find_nodes_response.nodes(i)) + "]\t";
   }
 
-  LOG(kVerbose) << find_node_result;
+  ROUTING_LOG(kVerbose) << find_node_result;
 
   for (int i = 0; i < find_nodes_response.nodes_size(); ++i) {
     if (!find_nodes_response.nodes(i).empty())
@@ -179,7 +180,7 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
 
 void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
   if (network_.bootstrap_connection_id().IsZero() && (routing_table_.size() == 0)) {
-    LOG(kWarning) << "Need to re bootstrap !";
+    ROUTING_LOG(kWarning) << "Need to re bootstrap !";
     return;
   }
   bool send_to_bootstrap_connection((routing_table_.size() < Parameters::closest_nodes_size) &&
@@ -193,7 +194,7 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
   }
 
   if (routing_table_.CheckNode(peer)) {
-    LOG(kVerbose) << "CheckNode succeeded for node " << peer.id;
+    ROUTING_LOG(kVerbose) << "CheckNode succeeded for node " << peer.id;
     rudp::EndpointPair this_endpoint_pair, peer_endpoint_pair;
     rudp::NatType this_nat_type(rudp::NatType::kUnknown);
     int ret_val = network_.GetAvailableEndpoint(peer.id, peer_endpoint_pair,
@@ -201,13 +202,14 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
     if (rudp::kSuccess != ret_val && rudp::kBootstrapConnectionAlreadyExists != ret_val) {
       if (rudp::kUnvalidatedConnectionAlreadyExists != ret_val &&
           rudp::kConnectAttemptAlreadyRunning != ret_val) {
-        LOG(kError) << "[" << DebugId(routing_table_.kNodeId()) << "] Response Handler"
-                    << "Failed to get available endpoint for new connection to : " << peer.id
-                    << "peer_endpoint_pair.external = " << peer_endpoint_pair.external
-                    << ", peer_endpoint_pair.local = " << peer_endpoint_pair.local
-                    << ". Rudp returned :" << ret_val;
+        ROUTING_LOG(kError) << "[" << DebugId(routing_table_.kNodeId()) << "] Response Handler"
+                            << "Failed to get available endpoint for new connection to : "
+                            << peer.id
+                            << "peer_endpoint_pair.external = " << peer_endpoint_pair.external
+                            << ", peer_endpoint_pair.local = " << peer_endpoint_pair.local
+                            << ". Rudp returned :" << ret_val;
       } else {
-        LOG(kVerbose) << "Already ongoing attempt to : " << DebugId(peer.id);
+        ROUTING_LOG(kVerbose) << "Already ongoing attempt to : " << DebugId(peer.id);
       }
       return;
     }
@@ -224,8 +226,8 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
     protobuf::Message connect_rpc(rpcs::Connect(
         peer.id, this_endpoint_pair, routing_table_.kNodeId(), routing_table_.kConnectionId(),
         routing_table_.client_mode(), this_nat_type, relay_message, relay_connection_id));
-    LOG(kVerbose) << "Sending Connect RPC to " << peer.id
-                  << " message id : " << connect_rpc.id();
+    ROUTING_LOG(kVerbose) << "Sending Connect RPC to " << peer.id
+                          << " message id : " << connect_rpc.id();
     if (send_to_bootstrap_connection)
       network_.SendToDirect(connect_rpc, network_.bootstrap_connection_id(),
                             network_.bootstrap_connection_id());
@@ -242,7 +244,7 @@ void ResponseHandler::ConnectSuccessAcknowledgement(protobuf::Message& message)
   protobuf::ConnectSuccessAcknowledgement connect_success_ack;
 
   if (!connect_success_ack.ParseFromString(message.data(0))) {
-    LOG(kWarning) << "Unable to parse connect success ack.";
+    ROUTING_LOG(kWarning) << "Unable to parse connect success ack.";
     message.Clear();
     return;
   }
@@ -253,11 +255,11 @@ void ResponseHandler::ConnectSuccessAcknowledgement(protobuf::Message& message)
   if (!connect_success_ack.connection_id().empty())
     peer.connection_id = NodeId(connect_success_ack.connection_id());
   if (peer.id.IsZero()) {
-    LOG(kWarning) << "Invalid node id provided";
+    ROUTING_LOG(kWarning) << "Invalid node id provided";
     return;
   }
   if (peer.connection_id.IsZero()) {
-    LOG(kWarning) << "Invalid peer connection_id provided";
+    ROUTING_LOG(kWarning) << "Invalid peer connection_id provided";
     return;
   }
 
@@ -270,10 +272,10 @@ void ResponseHandler::ConnectSuccessAcknowledgement(protobuf::Message& message)
     }
   }
   if (!client_node) {
-    LOG(kInfo) << "Validation -- Need non-client's public key";
+    ROUTING_LOG(kInfo) << "Validation -- Need non-client's public key";
     ValidateAndCompleteConnectionToNonClient(peer, from_requestor, close_ids);
   } else {
-    LOG(kInfo) << "Validation -- Not looking for client's public key";
+    ROUTING_LOG(kInfo) << "Validation -- Not looking for client's public key";
     ValidateAndCompleteConnectionToClient(peer, from_requestor, close_ids);
   }
   message.Clear();
@@ -296,7 +298,7 @@ void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
     const NodeInfo& peer, bool from_requestor, const std::vector<NodeId>& close_ids) {
   auto peer_public_key(public_key_holder_.Find(peer.id));
   if (!peer_public_key) {
-    LOG(kVerbose) << "missing public key for " << peer.id;
+    ROUTING_LOG(kVerbose) << "missing public key for " << peer.id;
     return;
   }
   public_key_holder_.Remove(peer.id);
@@ -358,7 +360,7 @@ void ResponseHandler::ValidateAndSendConnectRequest(const NodeId& peer_id) {
   if (request_public_key_functor_) {
     auto validate_node([=](boost::optional<asymm::PublicKey> public_key) {
       if (!public_key) {
-        LOG(kError) << "Failed to retrieve public key for: " << peer_id;
+        ROUTING_LOG(kError) << "Failed to retrieve public key for: " << peer_id;
         return;
       }
       if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock()) {
@@ -374,18 +376,18 @@ void ResponseHandler::CloseNodeUpdateForClient(protobuf::Message& message) {
   assert(routing_table_.client_mode());
   if (message.destination_id() != routing_table_.kNodeId().string()) {
     // Message not for this node and we should not pass it on.
-    LOG(kError) << "Message not for this node.";
+    ROUTING_LOG(kError) << "Message not for this node.";
     message.Clear();
     return;
   }
   protobuf::ClosestNodesUpdate closest_node_update;
   if (!closest_node_update.ParseFromString(message.data(0))) {
-    LOG(kError) << "No Data.";
+    ROUTING_LOG(kError) << "No Data.";
     return;
   }
 
   if (closest_node_update.node().empty() || !CheckId(closest_node_update.node())) {
-    LOG(kError) << "Invalid node id provided.";
+    ROUTING_LOG(kError) << "Invalid node id provided.";
     return;
   }
 
@@ -404,19 +406,19 @@ void ResponseHandler::InformClientOfNewCloseNode(protobuf::Message& message) {
   assert(routing_table_.client_mode() && "Handler must be client");
   if (message.destination_id() != routing_table_.kNodeId().string()) {
     // Message not for this node and we should not pass it on.
-    LOG(kError) << "Message not for this node.";
+    ROUTING_LOG(kError) << "Message not for this node.";
     message.Clear();
     return;
   }
   protobuf::InformClientOfhNewCloseNode inform_client_of_new_close_node;
   if (!inform_client_of_new_close_node.ParseFromString(message.data(0))) {
-    LOG(kError) << "Failure to parse";
+    ROUTING_LOG(kError) << "Failure to parse";
     return;
   }
 
   if (inform_client_of_new_close_node.node_id().empty() ||
      !CheckId(inform_client_of_new_close_node.node_id())) {
-    LOG(kError) << "Invalid node id provided.";
+    ROUTING_LOG(kError) << "Invalid node id provided.";
     return;
   }
   CheckAndSendConnectRequest(NodeId(inform_client_of_new_close_node.node_id()));
@@ -430,7 +432,7 @@ void ResponseHandler::GetGroup(Timer<std::string>& timer, protobuf::Message& mes
     timer.AddResponse(message.id(), message.data(0));
   }
   catch (const maidsafe_error& e) {
-    LOG(kError) << e.what();
+    ROUTING_LOG(kError) << e.what();
     return;
   }
 }
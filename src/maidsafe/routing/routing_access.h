@@ -0,0 +1,49 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_ACCESS_H_
+#define MAIDSAFE_ROUTING_ROUTING_ACCESS_H_
+
+#include "maidsafe/common/asio_service.h"
+
+#include "maidsafe/routing/routing_api.h"
+#include "maidsafe/routing/routing_host.h"
+#include "maidsafe/routing/upcall_executor.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Internal access to the private parts of Routing and RoutingHost, for the library itself and its
+// tests and benchmarks, so that the public headers needn't name them as friends.
+class RoutingAccess {
+ public:
+  typedef Routing::Impl Impl;
+
+  static AsioService& NextAsioService(RoutingHost& host) { return host.NextAsioService(); }
+  static UpcallExecutor* upcall_executor(RoutingHost& host) { return host.upcall_executor_.get(); }
+
+ private:
+  RoutingAccess();
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_ACCESS_H_
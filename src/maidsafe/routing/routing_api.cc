@@ -18,6 +18,7 @@
 
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/routing_impl.h"
+#include "maidsafe/routing/routing_log.h"
 
 namespace maidsafe {
 
@@ -35,8 +36,14 @@ Routing::~Routing() {
   pimpl_->Stop();
 }
 
-void Routing::InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys) {
-  pimpl_.reset(new Impl(client_mode, node_id, keys));
+void Routing::InitialisePimpl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                              RoutingHost* host) {
+  if (host) {
+    pimpl_.reset(new Impl(client_mode, node_id, keys, nullptr, &host->NextAsioService(),
+                          host->upcall_executor_.get()));
+  } else {
+    pimpl_.reset(new Impl(client_mode, node_id, keys));
+  }
 }
 
 void Routing::Join(Functors functors) {
@@ -103,21 +110,31 @@ bool Routing::IsConnectedClient(const NodeId& node_id) {
   return pimpl_->IsConnectedClient(node_id);
 }
 
+std::string Routing::MetricsSnapshot() const { return pimpl_->MetricsSnapshot(); }
+
+bool Routing::DumpMetrics(const boost::filesystem::path& path) const {
+  return pimpl_->DumpMetrics(path);
+}
+
+bool Routing::DumpFlightRecorder(const boost::filesystem::path& path) const {
+  return pimpl_->DumpFlightRecorder(path);
+}
+
 void UpdateNetworkHealth(int updated_health, int& current_health, std::mutex& mutex,
                          std::condition_variable& cond_var, const NodeId& this_node_id) {
   {
     std::lock_guard<std::mutex> lock{mutex};
 #if USE_LOGGING
     if (updated_health >= 0) {
-      std::string message{DebugId(this_node_id) + " - Network health is " +
-                          std::to_string(updated_health) + "% (was " +
-                          std::to_string(current_health) + "%)"};
       if (updated_health >= current_health)
-        LOG(kVerbose) << message;
+        ROUTING_LOG(kVerbose) << DebugId(this_node_id) << " - Network health is " << updated_health
+                              << "% (was " << current_health << "%)";
       else
-        LOG(kWarning) << message;
+        ROUTING_LOG(kWarning) << DebugId(this_node_id) << " - Network health is " << updated_health
+                              << "% (was " << current_health << "%)";
     } else {
-      LOG(kWarning) << DebugId(this_node_id) << " - Network is down (" << updated_health << "%)";
+      ROUTING_LOG(kWarning) << DebugId(this_node_id) << " - Network is down (" << updated_health
+                            << "%)";
     }
 #endif
     current_health = updated_health;
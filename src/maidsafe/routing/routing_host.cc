@@ -0,0 +1,107 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/routing_host.h"
+
+#ifdef MAIDSAFE_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <future>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/error.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/upcall_executor.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+bool PinThisThreadToCore(unsigned int core) {
+#ifdef MAIDSAFE_LINUX
+  if (core >= static_cast<unsigned int>(CPU_SETSIZE))
+    return false;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+  static_cast<void>(core);
+  return false;
+#endif
+}
+
+}  // unnamed namespace
+
+RoutingHost::RoutingHost(unsigned int thread_count)
+    : asio_services_(1, std::make_shared<AsioService>(thread_count)),
+      next_asio_service_(0),
+      pinned_thread_count_(0),
+      upcall_executor_(new UpcallExecutor(Parameters::upcall_threads,
+                                          Parameters::max_queued_upcalls)) {}
+
+RoutingHost::RoutingHost(const std::vector<unsigned int>& cores)
+    : asio_services_(),
+      next_asio_service_(0),
+      pinned_thread_count_(0),
+      upcall_executor_(new UpcallExecutor(Parameters::upcall_threads,
+                                          Parameters::max_queued_upcalls)) {
+  if (cores.empty())
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  std::vector<std::future<bool>> pinned;
+  for (const auto& core : cores) {
+    asio_services_.push_back(std::make_shared<AsioService>(1));
+    auto promise(std::make_shared<std::promise<bool>>());
+    pinned.push_back(promise->get_future());
+    asio_services_.back()->service().post(
+        [core, promise] { promise->set_value(PinThisThreadToCore(core)); });
+  }
+  for (auto& result : pinned) {
+    if (result.get())
+      ++pinned_thread_count_;
+  }
+}
+
+RoutingHost::RoutingHost(const std::vector<std::shared_ptr<AsioService>>& asio_services)
+    : asio_services_(asio_services),
+      next_asio_service_(0),
+      pinned_thread_count_(0),
+      upcall_executor_(new UpcallExecutor(Parameters::upcall_threads,
+                                          Parameters::max_queued_upcalls)) {
+  if (asio_services_.empty())
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  for (const auto& asio_service : asio_services_) {
+    if (!asio_service)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+}
+
+RoutingHost::~RoutingHost() {}
+
+AsioService& RoutingHost::NextAsioService() {
+  return *asio_services_[next_asio_service_++ % asio_services_.size()];
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -18,8 +18,15 @@
 
 #include "maidsafe/routing/routing_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <type_traits>
+#include <utility>
+
+#include "boost/asio/local/stream_protocol.hpp"
+#include "boost/asio/write.hpp"
+#include "boost/filesystem/operations.hpp"
 
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/make_unique.h"
@@ -30,11 +37,13 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/bootstrap_file_operations.h"
+#include "maidsafe/routing/flight_recorder.h"
 #include "maidsafe/routing/message.h"
 #include "maidsafe/routing/message_handler.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/rpcs.h"
 #include "maidsafe/routing/utils.h"
 
@@ -48,6 +57,9 @@ namespace {
 
 typedef boost::asio::ip::udp::endpoint Endpoint;
 
+// Number of SendDirect round trips used to derive the hedging delay.
+const size_t kHedgeLatencySamples(256);
+
 }  // unnamed namespace
 
 namespace detail {}  // namespace detail
@@ -66,7 +78,7 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
   protobuf::Message proto_message;
   proto_message.set_destination_id(message.receiver.relay_node->string());
   proto_message.set_routing_message(false);
-  proto_message.add_data(message.contents);
+  proto_message.add_data(message.payload());
   proto_message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
 
   proto_message.set_cacheable(static_cast<int32_t>(message.cacheable));
@@ -90,35 +102,48 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
   return proto_message;
 }
 
-Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys)
+Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                    std::unique_ptr<Transport> transport, AsioService* asio_service,
+                    UpcallExecutor* upcall_executor)
     : network_status_mutex_(),
       network_status_(kNotJoined),
       routing_table_(maidsafe::make_unique<RoutingTable>(client_mode, node_id, keys)),
       kNodeId_(node_id),
+      kFlightRecorderId_(FlightRecorder::Prefix(node_id.string())),
       running_(true),
       running_mutex_(),
       functors_(),
       random_node_helper_(),
       // TODO(Prakash) : don't create client_routing_table for client nodes (wrap both)
       client_routing_table_(node_id),
+      direct_send_latency_(kHedgeLatencySamples),
+      group_cache_(),
+      received_messages_(),
+      handler_fence_(std::make_shared<HandlerFence>()),
       message_handler_(),
-      asio_service_(2),
+      own_asio_service_(asio_service ? std::unique_ptr<AsioService>()
+                                      : maidsafe::make_unique<AsioService>(2)),
+      asio_service_(asio_service ? *asio_service : *own_asio_service_),
       network_utils_(node_id, asio_service_),
       network_(maidsafe::make_unique<Network>(*routing_table_, client_routing_table_,
-                                              network_utils_.acknowledgement_)),
+                                              network_utils_.acknowledgement_,
+                                              std::move(transport), &asio_service_,
+                                              &network_utils_.metrics_, handler_fence_)),
       timer_(asio_service_),
       re_bootstrap_timer_(asio_service_.service()),
       recovery_timer_(asio_service_.service()),
-      setup_timer_(asio_service_.service()) {
+      setup_timer_(asio_service_.service()),
+      flight_recorder_signals_(asio_service_.service()) {
   message_handler_.reset(new MessageHandler(*routing_table_, client_routing_table_, *network_,
-                                            timer_, network_utils_, asio_service_));
-  LOG(kInfo) << (client_mode ? "client " : "non-client ") << "node. Id : " << kNodeId_;
+                                            timer_, network_utils_, asio_service_,
+                                            upcall_executor, handler_fence_));
+  ROUTING_LOG(kInfo) << (client_mode ? "client " : "non-client ") << "node. Id : " << kNodeId_;
   assert((client_mode || !node_id.IsZero()) && "Server Nodes cannot be created without valid keys");
 }
 
 void Routing::Impl::Stop() {
-  LOG(kVerbose) << "Routing::Impl::Stop() " << kNodeId_ << ", connection id "
-                << routing_table_->kConnectionId();
+  ROUTING_LOG(kVerbose) << "Routing::Impl::Stop() " << kNodeId_ << ", connection id "
+                        << routing_table_->kConnectionId();
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     running_ = false;
@@ -130,17 +155,23 @@ void Routing::Impl::Stop() {
   std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
   while (this_ptr.use_count() > 6) {
     Sleep(std::chrono::seconds(1));
-    LOG(kVerbose) << "Waiting for pending operations to complete";
+    ROUTING_LOG(kVerbose) << "Waiting for pending operations to complete";
   }
 
   // }  // TOBE FIXED
 
+  // A hosted node shares its AsioService with other nodes, so the service can't be stopped here.
+  // Instead wait for this node's handlers which are already running and turn away any still queued.
+  handler_fence_->Close();
   network_utils_.acknowledgement_.RemoveAll();
   timer_.CancelAll();
   re_bootstrap_timer_.cancel();
   recovery_timer_.cancel();
   setup_timer_.cancel();
-  asio_service_.Stop();
+  boost::system::error_code error_code;
+  flight_recorder_signals_.cancel(error_code);
+  if (own_asio_service_)
+    asio_service_.Stop();
   // Need to destroy network_ & routing_table_ as they hold a lambda capture (functor) of
   // shared_from_this()
   message_handler_.reset();
@@ -149,7 +180,7 @@ void Routing::Impl::Stop() {
 }
 
 void Routing::Impl::Join(const Functors& functors) {
-  LOG(kInfo) << "Doing a default join";
+  ROUTING_LOG(kInfo) << "Doing a default join";
   ConnectFunctors(functors);
   Bootstrap();
 }
@@ -179,6 +210,30 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
     message_handler_->set_typed_message_and_caching_functor(functors.typed_message_and_caching);
 
   message_handler_->set_request_public_key_functor(functors.request_public_key);
+
+  if (Parameters::flight_recorder_dump_signal != 0) {
+    boost::system::error_code error_code;
+    flight_recorder_signals_.add(Parameters::flight_recorder_dump_signal, error_code);
+    if (error_code) {
+      ROUTING_LOG(kError) << "Failed to register flight recorder dump signal: "
+                          << error_code.message();
+    } else {
+      WaitForFlightRecorderSignal();
+    }
+  }
+}
+
+void Routing::Impl::WaitForFlightRecorderSignal() {
+  std::weak_ptr<Routing::Impl> this_weak(shared_from_this());
+  flight_recorder_signals_.async_wait([this_weak](const boost::system::error_code& error, int) {
+    std::shared_ptr<Routing::Impl> this_ptr(this_weak.lock());
+    if (error || !this_ptr)
+      return;
+    this_ptr->DumpFlightRecorder(fs::temp_directory_path() /
+                                 ("routing_flight_recorder_" + DebugId(this_ptr->kNodeId_) +
+                                  ".bin"));
+    this_ptr->WaitForFlightRecorderSignal();
+  });
 }
 
 void Routing::Impl::Bootstrap() {
@@ -193,7 +248,8 @@ void Routing::Impl::Bootstrap() {
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     re_bootstrap_timer_.async_wait(
         [this_ptr](boost::system::error_code error_code) {
-          if (error_code != boost::asio::error::operation_aborted)
+          HandlerFence::Scope scope(*this_ptr->handler_fence_);
+          if (scope.entered() && error_code != boost::asio::error::operation_aborted)
             this_ptr->Bootstrap();
         });
     NotifyNetworkStatus(return_value);
@@ -215,8 +271,8 @@ int Routing::Impl::DoBootstrap() {
   if (!running_)
     return kNetworkShuttingDown;
   if (!network_->bootstrap_connection_id().IsZero()) {
-    LOG(kInfo) << "Removing bootstrap connection to rebootstrap. Connection id : "
-               << network_->bootstrap_connection_id();
+    ROUTING_LOG(kInfo) << "Removing bootstrap connection to rebootstrap. Connection id : "
+                       << network_->bootstrap_connection_id();
     network_->Remove(network_->bootstrap_connection_id());
     network_->clear_bootstrap_connection_info();
   }
@@ -247,19 +303,20 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
       if (!running_)
         return;
       // Exit the loop & start recovery loop
-      LOG(kVerbose) << "[" << kNodeId_ << "] Added a node in routing table."
-                    << " Terminating setup loop & Scheduling recovery loop.";
+      ROUTING_LOG(kVerbose) << "[" << kNodeId_ << "] Added a node in routing table."
+                            << " Terminating setup loop & Scheduling recovery loop.";
       recovery_timer_.expires_from_now(Parameters::find_node_interval);
       std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
       recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
-        if (error_code != boost::asio::error::operation_aborted)
+        HandlerFence::Scope scope(*this_ptr->handler_fence_);
+        if (scope.entered() && error_code != boost::asio::error::operation_aborted)
           this_ptr->ReSendFindNodeRequest(error_code, false);
       });
       return;
     }
 
     if (static_cast<unsigned int>(attempts) >= Parameters::maximum_find_close_node_failures) {
-      LOG(kError) << "[" << kNodeId_ << "] failed to get closest node. ReBootstrapping...";
+      ROUTING_LOG(kError) << "[" << kNodeId_ << "] failed to get closest node. ReBootstrapping...";
       // TODO(Prakash) : Remove the bootstrap node from the list
       ReBootstrap();
       return;
@@ -269,18 +326,22 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
   int num_nodes_requested(1 + attempts / Parameters::find_node_repeats_per_num_requested);
   protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested, true,
                                                   network_->this_node_relay_connection_id()));
-  LOG(kVerbose) << "   [" << kNodeId_ << "] (attempt " << attempts << ")  requesting "
-                << num_nodes_requested << " nodes (id: " << find_node_rpc.id() << ")";
+  ROUTING_LOG(kVerbose) << "   [" << kNodeId_ << "] (attempt " << attempts << ")  requesting "
+                        << num_nodes_requested << " nodes (id: " << find_node_rpc.id() << ")";
   std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
   rudp::MessageSentFunctor message_sent_functor([this_ptr, find_node_rpc](int message_sent) {
+    HandlerFence::Scope scope(*this_ptr->handler_fence_);
+    if (!scope.entered())
+      return;
     if (message_sent == kSuccess)
-      LOG(kVerbose) << "   [" << this_ptr->kNodeId_ << "] sent : "
-                    << MessageTypeString(find_node_rpc)
-                    << " to   " << this_ptr->network_->bootstrap_connection_id() << "   (id: "
-                    << find_node_rpc.id() << ")";
+      ROUTING_LOG(kVerbose) << "   [" << this_ptr->kNodeId_ << "] sent : "
+                            << MessageTypeString(find_node_rpc)
+                            << " to   " << this_ptr->network_->bootstrap_connection_id()
+                            << "   (id: "
+                            << find_node_rpc.id() << ")";
     else
-      LOG(kError) << "Failed to send FindNodes RPC to bootstrap connection id : "
-                  << this_ptr->network_->bootstrap_connection_id();
+      ROUTING_LOG(kError) << "Failed to send FindNodes RPC to bootstrap connection id : "
+                          << this_ptr->network_->bootstrap_connection_id();
   });
 
   ++attempts;
@@ -291,7 +352,8 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
     return;
   setup_timer_.expires_from_now(Parameters::find_close_node_interval);
   setup_timer_.async_wait([this_ptr, attempts](boost::system::error_code error_code_local) {
-    if (error_code_local != boost::asio::error::operation_aborted)
+    HandlerFence::Scope scope(*this_ptr->handler_fence_);
+    if (scope.entered() && error_code_local != boost::asio::error::operation_aborted)
       this_ptr->FindClosestNode(error_code_local, attempts);
   });
 }
@@ -314,18 +376,19 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
       local_endpoint));
 
   if (result != kSuccess) {
-    LOG(kError) << "Could not bootstrap zero state node from local endpoint : " << local_endpoint
-                << " with peer endpoint : " << peer_endpoint;
+    ROUTING_LOG(kError) << "Could not bootstrap zero state node from local endpoint : "
+                        << local_endpoint
+                        << " with peer endpoint : " << peer_endpoint;
     return result;
   }
 
-  LOG(kInfo) << "[" << kNodeId_ << "]'s bootstrap connection id : "
-             << network_->bootstrap_connection_id();
+  ROUTING_LOG(kInfo) << "[" << kNodeId_ << "]'s bootstrap connection id : "
+                     << network_->bootstrap_connection_id();
 
   assert(!peer_info.id.IsZero() && "Zero NodeId passed");
   assert((network_->bootstrap_connection_id() == peer_info.id) &&
          "Should bootstrap only with known peer for zero state network");
-  LOG(kVerbose) << local_endpoint << " Bootstrapped with remote endpoint " << peer_endpoint;
+  ROUTING_LOG(kVerbose) << local_endpoint << " Bootstrapped with remote endpoint " << peer_endpoint;
   rudp::NatType nat_type(rudp::NatType::kUnknown);
   rudp::EndpointPair peer_endpoint_pair;  // zero state nodes must be directly connected endpoint
   rudp::EndpointPair this_endpoint_pair;
@@ -335,13 +398,14 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
   result = network_->GetAvailableEndpoint(peer_info.id, peer_endpoint_pair, this_endpoint_pair,
                                          nat_type);
   if (result != rudp::kBootstrapConnectionAlreadyExists) {
-    LOG(kError) << "Failed to get available endpoint to add zero state node : " << peer_endpoint;
+    ROUTING_LOG(kError) << "Failed to get available endpoint to add zero state node : "
+                        << peer_endpoint;
     return result;
   }
 
   result = network_->Add(peer_info.id, peer_endpoint_pair, "invalid");
   if (result != kSuccess) {
-    LOG(kError) << "Failed to add zero state node : " << peer_endpoint;
+    ROUTING_LOG(kError) << "Failed to add zero state node : " << peer_endpoint;
     return result;
   }
 
@@ -353,9 +417,9 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
     Sleep(std::chrono::milliseconds(100));
   } while ((routing_table_->size() == 0) && (++poll_count < 50));
   if (routing_table_->size() != 0) {
-    LOG(kInfo) << "Node Successfully joined zero state network, with "
-               << network_->bootstrap_connection_id() << ", Routing table size - "
-               << routing_table_->size() << ", Node id : " << kNodeId_;
+    ROUTING_LOG(kInfo) << "Node Successfully joined zero state network, with "
+                       << network_->bootstrap_connection_id() << ", Routing table size - "
+                       << routing_table_->size() << ", Node id : " << kNodeId_;
 
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
@@ -363,12 +427,14 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
     recovery_timer_.expires_from_now(Parameters::find_node_interval);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
-      if (error_code != boost::asio::error::operation_aborted)
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (scope.entered() && error_code != boost::asio::error::operation_aborted)
         this_ptr->ReSendFindNodeRequest(error_code, false);
     });
     return kSuccess;
   } else {
-    LOG(kError) << "Failed to join zero state network, with bootstrap_endpoint " << peer_endpoint;
+    ROUTING_LOG(kError) << "Failed to join zero state network, with bootstrap_endpoint "
+                        << peer_endpoint;
     return kNotJoined;
   }
 }
@@ -390,15 +456,29 @@ void Routing::Impl::SendGroup(const NodeId& destination_id, const std::string& d
 void Routing::Impl::Send(const NodeId& destination_id, const std::string& data,
                          const DestinationType& destination_type, bool cacheable,
                          ResponseFunctor response_functor) {
-  LOG(kVerbose) << "Routing::Impl::Send from " << kNodeId_ << " to " << destination_id;
+  ROUTING_LOG(kVerbose) << "Routing::Impl::Send from " << kNodeId_ << " to " << destination_id;
   CheckSendParameters(destination_id, data);
   protobuf::Message proto_message =
       CreateNodeLevelPartialMessage(destination_id, destination_type, data, cacheable);
   unsigned int expected_response_count(1);
   if (response_functor) {
+    auto send_time(std::chrono::steady_clock::now());
+    ResponseFunctor caller_functor(response_functor);
+    response_functor = [this, send_time, caller_functor](std::string response) {
+      if (!response.empty()) {
+        network_utils_.metrics_.AddResponseLatency(std::chrono::steady_clock::now() -
+                                                   send_time);
+      }
+      caller_functor(response);
+    };
     if (DestinationType::kGroup == destination_type)
       expected_response_count = 4;
     proto_message.set_id(timer_.NewTaskId());
+    if (Parameters::hedge_direct_sends && DestinationType::kDirect == destination_type &&
+        destination_id != kNodeId_ && routing_table_->size() > 1) {
+      SendHedged(destination_id, proto_message, response_functor);
+      return;
+    }
     timer_.AddTask(Parameters::default_response_timeout, response_functor, expected_response_count,
                    proto_message.id());
   } else {
@@ -407,23 +487,69 @@ void Routing::Impl::Send(const NodeId& destination_id, const std::string& data,
   SendMessage(destination_id, proto_message);
 }
 
+// The hedged copy keeps the original source and message ID, so the destination's firewall drops
+// whichever copy arrives second and only one response is returned to the single Timer task.
+void Routing::Impl::SendHedged(const NodeId& destination_id, protobuf::Message& proto_message,
+                               ResponseFunctor response_functor) {
+  auto hedged_request(std::make_shared<HedgedRequest>(asio_service_.service(),
+                                                      direct_send_latency_, response_functor));
+  timer_.AddTask(Parameters::default_response_timeout,
+                 [hedged_request](std::string response) {
+                   hedged_request->OnResponse(response);
+                 }, 1, proto_message.id());
+  // The original's first hop is noted so that the copy can avoid it.  With proximity routing, that
+  // needn't be the closest peer to the destination.
+  NodeId primary_hop;
+  if (client_routing_table_.Contains(destination_id)) {
+    SendMessage(destination_id, proto_message);
+  } else {
+    proto_message.set_source_id(kNodeId_.string());
+    primary_hop = network_->SendToClosestNode(proto_message, std::vector<NodeId>());
+  }
+
+  std::weak_ptr<Routing::Impl> this_weak(shared_from_this());
+  protobuf::Message hedged_message(proto_message);
+  hedged_request->Hedge([this_weak, hedged_message, primary_hop]() mutable {
+    std::shared_ptr<Routing::Impl> this_ptr(this_weak.lock());
+    if (!this_ptr)
+      return;
+    HandlerFence::Scope scope(*this_ptr->handler_fence_);
+    if (!scope.entered())
+      return;
+    this_ptr->SendHedgedCopy(hedged_message, primary_hop);
+  });
+}
+
+void Routing::Impl::SendHedgedCopy(protobuf::Message& proto_message, const NodeId& primary_hop) {
+  NodeId destination_id(proto_message.destination_id());
+  // There's no alternate path worth taking if the destination is a direct peer.
+  if (primary_hop.IsZero() || primary_hop == destination_id ||
+      client_routing_table_.Contains(destination_id)) {
+    return;
+  }
+  ROUTING_LOG(kVerbose) << "Hedging send to " << destination_id << " avoiding " << primary_hop
+                        << " id: " << proto_message.id();
+  proto_message.set_ack_id(network_utils_.acknowledgement_.GetId());
+  network_->SendToClosestNode(proto_message, std::vector<NodeId>(1, primary_hop));
+}
+
 void Routing::Impl::SendMessage(const NodeId& destination_id, protobuf::Message& proto_message) {
   if (routing_table_->size() == 0) {  // Partial join state
     PartiallyJoinedSend(proto_message);
   } else {  // Normal node
     proto_message.set_source_id(kNodeId_.string());
     if (!proto_message.direct() && !routing_table_->client_mode()) {
-      LOG(kInfo) << "handling group message";
+      ROUTING_LOG(kInfo) << "handling group message";
       OnMessageReceived(proto_message.SerializeAsString());
       return;
     }
     if (kNodeId_ != destination_id) {
       network_->SendToClosestNode(proto_message);
     } else if (routing_table_->client_mode()) {
-      LOG(kVerbose) << "Client sending request to self id";
+      ROUTING_LOG(kVerbose) << "Client sending request to self id";
       network_->SendToClosestNode(proto_message);
     } else {
-      LOG(kInfo) << "Sending request to self";
+      ROUTING_LOG(kInfo) << "Sending request to self";
       OnMessageReceived(proto_message.SerializeAsString());
     }
   }
@@ -443,6 +569,9 @@ void Routing::Impl::PartiallyJoinedSend(protobuf::Message& proto_message) {
       return;
     this_ptr->asio_service_.service().post([this_ptr, result, proto_message,
                                            bootstrap_connection_id]() {
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (!scope.entered())
+        return;
       if (rudp::kSuccess != result) {
         if (proto_message.id() != 0) {
           try {
@@ -453,13 +582,15 @@ void Routing::Impl::PartiallyJoinedSend(protobuf::Message& proto_message) {
               throw;
           }
         }
-        LOG(kError) << "Partial join Session Ended, Send not allowed anymore";
+        ROUTING_LOG(kError) << "Partial join Session Ended, Send not allowed anymore";
         this_ptr->NotifyNetworkStatus(kPartialJoinSessionEnded);
       } else {
-        LOG(kVerbose) << "   [" << this_ptr->kNodeId_ << "] sent : "
-                      << MessageTypeString(proto_message) << " to   " << bootstrap_connection_id
-                      << "   (id: " << proto_message.id()
-                      << ") dst: " << NodeId(proto_message.destination_id()) << "--Partial-joined-";
+        ROUTING_LOG(kVerbose) << "   [" << this_ptr->kNodeId_ << "] sent : "
+                              << MessageTypeString(proto_message) << " to   "
+                              << bootstrap_connection_id
+                              << "   (id: " << proto_message.id()
+                              << ") dst: " << NodeId(proto_message.destination_id())
+                              << "--Partial-joined-";
       }
     });
   });
@@ -494,17 +625,47 @@ protobuf::Message Routing::Impl::CreateNodeLevelPartialMessage(
 // throws
 void Routing::Impl::CheckSendParameters(const NodeId& destination_id, const std::string& data) {
   if (destination_id.IsZero()) {
-    LOG(kError) << "Invalid destination ID, aborted send";
+    ROUTING_LOG(kError) << "Invalid destination ID, aborted send";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_node_id));
   }
 
   if (data.empty() || (data.size() > Parameters::max_data_size)) {
-    LOG(kError) << "Data size not allowed : " << data.size();
+    ROUTING_LOG(kError) << "Data size not allowed : " << data.size();
     // FIXME (need error type here)
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
 }
 
+std::string Routing::Impl::MetricsSnapshot() const {
+  return "# routing metrics for node " + DebugId(kNodeId_) + "\n" +
+         network_utils_.metrics_.Snapshot();
+}
+
+bool Routing::Impl::DumpMetrics(const fs::path& path) const {
+  std::string snapshot(MetricsSnapshot());
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  boost::system::error_code error_code;
+  if (fs::status(path, error_code).type() == fs::socket_file) {
+    boost::asio::io_service io_service;
+    boost::asio::local::stream_protocol::socket socket(io_service);
+    socket.connect(boost::asio::local::stream_protocol::endpoint(path.string()), error_code);
+    if (!error_code)
+      boost::asio::write(socket, boost::asio::buffer(snapshot), error_code);
+    if (error_code) {
+      ROUTING_LOG(kError) << "Failed to write metrics to socket " << path << ": "
+                          << error_code.message();
+      return false;
+    }
+    return true;
+  }
+#endif
+  return WriteFile(path, snapshot);
+}
+
+bool Routing::Impl::DumpFlightRecorder(const fs::path& path) const {
+  return FlightRecorder::Dump(path, kFlightRecorderId_);
+}
+
 bool Routing::Impl::ClosestToId(const NodeId& target_id) {
   return routing_table_->IsThisNodeClosestTo(target_id, true);
 }
@@ -519,7 +680,26 @@ bool Routing::Impl::EstimateInGroup(const NodeId& sender_id, const NodeId& info_
 std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id) {
   auto promise(std::make_shared<std::promise<std::vector<NodeId>>>());
   auto future(promise->get_future());
-  auto callback = [promise](const std::string& response) {
+  std::vector<NodeId> group;
+  if (!routing_table_->client_mode() && routing_table_->IsThisNodeClosestTo(group_id, true)) {
+    // The request would be answered by this node's own Service::GetGroup.
+    std::vector<PeerView> close_peers;
+    routing_table_->GetClosestPeers(group_id, Parameters::group_size, close_peers, true);
+    for (const auto& peer : close_peers)
+      group.push_back(peer.id);
+  }
+  if (!group.empty()) {
+    promise->set_value(group);
+    return future;
+  }
+  if (group_cache_.Get(group_id, group)) {
+    network_utils_.metrics_.AddGroupCacheLookup(true);
+    promise->set_value(group);
+    return future;
+  }
+  network_utils_.metrics_.AddGroupCacheLookup(false);
+
+  auto callback = [this, promise, group_id](const std::string& response) {
     std::vector<NodeId> nodes_id;
     if (!response.empty()) {
       protobuf::GetGroup get_group;
@@ -529,10 +709,12 @@ std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id)
             nodes_id.push_back(NodeId(id));
         }
         catch (std::exception& ex) {
-          LOG(kError) << "Failed to parse response of GetGroup : " << ex.what();
+          ROUTING_LOG(kError) << "Failed to parse response of GetGroup : " << ex.what();
+          nodes_id.clear();
         }
       }
     }
+    group_cache_.Add(group_id, nodes_id);
     promise->set_value(nodes_id);
   };
   protobuf::Message get_group_message(rpcs::GetGroup(group_id, kNodeId_));
@@ -546,20 +728,34 @@ std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id)
 void Routing::Impl::OnMessageReceived(const std::string& message) {
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (running_) {
+    // Each handler takes the highest priority message waiting, so control messages overtake data
+    // which arrived before them.
+    received_messages_.Push(ClassifyMessage(message), message);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
-    asio_service_.service().post([this_ptr, message]() { this_ptr->DoOnMessageReceived(message); });
+    asio_service_.service().post([this_ptr]() {
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (!scope.entered())
+        return;
+      std::string next_message;
+      if (this_ptr->received_messages_.Pop(next_message))
+        this_ptr->DoOnMessageReceived(next_message);
+    });
   }
 }
 
 void Routing::Impl::DoOnMessageReceived(const std::string& message) {
+  auto receive_time(std::chrono::steady_clock::now());
   protobuf::Message pb_message;
   if (pb_message.ParseFromString(message)) {
+    network_utils_.metrics_.AddReceived(pb_message.type());
+    FlightRecorder::Add(FlightEvent::kReceived, kFlightRecorderId_, pb_message);
     bool relay_message(!pb_message.has_source_id());
-    LOG(kVerbose) << "   [" << kNodeId_ << "] rcvd : " << MessageTypeString(pb_message)
-                  << " from " << (relay_message ? HexSubstr(pb_message.relay_id())
-                                                : HexSubstr(pb_message.source_id())) << " to "
-                  << HexSubstr(pb_message.destination_id()) << "   (id: " << pb_message.id() << ")"
-                  << (relay_message ? " --Relay--" : "");
+    ROUTING_LOG(kVerbose) << "   [" << kNodeId_ << "] rcvd : " << MessageTypeString(pb_message)
+                          << " from " << (relay_message ? HexSubstr(pb_message.relay_id())
+                                                        : HexSubstr(pb_message.source_id()))
+                          << " to " << HexSubstr(pb_message.destination_id()) << "   (id: "
+                          << pb_message.id() << ")"
+                          << (relay_message ? " --Relay--" : "");
     if ((!pb_message.client_node() && pb_message.has_source_id()) ||
         (!pb_message.direct() && !pb_message.request())) {
       NodeId source_id(pb_message.source_id());
@@ -571,13 +767,27 @@ void Routing::Impl::DoOnMessageReceived(const std::string& message) {
       if (!running_)
         return;
     }
+    // Acks piggybacked by the sending peer are for this hop only, so are not passed on.
+    if (!IsAck(pb_message) && pb_message.ack_ids_size() != 0) {
+      network_utils_.acknowledgement_.HandleMessage(
+          std::vector<AckId>(pb_message.ack_ids().begin(), pb_message.ack_ids().end()));
+      pb_message.clear_ack_ids();
+    }
     if (network_utils_.acknowledgement_.IsSendingAckRequired(pb_message, kNodeId())) {
       network_->SendAck(pb_message);
       pb_message.clear_ack_node_ids();
     }
+    bool for_this_node(pb_message.destination_id() == kNodeId_.string());
     message_handler_->HandleMessage(pb_message);
+    if (for_this_node)
+      network_utils_.metrics_.AddHandleTime(std::chrono::steady_clock::now() - receive_time);
+    else
+      network_utils_.metrics_.AddForwardTime(std::chrono::steady_clock::now() - receive_time);
   } else {
-    LOG(kWarning) << "Message received, failed to parse";
+    ROUTING_LOG(kWarning) << "Message received, failed to parse";
+    network_utils_.metrics_.AddDropped(DropReason::kParseFailure);
+    FlightRecorder::Add(FlightEvent::kDropped, kFlightRecorderId_, protobuf::Message(), 0,
+                        DropReason::kParseFailure);
   }
 }
 
@@ -586,30 +796,35 @@ void Routing::Impl::OnConnectionLost(const NodeId& lost_connection_id) {
   if (running_) {
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     asio_service_.service().post([this_ptr, lost_connection_id]() {
-      this_ptr->DoOnConnectionLost(lost_connection_id);
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (scope.entered())
+        this_ptr->DoOnConnectionLost(lost_connection_id);
     });
   }
 }
 
 void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
-  LOG(kVerbose) << DebugId(kNodeId_) << "  Routing::ConnectionLost with -----------"
-                << DebugId(lost_connection_id);
+  ROUTING_LOG(kVerbose) << DebugId(kNodeId_) << "  Routing::ConnectionLost with -----------"
+                        << DebugId(lost_connection_id);
   {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
       return;
   }
 
+  // Losing a close node promotes the first standby node in its place (see RoutingTable::DropNode).
+  // Losing either a close or a standby node leaves the standby one short, so more are sought.
   NodeInfo dropped_node;
-  bool resend(
-      routing_table_->GetNodeInfo(lost_connection_id, dropped_node) &&
-      routing_table_->IsThisNodeInRange(dropped_node.id, Parameters::closest_nodes_size));
+  const unsigned int kCloseAndStandbySize(Parameters::closest_nodes_size +
+                                          Parameters::close_standby_size);
+  bool resend(routing_table_->GetNodeInfo(lost_connection_id, dropped_node) &&
+              routing_table_->IsThisNodeInRange(dropped_node.id, kCloseAndStandbySize));
 
   // Checking routing table
   dropped_node = routing_table_->DropNode(lost_connection_id, true);
   if (!dropped_node.id.IsZero()) {
-    LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
-                  << "Lost connection with routing node " << DebugId(dropped_node.id);
+    ROUTING_LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
+                          << "Lost connection with routing node " << DebugId(dropped_node.id);
     random_node_helper_.Remove(dropped_node.id);
   }
 
@@ -618,14 +833,14 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
     resend = false;
     dropped_node = client_routing_table_.DropConnection(lost_connection_id);
     if (!dropped_node.id.IsZero()) {
-      LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
-                    << "Lost connection with non-routing node "
-                    << HexSubstr(dropped_node.id.string());
+      ROUTING_LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
+                            << "Lost connection with non-routing node "
+                            << HexSubstr(dropped_node.id.string());
     } else if (!network_->bootstrap_connection_id().IsZero() &&
                lost_connection_id == network_->bootstrap_connection_id()) {
-      LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
-                    << "Lost temporary connection with bootstrap node. connection id :"
-                    << DebugId(lost_connection_id);
+      ROUTING_LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
+                            << "Lost temporary connection with bootstrap node. connection id :"
+                            << DebugId(lost_connection_id);
       {
         std::lock_guard<std::mutex> lock(running_mutex_);
         if (!running_)
@@ -636,9 +851,9 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
       if (routing_table_->size() == 0)
         resend = true;  // This will trigger rebootstrap
     } else {
-      LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
-                    << "Lost connection with unknown/internal connection id "
-                    << DebugId(lost_connection_id);
+      ROUTING_LOG(kWarning) << "[" << DebugId(kNodeId_) << "]"
+                            << "Lost connection with unknown/internal connection id "
+                            << DebugId(lost_connection_id);
     }
   }
 
@@ -646,12 +861,19 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
     std::lock_guard<std::mutex> lock(running_mutex_);
     if (!running_)
       return;
-    // Close node lost, get more nodes
-    LOG(kWarning) << "Lost close node, getting more.";
-    recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
+    // Close or standby node lost, get more nodes.  If no standby node was left to promote, the
+    // close group stays short until they arrive, so the search starts at once.
+    auto routing_table_size(routing_table_->size());
+    bool close_group_short(routing_table_size != 0 &&
+                           routing_table_size < Parameters::closest_nodes_size);
+    ROUTING_LOG(kWarning) << "Lost close or standby node, getting more"
+                          << (close_group_short ? " now." : ".");
+    recovery_timer_.expires_from_now(close_group_short ? std::chrono::seconds(0)
+                                                       : Parameters::recovery_time_lag);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
-      if (error_code != boost::asio::error::operation_aborted)
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (scope.entered() && error_code != boost::asio::error::operation_aborted)
         this_ptr->ReSendFindNodeRequest(error_code, true);
     });
   }
@@ -663,13 +885,13 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
 
   network_->Remove(node.connection_id);
   if (internal_rudp_only) {  // No recovery
-    LOG(kInfo) << "Routing: removed node : " << DebugId(node.id)
-               << ". Removed internal rudp connection id : " << DebugId(node.connection_id);
+    ROUTING_LOG(kInfo) << "Routing: removed node : " << DebugId(node.id)
+                       << ". Removed internal rudp connection id : " << DebugId(node.connection_id);
     return;
   }
 
-  LOG(kInfo) << "Routing: removed node : " << DebugId(node.id)
-             << ". Removed rudp connection id : " << DebugId(node.connection_id);
+  ROUTING_LOG(kInfo) << "Routing: removed node : " << DebugId(node.id)
+                     << ". Removed rudp connection id : " << DebugId(node.connection_id);
 
   // TODO(Prakash): Handle pseudo connection removal here and NRT node removal
 
@@ -679,12 +901,13 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
     if (!running_)
       return;
     // Close node removed by routing, get more nodes
-    LOG(kWarning) << "[" << DebugId(kNodeId_)
-                  << "] Removed close node, sending find node to get more nodes.";
+    ROUTING_LOG(kWarning) << "[" << DebugId(kNodeId_)
+                          << "] Removed close node, sending find node to get more nodes.";
     recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr](const boost::system::error_code& error_code) {
-      if (error_code != boost::asio::error::operation_aborted)
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (scope.entered() && error_code != boost::asio::error::operation_aborted)
         this_ptr->ReSendFindNodeRequest(error_code, true);
     });
   }
@@ -703,22 +926,26 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
   }
 
   if (routing_table_->size() == 0) {
-    LOG(kError) << "[" << kNodeId_ << "]'s' Routing table is empty. Scheduling Re-Bootstrap.. !!!";
+    ROUTING_LOG(kError) << "[" << kNodeId_
+                        << "]'s' Routing table is empty. Scheduling Re-Bootstrap.. !!!";
     ReBootstrap();
     return;
   } else if (ignore_size || (routing_table_->size() < routing_table_->kThresholdSize())) {
     if (!ignore_size)
-      LOG(kInfo) << "[" << kNodeId_ << "] Routing table smaller than "
-                 << routing_table_->kThresholdSize() << " nodes.  Sending another FindNodes. "
-                 << " Routing table size " << routing_table_->size() << " >";
+      ROUTING_LOG(kInfo) << "[" << kNodeId_ << "] Routing table smaller than "
+                         << routing_table_->kThresholdSize()
+                         << " nodes.  Sending another FindNodes. "
+                         << " Routing table size " << routing_table_->size() << " >";
     else
-      LOG(kInfo) << "[" << kNodeId_ << "] lost close node."
-                 << "Sending another FindNodes. Current routing table size : "
-                 << routing_table_->size();
+      ROUTING_LOG(kInfo) << "[" << kNodeId_ << "] lost close node."
+                         << "Sending another FindNodes. Current routing table size : "
+                         << routing_table_->size();
 
+    // After losing a close or standby node, enough are requested to refill the standby too.
     int num_nodes_requested(0);
     if (ignore_size && (routing_table_->size() > routing_table_->kThresholdSize()))
-      num_nodes_requested = static_cast<int>(Parameters::closest_nodes_size);
+      num_nodes_requested =
+          static_cast<int>(Parameters::closest_nodes_size + Parameters::close_standby_size);
     else
       num_nodes_requested = static_cast<int>(Parameters::max_routing_table_size);
 
@@ -728,7 +955,8 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
     recovery_timer_.expires_from_now(Parameters::find_node_interval);
     std::shared_ptr<Routing::Impl> this_ptr(shared_from_this());
     recovery_timer_.async_wait([this_ptr, error_code](boost::system::error_code error_code_local) {
-      if (error_code != boost::asio::error::operation_aborted)
+      HandlerFence::Scope scope(*this_ptr->handler_fence_);
+      if (scope.entered() && error_code != boost::asio::error::operation_aborted)
         this_ptr->ReSendFindNodeRequest(error_code_local, false);
     });
   }
@@ -779,13 +1007,19 @@ void Routing::Impl::OnRoutingTableChange(const RoutingTableChange& routing_table
     network_status_ = routing_table_change.health;
   }
   NotifyNetworkStatus(routing_table_change.health);
-  LOG(kVerbose) << kNodeId_ << " Updating network status !!! " << routing_table_change.health;
+  ROUTING_LOG(kVerbose) << kNodeId_ << " Updating network status !!! "
+                        << routing_table_change.health;
 
+  if (!routing_table_change.added_node.id.IsZero())
+    group_cache_.Invalidate(routing_table_change.added_node.id);
   if (routing_table_change.removed.node.id != NodeId()) {
+    group_cache_.Invalidate(routing_table_change.removed.node.id);
     RemoveNode(routing_table_change.removed.node,
                routing_table_change.removed.routing_only_removal);
-    LOG(kVerbose) << "Routing table removed node id : " << routing_table_change.removed.node.id
-                  << ", connection id : " << routing_table_change.removed.node.connection_id;
+    ROUTING_LOG(kVerbose) << "Routing table removed node id : "
+                          << routing_table_change.removed.node.id
+                          << ", connection id : "
+                          << routing_table_change.removed.node.connection_id;
   }
 
   if (routing_table_->client_mode()) {
@@ -803,10 +1037,21 @@ void Routing::Impl::OnRoutingTableChange(const RoutingTableChange& routing_table
     // IpcSendCloseNodes(); TO BE MOVED FROM RT TO UTILS
   }
 
-  if (routing_table_change.close_nodes_change && routing_table_change.insertion) {
-    auto clients(client_routing_table_.GetNodesInfo());
-    for (auto client : clients)
-      InformClientOfNewCloseNode(*network_, client, routing_table_change.added_node, kNodeId());
+  // The new close node is either one just added, or a standby node promoted in place of a lost one.
+  if (routing_table_change.close_nodes_change &&
+      !routing_table_change.close_nodes_change->new_node().IsZero()) {
+    NodeInfo new_close_node(routing_table_change.added_node);
+    if (!routing_table_change.insertion &&
+        routing_table_->GetNodeInfo(routing_table_change.close_nodes_change->new_node(),
+                                    new_close_node)) {
+      ROUTING_LOG(kInfo) << "[" << DebugId(kNodeId_) << "] promoted standby node "
+                         << DebugId(new_close_node.id) << " to the close group";
+    }
+    if (!new_close_node.id.IsZero()) {
+      auto clients(client_routing_table_.GetNodesInfo());
+      for (auto client : clients)
+        InformClientOfNewCloseNode(*network_, client, new_close_node, kNodeId());
+    }
   }
 
   if (routing_table_->size() > Parameters::routing_table_size_threshold)
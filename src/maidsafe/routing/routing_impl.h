@@ -24,8 +24,9 @@
 #include <string>
 #include <vector>
 
-#include "boost/asio/steady_timer.hpp"
+#include "boost/asio/signal_set.hpp"
 #include "boost/asio/ip/udp.hpp"
+#include "boost/filesystem/path.hpp"
 #include "boost/system/error_code.hpp"
 
 #include "maidsafe/common/asio_service.h"
@@ -35,13 +36,20 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/group_cache.h"
+#include "maidsafe/routing/handler_fence.h"
+#include "maidsafe/routing/hedged_request.h"
+#include "maidsafe/routing/latency_tracker.h"
 #include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/message_lanes.h"
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/random_node_helper.h"
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
 #include "maidsafe/routing/network_utils.h"
 
 namespace maidsafe {
@@ -97,7 +105,12 @@ class GenericNode;
 
 class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
  public:
-  Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  // 'transport' replaces the default rudp transport, e.g. with a SimulatedTransport.  If
+  // 'asio_service' or 'upcall_executor' is provided, it is used instead of one owned by this
+  // object, may be shared with other nodes and must outlive this object.
+  Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+       std::unique_ptr<Transport> transport = nullptr, AsioService* asio_service = nullptr,
+       UpcallExecutor* upcall_executor = nullptr);
 
   void Join(const Functors& functors);
 
@@ -133,6 +146,10 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   bool IsConnectedVault(const NodeId& node_id);
   bool IsConnectedClient(const NodeId& node_id);
 
+  std::string MetricsSnapshot() const;
+  bool DumpMetrics(const boost::filesystem::path& path) const;
+  bool DumpFlightRecorder(const boost::filesystem::path& path) const;
+
   friend class test::GenericNode;
 
  private:
@@ -141,6 +158,7 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   Impl& operator=(const Impl&);
 
   void ConnectFunctors(const Functors& functors);
+  void WaitForFlightRecorderSignal();
   void BootstrapFromTheseEndpoints(const BootstrapContacts& bootstrap_contacts);
   void DoJoin();
   void Bootstrap();
@@ -159,6 +177,9 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   void Send(const NodeId& destination_id, const std::string& data,
             const DestinationType& destination_type, bool cacheable,
             ResponseFunctor response_functor);
+  void SendHedged(const NodeId& destination_id, protobuf::Message& proto_message,
+                  ResponseFunctor response_functor);
+  void SendHedgedCopy(protobuf::Message& proto_message, const NodeId& primary_hop);
   void SendMessage(const NodeId& destination_id, protobuf::Message& proto_message);
   void PartiallyJoinedSend(protobuf::Message& proto_message);
   protobuf::Message CreateNodeLevelPartialMessage(const NodeId& destination_id,
@@ -182,20 +203,27 @@ class Routing::Impl : public std::enable_shared_from_this<Routing::Impl> {
   int network_status_;
   std::unique_ptr<RoutingTable> routing_table_;
   const NodeId kNodeId_;
+  const uint64_t kFlightRecorderId_;
   bool running_;
   std::mutex running_mutex_;
   Functors functors_;
   RandomNodeHelper random_node_helper_;
   ClientRoutingTable client_routing_table_;
+  LatencyTracker direct_send_latency_;
+  GroupCache group_cache_;
+  PriorityLanes<std::string> received_messages_;
+  std::shared_ptr<HandlerFence> handler_fence_;
   // The following variables' declarations should remain the last ones in this class and should stay
-  // in the order: message_handler_, asio_service_, network_, all timers.  This is important for the
-  // proper destruction of the routing library, i.e. to avoid segmentation faults.
+  // in the order: message_handler_, (own_)asio_service_, network_, all timers.  This is important
+  // for the proper destruction of the routing library, i.e. to avoid segmentation faults.
   std::unique_ptr<MessageHandler> message_handler_;
-  AsioService asio_service_;
+  std::unique_ptr<AsioService> own_asio_service_;
+  AsioService& asio_service_;
   NetworkUtils network_utils_;
   std::unique_ptr<Network> network_;
   Timer<std::string> timer_;
-  boost::asio::steady_timer re_bootstrap_timer_, recovery_timer_, setup_timer_;
+  SteadyTimer re_bootstrap_timer_, recovery_timer_, setup_timer_;
+  boost::asio::signal_set flight_recorder_signals_;
 };
 
 template <>
@@ -228,7 +256,7 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const T& message) {
   protobuf::Message proto_message;
   proto_message.set_destination_id(message.receiver->string());
   proto_message.set_routing_message(false);
-  proto_message.add_data(message.contents);
+  proto_message.add_data(message.payload());
   proto_message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
 
   proto_message.set_cacheable(static_cast<int32_t>(message.cacheable));
@@ -0,0 +1,170 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/routing_metrics.h"
+
+#include <sstream>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const char* const kMessageTypeNames[] = { "Unknown", "Ping", "Connect", "FindNodes",
+                                          "ConnectSuccess", "ConnectSuccessAcknowledgement",
+                                          "GetGroup", "InformClientOfNewCloseNode",
+                                          "Acknowledgement", "NodeLevel" };
+
+const char* const kDropReasonNames[] = { "parse_failure", "firewall", "invalid_message",
+                                         "hops_to_live", "client_to_client",
+                                         "client_over_budget", "vault_over_budget",
+                                         "upcall_overload", "send_queue_full" };
+
+// Must match routing::MessageType.
+const int32_t kMaxRoutingMessageType(8);
+const int32_t kNodeLevelMessageType(101);
+
+size_t MessageTypeSlot(int32_t message_type) {
+  if (message_type > 0 && message_type <= kMaxRoutingMessageType)
+    return static_cast<size_t>(message_type);
+  return message_type == kNodeLevelMessageType ? 9 : 0;
+}
+
+template <typename Array>
+void ResetAll(Array& counters) {
+  for (auto& counter : counters)
+    counter.store(0, std::memory_order_relaxed);
+}
+
+}  // unnamed namespace
+
+const size_t LogHistogram::kBucketCount;
+const size_t RoutingMetrics::kMessageTypeSlots;
+const size_t RoutingMetrics::kDropReasonCount;
+
+LogHistogram::LogHistogram() : buckets_(), count_(0), sum_microseconds_(0) {
+  ResetAll(buckets_);
+}
+
+void LogHistogram::Add(std::chrono::steady_clock::duration value) {
+  auto microseconds(std::chrono::duration_cast<std::chrono::microseconds>(value).count());
+  uint64_t rounded(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+  sum_microseconds_.fetch_add(rounded, std::memory_order_relaxed);
+  // The index is the bit length of rounded - 1, so that 2^i itself is counted in bucket i.
+  uint64_t remaining(rounded > 1 ? rounded - 1 : 0);
+  size_t index(0);
+  while (remaining != 0 && index != kBucketCount - 1) {
+    remaining >>= 1;
+    ++index;
+  }
+  buckets_[index].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LogHistogram::Print(std::ostream& stream, const std::string& name) const {
+  uint64_t cumulative(0);
+  for (size_t index(0); index != kBucketCount - 1; ++index) {
+    cumulative += buckets_[index].load(std::memory_order_relaxed);
+    stream << name << "_bucket{le=\"" << (uint64_t(1) << index) << "\"} " << cumulative << '\n';
+  }
+  cumulative += buckets_[kBucketCount - 1].load(std::memory_order_relaxed);
+  stream << name << "_bucket{le=\"+Inf\"} " << cumulative << '\n'
+         << name << "_sum " << sum_microseconds_.load(std::memory_order_relaxed) << '\n'
+         << name << "_count " << count() << '\n';
+}
+
+RoutingMetrics::RoutingMetrics()
+    : received_(),
+      forwarded_(),
+      dropped_(),
+      ack_retries_(0),
+      ack_timeouts_(0),
+      cache_hits_(0),
+      cache_misses_(0),
+      group_cache_hits_(0),
+      group_cache_misses_(0),
+      handle_time_(),
+      forward_time_(),
+      response_latency_() {
+  ResetAll(received_);
+  ResetAll(forwarded_);
+  ResetAll(dropped_);
+}
+
+void RoutingMetrics::AddReceived(int32_t message_type) {
+  received_[MessageTypeSlot(message_type)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoutingMetrics::AddForwarded(int32_t message_type) {
+  forwarded_[MessageTypeSlot(message_type)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoutingMetrics::AddDropped(DropReason reason) {
+  dropped_[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoutingMetrics::AddCacheLookup(bool hit) {
+  (hit ? cache_hits_ : cache_misses_).fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoutingMetrics::AddGroupCacheLookup(bool hit) {
+  (hit ? group_cache_hits_ : group_cache_misses_).fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t RoutingMetrics::received(int32_t message_type) const {
+  return received_[MessageTypeSlot(message_type)].load(std::memory_order_relaxed);
+}
+
+uint64_t RoutingMetrics::forwarded(int32_t message_type) const {
+  return forwarded_[MessageTypeSlot(message_type)].load(std::memory_order_relaxed);
+}
+
+uint64_t RoutingMetrics::dropped(DropReason reason) const {
+  return dropped_[static_cast<size_t>(reason)].load(std::memory_order_relaxed);
+}
+
+std::string RoutingMetrics::Snapshot() const {
+  std::ostringstream stream;
+  for (size_t slot(0); slot != kMessageTypeSlots; ++slot) {
+    stream << "routing_messages_received{type=\"" << kMessageTypeNames[slot] << "\"} "
+           << received_[slot].load(std::memory_order_relaxed) << '\n';
+  }
+  for (size_t slot(0); slot != kMessageTypeSlots; ++slot) {
+    stream << "routing_messages_forwarded{type=\"" << kMessageTypeNames[slot] << "\"} "
+           << forwarded_[slot].load(std::memory_order_relaxed) << '\n';
+  }
+  for (size_t reason(0); reason != kDropReasonCount; ++reason) {
+    stream << "routing_messages_dropped{reason=\"" << kDropReasonNames[reason] << "\"} "
+           << dropped_[reason].load(std::memory_order_relaxed) << '\n';
+  }
+  stream << "routing_ack_retries " << ack_retries() << '\n'
+         << "routing_ack_timeouts " << ack_timeouts() << '\n'
+         << "routing_cache_hits " << cache_hits() << '\n'
+         << "routing_cache_misses " << cache_misses() << '\n'
+         << "routing_group_cache_hits " << group_cache_hits() << '\n'
+         << "routing_group_cache_misses " << group_cache_misses() << '\n';
+  handle_time_.Print(stream, "routing_handle_time_microseconds");
+  forward_time_.Print(stream, "routing_forward_time_microseconds");
+  response_latency_.Print(stream, "routing_response_latency_microseconds");
+  return stream.str();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
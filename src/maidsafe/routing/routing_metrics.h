@@ -0,0 +1,124 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_ROUTING_METRICS_H_
+#define MAIDSAFE_ROUTING_ROUTING_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace maidsafe {
+
+namespace routing {
+
+enum class DropReason : int32_t {
+  kParseFailure = 0,
+  kFirewall = 1,
+  kInvalidMessage = 2,
+  kHopsToLive = 3,
+  kClientToClient = 4,
+  kClientOverBudget = 5,
+  kVaultOverBudget = 6,
+  kUpcallOverload = 7,
+  kSendQueueFull = 8
+};
+
+// Histogram of durations in power-of-two microsecond buckets: bucket 0 counts values up to 1us and
+// bucket i counts values in (2^(i-1), 2^i] us, matching its "le" label, with the last bucket
+// open-ended.
+class LogHistogram {
+ public:
+  static const size_t kBucketCount = 32;
+
+  LogHistogram();
+  void Add(std::chrono::steady_clock::duration value);
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  // Prints cumulative buckets in the Prometheus text format.
+  void Print(std::ostream& stream, const std::string& name) const;
+
+ private:
+  LogHistogram(const LogHistogram&);
+  LogHistogram(const LogHistogram&&);
+  LogHistogram& operator=(const LogHistogram&);
+
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+  std::atomic<uint64_t> count_, sum_microseconds_;
+};
+
+// Lock-free counters and histograms for the routing hot path.  All updates are relaxed atomic
+// increments, so a snapshot is only approximately consistent across different metrics.
+class RoutingMetrics {
+ public:
+  RoutingMetrics();
+  void AddReceived(int32_t message_type);
+  void AddForwarded(int32_t message_type);
+  void AddDropped(DropReason reason);
+  void AddAckRetry() { ack_retries_.fetch_add(1, std::memory_order_relaxed); }
+  void AddAckTimeout() { ack_timeouts_.fetch_add(1, std::memory_order_relaxed); }
+  void AddCacheLookup(bool hit);
+  void AddGroupCacheLookup(bool hit);
+  void AddHandleTime(std::chrono::steady_clock::duration value) { handle_time_.Add(value); }
+  // Time to process a message not addressed to this node, whether it is forwarded or dropped.
+  void AddForwardTime(std::chrono::steady_clock::duration value) { forward_time_.Add(value); }
+  void AddResponseLatency(std::chrono::steady_clock::duration value) {
+    response_latency_.Add(value);
+  }
+
+  uint64_t received(int32_t message_type) const;
+  uint64_t forwarded(int32_t message_type) const;
+  uint64_t dropped(DropReason reason) const;
+  uint64_t ack_retries() const { return ack_retries_.load(std::memory_order_relaxed); }
+  uint64_t ack_timeouts() const { return ack_timeouts_.load(std::memory_order_relaxed); }
+  uint64_t cache_hits() const { return cache_hits_.load(std::memory_order_relaxed); }
+  uint64_t cache_misses() const { return cache_misses_.load(std::memory_order_relaxed); }
+  uint64_t group_cache_hits() const { return group_cache_hits_.load(std::memory_order_relaxed); }
+  uint64_t group_cache_misses() const {
+    return group_cache_misses_.load(std::memory_order_relaxed);
+  }
+  const LogHistogram& handle_time() const { return handle_time_; }
+  const LogHistogram& forward_time() const { return forward_time_; }
+  const LogHistogram& response_latency() const { return response_latency_; }
+
+  // Returns all metrics in the Prometheus text exposition format.
+  std::string Snapshot() const;
+
+ private:
+  RoutingMetrics(const RoutingMetrics&);
+  RoutingMetrics(const RoutingMetrics&&);
+  RoutingMetrics& operator=(const RoutingMetrics&);
+
+  // Slot 0 counts unknown types, slots 1 to 8 the routing message types and slot 9 node-level.
+  static const size_t kMessageTypeSlots = 10;
+  static const size_t kDropReasonCount = 9;
+
+  std::array<std::atomic<uint64_t>, kMessageTypeSlots> received_, forwarded_;
+  std::array<std::atomic<uint64_t>, kDropReasonCount> dropped_;
+  std::atomic<uint64_t> ack_retries_, ack_timeouts_, cache_hits_, cache_misses_, group_cache_hits_,
+      group_cache_misses_;
+  LogHistogram handle_time_, forward_time_, response_latency_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_ROUTING_METRICS_H_
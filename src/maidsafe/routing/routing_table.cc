@@ -19,9 +19,7 @@
 #include "maidsafe/routing/routing_table.h"
 
 #include <algorithm>
-#include <bitset>
 #include <limits>
-#include <map>
 #include <sstream>
 
 #include "maidsafe/common/log.h"
@@ -33,6 +31,7 @@
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/close_nodes_change.h"
+#include "maidsafe/routing/routing_log.h"
 
 namespace maidsafe {
 
@@ -50,6 +49,12 @@ RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm:
       mutex_(),
       routing_table_change_functor_(),
       nodes_(),
+      key_fingerprints_(),
+      node_fingerprints_(),
+      buckets_(node_id),
+      peers_(),
+      scratch_peers_(),
+      key_store_(),
       ipc_message_queue_() {
 #ifdef TESTING
   try {
@@ -87,14 +92,17 @@ bool RoutingTable::CheckNode(const NodeInfo& peer) { return AddOrCheckNode(peer,
 
 bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
   if (peer.id.IsZero() || peer.id == kNodeId_) {
-    LOG(kError) << "Attempt to add an invalid node " << peer.id;
+    ROUTING_LOG(kError) << "Attempt to add an invalid node " << peer.id;
     return false;
   }
   if (remove && !asymm::ValidateKey(peer.public_key)) {
-    LOG(kInfo) << "Invalid public key for node " << DebugId(peer.id);
+    ROUTING_LOG(kInfo) << "Invalid public key for node " << DebugId(peer.id);
     return false;
   }
 
+  // Computed before taking the lock, as it means encoding and hashing the key.
+  KeyFingerprint fingerprint(remove ? Fingerprint(peer.public_key) : KeyFingerprint());
+
   bool return_value(false);
   NodeInfo removed_node;
   unsigned int routing_table_size(0);
@@ -105,22 +113,26 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
     SetBucketIndex(peer);
   {
     std::unique_lock<std::mutex> lock(mutex_);
-    auto found(Find(peer.id, lock));
-    if (found.first) {
+    if (peers_.Find(peer.id)) {
 //       LOG(kVerbose) << "Node " << peer.id << " already in routing table.";
       return false;
     }
 
-    auto close_nodes_size(PartialSortFromTarget(kNodeId_, Parameters::max_routing_table_size,
-                                                lock));
+    auto close_nodes_size(std::min(Parameters::max_routing_table_size,
+                                   static_cast<unsigned int>(nodes_.size())));
 
-    if (MakeSpaceForNodeToBeAdded(peer, remove, removed_node, lock)) {
+    if (MakeSpaceForNodeToBeAdded(peer, fingerprint, remove, removed_node, lock)) {
       if (remove) {
         assert(peer.bucket != NodeInfo::kInvalidBucket);
+        // The table is only sorted if the peer joins the close group, which is rare once the
+        // table is full.
+        scratch_peers_.clear();
+        if (!client_mode())
+          peers_.GetClosest(kNodeId_, Parameters::closest_nodes_size, scratch_peers_);
         if (!client_mode() &&
            ((nodes_.size() < Parameters::closest_nodes_size)  ||
-            NodeId::CloserToTarget(
-                peer.id, nodes_.at(Parameters::closest_nodes_size - 1).id, kNodeId()))) {
+            NodeId::CloserToTarget(peer.id, scratch_peers_.back().id, kNodeId()))) {
+          PartialSortFromTarget(kNodeId_, Parameters::max_routing_table_size, lock);
           bool full_close_nodes(nodes_.size() >= Parameters::closest_nodes_size);
           close_nodes_size = (full_close_nodes) ? (close_nodes_size - 1) : close_nodes_size;
           std::for_each (std::begin(nodes_), std::begin(nodes_) + close_nodes_size,
@@ -134,7 +146,7 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
           close_nodes_change.reset(new CloseNodesChange(kNodeId(), old_close_nodes,
                                                         new_close_nodes));
         }
-        nodes_.push_back(peer);
+        Insert(peer, fingerprint, lock);
       }
       return_value = true;
     }
@@ -147,7 +159,7 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove) {
           RoutingTableChange(peer, RoutingTableChange::Remove(removed_node, false), true,
                              close_nodes_change, NetworkStatus(routing_table_size)));
     }
-    LOG(kInfo) << PrintRoutingTable();
+    ROUTING_LOG(kInfo) << PrintRoutingTable();
   }
   return return_value;
 }
@@ -159,28 +171,29 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   std::shared_ptr<CloseNodesChange> close_nodes_change;
   {
     std::unique_lock<std::mutex> lock(mutex_);
-    auto close_nodes_size(PartialSortFromTarget(kNodeId_, Parameters::closest_nodes_size + 1,
-                                                lock));
     auto found(Find(node_to_drop, lock));
     if (found.first) {
+      scratch_peers_.clear();
+      peers_.GetClosest(kNodeId_, Parameters::closest_nodes_size + 1, scratch_peers_);
+      auto close_nodes_size(static_cast<unsigned int>(scratch_peers_.size()));
       if (!client_mode() &&
           ((nodes_.size() < Parameters::closest_nodes_size) ||
-           !NodeId::CloserToTarget(nodes_.at(Parameters::closest_nodes_size - 1).id,
+           !NodeId::CloserToTarget(scratch_peers_.at(Parameters::closest_nodes_size - 1).id,
                                    node_to_drop, kNodeId()))) {
-        std::for_each (std::begin(nodes_),
-                       std::begin(nodes_) + std::min(close_nodes_size,
-                                                     Parameters::closest_nodes_size),
-                       [&](const NodeInfo& node_info) {
-                         old_close_nodes.push_back(node_info.id);
-                         if (node_info.id != node_to_drop)
-                           new_close_nodes.push_back(node_info.id);
+        std::for_each (std::begin(scratch_peers_),
+                       std::begin(scratch_peers_) + std::min(close_nodes_size,
+                                                             Parameters::closest_nodes_size),
+                       [&](const PeerView& close_node) {
+                         old_close_nodes.push_back(close_node.id);
+                         if (close_node.id != node_to_drop)
+                           new_close_nodes.push_back(close_node.id);
                        });
         if (close_nodes_size == Parameters::closest_nodes_size + 1)
-          new_close_nodes.push_back(nodes_.at(Parameters::closest_nodes_size).id);
+          new_close_nodes.push_back(scratch_peers_.at(Parameters::closest_nodes_size).id);
         close_nodes_change.reset(new CloseNodesChange(kNodeId(), old_close_nodes, new_close_nodes));
       }
       dropped_node = *found.second;
-      nodes_.erase(found.second);
+      Erase(found.second, lock);
       routing_table_size = static_cast<unsigned int>(nodes_.size());
     }
   }
@@ -192,7 +205,7 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
                              false, close_nodes_change, NetworkStatus(routing_table_size)));
     }
   }
-  LOG(kInfo) << PrintRoutingTable();
+  ROUTING_LOG(kInfo) << PrintRoutingTable();
   return dropped_node;
 }
 
@@ -219,21 +232,33 @@ bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
   return found.first;
 }
 
+bool RoutingTable::GetPeer(const NodeId& node_id, PeerView& peer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const PeerView* found(peers_.Find(node_id));
+  if (found)
+    peer = *found;
+  return found != nullptr;
+}
+
 bool RoutingTable::IsThisNodeInRange(const NodeId& target_id, const unsigned int range) {
   // sort by target will always put the node bearing the same target_id (such as pmid_pub_key)
   // as the closest if that node is in the routing table
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> lock(mutex_);
   if (nodes_.size() < range)
     return true;
 
-  auto count(PartialSortFromTarget(target_id, range + 1, lock));
-  LOG(kVerbose) << "[kNodeId_ , " << DebugId(kNodeId_) << "] [target_id , " << DebugId(target_id)
-                << "] [count , " << count << "] [tail , " << DebugId(nodes_[count - 1].id) << "]";
-  bool skip_front(target_id == nodes_[0].id);
+  scratch_peers_.clear();
+  peers_.GetClosest(target_id, range + 1, scratch_peers_);
+  auto count(scratch_peers_.size());
+  ROUTING_LOG(kVerbose) << "[kNodeId_ , " << DebugId(kNodeId_) << "] [target_id , "
+                        << DebugId(target_id)
+                        << "] [count , " << count << "] [tail , "
+                        << DebugId(scratch_peers_[count - 1].id) << "]";
+  bool skip_front(target_id == scratch_peers_[0].id);
   if (skip_front && (count == range))
     return true;
   return NodeId::CloserToTarget(kNodeId_,
-                                nodes_[count - 1 - (skip_front ? 0 : 1)].id,
+                                scratch_peers_[count - 1 - (skip_front ? 0 : 1)].id,
                                 target_id);
 }
 
@@ -245,18 +270,63 @@ bool RoutingTable::IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exac
     return false;
 
   if (target_id.IsZero()) {
-    LOG(kError) << "Invalid target_id passed.";
+    ROUTING_LOG(kError) << "Invalid target_id passed.";
     return false;
   }
 
-  NodeInfo closest_node(GetClosestNode(target_id, ignore_exact_match));
+  PeerView closest_node(GetClosestPeer(target_id, ignore_exact_match));
   return (closest_node.bucket == NodeInfo::kInvalidBucket) ||
          NodeId::CloserToTarget(kNodeId_, closest_node.id, target_id);
 }
 
+RouteDecision RoutingTable::GetRouteDecision(const NodeId& target_id) {
+  RouteDecision route_decision;
+  route_decision.target = target_id;
+  route_decision.closest_nodes.reserve(Parameters::closest_nodes_size + 1);
+  std::lock_guard<std::mutex> lock(mutex_);
+  peers_.GetClosest(target_id, Parameters::closest_nodes_size + 1, route_decision.closest_nodes);
+  const auto& closest_nodes(route_decision.closest_nodes);
+  auto count(closest_nodes.size());
+  if (count == 0) {
+    route_decision.in_range = true;
+    return route_decision;
+  }
+
+  route_decision.contains_target = (closest_nodes[0].id == target_id);
+  if (nodes_.size() < Parameters::closest_nodes_size) {
+    route_decision.in_range = true;
+  } else {
+    bool skip_front(route_decision.contains_target);
+    route_decision.in_range =
+        (skip_front && (count == Parameters::closest_nodes_size)) ||
+        NodeId::CloserToTarget(kNodeId_, closest_nodes[count - 1 - (skip_front ? 0 : 1)].id,
+                               target_id);
+  }
+  route_decision.closest = (target_id != kNodeId_) && !target_id.IsZero() &&
+                           NodeId::CloserToTarget(kNodeId_, closest_nodes[0].id, target_id);
+  return route_decision;
+}
+
+PeerView RouteDecision::ClosestNode(bool ignore_exact_match,
+                                    const std::vector<std::string>& exclude) const {
+  size_t first((ignore_exact_match && contains_target) ? 1 : 0);
+  size_t last(std::min(closest_nodes.size(), first + Parameters::closest_nodes_size));
+  for (size_t i(first); i < last; ++i) {
+    if (std::find(exclude.begin(), exclude.end(), closest_nodes[i].id.string()) == exclude.end())
+      return closest_nodes[i];
+  }
+  return PeerView();
+}
+
+std::vector<PeerView> RouteDecision::ClosestNodes(unsigned int count) const {
+  return std::vector<PeerView>(std::begin(closest_nodes),
+                               std::begin(closest_nodes) +
+                                   std::min(closest_nodes.size(), static_cast<size_t>(count)));
+}
+
 bool RoutingTable::Contains(const NodeId& node_id) const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return Find(node_id, lock).first;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peers_.Find(node_id) != nullptr;
 }
 
 bool RoutingTable::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2) {
@@ -270,36 +340,16 @@ bool RoutingTable::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2)
 
 // bucket 0 is us, 511 is furthest bucket (should fill first)
 void RoutingTable::SetBucketIndex(NodeInfo& node_info) const {
-  std::string holder_raw_id(kNodeId_.string());
-  std::string node_raw_id(node_info.id.string());
-  int16_t byte_index(0);
-  while (byte_index != NodeId::kSize) {
-    if (holder_raw_id[byte_index] != node_raw_id[byte_index]) {
-      std::bitset<8> holder_byte(static_cast<int>(holder_raw_id[byte_index]));
-      std::bitset<8> node_byte(static_cast<int>(node_raw_id[byte_index]));
-      int16_t bit_index(0);
-      while (bit_index != 8U) {
-        if (holder_byte[7U - bit_index] != node_byte[7U - bit_index])
-          break;
-        ++bit_index;
-      }
-      node_info.bucket = (8 * (NodeId::kSize - byte_index)) - bit_index - 1;
-      return;
-    }
-    ++byte_index;
-  }
-  node_info.bucket = 0;
+  node_info.bucket = BucketOccupancy::BucketIndex(kNodeId_, node_info.id);
 }
 
-bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
+bool RoutingTable::CheckPublicKeyIsUnique(const KeyFingerprint& fingerprint,
                                           std::unique_lock<std::mutex>& lock) const {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   // If we already have a duplicate public key return false
-  if (std::find_if(nodes_.begin(), nodes_.end(), [node](const NodeInfo & node_info) {
-        return asymm::MatchingKeys(node_info.public_key, node.public_key);
-      }) != nodes_.end()) {
-    LOG(kInfo) << "Already have node with this public key";
+  if (key_fingerprints_.count(fingerprint) != 0) {
+    ROUTING_LOG(kInfo) << "Already have node with this public key";
     return false;
   }
 
@@ -319,14 +369,13 @@ bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
   return true;
 }
 
-bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
+bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node,
+                                             const KeyFingerprint& fingerprint, bool remove,
                                              NodeInfo& removed_node,
                                              std::unique_lock<std::mutex>& lock) {
   assert(lock.owns_lock());
 
-  std::map<uint32_t, unsigned int> bucket_rank_map;
-
-  if (remove && !CheckPublicKeyIsUnique(node, lock))
+  if (remove && !CheckPublicKeyIsUnique(fingerprint, lock))
     return false;
 
   if (nodes_.size() < kMaxSize_)
@@ -334,53 +383,52 @@ bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
 
   if (client_mode()) {
     assert(nodes_.size() == kMaxSize_);
-    if (NodeId::CloserToTarget(node.id, nodes_.at(kMaxSize_ - 1).id, kNodeId())) {
-      removed_node = *nodes_.rbegin();
-      nodes_.pop_back();
-      return true;
-    } else {
+    const NodeId& furthest_node(buckets_.Furthest());
+    if (!NodeId::CloserToTarget(node.id, furthest_node, kNodeId()))
       return false;
-    }
+    auto found(Find(furthest_node, lock));
+    removed_node = *found.second;
+    Erase(found.second, lock);
+    return true;
   }
 
-  unsigned int max_bucket(0), max_bucket_count(1);
-  std::for_each(std::begin(nodes_) + Parameters::unidirectional_interest_range, std::end(nodes_),
-                [&bucket_rank_map, &max_bucket, &max_bucket_count](const NodeInfo& node_info) {
-                  auto bucket_iter(bucket_rank_map.find(node_info.bucket));
-                  if (bucket_iter != std::end(bucket_rank_map))
-                    (*bucket_iter).second++;
-                   else
-                    bucket_rank_map.insert(std::make_pair(node_info.bucket, 1));
-
-                   if (bucket_rank_map[node_info.bucket] >= max_bucket_count) {
-                     max_bucket = node_info.bucket;
-                     max_bucket_count = bucket_rank_map[node_info.bucket];
-                   }
-                });
-
-  LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] max_bucket " << max_bucket << " count "
-                << max_bucket_count;
-
-  // If no duplicate bucket exists, prioirity is given to closer nodes.
-  if ((max_bucket_count == 1) && (nodes_.back().bucket < node.bucket))
+  NodeId evictee;
+  if (!buckets_.ChooseEviction(node.id, node.bucket, evictee))
     return false;
 
-  if (NodeId::CloserToTarget(nodes_.at(Parameters::unidirectional_interest_range).id, node.id,
-                             kNodeId()))
-    return false;
+  if (remove) {
+    auto found(Find(evictee, lock));
+    removed_node = *found.second;
+    Erase(found.second, lock);
+    ROUTING_LOG(kVerbose) << kNodeId_ << " Proposed removable " << removed_node.id;
+  }
+  return true;
+}
 
-  for (auto it(nodes_.rbegin()); it != nodes_.rend(); ++it)
-    if (static_cast<unsigned int>(it->bucket) == max_bucket) {
-      if ((it->bucket != node.bucket) || NodeId::CloserToTarget(node.id, it->id, kNodeId())) {
-        if (remove) {
-          removed_node = *it;
-          nodes_.erase(--(it.base()));
-          LOG(kVerbose) << kNodeId_ << " Proposed removable " << removed_node.id;
-        }
-        return true;
-      }
-    }
-  return false;
+void RoutingTable::Insert(const NodeInfo& node, const KeyFingerprint& fingerprint,
+                          std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  nodes_.push_back(node);
+  key_fingerprints_.insert(fingerprint);
+  node_fingerprints_.insert(std::make_pair(node.id, fingerprint));
+  buckets_.Add(node.id, node.bucket);
+  peers_.Insert(PeerView(node));
+}
+
+void RoutingTable::Erase(std::vector<NodeInfo>::iterator itr, std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  auto fingerprint(node_fingerprints_.find(itr->id));
+  assert(fingerprint != node_fingerprints_.end());
+  key_fingerprints_.erase(fingerprint->second);
+  node_fingerprints_.erase(fingerprint);
+  buckets_.Remove(itr->id, itr->bucket);
+  peers_.Erase(itr->id);
+  // Every reader of 'nodes_' sorts it first, so the last node can simply fill the gap.
+  using std::swap;
+  swap(*itr, nodes_.back());
+  nodes_.pop_back();
 }
 
 unsigned int RoutingTable::PartialSortFromTarget(const NodeId& target, unsigned int number,
@@ -452,6 +500,36 @@ std::vector<NodeInfo> RoutingTable::GetClosestNodes(
                                             static_cast<size_t>(number_to_get + index)));
 }
 
+PeerView RoutingTable::GetClosestPeer(const NodeId& target_id, bool ignore_exact_match,
+                                      const std::vector<std::string>& exclude) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  scratch_peers_.clear();
+  peers_.GetClosest(target_id, Parameters::closest_nodes_size + 1, scratch_peers_);
+  size_t index(!scratch_peers_.empty() && ignore_exact_match &&
+               scratch_peers_.front().id == target_id);
+  auto last(std::begin(scratch_peers_) +
+            std::min(scratch_peers_.size(), Parameters::closest_nodes_size + index));
+  for (auto itr(std::begin(scratch_peers_) + index); itr < last; ++itr) {
+    if (std::find(exclude.begin(), exclude.end(), itr->id.string()) == exclude.end())
+      return *itr;
+  }
+  return PeerView();
+}
+
+void RoutingTable::GetClosestPeers(const NodeId& target_id, unsigned int number_to_get,
+                                   std::vector<PeerView>& peers, bool ignore_exact_match) {
+  peers.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (number_to_get == 0)
+    return;
+
+  peers_.GetClosest(target_id, number_to_get + 1, peers);
+  if (ignore_exact_match && !peers.empty() && peers.front().id == target_id)
+    peers.erase(peers.begin());
+  else if (peers.size() > number_to_get)
+    peers.pop_back();
+}
+
 NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, unsigned int index) {
   std::unique_lock<std::mutex> lock(mutex_);
   if (nodes_.size() < index) {
@@ -524,14 +602,14 @@ std::string RoutingTable::PrintRoutingTable() {
   std::vector<NodeInfo> rt;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::sort(nodes_.begin(), nodes_.end(), [&](const NodeInfo& lhs, const NodeInfo& rhs) {
-      return NodeId::CloserToTarget(lhs.id, rhs.id, kNodeId_);
-    });
     rt = nodes_;
   }
+  std::sort(rt.begin(), rt.end(), [&](const NodeInfo& lhs, const NodeInfo& rhs) {
+    return NodeId::CloserToTarget(lhs.id, rhs.id, kNodeId_);
+  });
   std::stringstream stream;
   stream << "\n\n[" << kNodeId_ << "] This node's own routing table and peer connections:"
-         << "\nRouting table size: " << nodes_.size();
+         << "\nRouting table size: " << rt.size();
   for (const auto& node : rt) {
     stream << "\n\tPeer [" << node.id << "]--> " << node.connection_id << " && xored "
            << NodeId(kNodeId_ ^ node.id) << " bucket " << node.bucket;
@@ -20,9 +20,11 @@
 #define MAIDSAFE_ROUTING_ROUTING_TABLE_H_
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,7 +38,11 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/bucket_occupancy.h"
+#include "maidsafe/routing/key_store.h"
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/peer_trie.h"
+#include "maidsafe/routing/peer_view.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -84,6 +90,28 @@ struct RoutingTableChange {
 typedef std::function<void(const RoutingTableChange& /*routing_table_change*/)>
     RoutingTableChangeFunctor;
 
+// Everything needed to route one message towards 'target', taken from a single sort of the routing
+// table under one lock (see RoutingTable::GetRouteDecision).  'client_nodes' is left for the caller
+// to fill from the ClientRoutingTable.
+struct RouteDecision {
+  RouteDecision()
+      : target(), in_range(false), closest(false), contains_target(false), closest_nodes(),
+        client_nodes() {}
+  // The peer GetClosestNode would return, i.e. the closest not in 'exclude' among the
+  // closest_nodes_size closest, skipping 'target' itself if 'ignore_exact_match' is set.
+  PeerView ClosestNode(bool ignore_exact_match,
+                       const std::vector<std::string>& exclude = std::vector<std::string>()) const;
+  // The 'count' closest peers, as GetClosestNodes would return them.
+  std::vector<PeerView> ClosestNodes(unsigned int count) const;
+
+  NodeId target;
+  bool in_range;         // as IsThisNodeInRange(target, closest_nodes_size)
+  bool closest;          // as IsThisNodeClosestTo(target)
+  bool contains_target;  // as Contains(target)
+  std::vector<PeerView> closest_nodes;  // up to closest_nodes_size + 1, closest first
+  std::vector<PeerView> client_nodes;
+};
+
 class RoutingTable {
  public:
   RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
@@ -95,16 +123,24 @@ class RoutingTable {
 
   bool IsThisNodeInRange(const NodeId& target_id, unsigned int range);
   bool IsThisNodeClosestTo(const NodeId& target_id, bool ignore_exact_match = false);
+  RouteDecision GetRouteDecision(const NodeId& target_id);
   bool Contains(const NodeId& node_id) const;
   bool ConfirmGroupMembers(const NodeId& node1, const NodeId& node2);
 
   bool GetNodeInfo(const NodeId& node_id, NodeInfo& node_info) const;
+  bool GetPeer(const NodeId& node_id, PeerView& peer) const;
   // Returns default-constructed NodeId if routing table size is zero
   NodeInfo GetClosestNode(const NodeId& target_id,
                           bool ignore_exact_match = false,
                           const std::vector<std::string>& exclude = std::vector<std::string>());
   std::vector<NodeInfo> GetClosestNodes(const NodeId& target_id, unsigned int number_to_get,
                                         bool ignore_exact_match = false);
+  // As GetClosestNode and GetClosestNodes, but without copying the peers' public keys.  'peers' is
+  // cleared and refilled, so callers can reuse its capacity across queries.
+  PeerView GetClosestPeer(const NodeId& target_id, bool ignore_exact_match = false,
+                          const std::vector<std::string>& exclude = std::vector<std::string>());
+  void GetClosestPeers(const NodeId& target_id, unsigned int number_to_get,
+                       std::vector<PeerView>& peers, bool ignore_exact_match = false);
   NodeInfo GetNthClosestNode(const NodeId& target_id, unsigned int index);
   NodeId RandomConnectedNode();
 
@@ -115,6 +151,8 @@ class RoutingTable {
   asymm::PrivateKey kPrivateKey() const { return kKeys_.private_key; }
   asymm::PublicKey kPublicKey() const { return kKeys_.public_key; }
   NodeId kConnectionId() const { return kConnectionId_; }
+  // Shared by the components which hold peers' keys outside the table, e.g. PublicKeyHolder.
+  KeyStore& key_store() { return key_store_; }
   bool client_mode() const { return kClientMode_; }
 
   friend class test::GenericNode;
@@ -130,27 +168,29 @@ class RoutingTable {
   RoutingTable& operator=(const RoutingTable&);
   bool AddOrCheckNode(NodeInfo node, bool remove);
   void SetBucketIndex(NodeInfo& node_info) const;
-  bool CheckPublicKeyIsUnique(const NodeInfo& node, std::unique_lock<std::mutex>& lock) const;
+  bool CheckPublicKeyIsUnique(const KeyFingerprint& fingerprint,
+                              std::unique_lock<std::mutex>& lock) const;
 
   /** Attempts to find or allocate memory for an incomming connect request, returning true
    * indicates approval
    * returns true if routing table is not full, otherwise, performs the following process to
    * possibly evict an existing node:
-   * - sorts the nodes according to their distance from self-node-id
-   * - a candidate for eviction must have an index > Parameters::unidirectional_interest_range
-   * - count the number of nodes in each bucket for nodes with
-   *    index > Parameters::unidirectional_interest_range
-   * - choose the furthest node among the nodes with maximum bucket index
-   * - in case more than one bucket have similar maximum bucket size, the furthest node in higher
-   *    bucket will be evicted
+   * - a client evicts its furthest node for a closer newcomer
+   * - a vault asks 'buckets_' for a candidate (see BucketOccupancy::ChooseEviction)
    * - remove the selected node and return true **/
-  bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove, NodeInfo& removed_node,
+  bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, const KeyFingerprint& fingerprint,
+                                 bool remove, NodeInfo& removed_node,
                                  std::unique_lock<std::mutex>& lock);
 
   unsigned int PartialSortFromTarget(const NodeId& target, unsigned int number,
                                      std::unique_lock<std::mutex>& lock);
   void NthElementSortFromTarget(const NodeId& target, unsigned int nth_element,
                                 std::unique_lock<std::mutex>& lock);
+  void Insert(const NodeInfo& node, const KeyFingerprint& fingerprint,
+              std::unique_lock<std::mutex>& lock);
+  // Removes the node at 'itr' from 'nodes_' and the indices over it.  The order of 'nodes_' is not
+  // preserved.
+  void Erase(std::vector<NodeInfo>::iterator itr, std::unique_lock<std::mutex>& lock);
   std::pair<bool, std::vector<NodeInfo>::iterator> Find(const NodeId& node_id,
                                                         std::unique_lock<std::mutex>& lock);
   std::pair<bool, std::vector<NodeInfo>::const_iterator> Find(
@@ -170,6 +210,17 @@ class RoutingTable {
   mutable std::mutex mutex_;
   RoutingTableChangeFunctor routing_table_change_functor_;
   std::vector<NodeInfo> nodes_;
+  // Fingerprints of the public keys of 'nodes_', so that uniqueness checks needn't compare keys, and
+  // the same by node id, so that Erase needn't hash the removed node's key under 'mutex_'.
+  std::unordered_set<KeyFingerprint, KeyFingerprintHash> key_fingerprints_;
+  std::map<NodeId, KeyFingerprint> node_fingerprints_;
+  // Indices over 'nodes_': by bucket for eviction, and by id for lookups and closest-k queries,
+  // which then needn't sort 'nodes_'.
+  BucketOccupancy buckets_;
+  PeerTrie peers_;
+  // Reused under 'mutex_' by queries which only look at the closest few peers.
+  std::vector<PeerView> scratch_peers_;
+  KeyStore key_store_;
   std::unique_ptr<boost::interprocess::message_queue> ipc_message_queue_;
 };
 
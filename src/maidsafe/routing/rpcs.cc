@@ -25,6 +25,7 @@
 
 #include "maidsafe/routing/message_handler.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -96,7 +97,7 @@ protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_e
   } else {
     message.set_relay_id(this_node_id.string());
     // This node is not in any peer's routing table yet
-    LOG(kVerbose) << "Connect RPC has relay connection id " << DebugId(relay_connection_id);
+    ROUTING_LOG(kVerbose) << "Connect RPC has relay connection id " << DebugId(relay_connection_id);
     message.set_relay_connection_id(relay_connection_id.string());
   }
 
@@ -132,7 +133,8 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
   } else {
     message.set_relay_id(this_node_id.string());
     // This node is not in any peer's routing table yet
-    LOG(kVerbose) << "FindNodes RPC has relay connection id " << DebugId(relay_connection_id);
+    ROUTING_LOG(kVerbose) << "FindNodes RPC has relay connection id "
+                          << DebugId(relay_connection_id);
     message.set_relay_connection_id(relay_connection_id.string());
   }
   message.set_hops_to_live(Parameters::hops_to_live);
@@ -266,6 +268,15 @@ protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id, int32_t a
   return message;
 }
 
+protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id,
+                      const std::vector<int32_t>& ack_ids) {
+  assert(!ack_ids.empty() && "No ack ids");
+  protobuf::Message message(Ack(node_id, my_node_id, ack_ids.front()));
+  for (size_t i(1); i < ack_ids.size(); ++i)
+    message.add_ack_ids(ack_ids[i]);
+  return message;
+}
+
 }  // namespace rpcs
 
 }  // namespace routing
@@ -77,6 +77,10 @@ protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id);
 
 protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id, int32_t ack_id);
 
+// Acknowledges all of 'ack_ids' (which must not be empty) in a single message.
+protobuf::Message Ack(const NodeId& node_id, const NodeId& my_node_id,
+                      const std::vector<int32_t>& ack_ids);
+
 }  // namespace rpcs
 
 }  // namespace routing
@@ -34,6 +34,7 @@
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/rpcs.h"
 #include "maidsafe/routing/utils.h"
@@ -58,7 +59,7 @@ Service::~Service() {}
 void Service::Ping(protobuf::Message& message) {
   if (message.destination_id() != routing_table_.kNodeId().string()) {
     // Message not for this node and we should not pass it on.
-    LOG(kError) << "Message not for this node.";
+    ROUTING_LOG(kError) << "Message not for this node.";
     message.Clear();
     return;
   }
@@ -66,7 +67,7 @@ void Service::Ping(protobuf::Message& message) {
   protobuf::PingRequest ping_request;
 
   if (!ping_request.ParseFromString(message.data(0))) {
-    LOG(kError) << "No Data.";
+    ROUTING_LOG(kError) << "No Data.";
     return;
   }
   ping_response.set_pong(true);
@@ -89,19 +90,19 @@ void Service::Ping(protobuf::Message& message) {
 void Service::Connect(protobuf::Message& message) {
   if (message.destination_id() != routing_table_.kNodeId().string()) {
     // Message not for this node and we should not pass it on.
-    LOG(kError) << "Message not for this node.";
+    ROUTING_LOG(kError) << "Message not for this node.";
     message.Clear();
     return;
   }
   protobuf::ConnectRequest connect_request;
   if (!connect_request.ParseFromString(message.data(0))) {
-    LOG(kVerbose) << "Unable to parse connect request.";
+    ROUTING_LOG(kVerbose) << "Unable to parse connect request.";
     message.Clear();
     return;
   }
 
   if (connect_request.peer_id() != routing_table_.kNodeId().string()) {
-    LOG(kError) << "Message not for this node.";
+    ROUTING_LOG(kError) << "Message not for this node.";
     message.Clear();
     return;
   }
@@ -109,8 +110,8 @@ void Service::Connect(protobuf::Message& message) {
   NodeInfo peer_node;
   peer_node.id = NodeId(connect_request.contact().node_id());
   peer_node.connection_id = NodeId(connect_request.contact().connection_id());
-  LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] received Connect request from "
-                << peer_node.id;
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] received Connect request from "
+                        << peer_node.id;
   rudp::EndpointPair peer_endpoint_pair;
   peer_endpoint_pair.external =
       GetEndpointFromProtobuf(connect_request.contact().public_endpoint());
@@ -118,7 +119,7 @@ void Service::Connect(protobuf::Message& message) {
 
   if (peer_endpoint_pair.external.address().is_unspecified() &&
       peer_endpoint_pair.local.address().is_unspecified()) {
-    LOG(kWarning) << "Invalid endpoint pair provided in connect request.";
+    ROUTING_LOG(kWarning) << "Invalid endpoint pair provided in connect request.";
     message.Clear();
     return;
   }
@@ -136,7 +137,7 @@ void Service::ValidateAndSendConnectResponse(protobuf::Message message, const No
   if (request_public_key_functor_) {
     auto validate_node([=](boost::optional<asymm::PublicKey> public_key) {
       if (!public_key) {
-        LOG(kError) << "Failed to retrieve public key for: " << peer_node.id;
+        ROUTING_LOG(kError) << "Failed to retrieve public key for: " << peer_node.id;
         return;
       }
       if (std::shared_ptr<Service> service = service_weak_ptr.lock()) {
@@ -178,36 +179,36 @@ void Service::SendConnectResponse(protobuf::Message message, const NodeInfo& pee
   // Check rudp & routing
   bool check_node_succeeded(false);
   if (message.client_node()) {  // Client node, check non-routing table
-    LOG(kVerbose) << "Client connect request - will check non-routing table.";
+    ROUTING_LOG(kVerbose) << "Client connect request - will check non-routing table.";
     NodeId furthest_close_node_id =
         routing_table_.GetNthClosestNode(routing_table_.kNodeId(),
                                          2 * Parameters::closest_nodes_size).id;
     check_node_succeeded = client_routing_table_.CheckNode(peer_node, furthest_close_node_id);
   } else {
-    LOG(kVerbose) << "Server connect request - will check routing table.";
+    ROUTING_LOG(kVerbose) << "Server connect request - will check routing table.";
     check_node_succeeded = routing_table_.CheckNode(peer_node);
   }
 
   if (check_node_succeeded) {
-    LOG(kVerbose) << "CheckNode(node) for " << (message.client_node() ? "client" : "server")
-                  << " node succeeded.";
+    ROUTING_LOG(kVerbose) << "CheckNode(node) for " << (message.client_node() ? "client" : "server")
+                          << " node succeeded.";
     rudp::NatType this_nat_type(rudp::NatType::kUnknown);
     int ret_val = network_.GetAvailableEndpoint(peer_node.connection_id, peer_endpoint_pair,
                                                 this_endpoint_pair, this_nat_type);
     if (ret_val != rudp::kSuccess && ret_val != rudp::kBootstrapConnectionAlreadyExists) {
       if (rudp::kUnvalidatedConnectionAlreadyExists != ret_val &&
           rudp::kConnectAttemptAlreadyRunning != ret_val) {
-        LOG(kError) << "[" << routing_table_.kNodeId() << "] Service: "
-                    << "Failed to get available endpoint for new connection to node id : "
-                    << peer_node.id << ", Connection id :" << peer_node.connection_id
-                    << ". peer_endpoint_pair.external = " << peer_endpoint_pair.external
-                    << ", peer_endpoint_pair.local = " << peer_endpoint_pair.local
-                    << ". Rudp returned :" << ret_val;
+        ROUTING_LOG(kError) << "[" << routing_table_.kNodeId() << "] Service: "
+                            << "Failed to get available endpoint for new connection to node id : "
+                            << peer_node.id << ", Connection id :" << peer_node.connection_id
+                            << ". peer_endpoint_pair.external = " << peer_endpoint_pair.external
+                            << ", peer_endpoint_pair.local = " << peer_endpoint_pair.local
+                            << ". Rudp returned :" << ret_val;
         message.add_data(connect_response.SerializeAsString());
         return;
       } else {  // Resolving collision by giving priority to lesser node id.
         if (!CheckPriority(peer_node.id, routing_table_.kNodeId())) {
-          LOG(kInfo) << "Already ongoing attempt with : " << peer_node.connection_id;
+          ROUTING_LOG(kInfo) << "Already ongoing attempt with : " << peer_node.connection_id;
           connect_response.set_answer(protobuf::ConnectResponseType::kConnectAttemptAlreadyRunning);
           message.add_data(connect_response.SerializeAsString());
           return;
@@ -236,8 +237,8 @@ void Service::SendConnectResponse(protobuf::Message message, const NodeInfo& pee
                           connect_response.mutable_contact()->mutable_public_endpoint());
     }
   } else {
-    LOG(kVerbose) << "CheckNode(node) for " << (message.client_node() ? "client" : "server")
-                  << " node failed.";
+    ROUTING_LOG(kVerbose) << "CheckNode(node) for " << (message.client_node() ? "client" : "server")
+                          << " node failed.";
   }
 
   message.add_data(connect_response.SerializeAsString());
@@ -257,22 +258,24 @@ bool Service::CheckPriority(const NodeId& this_node, const NodeId& peer_node) {
 void Service::FindNodes(protobuf::Message& message) {
   protobuf::FindNodesRequest find_nodes;
   if (!find_nodes.ParseFromString(message.data(0))) {
-    LOG(kWarning) << "Unable to parse find node request.";
+    ROUTING_LOG(kWarning) << "Unable to parse find node request.";
     message.Clear();
     return;
   }
   if (0 == find_nodes.num_nodes_requested() || NodeId(message.destination_id()).IsZero()) {
-    LOG(kWarning) << "Invalid find node request.";
+    ROUTING_LOG(kWarning) << "Invalid find node request.";
     message.Clear();
     return;
   }
 
-  LOG(kVerbose) << "[" << routing_table_.kNodeId() << "] parsed find node request for target id : "
-                << HexSubstr(message.destination_id());
+  ROUTING_LOG(kVerbose) << "[" << routing_table_.kNodeId()
+                        << "] parsed find node request for target id : "
+                        << HexSubstr(message.destination_id());
   protobuf::FindNodesResponse found_nodes;
-  auto nodes(routing_table_.GetClosestNodes(
-                 NodeId(message.destination_id()),
-                 static_cast<unsigned int>(find_nodes.num_nodes_requested() - 1)));
+  std::vector<PeerView> nodes;
+  routing_table_.GetClosestPeers(NodeId(message.destination_id()),
+                                 static_cast<unsigned int>(find_nodes.num_nodes_requested() - 1),
+                                 nodes);
   found_nodes.add_nodes(routing_table_.kNodeId().string());
 
   for (const auto& node : nodes) {
@@ -280,7 +283,7 @@ void Service::FindNodes(protobuf::Message& message) {
       found_nodes.add_nodes(node.id.string());
   }
 
-  LOG(kVerbose) << "Responding Find node with " << found_nodes.nodes_size() << " contacts.";
+  ROUTING_LOG(kVerbose) << "Responding Find node with " << found_nodes.nodes_size() << " contacts.";
 
   found_nodes.set_original_request(message.data(0));
   found_nodes.set_original_signature(message.signature());
@@ -292,7 +295,7 @@ void Service::FindNodes(protobuf::Message& message) {
     message.set_destination_id(message.source_id());
   } else {
     message.clear_destination_id();
-    LOG(kVerbose) << "Relay message, so not setting destination ID.";
+    ROUTING_LOG(kVerbose) << "Relay message, so not setting destination ID.";
   }
   message.set_source_id(routing_table_.kNodeId().string());
   message.clear_route_history();
@@ -311,7 +314,7 @@ void Service::ConnectSuccess(protobuf::Message& message) {
   protobuf::ConnectSuccess connect_success;
 
   if (!connect_success.ParseFromString(message.data(0))) {
-    LOG(kWarning) << "Unable to parse connect success.";
+    ROUTING_LOG(kWarning) << "Unable to parse connect success.";
     message.Clear();
     return;
   }
@@ -321,7 +324,7 @@ void Service::ConnectSuccess(protobuf::Message& message) {
   peer.connection_id = NodeId(connect_success.connection_id());
 
   if (peer.id.IsZero() || peer.connection_id.IsZero()) {
-    LOG(kWarning) << "Invalid node_id / connection_id provided";
+    ROUTING_LOG(kWarning) << "Invalid node_id / connection_id provided";
     return;
   }
 
@@ -331,26 +334,26 @@ void Service::ConnectSuccess(protobuf::Message& message) {
 
 void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
   // Reply with ConnectSuccessAcknowledgement immediately
-  LOG(kVerbose) << "ConnectSuccessFromResponder peer id : " << peer.id;
+  ROUTING_LOG(kVerbose) << "ConnectSuccessFromResponder peer id : " << peer.id;
   if (peer.connection_id == network_.bootstrap_connection_id()) {
-    LOG(kVerbose) << "Special case : kConnectSuccess from bootstrapping node: " << peer.id;
+    ROUTING_LOG(kVerbose) << "Special case : kConnectSuccess from bootstrapping node: " << peer.id;
     return;
   }
   if (client) {
     if (!ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
                                       peer.connection_id, asymm::PublicKey(), true)) {
-      LOG(kVerbose) << "Failed to add to routing table";
+      ROUTING_LOG(kVerbose) << "Failed to add to routing table";
       return;
     }
   } else {
     auto peer_public_key(public_key_holder_.Find(peer.id));
     if (!peer_public_key) {
-      LOG(kVerbose) << "Missing peer public key for " << peer.id;
+      ROUTING_LOG(kVerbose) << "Missing peer public key for " << peer.id;
       return;
     }
     if (!ValidateAndAddToRoutingTable(network_, routing_table_, client_routing_table_, peer.id,
                                       peer.connection_id, *peer_public_key, false)) {
-      LOG(kVerbose) << "Failed to add to routing table";
+      ROUTING_LOG(kVerbose) << "Failed to add to routing table";
       return;
     } else {
       public_key_holder_.Remove(peer.id);
@@ -376,11 +379,12 @@ void Service::HandleConnectSuccess(NodeInfo& peer, bool client) {
 }
 
 void Service::GetGroup(protobuf::Message& message) {
-  LOG(kVerbose) << "Service::GetGroup,  msg id:  " << message.id();
+  ROUTING_LOG(kVerbose) << "Service::GetGroup,  msg id:  " << message.id();
   protobuf::GetGroup get_group;
   assert(get_group.ParseFromString(message.data(0)));
-  auto close_nodes(routing_table_.GetClosestNodes(NodeId(get_group.node_id()),
-                                                  Parameters::group_size, true));
+  std::vector<PeerView> close_nodes;
+  routing_table_.GetClosestPeers(NodeId(get_group.node_id()), Parameters::group_size, close_nodes,
+                                 true);
   get_group.set_node_id(routing_table_.kNodeId().string());
   for (const auto& node : close_nodes)
     get_group.add_group_nodes_id(node.id.string());
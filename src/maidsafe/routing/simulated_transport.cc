@@ -0,0 +1,392 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/simulated_transport.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/make_unique.h"
+
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing_log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+typedef Clock::time_point TimePoint;
+
+}  // unnamed namespace
+
+SimulatedNetwork::Config::Config()
+    : latency(std::chrono::milliseconds(20)),
+      jitter(std::chrono::milliseconds(5)),
+      loss_rate(0.0),
+      bandwidth(0),
+      seed(0),
+      thread_count(2) {}
+
+SimulatedNetwork::SimulatedNetwork(const Config& config, AsioService* asio_service)
+    : kConfig_(config),
+      mutex_(),
+      cond_var_(),
+      random_(config.seed),
+      next_address_(0x0a000001),  // 10.0.0.1
+      nodes_by_id_(),
+      nodes_by_endpoint_(),
+      delivery_observer_(),
+      messages_sent_(0),
+      messages_delivered_(0),
+      messages_lost_(0),
+      own_asio_service_(asio_service ? std::unique_ptr<AsioService>()
+                                      : maidsafe::make_unique<AsioService>(config.thread_count)),
+      asio_service_(asio_service ? *asio_service : *own_asio_service_) {}
+
+SimulatedNetwork::~SimulatedNetwork() {
+  if (own_asio_service_)
+    asio_service_.Stop();
+}
+
+std::unique_ptr<Transport> SimulatedNetwork::MakeTransport() {
+  return std::unique_ptr<Transport>(new SimulatedTransport(*this));
+}
+
+void SimulatedNetwork::set_delivery_observer(DeliveryObserver delivery_observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  delivery_observer_ = delivery_observer;
+}
+
+void SimulatedNetwork::Crash(const NodeId& connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<Node> node(FindNode(connection_id));
+  if (!node)
+    return;
+  node->crashed = true;
+  DoUnregister(node);
+}
+
+size_t SimulatedNetwork::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return nodes_by_id_.size();
+}
+
+int SimulatedNetwork::Bootstrap(const std::shared_ptr<Node>& node,
+                                const BootstrapContacts& bootstrap_contacts,
+                                const NodeId& this_node_id, const Endpoint& local_endpoint,
+                                NodeId& chosen_bootstrap_contact) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (node->crashed)
+    return kNoOnlineBootstrapContacts;
+  if (node->registered) {  // bootstrapping again keeps this node's existing connections
+    if (node->id != this_node_id)
+      return rudp::kConnectionAlreadyExists;
+  } else {
+    if (nodes_by_id_.count(this_node_id) != 0)
+      return rudp::kConnectionAlreadyExists;
+    node->id = this_node_id;
+    if (local_endpoint.address().is_unspecified()) {
+      do {
+        node->endpoint = Endpoint(boost::asio::ip::address_v4(next_address_++), 5483);
+      } while (nodes_by_endpoint_.count(node->endpoint) != 0);
+    } else {
+      if (nodes_by_endpoint_.count(local_endpoint) != 0)
+        return rudp::kInvalidAddress;
+      node->endpoint = local_endpoint;
+    }
+    node->registered = true;
+    nodes_by_id_.insert(std::make_pair(node->id, node));
+    nodes_by_endpoint_.insert(std::make_pair(node->endpoint, node));
+    cond_var_.notify_all();
+  }
+
+  std::shared_ptr<Node> peer;
+  for (const auto& contact : bootstrap_contacts) {
+    peer = FindNode(contact);
+    if (peer && peer != node)
+      break;
+    peer.reset();
+  }
+  // A zero state node waits for its partner, which may be bootstrapping off this node already.
+  if (!peer && !local_endpoint.address().is_unspecified()) {
+    cond_var_.wait_for(lock, std::chrono::seconds(10), [&] {
+      return !node->connections.empty() || nodes_by_id_.size() > 1;
+    });
+    if (!node->connections.empty())
+      peer = FindNode(node->connections.begin()->first);
+  }
+  if (!peer)
+    peer = RandomPeer(node);
+  if (!peer) {
+    ROUTING_LOG(kError) << "No simulated peer available to bootstrap off.";
+    return kNoOnlineBootstrapContacts;
+  }
+  Connect(node, peer, ConnectionState::kBootstrap);
+  chosen_bootstrap_contact = peer->id;
+  return kSuccess;
+}
+
+int SimulatedNetwork::GetAvailableEndpoint(const std::shared_ptr<Node>& node,
+                                           const NodeId& peer_id,
+                                           rudp::EndpointPair& this_endpoint_pair) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!node->registered)
+    return rudp::kNotBootstrapped;
+  this_endpoint_pair.external = this_endpoint_pair.local = node->endpoint;
+  auto itr(node->connections.find(peer_id));
+  if (itr == node->connections.end())
+    return kSuccess;
+  switch (itr->second.state) {
+    case ConnectionState::kBootstrap:
+      return rudp::kBootstrapConnectionAlreadyExists;
+    case ConnectionState::kUnvalidated:
+      return rudp::kUnvalidatedConnectionAlreadyExists;
+    default:
+      return rudp::kConnectionAlreadyExists;
+  }
+}
+
+int SimulatedNetwork::Add(const std::shared_ptr<Node>& node, const NodeId& peer_id,
+                          const rudp::EndpointPair& peer_endpoint_pair,
+                          const std::string& validation_data) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!node->registered)
+      return rudp::kNotBootstrapped;
+    auto itr(node->connections.find(peer_id));
+    if (itr != node->connections.end() && itr->second.state == ConnectionState::kValid)
+      return rudp::kConnectionAlreadyExists;
+    std::shared_ptr<Node> peer(FindNode(peer_endpoint_pair.external));
+    if (!peer)
+      peer = FindNode(peer_endpoint_pair.local);
+    if (!peer || peer->id != peer_id)
+      peer = FindNode(peer_id);
+    if (!peer || peer == node)
+      return rudp::kInvalidAddress;
+    Connect(node, peer, ConnectionState::kUnvalidated);
+  }
+  Deliver(node, peer_id, validation_data, nullptr);
+  return kSuccess;
+}
+
+int SimulatedNetwork::MarkConnectionAsValid(const std::shared_ptr<Node>& node,
+                                            const NodeId& peer_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(node->connections.find(peer_id));
+  if (itr == node->connections.end())
+    return rudp::kInvalidAddress;
+  itr->second.state = ConnectionState::kValid;
+  return kSuccess;
+}
+
+void SimulatedNetwork::Remove(const std::shared_ptr<Node>& node, const NodeId& peer_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Disconnect(node, peer_id);
+}
+
+void SimulatedNetwork::Send(const std::shared_ptr<Node>& node, const NodeId& peer_id,
+                            std::string message,
+                            const rudp::MessageSentFunctor& message_sent_functor) {
+  Deliver(node, peer_id, std::move(message), message_sent_functor);
+}
+
+void SimulatedNetwork::Unregister(const std::shared_ptr<Node>& node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DoUnregister(node);
+}
+
+void SimulatedNetwork::DoUnregister(const std::shared_ptr<Node>& node) {
+  if (!node->registered)
+    return;
+  while (!node->connections.empty()) {
+    const NodeId kPeerId(node->connections.begin()->first);
+    Disconnect(node, kPeerId);
+  }
+  nodes_by_id_.erase(node->id);
+  nodes_by_endpoint_.erase(node->endpoint);
+  node->registered = false;
+}
+
+std::shared_ptr<SimulatedNetwork::Node> SimulatedNetwork::FindNode(
+    const Endpoint& endpoint) const {
+  auto itr(nodes_by_endpoint_.find(endpoint));
+  return itr == nodes_by_endpoint_.end() ? nullptr : itr->second;
+}
+
+std::shared_ptr<SimulatedNetwork::Node> SimulatedNetwork::FindNode(const NodeId& id) const {
+  auto itr(nodes_by_id_.find(id));
+  return itr == nodes_by_id_.end() ? nullptr : itr->second;
+}
+
+std::shared_ptr<SimulatedNetwork::Node> SimulatedNetwork::RandomPeer(
+    const std::shared_ptr<Node>& node) {
+  if (nodes_by_id_.size() < 2)
+    return nullptr;
+  // Drawn from 'random_' so that the choice is repeatable for a given seed.
+  auto itr(nodes_by_id_.begin());
+  std::advance(itr, std::uniform_int_distribution<size_t>(0, nodes_by_id_.size() - 2)(random_));
+  if (!(itr->first < node->id))  // skip over 'node' itself
+    ++itr;
+  return itr->second;
+}
+
+void SimulatedNetwork::Connect(const std::shared_ptr<Node>& node,
+                               const std::shared_ptr<Node>& peer, ConnectionState state) {
+  for (const auto& side : { std::make_pair(node, peer), std::make_pair(peer, node) }) {
+    auto result(side.first->connections.insert(std::make_pair(side.second->id, Connection())));
+    if (result.second || result.first->second.state == ConnectionState::kBootstrap)
+      result.first->second.state = state;
+  }
+  cond_var_.notify_all();
+}
+
+void SimulatedNetwork::Disconnect(const std::shared_ptr<Node>& node, const NodeId& peer_id) {
+  if (node->connections.erase(peer_id) == 0)
+    return;
+  std::shared_ptr<Node> peer(FindNode(peer_id));
+  if (!peer || peer->connections.erase(node->id) == 0 || !peer->connection_lost)
+    return;
+  rudp::ConnectionLostFunctor connection_lost(peer->connection_lost);
+  NodeId lost_id(node->id);
+  asio_service_.service().post([connection_lost, lost_id] { connection_lost(lost_id); });
+}
+
+void SimulatedNetwork::Deliver(const std::shared_ptr<Node>& sender, const NodeId& receiver_id,
+                               std::string message,
+                               const rudp::MessageSentFunctor& message_sent_functor) {
+  ++messages_sent_;
+  auto timer(std::make_shared<SteadyTimer>(asio_service_.service()));
+  bool lost(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(sender->connections.find(receiver_id));
+    if (itr == sender->connections.end()) {
+      if (message_sent_functor) {
+        asio_service_.service().post([message_sent_functor] {
+          message_sent_functor(rudp::kInvalidAddress);
+        });
+      }
+      return;
+    }
+    // The message occupies the sender's uplink for its serialisation time, then travels for the
+    // link latency plus jitter.  Deliveries on a connection never overtake one another, and are
+    // kept a tick apart so that timers with equal expiries can't reorder them.
+    TimePoint sent(std::max(Clock::now(), sender->uplink_free));
+    if (kConfig_.bandwidth != 0)
+      sent += std::chrono::microseconds(message.size() * 1000000 / kConfig_.bandwidth);
+    sender->uplink_free = sent;
+    std::chrono::microseconds jitter(0);
+    if (kConfig_.jitter.count() > 0) {
+      jitter = std::chrono::microseconds(std::uniform_int_distribution<int64_t>(
+          0, kConfig_.jitter.count())(random_));
+    }
+    TimePoint delivery_time(std::max(sent + kConfig_.latency + jitter,
+                                     itr->second.last_delivery + Clock::duration(1)));
+    itr->second.last_delivery = delivery_time;
+    timer->expires_at(delivery_time);
+    lost = kConfig_.loss_rate > 0.0 &&
+           std::uniform_real_distribution<double>(0.0, 1.0)(random_) < kConfig_.loss_rate;
+  }
+
+  // A lost message is reported to the sender as sent, leaving recovery to routing's own
+  // acknowledgements and retries, as for a message dropped by a faulty peer.
+  NodeId sender_id(sender->id);
+  auto shared_message(std::make_shared<std::string>(std::move(message)));
+  timer->async_wait([this, timer, lost, sender_id, receiver_id, shared_message,
+                     message_sent_functor](const boost::system::error_code& error_code) {
+    if (error_code == boost::asio::error::operation_aborted)
+      return;
+    rudp::MessageReceivedFunctor message_received;
+    DeliveryObserver delivery_observer;
+    if (lost) {
+      ++messages_lost_;
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::shared_ptr<Node> receiver(FindNode(receiver_id));
+      if (receiver && receiver->connections.count(sender_id) != 0) {
+        message_received = receiver->message_received;
+        delivery_observer = delivery_observer_;
+      }
+    }
+    if (message_received) {
+      ++messages_delivered_;
+      if (delivery_observer)
+        delivery_observer(sender_id, receiver_id, *shared_message);
+      message_received(*shared_message);
+    }
+    if (message_sent_functor)
+      message_sent_functor(message_received || lost ? rudp::kSuccess : rudp::kSendFailure);
+  });
+}
+
+SimulatedTransport::SimulatedTransport(SimulatedNetwork& network)
+    : network_(network), node_(std::make_shared<SimulatedNetwork::Node>()) {}
+
+SimulatedTransport::~SimulatedTransport() {
+  network_.Unregister(node_);
+}
+
+int SimulatedTransport::Bootstrap(const BootstrapContacts& bootstrap_contacts,
+                                  const rudp::MessageReceivedFunctor& message_received_functor,
+                                  const rudp::ConnectionLostFunctor& connection_lost_functor,
+                                  const NodeId& this_node_id,
+                                  std::shared_ptr<asymm::PrivateKey> /*private_key*/,
+                                  std::shared_ptr<asymm::PublicKey> /*public_key*/,
+                                  NodeId& chosen_bootstrap_contact, rudp::NatType& nat_type,
+                                  const boost::asio::ip::udp::endpoint& local_endpoint) {
+  node_->message_received = message_received_functor;
+  node_->connection_lost = connection_lost_functor;
+  nat_type = rudp::NatType::kOther;
+  return network_.Bootstrap(node_, bootstrap_contacts, this_node_id, local_endpoint,
+                            chosen_bootstrap_contact);
+}
+
+int SimulatedTransport::GetAvailableEndpoint(const NodeId& peer_id,
+                                             const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                             rudp::EndpointPair& this_endpoint_pair,
+                                             rudp::NatType& this_nat_type) {
+  this_nat_type = rudp::NatType::kOther;
+  return network_.GetAvailableEndpoint(node_, peer_id, this_endpoint_pair);
+}
+
+int SimulatedTransport::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                            const std::string& validation_data) {
+  return network_.Add(node_, peer_id, peer_endpoint_pair, validation_data);
+}
+
+int SimulatedTransport::MarkConnectionAsValid(
+    const NodeId& peer_id, boost::asio::ip::udp::endpoint& /*new_bootstrap_endpoint*/) {
+  return network_.MarkConnectionAsValid(node_, peer_id);
+}
+
+void SimulatedTransport::Remove(const NodeId& peer_id) {
+  network_.Remove(node_, peer_id);
+}
+
+void SimulatedTransport::Send(const NodeId& peer_id, std::string message,
+                              const rudp::MessageSentFunctor& message_sent_functor) {
+  network_.Send(node_, peer_id, std::move(message), message_sent_functor);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,184 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_SIMULATED_TRANSPORT_H_
+#define MAIDSAFE_ROUTING_SIMULATED_TRANSPORT_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/transport.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+class SimulatedTransport;
+
+// In-process stand-in for the network beneath many routing nodes.  Each node's Network is given a
+// transport from MakeTransport(); messages between them are delivered on this object's threads
+// after the configured latency, serialisation delay (per-sender bandwidth) and random loss.  A
+// lost message is still reported to the sender as rudp::kSuccess, as a datagram dropped beyond the
+// sender would be; only a send on a missing connection fails.  Connection states (bootstrap,
+// unvalidated, valid) and return codes follow rudp::ManagedConnections.  Must outlive all of its
+// transports.  Delays are measured by Clock, so the network can run in a Simulation's virtual time
+// on that Simulation's AsioService.
+class SimulatedNetwork {
+ public:
+  struct Config {
+    Config();
+    std::chrono::microseconds latency, jitter;
+    double loss_rate;         // probability in [0, 1] of a message being lost
+    uint64_t bandwidth;       // bytes per second per sender; 0 for unlimited
+    uint32_t seed;
+    unsigned int thread_count;
+  };
+  // Observes each delivered message, identified by the sending and receiving connection ids.
+  typedef std::function<void(const NodeId& sender, const NodeId& receiver,
+                             const std::string& message)> DeliveryObserver;
+
+  // If 'asio_service' is provided, deliveries run on it rather than on a service owned by this
+  // object, and Config::thread_count is unused.
+  explicit SimulatedNetwork(const Config& config = Config(), AsioService* asio_service = nullptr);
+  ~SimulatedNetwork();
+
+  std::unique_ptr<Transport> MakeTransport();
+  // Drops all of the node's connections, as if its process had died.  Its transport fails all
+  // further calls, including attempts to bootstrap again.
+  void Crash(const NodeId& connection_id);
+  // Must be set before any transports are bootstrapped.
+  void set_delivery_observer(DeliveryObserver delivery_observer);
+  size_t size() const;
+  uint64_t messages_sent() const { return messages_sent_; }
+  uint64_t messages_delivered() const { return messages_delivered_; }
+  uint64_t messages_lost() const { return messages_lost_; }
+
+  friend class SimulatedTransport;
+
+ private:
+  typedef boost::asio::ip::udp::endpoint Endpoint;
+  enum class ConnectionState { kBootstrap, kUnvalidated, kValid };
+  struct Connection {
+    Connection() : state(ConnectionState::kBootstrap), last_delivery() {}
+    ConnectionState state;
+    Clock::time_point last_delivery;
+  };
+  struct Node {
+    Node() : id(), endpoint(), message_received(), connection_lost(), connections(),
+             uplink_free(), registered(false), crashed(false) {}
+    NodeId id;
+    Endpoint endpoint;
+    rudp::MessageReceivedFunctor message_received;
+    rudp::ConnectionLostFunctor connection_lost;
+    std::map<NodeId, Connection> connections;
+    Clock::time_point uplink_free;
+    bool registered, crashed;
+  };
+
+  SimulatedNetwork(const SimulatedNetwork&);
+  SimulatedNetwork(const SimulatedNetwork&&);
+  SimulatedNetwork& operator=(const SimulatedNetwork&);
+
+  int Bootstrap(const std::shared_ptr<Node>& node, const BootstrapContacts& bootstrap_contacts,
+                const NodeId& this_node_id, const Endpoint& local_endpoint,
+                NodeId& chosen_bootstrap_contact);
+  int GetAvailableEndpoint(const std::shared_ptr<Node>& node, const NodeId& peer_id,
+                           rudp::EndpointPair& this_endpoint_pair);
+  int Add(const std::shared_ptr<Node>& node, const NodeId& peer_id,
+          const rudp::EndpointPair& peer_endpoint_pair, const std::string& validation_data);
+  int MarkConnectionAsValid(const std::shared_ptr<Node>& node, const NodeId& peer_id);
+  void Remove(const std::shared_ptr<Node>& node, const NodeId& peer_id);
+  void Send(const std::shared_ptr<Node>& node, const NodeId& peer_id, std::string message,
+            const rudp::MessageSentFunctor& message_sent_functor);
+  void Unregister(const std::shared_ptr<Node>& node);
+  // The following require 'mutex_' to be held.
+  void DoUnregister(const std::shared_ptr<Node>& node);
+  std::shared_ptr<Node> FindNode(const Endpoint& endpoint) const;
+  std::shared_ptr<Node> FindNode(const NodeId& id) const;
+  std::shared_ptr<Node> RandomPeer(const std::shared_ptr<Node>& node);
+  void Connect(const std::shared_ptr<Node>& node, const std::shared_ptr<Node>& peer,
+               ConnectionState state);
+  void Disconnect(const std::shared_ptr<Node>& node, const NodeId& peer_id);
+  void Deliver(const std::shared_ptr<Node>& sender, const NodeId& receiver_id,
+               std::string message, const rudp::MessageSentFunctor& message_sent_functor);
+
+  const Config kConfig_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_var_;
+  std::mt19937 random_;
+  uint32_t next_address_;
+  std::map<NodeId, std::shared_ptr<Node>> nodes_by_id_;
+  std::map<Endpoint, std::shared_ptr<Node>> nodes_by_endpoint_;
+  DeliveryObserver delivery_observer_;
+  std::atomic<uint64_t> messages_sent_, messages_delivered_, messages_lost_;
+  std::unique_ptr<AsioService> own_asio_service_;
+  AsioService& asio_service_;
+};
+
+class SimulatedTransport : public Transport {
+ public:
+  explicit SimulatedTransport(SimulatedNetwork& network);
+  virtual ~SimulatedTransport();
+  virtual int Bootstrap(const BootstrapContacts& bootstrap_contacts,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id,
+                        std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_contact, rudp::NatType& nat_type,
+                        const boost::asio::ip::udp::endpoint& local_endpoint);
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id,
+                                    boost::asio::ip::udp::endpoint& new_bootstrap_endpoint);
+  virtual void Remove(const NodeId& peer_id);
+  virtual void Send(const NodeId& peer_id, std::string message,
+                    const rudp::MessageSentFunctor& message_sent_functor);
+
+ private:
+  SimulatedTransport(const SimulatedTransport&);
+  SimulatedTransport(const SimulatedTransport&&);
+  SimulatedTransport& operator=(const SimulatedTransport&);
+
+  SimulatedNetwork& network_;
+  std::shared_ptr<SimulatedNetwork::Node> node_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_SIMULATED_TRANSPORT_H_
@@ -0,0 +1,76 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/simulation.h"
+
+#include <algorithm>
+#include <future>
+
+namespace maidsafe {
+
+namespace routing {
+
+Simulation::Simulation(AsioService& asio_service)
+    : asio_service_(asio_service), kick_timer_(asio_service.service()), steps_(0) {
+  VirtualClock::Enable();
+}
+
+Simulation::~Simulation() {
+  RunFor(Clock::duration::zero());
+  VirtualClock::Disable();
+}
+
+void Simulation::Schedule(const Clock::duration& delay, const std::function<void()>& functor) {
+  auto timer(std::make_shared<SteadyTimer>(asio_service_.service(), delay));
+  timer->async_wait([timer, functor](const boost::system::error_code& error) {
+    if (!error)
+      functor();
+  });
+}
+
+bool Simulation::RunFor(const Clock::duration& duration, const std::function<bool()>& done) {
+  const Clock::time_point kEnd(Clock::now() + duration);
+  for (;;) {
+    if (Step(done))
+      return true;
+    if (Clock::now() >= kEnd)
+      return false;
+    // Timers which expired at an earlier advance may not have been dispatched yet; they will be
+    // picked up by the next step.
+    VirtualClock::AdvanceTo(std::min(VirtualClock::NextExpiry(), kEnd));
+  }
+}
+
+bool Simulation::Step(const std::function<bool()>& done) {
+  ++steps_;
+  std::promise<bool> result;
+  asio_service_.service().post([&] {
+    // Re-arming a timer makes asio re-evaluate its deadlines against the advanced clock.
+    kick_timer_.expires_at(Clock::now());
+    kick_timer_.async_wait([](const boost::system::error_code&) {});
+    // Nested polling runs everything which is ready, including handlers it posts in turn.
+    while (asio_service_.service().poll_one() != 0) {
+    }
+    result.set_value(done && done());
+  });
+  return result.get_future().get();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,70 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_SIMULATION_H_
+#define MAIDSAFE_ROUTING_SIMULATION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "maidsafe/common/asio_service.h"
+
+#include "maidsafe/routing/clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Discrete-event driver for routing objects which share 'asio_service', e.g. Routing::Impls over a
+// SimulatedNetwork constructed with the same service.  VirtualClock is enabled for the lifetime of
+// this object, so all such objects must be created after it and destroyed before it.
+//
+// Each step runs every ready handler on the service's thread, then moves the clock straight to the
+// next timer expiry; hours of protocol time therefore pass in seconds.  With a single-threaded
+// 'asio_service' and seeded inputs the order of events is repeatable.
+class Simulation {
+ public:
+  explicit Simulation(AsioService& asio_service);
+  ~Simulation();
+
+  // Runs 'functor' on the service's thread once 'delay' of virtual time has passed.
+  void Schedule(const Clock::duration& delay, const std::function<void()>& functor);
+  // Processes events until 'duration' of virtual time has passed or 'done', evaluated on the
+  // service's thread after each step, returns true.  Returns whether 'done' was satisfied.
+  bool RunFor(const Clock::duration& duration, const std::function<bool()>& done = nullptr);
+  uint64_t steps() const { return steps_; }
+
+ private:
+  Simulation(const Simulation&);
+  Simulation(const Simulation&&);
+  Simulation& operator=(const Simulation&);
+
+  bool Step(const std::function<bool()>& done);
+
+  AsioService& asio_service_;
+  SteadyTimer kick_timer_;
+  std::atomic<uint64_t> steps_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_SIMULATION_H_
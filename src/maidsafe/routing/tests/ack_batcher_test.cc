@@ -0,0 +1,169 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/ack_batcher.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class AckBatcherTest : public testing::Test {
+ protected:
+  AckBatcherTest()
+      : kAckBatchDelay_(Parameters::ack_batch_delay),
+        kMaxAcksPerBatch_(Parameters::max_acks_per_batch),
+        asio_service_(1),
+        mutex_(),
+        flushed_(),
+        peer_(NodeId::IdType::kRandomId),
+        connection_(NodeId::IdType::kRandomId) {
+    Parameters::ack_batch_delay = std::chrono::hours(1);
+    Parameters::max_acks_per_batch = 4;
+  }
+  ~AckBatcherTest() {
+    Parameters::ack_batch_delay = kAckBatchDelay_;
+    Parameters::max_acks_per_batch = kMaxAcksPerBatch_;
+  }
+
+  AckBatcher::FlushFunctor Flush() {
+    return [this](const NodeId& peer_id, const NodeId& peer_connection_id,
+                  const std::vector<int32_t>& ack_ids) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      EXPECT_EQ(peer_, peer_id);
+      EXPECT_EQ(connection_, peer_connection_id);
+      flushed_.push_back(ack_ids);
+    };
+  }
+
+  std::vector<std::vector<int32_t>> flushed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushed_;
+  }
+
+  const std::chrono::steady_clock::duration kAckBatchDelay_;
+  const unsigned int kMaxAcksPerBatch_;
+  AsioService asio_service_;
+  std::mutex mutex_;
+  std::vector<std::vector<int32_t>> flushed_;
+  const NodeId peer_, connection_;
+};
+
+TEST_F(AckBatcherTest, BEH_FlushesFullBatch) {
+  AckBatcher batcher(asio_service_.service(), Flush());
+  for (int32_t ack_id(1); ack_id != 7; ++ack_id)
+    batcher.Add(peer_, connection_, ack_id);
+  auto batches(flushed());
+  ASSERT_EQ(1U, batches.size());
+  EXPECT_EQ(std::vector<int32_t>({1, 2, 3, 4}), batches.front());
+  EXPECT_EQ(2U, batcher.pending());
+}
+
+TEST_F(AckBatcherTest, BEH_TakeForPiggybacking) {
+  AckBatcher batcher(asio_service_.service(), Flush());
+  NodeId peer_id;
+  EXPECT_TRUE(batcher.Take(connection_, peer_id).empty());
+  batcher.Add(peer_, connection_, 1);
+  batcher.Add(peer_, connection_, 2);
+  EXPECT_TRUE(batcher.Take(NodeId(NodeId::IdType::kRandomId), peer_id).empty());
+  EXPECT_TRUE(peer_id.IsZero());
+  EXPECT_EQ(std::vector<int32_t>({1, 2}), batcher.Take(connection_, peer_id));
+  EXPECT_EQ(peer_, peer_id);
+  EXPECT_EQ(0U, batcher.pending());
+  EXPECT_TRUE(flushed().empty());
+}
+
+TEST_F(AckBatcherTest, BEH_FlushesAfterDelay) {
+  Parameters::ack_batch_delay = std::chrono::milliseconds(10);
+  std::promise<void> done;
+  auto done_future(done.get_future());
+  auto flush(Flush());
+  AckBatcher batcher(asio_service_.service(),
+                     [&](const NodeId& peer_id, const NodeId& peer_connection_id,
+                         const std::vector<int32_t>& ack_ids) {
+                       flush(peer_id, peer_connection_id, ack_ids);
+                       done.set_value();
+                     });
+  batcher.Add(peer_, connection_, 1);
+  batcher.Add(peer_, connection_, 2);
+  ASSERT_EQ(std::future_status::ready, done_future.wait_for(std::chrono::seconds(5)));
+  auto batches(flushed());
+  ASSERT_EQ(1U, batches.size());
+  EXPECT_EQ(std::vector<int32_t>({1, 2}), batches.front());
+  EXPECT_EQ(0U, batcher.pending());
+}
+
+TEST_F(AckBatcherTest, BEH_StopDiscardsPending) {
+  Parameters::ack_batch_delay = std::chrono::milliseconds(10);
+  AckBatcher batcher(asio_service_.service(), Flush());
+  batcher.Add(peer_, connection_, 1);
+  batcher.Stop();
+  EXPECT_EQ(0U, batcher.pending());
+  batcher.Add(peer_, connection_, 2);
+  EXPECT_EQ(0U, batcher.pending());
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(flushed().empty());
+}
+
+TEST(AppendAckIdsTest, BEH_ParsesAsCarrier) {
+  protobuf::Message message;
+  message.set_destination_id(NodeId(NodeId::IdType::kRandomId).string());
+  message.set_routing_message(false);
+  message.set_direct(true);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  message.add_data("payload");
+  message.set_ack_id(7);
+  message.set_id(42);
+  const std::vector<int32_t> kAckIds({1, -2, 300, 2147483647});
+  std::string serialised(message.SerializeAsString());
+  AppendAckIds(kAckIds, serialised);
+
+  // Same bytes as if the acks had been added to a copy of the message before serialising.
+  protobuf::Message carrier(message);
+  for (const auto& ack_id : kAckIds)
+    carrier.add_ack_ids(ack_id);
+  EXPECT_EQ(carrier.SerializeAsString(), serialised);
+
+  protobuf::Message parsed;
+  ASSERT_TRUE(parsed.ParseFromString(serialised));
+  EXPECT_EQ(kAckIds, std::vector<int32_t>(parsed.ack_ids().begin(), parsed.ack_ids().end()));
+  EXPECT_EQ(message.data(0), parsed.data(0));
+  EXPECT_EQ(message.id(), parsed.id());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -18,7 +18,9 @@
 
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "boost/date_time/posix_time/posix_time.hpp"
@@ -94,6 +96,53 @@ TEST_F(AcknowledgementTest, BEH_CallRemove) {
   EXPECT_EQ(2, message_.id());
 }
 
+TEST_F(AcknowledgementTest, BEH_HandleBatch) {
+  std::atomic<int> timeouts(0);
+  Handler count_timeout([&timeouts](const boost::system::error_code& error) {
+    if (error.value() == boost::system::errc::success)
+      ++timeouts;
+  });
+  std::vector<AckId> ack_ids;
+  for (int i(0); i != 4; ++i) {
+    message_.set_ack_id(acknowledgement_.GetId());
+    ack_ids.push_back(message_.ack_id());
+    acknowledgement_.Add(message_, count_timeout, 1);
+  }
+  // Acks the first three, plus one which isn't pending.
+  acknowledgement_.HandleMessage(
+      std::vector<AckId>{ ack_ids.at(2), ack_ids.at(0), ack_ids.at(3) + 1, ack_ids.at(1) });
+  Sleep(std::chrono::seconds(2));
+  EXPECT_EQ(1, timeouts);
+  acknowledgement_.Remove(ack_ids.at(3));
+}
+
+TEST_F(AcknowledgementTest, BEH_ReportRoundTrip) {
+  std::vector<std::pair<NodeId, Clock::duration>> round_trips;
+  acknowledgement_.set_round_trip_functor([&round_trips](const NodeId& peer_connection_id,
+                                                         Clock::duration round_trip) {
+    round_trips.push_back(std::make_pair(peer_connection_id, round_trip));
+  });
+  Handler ignore([](const boost::system::error_code&) {});  // NOLINT
+  const NodeId kPeer(NodeId::IdType::kRandomId);
+  acknowledgement_.Add(message_, ignore, Parameters::ack_timeout, kPeer);
+  Sleep(std::chrono::milliseconds(20));
+  acknowledgement_.HandleMessage(message_.ack_id());
+  ASSERT_EQ(1U, round_trips.size());
+  EXPECT_EQ(kPeer, round_trips.front().first);
+  EXPECT_GE(round_trips.front().second, std::chrono::milliseconds(20));
+
+  // A re-sent message's ack can't be matched to one send, so it isn't reported.
+  message_.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(message_, ignore, Parameters::ack_timeout, kPeer);
+  acknowledgement_.Add(message_, ignore, Parameters::ack_timeout, kPeer);
+  acknowledgement_.HandleMessage(message_.ack_id());
+  // Nor is one for a message sent without naming the peer.
+  message_.set_ack_id(acknowledgement_.GetId());
+  acknowledgement_.Add(message_, ignore, Parameters::ack_timeout);
+  acknowledgement_.HandleMessage(message_.ack_id());
+  EXPECT_EQ(1U, round_trips.size());
+}
+
 }  // namespace test
 
 }  // namespace routing
@@ -0,0 +1,138 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/admission_control.h"
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class AdmissionControlTest : public testing::Test {
+ protected:
+  AdmissionControlTest()
+      : client_rate_(Parameters::admission_client_rate),
+        client_burst_(Parameters::admission_client_burst),
+        vault_rate_(Parameters::admission_vault_rate),
+        vault_burst_(Parameters::admission_vault_burst) {
+    VirtualClock::Enable();
+    Parameters::admission_client_rate = 10;
+    Parameters::admission_client_burst = 5;
+    Parameters::admission_vault_rate = 100;
+    Parameters::admission_vault_burst = 20;
+  }
+  ~AdmissionControlTest() {
+    Parameters::admission_client_rate = client_rate_;
+    Parameters::admission_client_burst = client_burst_;
+    Parameters::admission_vault_rate = vault_rate_;
+    Parameters::admission_vault_burst = vault_burst_;
+    VirtualClock::Disable();
+  }
+
+  size_t AdmitAll(AdmissionControl& admission_control, const NodeId& sender, bool client,
+                  size_t count) {
+    size_t admitted(0);
+    for (size_t i(0); i != count; ++i)
+      admitted += admission_control.Admit(sender, client) ? 1 : 0;
+    return admitted;
+  }
+
+ private:
+  const unsigned int client_rate_, client_burst_, vault_rate_, vault_burst_;
+};
+
+TEST_F(AdmissionControlTest, BEH_BurstAndRefill) {
+  AdmissionControl admission_control;
+  NodeId client(NodeId::IdType::kRandomId), vault(NodeId::IdType::kRandomId),
+      other_vault(NodeId::IdType::kRandomId);
+
+  // Each sender may send a burst, after which it is limited to its class's rate.
+  EXPECT_EQ(5U, AdmitAll(admission_control, client, true, 50));
+  EXPECT_EQ(20U, AdmitAll(admission_control, vault, false, 50));
+  EXPECT_EQ(20U, AdmitAll(admission_control, other_vault, false, 50));
+  VirtualClock::Advance(std::chrono::milliseconds(500));
+  EXPECT_EQ(5U, AdmitAll(admission_control, client, true, 50));
+  EXPECT_EQ(20U, AdmitAll(admission_control, vault, false, 50));
+  VirtualClock::Advance(std::chrono::milliseconds(100));
+  EXPECT_EQ(1U, AdmitAll(admission_control, client, true, 50));
+  EXPECT_EQ(10U, AdmitAll(admission_control, vault, false, 50));
+  EXPECT_EQ(3U, admission_control.tracked_senders());
+
+  // A rate of 0 disables the limit.
+  Parameters::admission_client_rate = 0;
+  EXPECT_EQ(50U, AdmitAll(admission_control, client, true, 50));
+}
+
+TEST_F(AdmissionControlTest, BEH_ForgetsIdleSenders) {
+  AdmissionControl admission_control;
+  const size_t kSenders(10000);
+  for (size_t i(0); i != kSenders; ++i)
+    EXPECT_TRUE(admission_control.Admit(NodeId(NodeId::IdType::kRandomId), true));
+  EXPECT_EQ(kSenders, admission_control.tracked_senders());
+
+  // Once their buckets have refilled, senders are forgotten as new ones arrive.
+  VirtualClock::Advance(std::chrono::seconds(1));
+  for (size_t i(0); i != kSenders && admission_control.tracked_senders() >= kSenders; ++i)
+    EXPECT_TRUE(admission_control.Admit(NodeId(NodeId::IdType::kRandomId), true));
+  EXPECT_LT(admission_control.tracked_senders(), kSenders);
+
+  // A sender which is still limited is remembered.
+  NodeId sender(NodeId::IdType::kRandomId);
+  EXPECT_EQ(5U, AdmitAll(admission_control, sender, true, 50));
+  for (size_t i(0); i != 2 * kSenders; ++i)
+    admission_control.Admit(NodeId(NodeId::IdType::kRandomId), true);
+  EXPECT_FALSE(admission_control.Admit(sender, true));
+}
+
+TEST(PreviousHopTest, BEH_ForwardedAndRelayed) {
+  NodeId this_node(NodeId::IdType::kRandomId), source(NodeId::IdType::kRandomId),
+      forwarder(NodeId::IdType::kRandomId), client_connection(NodeId::IdType::kRandomId);
+  protobuf::Message message;
+
+  // Straight from its source.
+  message.set_source_id(source.string());
+  EXPECT_EQ(source.string(), PreviousHop(message, this_node));
+
+  // Forwarded: the claimed source is ignored in favour of the last forwarder.
+  message.add_route_history(NodeId(NodeId::IdType::kRandomId).string());
+  message.add_route_history(forwarder.string());
+  EXPECT_EQ(forwarder.string(), PreviousHop(message, this_node));
+
+  // A client's request to its relay node, with or without the relay having adopted it.
+  message.Clear();
+  message.set_relay_connection_id(client_connection.string());
+  EXPECT_EQ(client_connection.string(), PreviousHop(message, this_node));
+  message.set_source_id(this_node.string());
+  EXPECT_EQ(client_connection.string(), PreviousHop(message, this_node));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,153 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/bucket_occupancy.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// A random id which first differs from 'this_node_id' at the bit giving it 'bucket'.
+NodeId IdInBucket(const NodeId& this_node_id, int bucket) {
+  std::string raw_id(NodeId(NodeId::IdType::kRandomId).string());
+  const std::string& own_id(this_node_id.string());
+  int bit(NodeId::kSize * 8 - 1 - bucket);
+  std::copy(own_id.begin(), own_id.begin() + bit / 8, raw_id.begin());
+  unsigned char mask(static_cast<unsigned char>(0x80 >> (bit % 8)));
+  unsigned char same(static_cast<unsigned char>(0xFF << (8 - bit % 8)));
+  unsigned char own_byte(static_cast<unsigned char>(own_id[bit / 8]));
+  unsigned char random_byte(static_cast<unsigned char>(raw_id[bit / 8]));
+  raw_id[bit / 8] = static_cast<char>((own_byte & same) | (~own_byte & mask) |
+                                      (random_byte & ~(same | mask)));
+  return NodeId(raw_id);
+}
+
+}  // unnamed namespace
+
+TEST(BucketOccupancyTest, BEH_BucketIndex) {
+  NodeId this_node_id(NodeId::IdType::kRandomId);
+  EXPECT_EQ(0, BucketOccupancy::BucketIndex(this_node_id, this_node_id));
+  for (int bucket : {511, 504, 503, 300, 8, 7, 1, 0})
+    EXPECT_EQ(bucket, BucketOccupancy::BucketIndex(this_node_id, IdInBucket(this_node_id, bucket)));
+}
+
+TEST(BucketOccupancyTest, BEH_AddRemove) {
+  NodeId this_node_id(NodeId::IdType::kRandomId);
+  BucketOccupancy bucket_occupancy(this_node_id);
+  EXPECT_TRUE(bucket_occupancy.empty());
+
+  NodeId closer(IdInBucket(this_node_id, 400)), further(IdInBucket(this_node_id, 500));
+  bucket_occupancy.Add(further, 500);
+  bucket_occupancy.Add(closer, 400);
+  bucket_occupancy.Add(closer, 400);
+  EXPECT_EQ(2U, bucket_occupancy.size());
+  EXPECT_EQ(1U, bucket_occupancy.BucketSize(400));
+  EXPECT_EQ(further, bucket_occupancy.Furthest());
+
+  bucket_occupancy.Remove(further, 500);
+  EXPECT_EQ(0U, bucket_occupancy.BucketSize(500));
+  EXPECT_EQ(closer, bucket_occupancy.Furthest());
+  bucket_occupancy.Remove(closer, 400);
+  EXPECT_TRUE(bucket_occupancy.empty());
+}
+
+TEST(BucketOccupancyTest, BEH_BalanceBuckets) {
+  NodeId this_node_id(NodeId::IdType::kRandomId);
+  BucketOccupancy bucket_occupancy(this_node_id);
+  // The interest range is filled with close nodes, followed by one node in bucket 300 and an
+  // overfull bucket 400.
+  for (unsigned int i(0); i != Parameters::unidirectional_interest_range; ++i) {
+    int bucket(100 + static_cast<int>(i));
+    bucket_occupancy.Add(IdInBucket(this_node_id, bucket), bucket);
+  }
+  bucket_occupancy.Add(IdInBucket(this_node_id, 300), 300);
+  std::vector<NodeId> full_bucket;
+  for (int i(0); i != 10; ++i) {
+    full_bucket.push_back(IdInBucket(this_node_id, 400));
+    bucket_occupancy.Add(full_bucket.back(), 400);
+  }
+  std::sort(full_bucket.begin(), full_bucket.end(), [&](const NodeId& lhs, const NodeId& rhs) {
+    return NodeId::CloserToTarget(lhs, rhs, this_node_id);
+  });
+
+  // By default a newcomer further than the first node beyond the interest range is refused.
+  NodeId newcomer(IdInBucket(this_node_id, 511)), evictee;
+  EXPECT_FALSE(bucket_occupancy.ChooseEviction(newcomer, 511, evictee));
+
+  // With a bucket target, it displaces the furthest node of the fullest bucket...
+  auto bucket_target_size(Parameters::bucket_target_size);
+  Parameters::bucket_target_size = 4;
+  EXPECT_TRUE(bucket_occupancy.ChooseEviction(newcomer, 511, evictee));
+  EXPECT_EQ(full_bucket.back(), evictee);
+  // ...unless that bucket is already down to the target.
+  for (int i(0); i != 6; ++i)
+    bucket_occupancy.Remove(full_bucket[i], 400);
+  EXPECT_FALSE(bucket_occupancy.ChooseEviction(newcomer, 511, evictee));
+  Parameters::bucket_target_size = bucket_target_size;
+}
+
+TEST(BucketOccupancyTest, BEH_KeepsCloseStandby) {
+  NodeId this_node_id(NodeId::IdType::kRandomId);
+  BucketOccupancy bucket_occupancy(this_node_id);
+  // The close nodes have a bucket each, their standby shares bucket 400, and one further node sits
+  // in bucket 450.
+  for (unsigned int i(0); i != Parameters::closest_nodes_size; ++i) {
+    int bucket(100 + static_cast<int>(i));
+    bucket_occupancy.Add(IdInBucket(this_node_id, bucket), bucket);
+  }
+  std::vector<NodeId> standby;
+  for (unsigned int i(0); i != Parameters::close_standby_size; ++i) {
+    standby.push_back(IdInBucket(this_node_id, 400));
+    bucket_occupancy.Add(standby.back(), 400);
+  }
+  NodeId further(IdInBucket(this_node_id, 450));
+  bucket_occupancy.Add(further, 450);
+
+  // However small the interest range, a newcomer displaces the node beyond the standby...
+  auto unidirectional_interest_range(Parameters::unidirectional_interest_range);
+  Parameters::unidirectional_interest_range = 0;
+  NodeId newcomer(IdInBucket(this_node_id, 380)), evictee;
+  EXPECT_TRUE(bucket_occupancy.ChooseEviction(newcomer, 380, evictee));
+  EXPECT_EQ(further, evictee);
+
+  // ...but without a standby it displaces the furthest node of the fullest bucket.
+  auto close_standby_size(Parameters::close_standby_size);
+  Parameters::close_standby_size = 0;
+  EXPECT_TRUE(bucket_occupancy.ChooseEviction(newcomer, 380, evictee));
+  EXPECT_NE(standby.end(), std::find(standby.begin(), standby.end(), evictee));
+  Parameters::close_standby_size = close_standby_size;
+  Parameters::unidirectional_interest_range = unidirectional_interest_range;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -41,7 +41,7 @@ protobuf::Message CreateNodeLevelSingleToSingleResponseMessageProto(
   protobuf::Message proto_message;
   proto_message.set_destination_id(message.receiver->string());
   proto_message.set_routing_message(false);
-  proto_message.add_data(message.contents);
+  proto_message.add_data(message.payload());
   proto_message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
 
   proto_message.set_cacheable(static_cast<int32_t>(message.cacheable));
@@ -152,7 +152,7 @@ TEST_F(NetworkCache, FUNC_StoreGet) {
   auto response_functor([&](std::string string) { EXPECT_EQ(string, content); });
   nodes_[no_cache_holder_index]->AddTask(response_functor, 1, message.id());
 
-  message.add_data(crypto::Hash<crypto::SHA512>(single_to_single_message.contents).string());
+  message.add_data(crypto::Hash<crypto::SHA512>(single_to_single_message.payload()).string());
   message.set_destination_id(nodes_[cache_holder_index]->node_id().string());
   message.set_source_id(nodes_[no_cache_holder_index]->node_id().string());
   message.set_cacheable(static_cast<int32_t>(Cacheable::kGet));
@@ -287,6 +287,14 @@ TEST_F(ClientRoutingTableTest, FUNC_GetNodesInfo) {
     }
     EXPECT_TRUE(found_counterpart);
   }
+
+  std::vector<PeerView> got_peers(1);
+  client_routing_table.GetPeers(sought_id, got_peers);
+  ASSERT_EQ(got_nodes.size(), got_peers.size());
+  for (size_t i(0); i != got_nodes.size(); ++i) {
+    EXPECT_EQ(got_nodes[i].id, got_peers[i].id);
+    EXPECT_EQ(got_nodes[i].connection_id, got_peers[i].connection_id);
+  }
 }
 
 TEST_F(ClientRoutingTableTest, FUNC_IsConnected) {
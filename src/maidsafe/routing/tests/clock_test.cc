@@ -0,0 +1,100 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(ClockTest, BEH_RealTime) {
+  ASSERT_FALSE(VirtualClock::enabled());
+  auto real_before(std::chrono::steady_clock::now().time_since_epoch());
+  auto now(Clock::now().time_since_epoch());
+  auto real_after(std::chrono::steady_clock::now().time_since_epoch());
+  EXPECT_LE(real_before, now);
+  EXPECT_LE(now, real_after);
+
+  AsioService asio_service(1);
+  SteadyTimer timer(asio_service.service(), std::chrono::milliseconds(50));
+  std::promise<boost::system::error_code> fired;
+  auto start(Clock::now());
+  timer.async_wait([&](const boost::system::error_code& error) { fired.set_value(error); });
+  EXPECT_FALSE(fired.get_future().get());
+  EXPECT_GE(Clock::now() - start, std::chrono::milliseconds(50));
+  asio_service.Stop();
+}
+
+TEST(ClockTest, BEH_VirtualTime) {
+  AsioService asio_service(1);
+  VirtualClock::Enable();
+  const Clock::time_point kStart(Clock::now());
+  EXPECT_EQ(Clock::time_point::max(), VirtualClock::NextExpiry());
+
+  // Virtual time stands still until advanced, and timers wait for it.
+  std::promise<Clock::time_point> fired;
+  auto fired_future(fired.get_future());
+  {
+    SteadyTimer timer(asio_service.service(), std::chrono::hours(1));
+    timer.async_wait([&](const boost::system::error_code& error) {
+      if (!error)
+        fired.set_value(Clock::now());
+    });
+    EXPECT_EQ(kStart + std::chrono::hours(1), VirtualClock::NextExpiry());
+    EXPECT_EQ(kStart, Clock::now());
+    EXPECT_EQ(std::future_status::timeout, fired_future.wait_for(std::chrono::milliseconds(20)));
+
+    VirtualClock::Advance(std::chrono::minutes(30));
+    EXPECT_EQ(kStart + std::chrono::minutes(30), Clock::now());
+    VirtualClock::AdvanceTo(kStart);  // can't go backwards
+    EXPECT_EQ(kStart + std::chrono::minutes(30), Clock::now());
+    EXPECT_EQ(std::future_status::timeout, fired_future.wait_for(std::chrono::milliseconds(20)));
+
+    VirtualClock::Advance(std::chrono::minutes(30));
+    EXPECT_EQ(kStart + std::chrono::hours(1), fired_future.get());
+  }
+  // A cancelled wait is unregistered too.
+  {
+    SteadyTimer timer(asio_service.service(), std::chrono::hours(1));
+    std::promise<void> cancelled;
+    timer.async_wait([&](const boost::system::error_code&) { cancelled.set_value(); });
+    EXPECT_EQ(Clock::now() + std::chrono::hours(1), VirtualClock::NextExpiry());
+    timer.cancel();
+    cancelled.get_future().get();
+  }
+  asio_service.Stop();
+  EXPECT_EQ(Clock::time_point::max(), VirtualClock::NextExpiry());
+  VirtualClock::Disable();
+  EXPECT_FALSE(VirtualClock::enabled());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -16,6 +16,7 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
 #include <bitset>
 #include <map>
 #include <memory>
@@ -293,6 +294,41 @@ TEST_F(CloseNodesChangeTest, BEH_CheckHolders) {
   }
 }
 
+TEST_F(CloseNodesChangeTest, BEH_BulkCheckHolders) {
+  const NodeId kLostNode(old_close_nodes_.front()), kNewNode(NodeId::IdType::kRandomId);
+  new_close_nodes_.front() = kNewNode;
+  CloseNodesChange close_nodes_change(kNodeId_, old_close_nodes_, new_close_nodes_);
+
+  // Cluster the targets around the changed nodes and this node, sharing up to three leading bytes.
+  std::vector<NodeId> targets(1, kLostNode);
+  targets.push_back(kNewNode);
+  for (auto i(0); i != 40000; ++i) {
+    const NodeId& kNear(i % 3 == 0 ? kLostNode : (i % 3 == 1 ? kNewNode : kNodeId_));
+    const size_t kSharedBytes(i % 4);
+    targets.push_back(NodeId(kNear.string().substr(0, kSharedBytes) +
+                             RandomString(NodeId::kSize - kSharedBytes)));
+  }
+  std::sort(std::begin(targets), std::end(targets));
+  targets.erase(std::unique(std::begin(targets), std::end(targets)), std::end(targets));
+
+  auto changed(close_nodes_change.CheckHolders(targets));
+  EXPECT_FALSE(changed.empty());
+  EXPECT_LT(changed.size(), targets.size());
+  auto changed_itr(std::begin(changed));
+  for (const auto& target : targets) {
+    bool holders_changed(false);
+    auto result(close_nodes_change.DoCheckHolders(target, holders_changed));
+    bool reported(changed_itr != std::end(changed) && changed_itr->first == target);
+    ASSERT_EQ(holders_changed, reported) << DebugId(target);
+    if (reported) {
+      EXPECT_EQ(result.new_holder, changed_itr->second.new_holder);
+      EXPECT_EQ(result.proximity_status, changed_itr->second.proximity_status);
+      ++changed_itr;
+    }
+  }
+  EXPECT_TRUE(changed_itr == std::end(changed));
+}
+
 void Choose(const std::set<NodeId>& online_pmids, const NodeId& kTarget,
             const std::vector<CloseNodesChange>& owners, int owner_count, int online_pmid_count) {
   // This test is only valid where 'owner_count' <= 'Parameters::group_size'.
@@ -0,0 +1,152 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/flight_recorder.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// The recorder is process-wide, so each test records under its own random node prefix.
+uint64_t RandomNode() {
+  uint64_t node(0);
+  while (node == 0)
+    node = FlightRecorder::Prefix(RandomString(8));
+  return node;
+}
+
+FlightRecord MakeRecord(uint64_t node, uint32_t message_id) {
+  FlightRecord record = FlightRecord();
+  record.timestamp = message_id;
+  record.node = node;
+  record.message_id = message_id;
+  record.event = FlightEvent::kReceived;
+  return record;
+}
+
+}  // unnamed namespace
+
+TEST(FlightRecorderTest, BEH_RecordAndDump) {
+  uint64_t node(RandomNode());
+  std::string source_id(RandomString(64)), destination_id(RandomString(64));
+  protobuf::Message message;
+  message.set_id(42);
+  message.set_type(101);
+  message.set_source_id(source_id);
+  message.set_destination_id(destination_id);
+
+  FlightRecorder::Add(FlightEvent::kReceived, node, message);
+  FlightRecorder::Add(FlightEvent::kSent, node, message, 7);
+  FlightRecorder::Add(FlightEvent::kDropped, node, message, 0, DropReason::kHopsToLive);
+
+  auto records(FlightRecorder::Records(node));
+  ASSERT_EQ(3U, records.size());
+  EXPECT_EQ(FlightEvent::kReceived, records[0].event);
+  EXPECT_EQ(FlightEvent::kSent, records[1].event);
+  EXPECT_EQ(FlightEvent::kDropped, records[2].event);
+  EXPECT_LE(records[0].timestamp, records[1].timestamp);
+  EXPECT_LE(records[1].timestamp, records[2].timestamp);
+  EXPECT_EQ(42U, records[0].message_id);
+  EXPECT_EQ(101, records[0].message_type);
+  EXPECT_EQ(FlightRecorder::Prefix(source_id), records[0].source);
+  EXPECT_EQ(FlightRecorder::Prefix(destination_id), records[0].destination);
+  EXPECT_EQ(7U, records[1].next_hop);
+  EXPECT_EQ(static_cast<uint8_t>(DropReason::kHopsToLive), records[2].drop_reason);
+
+  fs::path path(fs::temp_directory_path() / fs::unique_path("flight_recorder_%%%%-%%%%.bin"));
+  ASSERT_TRUE(FlightRecorder::Dump(path, node));
+  std::ifstream stream(path.string(), std::ios::binary);
+  FlightRecordHeader header;
+  ASSERT_TRUE(stream.read(reinterpret_cast<char*>(&header), sizeof(header)).good());
+  EXPECT_EQ(FlightRecordHeader::kMagic, header.magic);
+  EXPECT_EQ(sizeof(FlightRecord), header.record_size);
+  EXPECT_EQ(3U, header.record_count);
+  FlightRecord record;
+  ASSERT_TRUE(stream.read(reinterpret_cast<char*>(&record), sizeof(record)).good());
+  EXPECT_EQ(42U, record.message_id);
+  stream.close();
+  boost::system::error_code error_code;
+  fs::remove(path, error_code);
+}
+
+TEST(FlightRecorderTest, BEH_RingWrap) {
+  uint64_t node(RandomNode());
+  const uint32_t kOverflow(10);
+  std::thread writer([node, kOverflow] {
+    for (uint32_t i(0); i != FlightRecorder::kRingSize + kOverflow; ++i)
+      FlightRecorder::Add(MakeRecord(node, i));
+  });
+  writer.join();
+
+  // The exited thread's ring is still dumped, holding only its most recent records.
+  auto records(FlightRecorder::Records(node));
+  ASSERT_EQ(FlightRecorder::kRingSize, records.size());
+  EXPECT_EQ(kOverflow, records.front().message_id);
+  EXPECT_EQ(FlightRecorder::kRingSize + kOverflow - 1, records.back().message_id);
+}
+
+TEST(FlightRecorderTest, BEH_ConcurrentWriters) {
+  uint64_t node(RandomNode());
+  const uint32_t kThreadCount(4), kRecordsPerThread(1000);
+  std::atomic<uint32_t> started(0);
+  std::vector<std::thread> writers;
+  for (uint32_t i(0); i != kThreadCount; ++i) {
+    writers.emplace_back([node, i, kThreadCount, kRecordsPerThread, &started] {
+      // Hold every writer until all have taken a ring, so that none reuses another's ring.
+      FlightRecorder::Add(MakeRecord(node, i * kRecordsPerThread));
+      ++started;
+      while (started != kThreadCount)
+        std::this_thread::yield();
+      for (uint32_t j(1); j != kRecordsPerThread; ++j)
+        FlightRecorder::Add(MakeRecord(node, i * kRecordsPerThread + j));
+    });
+  }
+  // Reading while the writers run must only ever yield whole records.
+  for (int i(0); i != 10; ++i) {
+    for (const auto& record : FlightRecorder::Records(node))
+      EXPECT_LT(record.message_id, kThreadCount * kRecordsPerThread);
+  }
+  for (auto& writer : writers)
+    writer.join();
+  EXPECT_EQ(kThreadCount * kRecordsPerThread, FlightRecorder::Records(node).size());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
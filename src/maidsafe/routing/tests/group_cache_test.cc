@@ -0,0 +1,134 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/group_cache.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class GroupCacheTest : public testing::Test {
+ protected:
+  GroupCacheTest()
+      : group_cache_ttl_(Parameters::group_cache_ttl),
+        max_group_cache_size_(Parameters::max_group_cache_size) {
+    VirtualClock::Enable();
+    Parameters::group_cache_ttl = std::chrono::seconds(10);
+    Parameters::max_group_cache_size = 3;
+  }
+  ~GroupCacheTest() {
+    Parameters::group_cache_ttl = group_cache_ttl_;
+    Parameters::max_group_cache_size = max_group_cache_size_;
+    VirtualClock::Disable();
+  }
+
+  // Returns an ID sharing the first 'shared_bytes' bytes with 'node_id'.
+  NodeId IdNear(const NodeId& node_id, size_t shared_bytes) {
+    return NodeId(node_id.string().substr(0, shared_bytes) +
+                  RandomString(NodeId::kSize - shared_bytes));
+  }
+
+  std::vector<NodeId> MakeGroup(const NodeId& group_id) {
+    std::vector<NodeId> group;
+    for (unsigned int i(0); i != Parameters::group_size; ++i)
+      group.push_back(IdNear(group_id, 8));
+    return group;
+  }
+
+ private:
+  const std::chrono::steady_clock::duration group_cache_ttl_;
+  const unsigned int max_group_cache_size_;
+};
+
+TEST_F(GroupCacheTest, BEH_AddGetExpire) {
+  GroupCache group_cache;
+  NodeId group_id(NodeId::IdType::kRandomId);
+  std::vector<NodeId> group;
+  EXPECT_FALSE(group_cache.Get(group_id, group));
+
+  auto members(MakeGroup(group_id));
+  group_cache.Add(group_id, members);
+  group_cache.Add(NodeId(NodeId::IdType::kRandomId), std::vector<NodeId>());
+  EXPECT_EQ(1U, group_cache.size());
+  ASSERT_TRUE(group_cache.Get(group_id, group));
+  EXPECT_EQ(members, group);
+
+  VirtualClock::Advance(std::chrono::seconds(9));
+  EXPECT_TRUE(group_cache.Get(group_id, group));
+  VirtualClock::Advance(std::chrono::seconds(1));
+  EXPECT_FALSE(group_cache.Get(group_id, group));
+  EXPECT_EQ(0U, group_cache.size());
+
+  // A zero TTL disables caching.
+  Parameters::group_cache_ttl = std::chrono::steady_clock::duration::zero();
+  group_cache.Add(group_id, members);
+  EXPECT_FALSE(group_cache.Get(group_id, group));
+}
+
+TEST_F(GroupCacheTest, BEH_InvalidateInRange) {
+  GroupCache group_cache;
+  NodeId group_id(NodeId::IdType::kRandomId);
+  auto members(MakeGroup(group_id));
+  group_cache.Add(group_id, members);
+  std::vector<NodeId> group;
+
+  // A change outside the group's range leaves it alone.
+  NodeId far_node(group_id ^ NodeId(std::string(1, '\x80') + std::string(NodeId::kSize - 1, 0)));
+  group_cache.Invalidate(far_node);
+  EXPECT_TRUE(group_cache.Get(group_id, group));
+
+  // A member leaving, or a node joining closer than the furthest member, invalidates the entry.
+  group_cache.Invalidate(members.back());
+  EXPECT_FALSE(group_cache.Get(group_id, group));
+  group_cache.Add(group_id, members);
+  group_cache.Invalidate(IdNear(group_id, 16));
+  EXPECT_FALSE(group_cache.Get(group_id, group));
+}
+
+TEST_F(GroupCacheTest, BEH_EvictsNearestExpiry) {
+  GroupCache group_cache;
+  std::vector<NodeId> group_ids;
+  for (int i(0); i != 4; ++i) {
+    group_ids.push_back(NodeId(NodeId::IdType::kRandomId));
+    group_cache.Add(group_ids.back(), MakeGroup(group_ids.back()));
+    VirtualClock::Advance(std::chrono::seconds(1));
+  }
+  EXPECT_EQ(3U, group_cache.size());
+  std::vector<NodeId> group;
+  EXPECT_FALSE(group_cache.Get(group_ids[0], group));
+  for (int i(1); i != 4; ++i)
+    EXPECT_TRUE(group_cache.Get(group_ids[i], group));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
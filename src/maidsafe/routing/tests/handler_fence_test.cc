@@ -0,0 +1,82 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/handler_fence.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(HandlerFenceTest, BEH_CloseWaitsForRunningHandlers) {
+  HandlerFence fence;
+  std::promise<void> entered, release;
+  std::shared_future<void> released(release.get_future());
+  std::thread handler([&] {
+    HandlerFence::Scope scope(fence);
+    EXPECT_TRUE(scope.entered());
+    entered.set_value();
+    released.wait();
+  });
+  entered.get_future().wait();
+
+  auto closed(std::async(std::launch::async, [&] { fence.Close(); }));
+  EXPECT_EQ(std::future_status::timeout, closed.wait_for(std::chrono::milliseconds(100)));
+  EXPECT_TRUE(fence.closed());
+  release.set_value();
+  EXPECT_EQ(std::future_status::ready, closed.wait_for(std::chrono::seconds(10)));
+  handler.join();
+}
+
+TEST(HandlerFenceTest, BEH_ClosedFenceTurnsHandlersAway) {
+  HandlerFence fence;
+  {
+    HandlerFence::Scope scope(fence);
+    EXPECT_TRUE(scope.entered());
+  }
+  fence.Close();
+  HandlerFence::Scope scope(fence);
+  EXPECT_FALSE(scope.entered());
+  // Closing again, or with a Scope which wasn't entered still held, returns at once.
+  fence.Close();
+}
+
+TEST(HandlerFenceTest, BEH_HandlerClosesItsOwnFence) {
+  HandlerFence fence;
+  auto closed(std::async(std::launch::async, [&] {
+    HandlerFence::Scope outer(fence);
+    HandlerFence::Scope inner(fence);
+    EXPECT_TRUE(inner.entered());
+    fence.Close();
+  }));
+  EXPECT_EQ(std::future_status::ready, closed.wait_for(std::chrono::seconds(10)));
+  EXPECT_TRUE(fence.closed());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
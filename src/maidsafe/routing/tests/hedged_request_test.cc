@@ -0,0 +1,166 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/hedged_request.h"
+#include "maidsafe/routing/latency_tracker.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class HedgedRequestTest : public testing::Test {
+ protected:
+  HedgedRequestTest()
+      : kHedgeDelayPercentile_(Parameters::hedge_delay_percentile),
+        kHedgeMinDelay_(Parameters::hedge_min_delay),
+        kHedgeInitialDelay_(Parameters::hedge_initial_delay),
+        asio_service_(1),
+        latency_tracker_(100),
+        mutex_(),
+        responses_() {
+    Parameters::hedge_delay_percentile = 95;
+    Parameters::hedge_min_delay = std::chrono::milliseconds(10);
+    Parameters::hedge_initial_delay = std::chrono::seconds(10);
+  }
+  ~HedgedRequestTest() {
+    Parameters::hedge_delay_percentile = kHedgeDelayPercentile_;
+    Parameters::hedge_min_delay = kHedgeMinDelay_;
+    Parameters::hedge_initial_delay = kHedgeInitialDelay_;
+  }
+
+  void AddLatencySamples(std::chrono::steady_clock::duration latency) {
+    for (size_t i(0); i != HedgedRequest::kMinLatencySamples; ++i)
+      latency_tracker_.Add(latency);
+  }
+
+  std::shared_ptr<HedgedRequest> MakeRequest() {
+    return std::make_shared<HedgedRequest>(asio_service_.service(), latency_tracker_,
+                                           [this](std::string response) {
+                                             std::lock_guard<std::mutex> lock(mutex_);
+                                             responses_.push_back(response);
+                                           });
+  }
+
+  std::vector<std::string> responses() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return responses_;
+  }
+
+  const unsigned int kHedgeDelayPercentile_;
+  const std::chrono::steady_clock::duration kHedgeMinDelay_, kHedgeInitialDelay_;
+  AsioService asio_service_;
+  LatencyTracker latency_tracker_;
+  std::mutex mutex_;
+  std::vector<std::string> responses_;
+};
+
+TEST_F(HedgedRequestTest, BEH_Delay) {
+  // Too few round trips to go on.
+  latency_tracker_.Add(std::chrono::milliseconds(100));
+  EXPECT_EQ(Parameters::hedge_initial_delay, HedgedRequest::Delay(latency_tracker_));
+
+  AddLatencySamples(std::chrono::milliseconds(100));
+  latency_tracker_.Add(std::chrono::seconds(1));
+  EXPECT_EQ(std::chrono::milliseconds(100), HedgedRequest::Delay(latency_tracker_));
+  Parameters::hedge_delay_percentile = 100;
+  EXPECT_EQ(std::chrono::seconds(1), HedgedRequest::Delay(latency_tracker_));
+  Parameters::hedge_min_delay = std::chrono::seconds(2);
+  EXPECT_EQ(std::chrono::seconds(2), HedgedRequest::Delay(latency_tracker_));
+}
+
+TEST_F(HedgedRequestTest, BEH_HedgesAfterPercentileDelay) {
+  const auto kDelay(std::chrono::milliseconds(200));
+  AddLatencySamples(kDelay);
+  std::promise<std::chrono::steady_clock::time_point> copy_sent;
+  auto copy_sent_future(copy_sent.get_future());
+  auto request(MakeRequest());
+  auto start(std::chrono::steady_clock::now());
+  request->Hedge([&] { copy_sent.set_value(std::chrono::steady_clock::now()); });
+
+  EXPECT_EQ(std::future_status::timeout, copy_sent_future.wait_for(kDelay / 2));
+  EXPECT_FALSE(request->hedged());
+  ASSERT_EQ(std::future_status::ready, copy_sent_future.wait_for(std::chrono::seconds(5)));
+  EXPECT_GE(copy_sent_future.get() - start, kDelay);
+  EXPECT_TRUE(request->hedged());
+  EXPECT_TRUE(responses().empty());
+}
+
+TEST_F(HedgedRequestTest, BEH_FirstResponseWins) {
+  AddLatencySamples(std::chrono::milliseconds(20));
+  std::promise<void> copy_sent;
+  auto copy_sent_future(copy_sent.get_future());
+  auto request(MakeRequest());
+  request->Hedge([&] { copy_sent.set_value(); });
+  ASSERT_EQ(std::future_status::ready, copy_sent_future.wait_for(std::chrono::seconds(5)));
+
+  // Either copy may be answered first; the response to the other arrives late and is dropped.
+  request->OnResponse("first");
+  request->OnResponse("late");
+  EXPECT_EQ(std::vector<std::string>(1, "first"), responses());
+  EXPECT_EQ(HedgedRequest::kMinLatencySamples + 1, latency_tracker_.size());
+}
+
+TEST_F(HedgedRequestTest, BEH_ResponseCancelsHedge) {
+  const auto kDelay(std::chrono::milliseconds(50));
+  AddLatencySamples(kDelay);
+  std::atomic<bool> copy_sent(false);
+  auto request(MakeRequest());
+  request->Hedge([&] { copy_sent = true; });
+  request->OnResponse("response");
+  std::this_thread::sleep_for(kDelay * 3);
+  EXPECT_FALSE(copy_sent);
+  EXPECT_FALSE(request->hedged());
+  EXPECT_EQ(std::vector<std::string>(1, "response"), responses());
+
+  // A request answered before it could be hedged isn't.
+  request = MakeRequest();
+  request->OnResponse("response");
+  request->Hedge([&] { copy_sent = true; });
+  std::this_thread::sleep_for(kDelay * 3);
+  EXPECT_FALSE(copy_sent);
+}
+
+TEST_F(HedgedRequestTest, BEH_TimeoutNotSampled) {
+  auto request(MakeRequest());
+  request->Hedge([] {});  // NOLINT
+  request->OnResponse("");
+  EXPECT_EQ(std::vector<std::string>(1, ""), responses());
+  EXPECT_EQ(0U, latency_tracker_.size());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
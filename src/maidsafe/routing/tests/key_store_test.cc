@@ -0,0 +1,82 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <memory>
+
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/key_store.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(KeyStoreTest, BEH_Fingerprint) {
+  auto public_key(asymm::GenerateKeyPair().public_key);
+  asymm::PublicKey copy(public_key);
+  EXPECT_EQ(Fingerprint(public_key), Fingerprint(copy));
+  EXPECT_NE(Fingerprint(public_key), Fingerprint(asymm::GenerateKeyPair().public_key));
+  EXPECT_EQ(KeyFingerprintHash()(Fingerprint(public_key)), KeyFingerprintHash()(Fingerprint(copy)));
+}
+
+TEST(KeyStoreTest, BEH_InternSharesKeys) {
+  KeyStore key_store;
+  auto public_key(asymm::GenerateKeyPair().public_key);
+  EXPECT_FALSE(key_store.Find(Fingerprint(public_key)));
+
+  auto first(key_store.Intern(public_key));
+  auto second(key_store.Intern(asymm::PublicKey(public_key)));
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first, second);
+  EXPECT_TRUE(asymm::MatchingKeys(public_key, *first));
+  EXPECT_EQ(first, key_store.Find(Fingerprint(public_key)));
+
+  auto other(key_store.Intern(asymm::GenerateKeyPair().public_key));
+  EXPECT_NE(first, other);
+  EXPECT_EQ(2, key_store.size());
+
+  // The store doesn't keep keys alive by itself.
+  first.reset();
+  EXPECT_EQ(2, key_store.size());
+  second.reset();
+  EXPECT_EQ(1, key_store.size());
+  EXPECT_FALSE(key_store.Find(Fingerprint(public_key)));
+  other.reset();
+  EXPECT_EQ(0, key_store.size());
+}
+
+TEST(KeyStoreTest, BEH_PurgeReleasedKeys) {
+  KeyStore key_store;
+  auto kept(key_store.Intern(asymm::GenerateKeyPair().public_key));
+  // Enough short-lived keys to trigger at least one purge of the released entries.
+  const size_t kCount(100);
+  for (size_t i(0); i != kCount; ++i)
+    key_store.Intern(asymm::GenerateKeyPair().public_key);
+  EXPECT_EQ(1, key_store.size());
+  EXPECT_LT(key_store.keys_.size(), kCount);
+  EXPECT_EQ(kept, key_store.Intern(*kept));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,60 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/latency_tracker.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(LatencyTrackerTest, BEH_Percentile) {
+  LatencyTracker latency_tracker(100);
+  EXPECT_EQ(0U, latency_tracker.size());
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(), latency_tracker.Percentile(95));
+
+  for (int i(100); i != 0; --i)
+    latency_tracker.Add(std::chrono::milliseconds(i));
+  EXPECT_EQ(100U, latency_tracker.size());
+  EXPECT_EQ(std::chrono::milliseconds(1), latency_tracker.Percentile(0));
+  EXPECT_EQ(std::chrono::milliseconds(51), latency_tracker.Percentile(50));
+  EXPECT_EQ(std::chrono::milliseconds(96), latency_tracker.Percentile(95));
+  EXPECT_EQ(std::chrono::milliseconds(100), latency_tracker.Percentile(100));
+  EXPECT_EQ(std::chrono::milliseconds(100), latency_tracker.Percentile(1000));
+}
+
+TEST(LatencyTrackerTest, BEH_OldestSamplesReplaced) {
+  LatencyTracker latency_tracker(10);
+  for (int i(0); i != 10; ++i)
+    latency_tracker.Add(std::chrono::seconds(10));
+  for (int i(0); i != 10; ++i)
+    latency_tracker.Add(std::chrono::milliseconds(5));
+  EXPECT_EQ(10U, latency_tracker.size());
+  EXPECT_EQ(std::chrono::milliseconds(5), latency_tracker.Percentile(100));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -17,6 +17,8 @@
     use of the MaidSafe Software.                                                                 */
 
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/utils.h"
@@ -43,6 +45,26 @@ namespace routing {
 
 namespace test {
 
+namespace {
+
+// Sets Parameters::copy_message_contents for its lifetime, even if an assertion fails.
+class ScopedCopyMessageContents {
+ public:
+  explicit ScopedCopyMessageContents(bool copy)
+      : kPrevious_(Parameters::copy_message_contents) {
+    Parameters::copy_message_contents = copy;
+  }
+  ~ScopedCopyMessageContents() { Parameters::copy_message_contents = kPrevious_; }
+
+ private:
+  ScopedCopyMessageContents(const ScopedCopyMessageContents&);
+  ScopedCopyMessageContents& operator=(const ScopedCopyMessageContents&);
+
+  const bool kPrevious_;
+};
+
+}  // unnamed namespace
+
 class MessageHandlerTest : public testing::Test {
  public:
   MessageHandlerTest()
@@ -59,8 +81,12 @@ class MessageHandlerTest : public testing::Test {
         service_(),
         response_handler_(),
         network_network_(),
-        public_key_holder_(asio_service_, *network_),
-        close_info_() {
+        key_store_(),
+        public_key_holder_(asio_service_, *network_, key_store_),
+        close_info_(),
+        kUpcallThreads_(Parameters::upcall_threads) {
+    // Run upcalls inline, so that mock expectations are met before HandleMessage returns.
+    Parameters::upcall_threads = 0;
     message_and_caching_functor_.message_received = [this](const std::string& message,
                                                            ReplyFunctor reply_functor) {
       MessageReceived(message);
@@ -79,6 +105,8 @@ class MessageHandlerTest : public testing::Test {
     table_->AddNode(close_info_);
   }
 
+  ~MessageHandlerTest() { Parameters::upcall_threads = kUpcallThreads_; }
+
   void MessageReceived(const std::string& /*message*/) {
     {
       std::lock_guard<std::mutex> lock(mutex_);
@@ -103,8 +131,10 @@ class MessageHandlerTest : public testing::Test {
   std::shared_ptr<MockService> service_;
   std::shared_ptr<MockResponseHandler> response_handler_;
   std::shared_ptr<NetworkUtils> network_network_;
+  KeyStore key_store_;
   PublicKeyHolder public_key_holder_;
   NodeInfo close_info_;
+  const unsigned int kUpcallThreads_;
 };
 
 TEST_F(MessageHandlerTest, BEH_HandleInvalidMessage) {
@@ -631,6 +661,61 @@ TEST_F(MessageHandlerTest, BEH_HandleNodeLevelMessage) {
   }
 }
 
+TEST_F(MessageHandlerTest, BEH_ShareTypedMessageContents) {
+  MessageHandler message_handler(*table_, *ntable_, *network_, timer_, *network_network_,
+                                 asio_service_);
+  message_handler.service_ = service_;
+  message_handler.response_handler_ = response_handler_;
+  EXPECT_CALL(*network_, SendToClosestNode(testing::_)).Times(testing::AnyNumber());
+  std::vector<SingleToSingleMessage> received;
+  TypedMessageAndCachingFunctor functors;
+  functors.single_to_single.message_received = [&](const SingleToSingleMessage& message) {
+    received.push_back(message);
+  };
+  message_handler.set_typed_message_and_caching_functor(functors);
+  const std::string kContents(RandomString(1024 * 1024));
+  auto make_message([&]()->protobuf::Message {
+    protobuf::Message message;
+    message.set_hops_to_live(1);
+    message.set_routing_message(false);
+    message.set_direct(true);
+    message.set_request(true);
+    message.set_client_node(false);
+    message.set_source_id(NodeId(NodeId::IdType::kRandomId).string());
+    message.set_destination_id(table_->kNodeId().string());
+    message.set_id(RandomUint32() % 10000);
+    message.add_data(kContents);
+    return message;
+  });
+
+  {
+    // When copying, the payload is held in 'contents' alone, so editing that changes what is sent
+    // on.
+    ScopedCopyMessageContents copy(true);
+    auto copied(make_message());
+    message_handler.HandleMessage(copied);
+    ASSERT_EQ(1U, received.size());
+    EXPECT_EQ(kContents, received.back().contents);
+    EXPECT_TRUE(received.back().shared_contents == nullptr);
+    EXPECT_EQ(kContents, received.back().payload());
+    SingleToSingleMessage edited(received.back());
+    edited.contents = "edited";
+    EXPECT_EQ("edited", edited.payload());
+  }
+  {
+    // Otherwise the upper layer gets the very buffer the message was parsed into.
+    ScopedCopyMessageContents copy(false);
+    auto shared(make_message());
+    const char* const kReceiveBuffer(shared.data(0).data());
+    message_handler.HandleMessage(shared);
+    ASSERT_EQ(2U, received.size());
+    EXPECT_TRUE(received.back().contents.empty());
+    ASSERT_TRUE(received.back().shared_contents != nullptr);
+    EXPECT_EQ(kContents, received.back().payload());
+    EXPECT_EQ(kReceiveBuffer, received.back().shared_contents->data());
+  }
+}
+
 TEST_F(MessageHandlerTest, BEH_ClientRoutingTable) {
   auto maid(passport::CreateMaidAndSigner().first);
   asymm::Keys keys;
@@ -0,0 +1,158 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/rudp/return_codes.h"
+
+#include "maidsafe/routing/message_lanes.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(MessageLanesTest, BEH_ClassifyMessage) {
+  protobuf::Message message;
+  message.set_source_id(std::string(64, 's'));
+  message.set_destination_id(std::string(64, 'd'));
+  message.set_routing_message(true);
+  message.add_data(std::string(100000, 'a'));
+  message.set_direct(true);
+  message.set_type(8);
+  message.set_client_node(false);
+  message.set_request(false);
+  message.set_hops_to_live(10);
+  EXPECT_EQ(MessageLane::kControl, ClassifyMessage(message));
+  EXPECT_EQ(MessageLane::kControl, ClassifyMessage(message.SerializeAsString()));
+
+  message.set_routing_message(false);
+  message.set_type(101);
+  EXPECT_EQ(MessageLane::kData, ClassifyMessage(message));
+  EXPECT_EQ(MessageLane::kData, ClassifyMessage(message.SerializeAsString()));
+
+  // Relay messages have no source ID.
+  message.clear_source_id();
+  message.set_routing_message(true);
+  EXPECT_EQ(MessageLane::kControl, ClassifyMessage(message.SerializeAsString()));
+
+  // Malformed input is classed as data.
+  std::string serialised(message.SerializeAsString());
+  EXPECT_EQ(MessageLane::kData, ClassifyMessage(std::string()));
+  EXPECT_EQ(MessageLane::kData, ClassifyMessage(serialised.substr(0, 10)));
+  EXPECT_EQ(MessageLane::kData, ClassifyMessage(std::string(8, '\xff')));
+}
+
+TEST(MessageLanesTest, BEH_WeightedPriority) {
+  const unsigned int kWeight(Parameters::control_lane_weight);
+  Parameters::control_lane_weight = 2;
+  PriorityLanes<int> lanes;
+  int item(0);
+  EXPECT_FALSE(lanes.Pop(item));
+  for (int i(0); i != 3; ++i)
+    lanes.Push(MessageLane::kData, i);
+  for (int i(10); i != 15; ++i)
+    lanes.Push(MessageLane::kControl, i);
+  EXPECT_EQ(5U, lanes.size(MessageLane::kControl));
+  EXPECT_EQ(3U, lanes.size(MessageLane::kData));
+
+  std::vector<int> popped;
+  while (lanes.Pop(item))
+    popped.push_back(item);
+  EXPECT_EQ(std::vector<int>({10, 11, 0, 12, 13, 1, 14, 2}), popped);
+
+  // With a weight of 0, control messages have strict priority.
+  Parameters::control_lane_weight = 0;
+  lanes.Push(MessageLane::kData, 0);
+  lanes.Push(MessageLane::kControl, 10);
+  lanes.Push(MessageLane::kControl, 11);
+  lanes.Push(MessageLane::kControl, 12);
+  popped.clear();
+  while (lanes.Pop(item))
+    popped.push_back(item);
+  EXPECT_EQ(std::vector<int>({10, 11, 12, 0}), popped);
+  Parameters::control_lane_weight = kWeight;
+}
+
+TEST(MessageLanesTest, BEH_PeerSendQueue) {
+  const unsigned int kLimit(Parameters::max_data_sends_per_peer),
+      kHeldLimit(Parameters::max_held_data_sends_per_peer);
+  Parameters::max_data_sends_per_peer = 2;
+  Parameters::max_held_data_sends_per_peer = 2;
+  PeerSendQueue peer_send_queue;
+  NodeId peer(NodeId::IdType::kRandomId), other_peer(NodeId::IdType::kRandomId);
+  std::vector<std::string> sent;
+  std::vector<rudp::MessageSentFunctor> in_flight;
+  std::vector<int> results;
+  auto send([&](const NodeId& peer_id, MessageLane lane, const std::string& name) {
+    peer_send_queue.Send(peer_id, lane, [&sent, &in_flight, name](
+                             const rudp::MessageSentFunctor& message_sent_functor) {
+                           sent.push_back(name);
+                           in_flight.push_back(message_sent_functor);
+                         },
+                         [&results](int result) { results.push_back(result); });
+  });
+
+  // Data beyond the limit is held, but control messages and other peers aren't affected.
+  send(peer, MessageLane::kData, "data0");
+  send(peer, MessageLane::kData, "data1");
+  send(peer, MessageLane::kData, "data2");
+  send(peer, MessageLane::kData, "data3");
+  send(peer, MessageLane::kControl, "control");
+  send(other_peer, MessageLane::kData, "other");
+  EXPECT_EQ(std::vector<std::string>({"data0", "data1", "control", "other"}), sent);
+  EXPECT_EQ(2U, peer_send_queue.queued(peer));
+  EXPECT_EQ(0U, peer_send_queue.queued(other_peer));
+
+  // Data beyond the held limit fails at once, distinguishably from a transport failure.
+  send(peer, MessageLane::kData, "data4");
+  EXPECT_EQ(4U, sent.size());
+  EXPECT_EQ(2U, peer_send_queue.queued(peer));
+  EXPECT_EQ(std::vector<int>({kSendQueueFull}), results);
+  results.clear();
+
+  // Completing a send releases the next held message, in order.
+  in_flight.at(0)(rudp::kSuccess);
+  EXPECT_EQ("data2", sent.back());
+  EXPECT_EQ(1U, peer_send_queue.queued(peer));
+  EXPECT_EQ(std::vector<int>({rudp::kSuccess}), results);
+
+  // Removing the peer hands its held messages to the transport.
+  peer_send_queue.Remove(peer);
+  EXPECT_EQ("data3", sent.back());
+  EXPECT_EQ(0U, peer_send_queue.queued(peer));
+  for (size_t i(1); i != in_flight.size(); ++i)
+    in_flight.at(i)(rudp::kSendFailure);
+  EXPECT_EQ(6U, results.size());
+  Parameters::max_data_sends_per_peer = kLimit;
+  Parameters::max_held_data_sends_per_peer = kHeldLimit;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -39,6 +39,10 @@ class MockNetwork : public Network {
   virtual ~MockNetwork();
 
   MOCK_METHOD1(SendToClosestNode, void(const protobuf::Message& message));
+  // Expectations are set on the overload above whether or not a RouteDecision is passed.
+  virtual void SendToClosestNode(const protobuf::Message& message, const RouteDecision&) {
+    SendToClosestNode(message);
+  }
   MOCK_METHOD1(MarkConnectionAsValid, int(const NodeId& peer_id));
   MOCK_METHOD3(SendToDirect, void(protobuf::Message& message, const NodeId& peer,
                                   const NodeId& connection));
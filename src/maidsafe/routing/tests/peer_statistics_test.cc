@@ -0,0 +1,97 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/peer_statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(PeerStatisticsTest, BEH_SmoothedRoundTripTime) {
+  PeerStatistics peer_statistics;
+  NodeId peer(NodeId::IdType::kRandomId);
+  // Sends to untracked peers aren't counted.
+  peer_statistics.AddSendStart(peer);
+  EXPECT_TRUE(peer_statistics.entries_.empty());
+
+  peer_statistics.Add(peer);
+  peer_statistics.AddSendStart(peer);
+  EXPECT_EQ(1U, peer_statistics.entries_[peer].outstanding_sends);
+  // Completing a send releases the outstanding count; only hop acks are sampled.
+  peer_statistics.AddSendResult(peer);
+  EXPECT_EQ(0U, peer_statistics.entries_[peer].outstanding_sends);
+  EXPECT_FALSE(peer_statistics.entries_[peer].sampled);
+  peer_statistics.AddRoundTrip(peer, std::chrono::milliseconds(80));
+  EXPECT_EQ(std::chrono::microseconds(80000), peer_statistics.entries_[peer].smoothed_round_trip);
+  peer_statistics.AddRoundTrip(peer, std::chrono::milliseconds(160));
+  EXPECT_EQ(std::chrono::microseconds(90000), peer_statistics.entries_[peer].smoothed_round_trip);
+
+  peer_statistics.Remove(peer);
+  EXPECT_TRUE(peer_statistics.entries_.empty());
+  // A send or ack still in flight when the peer was removed mustn't bring it back.
+  peer_statistics.AddSendStart(peer);
+  peer_statistics.AddSendResult(peer);
+  peer_statistics.AddRoundTrip(peer, std::chrono::milliseconds(1));
+  EXPECT_TRUE(peer_statistics.entries_.empty());
+}
+
+TEST(PeerStatisticsTest, BEH_SelectLowestCost) {
+  PeerStatistics peer_statistics;
+  std::vector<NodeId> peers;
+  for (int i(0); i != 3; ++i)
+    peers.push_back(NodeId(NodeId::IdType::kRandomId));
+
+  EXPECT_EQ(0U, peer_statistics.SelectLowestCost(std::vector<NodeId>()));
+  // No samples - the first (XOR-closest) candidate is preferred.
+  EXPECT_EQ(0U, peer_statistics.SelectLowestCost(peers));
+
+  for (const auto& peer : peers) {
+    peer_statistics.Add(peer);
+    peer_statistics.AddSendStart(peer);
+  }
+  peer_statistics.AddSendResult(peers[0]);
+  peer_statistics.AddSendResult(peers[1]);
+  peer_statistics.AddSendResult(peers[2]);
+  peer_statistics.AddRoundTrip(peers[0], std::chrono::milliseconds(300));
+  peer_statistics.AddRoundTrip(peers[1], std::chrono::milliseconds(20));
+  peer_statistics.AddRoundTrip(peers[2], std::chrono::milliseconds(50));
+  EXPECT_EQ(1U, peer_statistics.SelectLowestCost(peers));
+
+  // Queue depth on the fastest peer pushes traffic to the next best one.
+  for (int i(0); i != 3; ++i)
+    peer_statistics.AddSendStart(peers[1]);
+  EXPECT_EQ(2U, peer_statistics.SelectLowestCost(peers));
+
+  // An unmeasured peer is costed at the best measured round trip time, so gets probed.
+  peers.push_back(NodeId(NodeId::IdType::kRandomId));
+  EXPECT_EQ(3U, peer_statistics.SelectLowestCost(peers));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,116 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/peer_trie.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+PeerView MakePeer(const NodeId& node_id) {
+  PeerView peer;
+  peer.id = node_id;
+  peer.connection_id = node_id;
+  return peer;
+}
+
+}  // unnamed namespace
+
+TEST(PeerTrieTest, BEH_InsertFindErase) {
+  PeerTrie peer_trie;
+  EXPECT_TRUE(peer_trie.empty());
+  NodeId node_id(NodeId::IdType::kRandomId);
+  EXPECT_EQ(nullptr, peer_trie.Find(node_id));
+  EXPECT_FALSE(peer_trie.Erase(node_id));
+
+  EXPECT_TRUE(peer_trie.Insert(MakePeer(node_id)));
+  EXPECT_FALSE(peer_trie.Insert(MakePeer(node_id)));
+  EXPECT_EQ(1U, peer_trie.size());
+  ASSERT_NE(nullptr, peer_trie.Find(node_id));
+  EXPECT_EQ(node_id, peer_trie.Find(node_id)->id);
+
+  std::vector<NodeId> node_ids;
+  for (int i(0); i != 100; ++i) {
+    node_ids.push_back(NodeId(NodeId::IdType::kRandomId));
+    EXPECT_TRUE(peer_trie.Insert(MakePeer(node_ids.back())));
+  }
+  EXPECT_EQ(101U, peer_trie.size());
+  EXPECT_EQ(nullptr, peer_trie.Find(NodeId(NodeId::IdType::kRandomId)));
+
+  EXPECT_TRUE(peer_trie.Erase(node_id));
+  EXPECT_FALSE(peer_trie.Erase(node_id));
+  EXPECT_EQ(nullptr, peer_trie.Find(node_id));
+  for (const auto& remaining_id : node_ids) {
+    ASSERT_NE(nullptr, peer_trie.Find(remaining_id));
+    EXPECT_TRUE(peer_trie.Erase(remaining_id));
+  }
+  EXPECT_TRUE(peer_trie.empty());
+}
+
+TEST(PeerTrieTest, BEH_GetClosestMatchesSort) {
+  PeerTrie peer_trie;
+  std::vector<NodeId> node_ids;
+  for (int i(0); i != 500; ++i) {
+    node_ids.push_back(NodeId(NodeId::IdType::kRandomId));
+    peer_trie.Insert(MakePeer(node_ids.back()));
+  }
+  // Erasing some keeps the collapsed paths consistent.
+  for (int i(0); i != 100; ++i) {
+    EXPECT_TRUE(peer_trie.Erase(node_ids.back()));
+    node_ids.pop_back();
+  }
+
+  std::vector<PeerView> peers;
+  for (int i(0); i != 50; ++i) {
+    // Targets are both held ids and arbitrary ones.
+    NodeId target(i % 2 ? node_ids.at(i) : NodeId(NodeId::IdType::kRandomId));
+    std::sort(node_ids.begin(), node_ids.end(), [&](const NodeId& lhs, const NodeId& rhs) {
+      return NodeId::CloserToTarget(lhs, rhs, target);
+    });
+    for (size_t count : {size_t(1), size_t(17), node_ids.size(), node_ids.size() + 1}) {
+      peers.clear();
+      peer_trie.GetClosest(target, count, peers);
+      ASSERT_EQ(std::min(count, node_ids.size()), peers.size());
+      for (size_t j(0); j != peers.size(); ++j)
+        EXPECT_EQ(node_ids[j], peers[j].id);
+    }
+  }
+
+  // Results are appended.
+  peers.assign(1, PeerView());
+  peer_trie.GetClosest(node_ids.front(), 2, peers);
+  EXPECT_EQ(3U, peers.size());
+  peer_trie.GetClosest(node_ids.front(), 0, peers);
+  EXPECT_EQ(3U, peers.size());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
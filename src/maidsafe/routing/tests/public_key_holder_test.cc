@@ -40,7 +40,7 @@ TEST(PublicKeyHolderTest, BEH_AddFindRemoveTimeout) {
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
   Network network(routing_table, client_routing_table, acknowledgment);
-  PublicKeyHolder public_key_holder(asio_service, network);
+  PublicKeyHolder public_key_holder(asio_service, network, routing_table.key_store());
 
   EXPECT_FALSE(public_key_holder.Find(NodeId(NodeId::IdType::kRandomId)));
 
@@ -65,7 +65,7 @@ TEST(PublicKeyHolderTest, BEH_MultipleAddFindRemove) {
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
   Network network(routing_table, client_routing_table, acknowledgment);
-  PublicKeyHolder public_key_holder(asio_service, network);
+  PublicKeyHolder public_key_holder(asio_service, network, routing_table.key_store());
   std::vector<NodeInfoAndPrivateKey> nodes_details;
   const size_t kIterations(100);
   std::vector<std::future<bool>> futures;
@@ -140,7 +140,7 @@ TEST(PublicKeyHolderTest, BEH_MultipleAddFindTimeout) {
   ClientRoutingTable client_routing_table(node_details.node_info.id);
   Acknowledgement acknowledgment(node_details.node_info.id, asio_service);
   Network network(routing_table, client_routing_table, acknowledgment);
-  PublicKeyHolder public_key_holder(asio_service, network);
+  PublicKeyHolder public_key_holder(asio_service, network, routing_table.key_store());
   std::vector<NodeInfoAndPrivateKey> nodes_details;
   const size_t kIterations(100);
   std::vector<std::future<bool>> futures;
@@ -0,0 +1,108 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifdef MAIDSAFE_LINUX
+#include <sched.h>
+#endif
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/routing_access.h"
+#include "maidsafe/routing/routing_host.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class RoutingHostTest : public testing::Test {
+ protected:
+  static AsioService& NextAsioService(RoutingHost& host) {
+    return RoutingAccess::NextAsioService(host);
+  }
+};
+
+TEST_F(RoutingHostTest, BEH_AssignsServicesInTurn) {
+  RoutingHost host(std::vector<unsigned int>(3, 0));
+  std::set<AsioService*> assigned;
+  AsioService* first(&NextAsioService(host));
+  assigned.insert(first);
+  assigned.insert(&NextAsioService(host));
+  assigned.insert(&NextAsioService(host));
+  EXPECT_EQ(3U, assigned.size());
+  EXPECT_EQ(first, &NextAsioService(host));
+
+  RoutingHost pool(2);
+  EXPECT_EQ(&NextAsioService(pool), &NextAsioService(pool));
+  EXPECT_EQ(0U, pool.pinned_thread_count());
+}
+
+TEST_F(RoutingHostTest, BEH_UsesEmbedderServices) {
+  auto asio_service(std::make_shared<AsioService>(1));
+  {
+    RoutingHost host(std::vector<std::shared_ptr<AsioService>>(1, asio_service));
+    EXPECT_EQ(asio_service.get(), &NextAsioService(host));
+    EXPECT_EQ(0U, host.pinned_thread_count());
+  }
+  std::promise<void> ran;
+  asio_service->service().post([&ran] { ran.set_value(); });
+  EXPECT_EQ(std::future_status::ready, ran.get_future().wait_for(std::chrono::seconds(5)))
+      << "Destroying the host must not stop the embedder's service.";
+
+  EXPECT_THROW(RoutingHost(std::vector<std::shared_ptr<AsioService>>()), std::exception);
+  EXPECT_THROW(RoutingHost(std::vector<std::shared_ptr<AsioService>>(1)), std::exception);
+  EXPECT_THROW(RoutingHost(std::vector<unsigned int>()), std::exception);
+}
+
+#ifdef MAIDSAFE_LINUX
+TEST_F(RoutingHostTest, BEH_PinsThreadsToCores) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  std::vector<unsigned int> cores;
+  for (unsigned int core(0); core != CPU_SETSIZE && cores.size() != 4; ++core) {
+    if (CPU_ISSET(core, &allowed))
+      cores.push_back(core);
+  }
+  ASSERT_FALSE(cores.empty());
+
+  RoutingHost host(cores);
+  EXPECT_EQ(cores.size(), host.pinned_thread_count());
+  for (const auto& core : cores) {
+    std::promise<int> ran_on;
+    NextAsioService(host).service().post([&ran_on] { ran_on.set_value(sched_getcpu()); });
+    auto future(ran_on.get_future());
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ(static_cast<int>(core), future.get());
+  }
+}
+#endif
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
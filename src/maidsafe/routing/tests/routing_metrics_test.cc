@@ -0,0 +1,126 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/routing_metrics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(RoutingMetricsTest, BEH_Counters) {
+  RoutingMetrics metrics;
+  metrics.AddReceived(1);
+  metrics.AddReceived(101);
+  metrics.AddReceived(101);
+  metrics.AddReceived(55);
+  metrics.AddForwarded(3);
+  metrics.AddDropped(DropReason::kFirewall);
+  metrics.AddDropped(DropReason::kHopsToLive);
+  metrics.AddDropped(DropReason::kHopsToLive);
+  metrics.AddAckRetry();
+  metrics.AddAckTimeout();
+  metrics.AddCacheLookup(true);
+  metrics.AddCacheLookup(false);
+  metrics.AddCacheLookup(false);
+  metrics.AddGroupCacheLookup(true);
+
+  EXPECT_EQ(1U, metrics.received(1));
+  EXPECT_EQ(2U, metrics.received(101));
+  EXPECT_EQ(1U, metrics.received(0));
+  EXPECT_EQ(1U, metrics.forwarded(3));
+  EXPECT_EQ(0U, metrics.forwarded(1));
+  EXPECT_EQ(1U, metrics.dropped(DropReason::kFirewall));
+  EXPECT_EQ(2U, metrics.dropped(DropReason::kHopsToLive));
+  EXPECT_EQ(0U, metrics.dropped(DropReason::kClientToClient));
+  EXPECT_EQ(1U, metrics.ack_retries());
+  EXPECT_EQ(1U, metrics.ack_timeouts());
+  EXPECT_EQ(1U, metrics.cache_hits());
+  EXPECT_EQ(2U, metrics.cache_misses());
+  EXPECT_EQ(1U, metrics.group_cache_hits());
+  EXPECT_EQ(0U, metrics.group_cache_misses());
+
+  std::string snapshot(metrics.Snapshot());
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_messages_received{type=\"NodeLevel\"} 2\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_messages_dropped{reason=\"hops_to_live\"} 2\n"));
+  EXPECT_NE(std::string::npos, snapshot.find("routing_cache_misses 2\n"));
+  EXPECT_NE(std::string::npos, snapshot.find("routing_group_cache_hits 1\n"));
+}
+
+TEST(RoutingMetricsTest, BEH_LogHistogram) {
+  RoutingMetrics metrics;
+  metrics.AddHandleTime(std::chrono::nanoseconds(100));
+  metrics.AddHandleTime(std::chrono::microseconds(1));
+  metrics.AddHandleTime(std::chrono::microseconds(3));
+  metrics.AddHandleTime(std::chrono::microseconds(4));
+  metrics.AddHandleTime(std::chrono::microseconds(5));
+  metrics.AddHandleTime(std::chrono::microseconds(700));
+  metrics.AddHandleTime(std::chrono::hours(1000));
+  EXPECT_EQ(7U, metrics.handle_time().count());
+  EXPECT_EQ(0U, metrics.forward_time().count());
+
+  // Each bucket counts values up to and including its bound.
+  std::string snapshot(metrics.Snapshot());
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"1\"} 2\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"2\"} 2\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"4\"} 4\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"8\"} 5\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"1024\"} 6\n"));
+  EXPECT_NE(std::string::npos,
+            snapshot.find("routing_handle_time_microseconds_bucket{le=\"+Inf\"} 7\n"));
+  EXPECT_NE(std::string::npos, snapshot.find("routing_handle_time_microseconds_count 7\n"));
+}
+
+TEST(RoutingMetricsTest, BEH_ConcurrentUpdates) {
+  RoutingMetrics metrics;
+  const int kThreadCount(8), kIterations(10000);
+  std::vector<std::thread> threads;
+  for (int i(0); i != kThreadCount; ++i) {
+    threads.push_back(std::thread([&] {
+      for (int j(0); j != kIterations; ++j) {
+        metrics.AddReceived(101);
+        metrics.AddForwardTime(std::chrono::microseconds(j));
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(static_cast<uint64_t>(kThreadCount * kIterations), metrics.received(101));
+  EXPECT_EQ(static_cast<uint64_t>(kThreadCount * kIterations), metrics.forward_time().count());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
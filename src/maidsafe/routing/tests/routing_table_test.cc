@@ -16,7 +16,9 @@
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
 
+#include <algorithm>
 #include <bitset>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -66,6 +68,23 @@ TEST(RoutingTableTest, BEH_AddCloseNodes) {
   EXPECT_EQ(Parameters::closest_nodes_size, routing_table.size());
 }
 
+TEST(RoutingTableTest, BEH_RejectDuplicatePublicKey) {
+  RoutingTable routing_table(false, NodeId(NodeId::IdType::kRandomId), asymm::GenerateKeyPair());
+  NodeInfo node(MakeNode());
+  EXPECT_TRUE(routing_table.AddNode(node));
+
+  NodeInfo duplicate(MakeNode());
+  duplicate.public_key = node.public_key;
+  EXPECT_FALSE(routing_table.AddNode(duplicate));
+  EXPECT_EQ(1, routing_table.size());
+
+  // Once the holder of the key has gone, the key can be used again.
+  routing_table.DropNode(node.id, true);
+  EXPECT_TRUE(routing_table.AddNode(duplicate));
+  EXPECT_FALSE(routing_table.AddNode(node));
+  EXPECT_EQ(1, routing_table.size());
+}
+
 TEST(RoutingTableTest, FUNC_AddTooManyNodes) {
   NodeId node_id(NodeId::IdType::kRandomId);
   RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair());
@@ -88,6 +107,51 @@ TEST(RoutingTableTest, FUNC_AddTooManyNodes) {
   EXPECT_EQ(routing_table.size(), Parameters::max_routing_table_size);
 }
 
+TEST(RoutingTableTest, FUNC_EvictFurthestNodeOfFullestBucket) {
+  RoutingTable routing_table(false, NodeId(NodeId::IdType::kRandomId), asymm::GenerateKeyPair());
+  NodeId removed_id;
+  routing_table.InitialiseFunctors([&](const RoutingTableChange& routing_table_change) {
+    removed_id = routing_table_change.removed.node.id;
+  });
+  while (routing_table.size() < Parameters::max_routing_table_size)
+    routing_table.AddNode(MakeNode());
+
+  size_t evictions(0);
+  for (int i(0); i != 500; ++i) {
+    // Drop nodes now and then so that the bucket bookkeeping is exercised on removal as well.
+    if (i % 10 == 0) {
+      routing_table.DropNode(routing_table.RandomConnectedNode(), true);
+      routing_table.AddNode(MakeNode());
+    }
+    auto nodes(routing_table.GetClosestNodes(routing_table.kNodeId(),
+                                             static_cast<unsigned int>(routing_table.size())));
+    // Brute force choice: the furthest node in the fullest bucket, ignoring the closest
+    // unidirectional_interest_range nodes, with ties going to the further bucket.
+    std::map<int32_t, unsigned int> bucket_counts;
+    int32_t max_bucket(0);
+    unsigned int max_bucket_count(1);
+    for (auto itr(std::begin(nodes) + Parameters::unidirectional_interest_range);
+         itr != std::end(nodes); ++itr) {
+      if (++bucket_counts[itr->bucket] >= max_bucket_count) {
+        max_bucket = itr->bucket;
+        max_bucket_count = bucket_counts[itr->bucket];
+      }
+    }
+    auto expected(std::find_if(nodes.rbegin(), nodes.rend(), [max_bucket](const NodeInfo& node) {
+      return node.bucket == max_bucket;
+    }));
+    ASSERT_NE(nodes.rend(), expected);
+
+    removed_id = NodeId();
+    if (routing_table.AddNode(MakeNode()) && !removed_id.IsZero()) {
+      EXPECT_EQ(expected->id, removed_id);
+      ++evictions;
+    }
+    EXPECT_EQ(Parameters::max_routing_table_size, routing_table.size());
+  }
+  EXPECT_NE(0U, evictions);
+}
+
 TEST(RoutingTableTest, BEH_GetNthClosest) {
   std::vector<NodeId> nodes_id;
   NodeId node_id(NodeId::IdType::kRandomId);
@@ -291,6 +355,96 @@ TEST(RoutingTableTest, FUNC_ClosestToId) {
   EXPECT_TRUE(test_unknown_ids());
 }
 
+TEST(RoutingTableTest, BEH_GetClosestPeers) {
+  NodeId own_node_id(NodeId::IdType::kRandomId);
+  RoutingTable routing_table(false, own_node_id, asymm::GenerateKeyPair());
+  std::vector<NodeId> node_ids;
+  std::vector<PeerView> peers;
+  PeerView peer;
+
+  EXPECT_FALSE(routing_table.GetPeer(own_node_id, peer));
+  while (routing_table.size() < Parameters::max_routing_table_size) {
+    NodeInfo node(MakeNode());
+    node_ids.push_back(node.id);
+    EXPECT_TRUE(routing_table.AddNode(node));
+    ASSERT_TRUE(routing_table.GetPeer(node.id, peer));
+    EXPECT_EQ(node.id, peer.id);
+    EXPECT_EQ(node.connection_id, peer.connection_id);
+    EXPECT_NE(NodeInfo::kInvalidBucket, peer.bucket);
+
+    for (const auto& target : {node_ids[RandomUint32() % node_ids.size()],
+                               NodeId(NodeId::IdType::kRandomId)}) {
+      for (bool ignore_exact_match : {false, true}) {
+        auto closest_node(routing_table.GetClosestNode(target, ignore_exact_match));
+        auto closest_peer(routing_table.GetClosestPeer(target, ignore_exact_match));
+        EXPECT_EQ(closest_node.id, closest_peer.id);
+        EXPECT_EQ(closest_node.connection_id, closest_peer.connection_id);
+        EXPECT_EQ(closest_node.bucket, closest_peer.bucket);
+        std::vector<std::string> exclude(1, closest_node.id.string());
+        EXPECT_EQ(routing_table.GetClosestNode(target, ignore_exact_match, exclude).id,
+                  routing_table.GetClosestPeer(target, ignore_exact_match, exclude).id);
+
+        // 'peers' is reused, so stale entries from the previous query must not survive.
+        auto close_nodes(routing_table.GetClosestNodes(target, Parameters::group_size,
+                                                       ignore_exact_match));
+        routing_table.GetClosestPeers(target, Parameters::group_size, peers, ignore_exact_match);
+        ASSERT_EQ(close_nodes.size(), peers.size());
+        for (size_t i(0); i != close_nodes.size(); ++i) {
+          EXPECT_EQ(close_nodes[i].id, peers[i].id);
+          EXPECT_EQ(close_nodes[i].connection_id, peers[i].connection_id);
+        }
+      }
+    }
+  }
+  routing_table.GetClosestPeers(own_node_id, 0, peers);
+  EXPECT_TRUE(peers.empty());
+}
+
+TEST(RoutingTableTest, BEH_GetRouteDecision) {
+  NodeId own_node_id(NodeId::IdType::kRandomId);
+  RoutingTable routing_table(false, own_node_id, asymm::GenerateKeyPair());
+  std::vector<NodeId> node_ids;
+
+  // Compares the single-pass decision with the separate queries it replaces, for targets which are
+  // random, in the table and this node itself, as the table fills up.
+  auto check_decisions = [&]() {
+    std::vector<NodeId> targets(1, own_node_id);
+    targets.push_back(NodeId(NodeId::IdType::kRandomId));
+    if (!node_ids.empty())
+      targets.push_back(node_ids[RandomUint32() % node_ids.size()]);
+    for (const auto& target : targets) {
+      auto route_decision(routing_table.GetRouteDecision(target));
+      EXPECT_EQ(target, route_decision.target);
+      EXPECT_EQ(routing_table.IsThisNodeInRange(target, Parameters::closest_nodes_size),
+                route_decision.in_range);
+      EXPECT_EQ(routing_table.IsThisNodeClosestTo(target), route_decision.closest);
+      EXPECT_EQ(routing_table.Contains(target), route_decision.contains_target);
+      EXPECT_EQ(routing_table.GetClosestNode(target, false).id,
+                route_decision.ClosestNode(false).id);
+      EXPECT_EQ(routing_table.GetClosestNode(target, true).id,
+                route_decision.ClosestNode(true).id);
+      auto close_nodes(routing_table.GetClosestNodes(target, Parameters::group_size + 1));
+      auto decided_close_nodes(route_decision.ClosestNodes(Parameters::group_size + 1));
+      ASSERT_EQ(close_nodes.size(), decided_close_nodes.size());
+      for (size_t i(0); i != close_nodes.size(); ++i)
+        EXPECT_EQ(close_nodes[i].id, decided_close_nodes[i].id);
+      if (!close_nodes.empty()) {
+        std::vector<std::string> exclude(1, close_nodes.front().id.string());
+        EXPECT_EQ(routing_table.GetClosestNode(target, false, exclude).id,
+                  route_decision.ClosestNode(false, exclude).id);
+      }
+    }
+  };
+
+  check_decisions();
+  while (routing_table.size() < Parameters::max_routing_table_size) {
+    NodeInfo node(MakeNode());
+    node_ids.push_back(node.id);
+    EXPECT_TRUE(routing_table.AddNode(node));
+    check_decisions();
+  }
+}
+
 TEST(RoutingTableTest, FUNC_GetRandomExistingNode) {
   NodeId own_node_id(NodeId::IdType::kRandomId);
   RoutingTable routing_table(false, own_node_id, asymm::GenerateKeyPair());
@@ -55,7 +55,7 @@ TEST(ServicesTest, BEH_Ping) {
   AsioService asio_service(1);
   Acknowledgement acknowledgement(node_id, asio_service);
   Network network(routing_table, client_routing_table, acknowledgement);
-  PublicKeyHolder public_key_holder(asio_service, network);
+  PublicKeyHolder public_key_holder(asio_service, network, routing_table.key_store());
   Service service(routing_table, client_routing_table, network, public_key_holder);
   NodeInfo node;
   rudp::ManagedConnections rudp;
@@ -87,7 +87,7 @@ TEST(ServicesTest, BEH_FindNodes) {
   AsioService asio_service(1);
   Acknowledgement acknowledgement(node_id, asio_service);
   Network network(routing_table, client_routing_table, acknowledgement);
-  PublicKeyHolder public_key_holder(asio_service, network);
+  PublicKeyHolder public_key_holder(asio_service, network, routing_table.key_store());
   Service service(routing_table, client_routing_table, network, public_key_holder);
   protobuf::Message message = rpcs::FindNodes(this_node_id, this_node_id, 8);
   service.FindNodes(message);
@@ -0,0 +1,1029 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_access.h"
+#include "maidsafe/routing/routing_api.h"
+#include "maidsafe/routing/routing_host.h"
+#include "maidsafe/routing/routing_impl.h"
+#include "maidsafe/routing/simulated_transport.h"
+#include "maidsafe/routing/simulation.h"
+#include "maidsafe/routing/tests/test_utils.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+class Inbox {
+ public:
+  Inbox() : mutex_(), cond_var_(), messages_(), lost_() {}
+  rudp::MessageReceivedFunctor message_received() {
+    return [this](const std::string& message) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      messages_.push_back(message);
+      cond_var_.notify_all();
+    };
+  }
+  rudp::ConnectionLostFunctor connection_lost() {
+    return [this](const NodeId& peer_id) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lost_.push_back(peer_id);
+      cond_var_.notify_all();
+    };
+  }
+  std::vector<std::string> WaitForMessages(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_var_.wait_for(lock, std::chrono::seconds(5),
+                       [&] { return messages_.size() >= count; });
+    return messages_;
+  }
+  std::vector<NodeId> WaitForLost(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_var_.wait_for(lock, std::chrono::seconds(5), [&] { return lost_.size() >= count; });
+    return lost_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_var_;
+  std::vector<std::string> messages_;
+  std::vector<NodeId> lost_;
+};
+
+SimulatedNetwork::Config FastConfig() {
+  SimulatedNetwork::Config config;
+  config.latency = std::chrono::milliseconds(1);
+  config.jitter = std::chrono::microseconds(0);
+  return config;
+}
+
+int SimulatedBootstrap(Transport& transport, Inbox& inbox, const NodeId& node_id,
+                       NodeId& chosen, const Endpoint& local_endpoint = Endpoint()) {
+  rudp::NatType nat_type;
+  return transport.Bootstrap(BootstrapContacts(), inbox.message_received(),
+                             inbox.connection_lost(), node_id, nullptr, nullptr, chosen,
+                             nat_type, local_endpoint);
+}
+
+asymm::Keys MakeKeys(const NodeInfoAndPrivateKey& node) {
+  asymm::Keys keys;
+  keys.private_key = node.private_key;
+  keys.public_key = node.node_info.public_key;
+  return keys;
+}
+
+int SendAndWait(Transport& transport, const NodeId& peer_id, const std::string& message) {
+  std::promise<int> result;
+  transport.Send(peer_id, message, [&result](int sent) { result.set_value(sent); });
+  return result.get_future().get();
+}
+
+template <typename T>
+bool IsReady(const std::future<T>& result) {
+  return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+}  // unnamed namespace
+
+TEST(SimulatedNetworkTest, BEH_ConnectSendAndRemove) {
+  Inbox inbox0, inbox1, inbox2;  // outlives the network's threads
+  SimulatedNetwork network(FastConfig());
+  std::unique_ptr<Transport> transport0(network.MakeTransport()),
+      transport1(network.MakeTransport()), transport2(network.MakeTransport());
+  NodeId id0(NodeId::IdType::kRandomId), id1(NodeId::IdType::kRandomId),
+      id2(NodeId::IdType::kRandomId), chosen0, chosen1, chosen2;
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 6000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 6001);
+
+  // A non-zero state node can't bootstrap off an empty network.
+  EXPECT_EQ(kNoOnlineBootstrapContacts, SimulatedBootstrap(*transport2, inbox2, id2, chosen2));
+  transport2 = network.MakeTransport();
+
+  // Zero state nodes find one another.
+  auto zero_state(std::async(std::launch::async, [&] {
+    return SimulatedBootstrap(*transport0, inbox0, id0, chosen0, endpoint0);
+  }));
+  EXPECT_EQ(kSuccess, SimulatedBootstrap(*transport1, inbox1, id1, chosen1, endpoint1));
+  EXPECT_EQ(kSuccess, zero_state.get());
+  EXPECT_EQ(id1, chosen0);
+  EXPECT_EQ(id0, chosen1);
+  EXPECT_EQ(2U, network.size());
+
+  rudp::EndpointPair this_endpoint_pair, peer_endpoint_pair;
+  rudp::NatType nat_type;
+  EXPECT_EQ(rudp::kBootstrapConnectionAlreadyExists,
+            transport0->GetAvailableEndpoint(id1, peer_endpoint_pair, this_endpoint_pair,
+                                             nat_type));
+  EXPECT_EQ(endpoint0, this_endpoint_pair.external);
+
+  // A third node bootstraps off one of them and connects to the other.
+  EXPECT_EQ(kSuccess, SimulatedBootstrap(*transport2, inbox2, id2, chosen2));
+  const NodeId kOther(chosen2 == id0 ? id1 : id0);
+  Transport& other(chosen2 == id0 ? *transport1 : *transport0);
+  Inbox& other_inbox(chosen2 == id0 ? inbox1 : inbox0);
+  EXPECT_EQ(kSuccess, transport2->GetAvailableEndpoint(kOther, peer_endpoint_pair,
+                                                        this_endpoint_pair, nat_type));
+  peer_endpoint_pair.external = peer_endpoint_pair.local =
+      (kOther == id0 ? endpoint0 : endpoint1);
+  EXPECT_EQ(kSuccess, transport2->Add(kOther, peer_endpoint_pair, "validation"));
+  ASSERT_EQ(1U, other_inbox.WaitForMessages(1).size());
+  EXPECT_EQ("validation", other_inbox.WaitForMessages(1).front());
+  EXPECT_EQ(rudp::kUnvalidatedConnectionAlreadyExists,
+            other.GetAvailableEndpoint(id2, peer_endpoint_pair, this_endpoint_pair, nat_type));
+  Endpoint new_bootstrap_endpoint;
+  EXPECT_EQ(kSuccess, transport2->MarkConnectionAsValid(kOther, new_bootstrap_endpoint));
+  EXPECT_EQ(rudp::kConnectionAlreadyExists,
+            transport2->Add(kOther, peer_endpoint_pair, "validation"));
+
+  // Messages on a connection arrive in order.
+  for (int i(0); i != 10; ++i)
+    EXPECT_EQ(kSuccess, SendAndWait(*transport2, kOther, std::to_string(i)));
+  auto received(other_inbox.WaitForMessages(11));
+  ASSERT_EQ(11U, received.size());
+  for (int i(0); i != 10; ++i)
+    EXPECT_EQ(std::to_string(i), received.at(i + 1));
+
+  // Removing a connection notifies the peer, after which sending fails.
+  transport2->Remove(kOther);
+  auto lost(other_inbox.WaitForLost(1));
+  ASSERT_EQ(1U, lost.size());
+  EXPECT_EQ(id2, lost.front());
+  EXPECT_EQ(rudp::kInvalidAddress, SendAndWait(*transport2, kOther, "dropped"));
+
+  // Destroying a transport disconnects it.
+  transport2.reset();
+  EXPECT_EQ(2U, network.size());
+  EXPECT_EQ(1U, (chosen2 == id0 ? inbox0 : inbox1).WaitForLost(1).size());
+  EXPECT_EQ(network.messages_sent(), network.messages_delivered() + 1);
+}
+
+TEST(SimulatedNetworkTest, BEH_LossAndBandwidth) {
+  SimulatedNetwork::Config config(FastConfig());
+  config.loss_rate = 1.0;
+  Inbox inbox0, inbox1, inbox2, inbox3;
+  SimulatedNetwork network(config);
+  std::unique_ptr<Transport> transport0(network.MakeTransport()),
+      transport1(network.MakeTransport());
+  NodeId id0(NodeId::IdType::kRandomId), id1(NodeId::IdType::kRandomId), chosen0, chosen1;
+  auto zero_state(std::async(std::launch::async, [&] {
+    return SimulatedBootstrap(*transport0, inbox0, id0, chosen0,
+                              Endpoint(boost::asio::ip::address_v4::loopback(), 6000));
+  }));
+  ASSERT_EQ(kSuccess, SimulatedBootstrap(*transport1, inbox1, id1, chosen1,
+                                         Endpoint(boost::asio::ip::address_v4::loopback(), 6001)));
+  ASSERT_EQ(kSuccess, zero_state.get());
+
+  // Lost messages are reported as sent, as a dropped UDP datagram would be.
+  for (int i(0); i != 5; ++i)
+    EXPECT_EQ(kSuccess, SendAndWait(*transport0, id1, "lost"));
+  EXPECT_EQ(5U, network.messages_lost());
+  EXPECT_EQ(0U, network.messages_delivered());
+  EXPECT_TRUE(inbox1.WaitForMessages(0).empty());
+
+  // At 100 kB/s, a 10 kB message takes at least 100ms to serialise.
+  config.loss_rate = 0.0;
+  config.bandwidth = 100 * 1024;
+  SimulatedNetwork slow_network(config);
+  std::unique_ptr<Transport> transport2(slow_network.MakeTransport()),
+      transport3(slow_network.MakeTransport());
+  NodeId id2(NodeId::IdType::kRandomId), id3(NodeId::IdType::kRandomId), chosen2, chosen3;
+  zero_state = std::async(std::launch::async, [&] {
+    return SimulatedBootstrap(*transport2, inbox2, id2, chosen2,
+                              Endpoint(boost::asio::ip::address_v4::loopback(), 6000));
+  });
+  ASSERT_EQ(kSuccess, SimulatedBootstrap(*transport3, inbox3, id3, chosen3,
+                                         Endpoint(boost::asio::ip::address_v4::loopback(), 6001)));
+  ASSERT_EQ(kSuccess, zero_state.get());
+  auto start(std::chrono::steady_clock::now());
+  EXPECT_EQ(kSuccess, SendAndWait(*transport2, id3, std::string(10 * 1024, 'a')));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+// Runs full routing nodes over a SimulatedNetwork.  Set MAIDSAFE_ROUTING_SIMULATED_NODES to change
+// the network size; unless 'asio_service' or a RoutingHost is shared, each node runs its own
+// AsioService, which bounds how large that can usefully be on one machine.
+class SimulatedNode {
+ public:
+  SimulatedNode(SimulatedNetwork& network, const NodeInfoAndPrivateKey& node,
+                AsioService* asio_service = nullptr)
+      : node_info(node.node_info),
+        impl(std::make_shared<RoutingAccess::Impl>(false, node.node_info.id, MakeKeys(node),
+                                                   network.MakeTransport(), asio_service)) {}
+  SimulatedNode(SimulatedNetwork& network, const NodeInfoAndPrivateKey& node, RoutingHost& host)
+      : node_info(node.node_info),
+        impl(std::make_shared<RoutingAccess::Impl>(
+            false, node.node_info.id, MakeKeys(node), network.MakeTransport(),
+            &RoutingAccess::NextAsioService(host), RoutingAccess::upcall_executor(host))) {}
+  ~SimulatedNode() { impl->Stop(); }
+
+  const NodeInfo node_info;
+  std::shared_ptr<RoutingAccess::Impl> impl;
+
+ private:
+  SimulatedNode(const SimulatedNode&);
+  SimulatedNode(const SimulatedNode&&);
+  SimulatedNode& operator=(const SimulatedNode&);
+};
+
+TEST(SimulatedNetworkTest, FUNC_JoinAndSendDirect) {
+  const char* const kEnvSize(std::getenv("MAIDSAFE_ROUTING_SIMULATED_NODES"));
+  const size_t kNetworkSize(std::max(kEnvSize ? std::strtoul(kEnvSize, nullptr, 10) : 20UL, 3UL));
+  const size_t kMessageCount(100);
+
+  // Declared before the network and nodes, whose threads may still be using them on destruction.
+  std::mutex mutex, latency_mutex;
+  std::map<std::string, int> hops;  // by message ID, for node level requests
+  std::vector<std::chrono::steady_clock::duration> latencies;
+  std::atomic<size_t> responses(0);
+  std::promise<void> all_responded;
+  SimulatedNetwork network;
+  network.set_delivery_observer([&](const NodeId&, const NodeId&, const std::string& message) {
+    protobuf::Message proto_message;
+    if (proto_message.ParseFromString(message) && proto_message.request() &&
+        proto_message.type() == static_cast<int32_t>(MessageType::kNodeLevel)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++hops[proto_message.source_id() + std::to_string(proto_message.id())];
+    }
+  });
+
+  std::vector<NodeInfoAndPrivateKey> keys;
+  std::map<NodeId, asymm::PublicKey> key_map;
+  for (size_t i(0); i != kNetworkSize; ++i) {
+    keys.push_back(MakeNodeInfoAndKeys());
+    key_map.insert(std::make_pair(keys.back().node_info.id, keys.back().node_info.public_key));
+  }
+  std::vector<std::unique_ptr<SimulatedNode>> nodes;
+  for (const auto& key : keys)
+    nodes.emplace_back(new SimulatedNode(network, key));
+
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = [](const std::string& message,
+                                                     ReplyFunctor reply_functor) {
+    reply_functor("response to " + message);
+  };
+  functors.request_public_key = [&key_map](const NodeId& node_id,
+                                           GivePublicKeyFunctor give_key) {
+    auto itr(key_map.find(node_id));
+    if (itr != key_map.end())
+      give_key(itr->second);
+  };
+
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 5000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 5001);
+  auto zero_state(std::async(std::launch::async, [&] {
+    return nodes.at(0)->impl->ZeroStateJoin(functors, endpoint0, endpoint1,
+                                            nodes.at(1)->node_info);
+  }));
+  ASSERT_EQ(kSuccess, nodes.at(1)->impl->ZeroStateJoin(functors, endpoint1, endpoint0,
+                                                       nodes.at(0)->node_info));
+  ASSERT_EQ(kSuccess, zero_state.get());
+
+  // Each node is joined once its routing table holds min(group size, nodes so far) peers.
+  std::chrono::steady_clock::duration total_join_time(0);
+  for (size_t i(2); i != kNetworkSize; ++i) {
+    auto joined(std::make_shared<std::promise<void>>());
+    auto once(std::make_shared<std::once_flag>());
+    const int kTarget(NetworkStatus(false, static_cast<int>(
+        std::min(static_cast<size_t>(Parameters::group_size), i))));
+    Functors node_functors(functors);
+    node_functors.network_status = [joined, once, kTarget](int result) {
+      if (result >= kTarget)
+        std::call_once(*once, [joined] { joined->set_value(); });
+    };
+    auto start(std::chrono::steady_clock::now());
+    nodes.at(i)->impl->Join(node_functors);
+    ASSERT_EQ(std::future_status::ready,
+              joined->get_future().wait_for(std::chrono::seconds(20))) << "Node " << i;
+    total_join_time += std::chrono::steady_clock::now() - start;
+  }
+
+  for (size_t i(0); i != kMessageCount; ++i) {
+    auto& sender(*nodes.at(RandomUint32() % kNetworkSize));
+    NodeId receiver_id(nodes.at(RandomUint32() % kNetworkSize)->node_info.id);
+    auto start(std::chrono::steady_clock::now());
+    sender.impl->SendDirect(receiver_id, "message " + std::to_string(i), false,
+                            [&, start](std::string response) {
+                              if (!response.empty()) {
+                                std::lock_guard<std::mutex> lock(latency_mutex);
+                                latencies.push_back(std::chrono::steady_clock::now() - start);
+                              }
+                              if (++responses == kMessageCount)
+                                all_responded.set_value();
+                            });
+  }
+  ASSERT_EQ(std::future_status::ready,
+            all_responded.get_future().wait_for(std::chrono::seconds(60)));
+  ASSERT_FALSE(latencies.empty());
+  std::sort(latencies.begin(), latencies.end());
+
+  int total_hops(0), max_hops(0);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& message_hops : hops) {
+      total_hops += message_hops.second;
+      max_hops = std::max(max_hops, message_hops.second);
+    }
+  }
+  typedef std::chrono::milliseconds ms;
+  std::cout << "Simulated network of " << kNetworkSize << " nodes:\n"
+            << "  mean join time:     "
+            << std::chrono::duration_cast<ms>(total_join_time).count() / (kNetworkSize - 2)
+            << " ms\n"
+            << "  responses:          " << latencies.size() << " of " << kMessageCount << '\n'
+            << "  median latency:     "
+            << std::chrono::duration_cast<ms>(latencies.at(latencies.size() / 2)).count()
+            << " ms\n"
+            << "  mean hops:          "
+            << (hops.empty() ? 0.0 : static_cast<double>(total_hops) / hops.size()) << '\n'
+            << "  max hops:           " << max_hops << '\n'
+            << "  messages delivered: " << network.messages_delivered() << '\n';
+  EXPECT_EQ(kMessageCount, latencies.size());
+  nodes.clear();
+}
+
+// Drives a network of routing nodes in virtual time through rounds of churn, reporting how long
+// close groups take to converge after each round and how many messages are lost meanwhile.  Node
+// IDs, link behaviour and the churn schedule all derive from MAIDSAFE_ROUTING_SIMULATION_SEED.
+TEST(SimulatedNetworkTest, FUNC_ChurnConvergence) {
+  const char* const kEnvSize(std::getenv("MAIDSAFE_ROUTING_SIMULATED_NODES"));
+  const char* const kEnvSeed(std::getenv("MAIDSAFE_ROUTING_SIMULATION_SEED"));
+  const size_t kNetworkSize(std::max(kEnvSize ? std::strtoul(kEnvSize, nullptr, 10) : 20UL,
+                                     static_cast<size_t>(Parameters::group_size) + 4));
+  const uint32_t kSeed(kEnvSeed ? static_cast<uint32_t>(std::strtoul(kEnvSeed, nullptr, 10)) : 1);
+  const size_t kChurnRounds(4), kMessagesPerRound(50);
+  const Clock::duration kRoundLength(std::chrono::minutes(10));
+  std::mt19937 random(kSeed);
+
+  std::mutex mutex;
+  std::set<size_t> live;
+  size_t responses(0), lost(0);
+  AsioService asio_service(1);
+  Simulation simulation(asio_service);
+  SimulatedNetwork::Config config;
+  config.seed = kSeed;
+  SimulatedNetwork network(config, &asio_service);
+
+  std::vector<NodeInfoAndPrivateKey> keys(kNetworkSize);
+  std::map<NodeId, asymm::PublicKey> key_map;
+  for (auto& key : keys) {
+    std::string id(NodeId::kSize, 0);
+    for (auto& byte : id)
+      byte = static_cast<char>(random());
+    asymm::Keys key_pair(asymm::GenerateKeyPair());
+    key.node_info.id = key.node_info.connection_id = NodeId(id);
+    key.node_info.public_key = key_pair.public_key;
+    key.private_key = key_pair.private_key;
+    key_map.insert(std::make_pair(key.node_info.id, key.node_info.public_key));
+  }
+  std::vector<std::unique_ptr<SimulatedNode>> nodes;
+  for (const auto& key : keys)
+    nodes.emplace_back(new SimulatedNode(network, key, &asio_service));
+
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = [](const std::string& message,
+                                                     ReplyFunctor reply_functor) {
+    reply_functor("response to " + message);
+  };
+  functors.request_public_key = [&key_map](const NodeId& node_id,
+                                           GivePublicKeyFunctor give_key) {
+    auto itr(key_map.find(node_id));
+    if (itr != key_map.end())
+      give_key(itr->second);
+  };
+
+  // A live node has converged once the first group_size entries of its routing table are the
+  // group_size live nodes closest to it.
+  auto converged([&]()->bool {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t index : live) {
+      const NodeId kNodeId(nodes.at(index)->node_info.id);
+      std::vector<NodeId> expected;
+      for (size_t other : live) {
+        if (other != index)
+          expected.push_back(nodes.at(other)->node_info.id);
+      }
+      const size_t kGroupSize(std::min(expected.size(),
+                                       static_cast<size_t>(Parameters::group_size)));
+      std::partial_sort(expected.begin(), expected.begin() + kGroupSize, expected.end(),
+                        [&](const NodeId& lhs, const NodeId& rhs) {
+                          return NodeId::CloserToTarget(lhs, rhs, kNodeId);
+                        });
+      auto closest(nodes.at(index)->impl->ClosestNodes());
+      if (closest.size() < kGroupSize)
+        return false;
+      for (size_t i(0); i != kGroupSize; ++i) {
+        if (closest.at(i).id != expected.at(i))
+          return false;
+      }
+    }
+    return true;
+  });
+
+  // ZeroStateJoin blocks until its peer has connected, so both run off the service's thread.
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 5000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 5001);
+  auto zero_state0(std::async(std::launch::async, [&] {
+    return nodes.at(0)->impl->ZeroStateJoin(functors, endpoint0, endpoint1,
+                                            nodes.at(1)->node_info);
+  }));
+  auto zero_state1(std::async(std::launch::async, [&] {
+    return nodes.at(1)->impl->ZeroStateJoin(functors, endpoint1, endpoint0,
+                                            nodes.at(0)->node_info);
+  }));
+  ASSERT_TRUE(simulation.RunFor(std::chrono::minutes(1),
+                                [&] { return IsReady(zero_state0) && IsReady(zero_state1); }));
+  ASSERT_EQ(kSuccess, zero_state0.get());
+  ASSERT_EQ(kSuccess, zero_state1.get());
+  live.insert(0);
+  live.insert(1);
+
+  // The remaining nodes join a second apart.
+  const size_t kInitialSize(kNetworkSize - kChurnRounds);
+  for (size_t i(2); i != kInitialSize; ++i) {
+    simulation.Schedule(std::chrono::seconds(i), [&, i] {
+      nodes.at(i)->impl->Join(functors);
+      std::lock_guard<std::mutex> lock(mutex);
+      live.insert(i);
+    });
+  }
+  const Clock::time_point kJoinStart(Clock::now());
+  ASSERT_TRUE(simulation.RunFor(std::chrono::hours(1), [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return live.size() == kInitialSize;
+  }));
+  ASSERT_TRUE(simulation.RunFor(std::chrono::hours(1), converged));
+  const Clock::duration kInitialConvergence(Clock::now() - kJoinStart);
+
+  // Each round crashes one random live node and joins one new node, while random live nodes send
+  // to one another.
+  std::vector<Clock::duration> convergence_times;
+  size_t sent(0);
+  for (size_t round(0); round != kChurnRounds; ++round) {
+    std::vector<size_t> candidates;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      candidates.assign(live.begin(), live.end());
+    }
+    const size_t kVictim(candidates.at(random() % candidates.size()));
+    const size_t kJoiner(kInitialSize + round);
+    simulation.Schedule(Clock::duration::zero(), [&, kVictim] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.erase(kVictim);
+      }
+      network.Crash(nodes.at(kVictim)->node_info.connection_id);
+    });
+    simulation.Schedule(std::chrono::seconds(1), [&, kJoiner] {
+      nodes.at(kJoiner)->impl->Join(functors);
+      std::lock_guard<std::mutex> lock(mutex);
+      live.insert(kJoiner);
+    });
+    for (size_t i(0); i != kMessagesPerRound; ++i, ++sent) {
+      const size_t kSender(candidates.at(random() % candidates.size()));
+      const size_t kReceiver(candidates.at(random() % candidates.size()));
+      const Clock::duration kDelay(std::chrono::milliseconds(random() % 60000));
+      simulation.Schedule(kDelay, [&, kSender, kReceiver, i] {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (live.count(kSender) == 0) {
+            ++responses;
+            ++lost;
+            return;
+          }
+        }
+        nodes.at(kSender)->impl->SendDirect(
+            nodes.at(kReceiver)->node_info.id, "message " + std::to_string(i), false,
+            [&](std::string response) {
+              std::lock_guard<std::mutex> lock(mutex);
+              ++responses;
+              if (response.empty())
+                ++lost;
+            });
+      });
+    }
+    const Clock::time_point kRoundStart(Clock::now());
+    EXPECT_TRUE(simulation.RunFor(kRoundLength, [&] {
+      std::lock_guard<std::mutex> lock(mutex);
+      return live.count(kJoiner) != 0;
+    }));
+    EXPECT_TRUE(simulation.RunFor(kRoundLength, converged)) << "Round " << round;
+    convergence_times.push_back(Clock::now() - kRoundStart);
+    simulation.RunFor(kRoundStart + kRoundLength - Clock::now());
+  }
+  EXPECT_TRUE(simulation.RunFor(kRoundLength, [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return responses == sent;
+  }));
+
+  typedef std::chrono::milliseconds ms;
+  std::sort(convergence_times.begin(), convergence_times.end());
+  std::cout << "Simulated churn of " << kNetworkSize << " nodes, seed " << kSeed << ":\n"
+            << "  initial convergence:     "
+            << std::chrono::duration_cast<ms>(kInitialConvergence).count() << " ms\n"
+            << "  median convergence:      "
+            << std::chrono::duration_cast<ms>(convergence_times.at(kChurnRounds / 2)).count()
+            << " ms\n"
+            << "  max convergence:         "
+            << std::chrono::duration_cast<ms>(convergence_times.back()).count() << " ms\n"
+            << "  messages lost in churn:  " << lost << " of " << sent << '\n'
+            << "  network messages lost:   " << network.messages_lost() << " of "
+            << network.messages_sent() << '\n'
+            << "  simulation steps:        " << simulation.steps() << '\n';
+
+  // Stop waits in real time for pending operations, which need the simulation to keep running.
+  auto stopped(std::async(std::launch::async, [&] { nodes.clear(); }));
+  simulation.RunFor(std::chrono::hours(1), [&] { return IsReady(stopped); });
+  stopped.get();
+}
+
+// Crashes the closest peer of one node after another in virtual time, reporting how long each node
+// takes to hold its true close group again, i.e. for its closest_nodes_size closest routing table
+// entries to be the closest live nodes.  Each node is first given time to connect to its standby
+// (see Parameters::close_standby_size), so the loss should be made good by promoting a standby node
+// as soon as it's noticed, well inside the recovery_time_lag before any search for more nodes.
+TEST(SimulatedNetworkTest, FUNC_CloseGroupRestoration) {
+  const char* const kEnvSize(std::getenv("MAIDSAFE_ROUTING_SIMULATED_NODES"));
+  const char* const kEnvSeed(std::getenv("MAIDSAFE_ROUTING_SIMULATION_SEED"));
+  const size_t kRounds(4);
+  const size_t kNetworkSize(std::max(
+      kEnvSize ? std::strtoul(kEnvSize, nullptr, 10) : 40UL,
+      static_cast<size_t>(Parameters::closest_nodes_size + Parameters::close_standby_size) +
+          kRounds + 1));
+  const uint32_t kSeed(kEnvSeed ? static_cast<uint32_t>(std::strtoul(kEnvSeed, nullptr, 10)) : 1);
+  std::mt19937 random(kSeed);
+
+  std::mutex mutex;
+  std::set<size_t> live;
+  AsioService asio_service(1);
+  Simulation simulation(asio_service);
+  SimulatedNetwork::Config config;
+  config.seed = kSeed;
+  SimulatedNetwork network(config, &asio_service);
+
+  std::vector<NodeInfoAndPrivateKey> keys(kNetworkSize);
+  std::map<NodeId, asymm::PublicKey> key_map;
+  for (auto& key : keys) {
+    std::string id(NodeId::kSize, 0);
+    for (auto& byte : id)
+      byte = static_cast<char>(random());
+    asymm::Keys key_pair(asymm::GenerateKeyPair());
+    key.node_info.id = key.node_info.connection_id = NodeId(id);
+    key.node_info.public_key = key_pair.public_key;
+    key.private_key = key_pair.private_key;
+    key_map.insert(std::make_pair(key.node_info.id, key.node_info.public_key));
+  }
+  std::vector<std::unique_ptr<SimulatedNode>> nodes;
+  for (const auto& key : keys)
+    nodes.emplace_back(new SimulatedNode(network, key, &asio_service));
+
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = [](const std::string&, ReplyFunctor) {};
+  functors.request_public_key = [&key_map](const NodeId& node_id,
+                                           GivePublicKeyFunctor give_key) {
+    auto itr(key_map.find(node_id));
+    if (itr != key_map.end())
+      give_key(itr->second);
+  };
+
+  // The live nodes other than 'index', closest to it first.
+  auto closest_live([&](size_t index)->std::vector<size_t> {
+    const NodeId kNodeId(nodes.at(index)->node_info.id);
+    std::vector<size_t> others;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t other : live) {
+      if (other != index)
+        others.push_back(other);
+    }
+    std::sort(others.begin(), others.end(), [&](size_t lhs, size_t rhs) {
+      return NodeId::CloserToTarget(nodes.at(lhs)->node_info.id, nodes.at(rhs)->node_info.id,
+                                    kNodeId);
+    });
+    return others;
+  });
+  auto holds_close_group([&](size_t index)->bool {
+    auto expected(closest_live(index));
+    expected.resize(std::min(expected.size(), static_cast<size_t>(Parameters::closest_nodes_size)));
+    auto closest(nodes.at(index)->impl->ClosestNodes());
+    if (closest.size() < expected.size())
+      return false;
+    for (size_t i(0); i != expected.size(); ++i) {
+      if (closest.at(i).id != nodes.at(expected.at(i))->node_info.id)
+        return false;
+    }
+    return true;
+  });
+  auto holds_standby([&](size_t index)->bool {
+    auto expected(closest_live(index));
+    expected.resize(std::min(expected.size(), static_cast<size_t>(Parameters::closest_nodes_size +
+                                                                  Parameters::close_standby_size)));
+    for (size_t i(Parameters::closest_nodes_size); i < expected.size(); ++i) {
+      if (!nodes.at(index)->impl->IsConnectedVault(nodes.at(expected.at(i))->node_info.id))
+        return false;
+    }
+    return true;
+  });
+
+  // ZeroStateJoin blocks until its peer has connected, so both run off the service's thread.
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 5000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 5001);
+  auto zero_state0(std::async(std::launch::async, [&] {
+    return nodes.at(0)->impl->ZeroStateJoin(functors, endpoint0, endpoint1,
+                                            nodes.at(1)->node_info);
+  }));
+  auto zero_state1(std::async(std::launch::async, [&] {
+    return nodes.at(1)->impl->ZeroStateJoin(functors, endpoint1, endpoint0,
+                                            nodes.at(0)->node_info);
+  }));
+  ASSERT_TRUE(simulation.RunFor(std::chrono::minutes(1),
+                                [&] { return IsReady(zero_state0) && IsReady(zero_state1); }));
+  ASSERT_EQ(kSuccess, zero_state0.get());
+  ASSERT_EQ(kSuccess, zero_state1.get());
+  live.insert(0);
+  live.insert(1);
+  for (size_t i(2); i != kNetworkSize; ++i) {
+    simulation.Schedule(std::chrono::seconds(i), [&, i] {
+      nodes.at(i)->impl->Join(functors);
+      std::lock_guard<std::mutex> lock(mutex);
+      live.insert(i);
+    });
+  }
+  ASSERT_TRUE(simulation.RunFor(std::chrono::hours(1), [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return live.size() == kNetworkSize;
+  }));
+  ASSERT_TRUE(simulation.RunFor(std::chrono::hours(1), [&] {
+    for (size_t index(0); index != kNetworkSize; ++index) {
+      if (!holds_close_group(index))
+        return false;
+    }
+    return true;
+  }));
+
+  // Each round picks a random live node and crashes the live node closest to it.
+  std::vector<Clock::duration> restoration_times;
+  for (size_t round(0); round != kRounds; ++round) {
+    std::vector<size_t> candidates;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      candidates.assign(live.begin(), live.end());
+    }
+    const size_t kObserver(candidates.at(random() % candidates.size()));
+    ASSERT_TRUE(simulation.RunFor(std::chrono::minutes(10), [&] {
+      return holds_close_group(kObserver) && holds_standby(kObserver);
+    })) << "Round " << round;
+    const size_t kVictim(closest_live(kObserver).front());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      live.erase(kVictim);
+    }
+    const Clock::time_point kCrashTime(Clock::now());
+    simulation.Schedule(Clock::duration::zero(), [&, kVictim] {
+      network.Crash(nodes.at(kVictim)->node_info.connection_id);
+    });
+    EXPECT_TRUE(simulation.RunFor(std::chrono::minutes(10),
+                                  [&] { return holds_close_group(kObserver); }))
+        << "Round " << round;
+    restoration_times.push_back(Clock::now() - kCrashTime);
+    // Lets the rest of the network notice the loss and refill before the next round.
+    simulation.RunFor(Parameters::recovery_time_lag + std::chrono::minutes(1));
+  }
+
+  typedef std::chrono::milliseconds ms;
+  std::sort(restoration_times.begin(), restoration_times.end());
+  std::cout << "Close group restoration in " << kNetworkSize << " nodes, seed " << kSeed
+            << ", standby of " << Parameters::close_standby_size << ":\n"
+            << "  median restoration:      "
+            << std::chrono::duration_cast<ms>(restoration_times.at(kRounds / 2)).count()
+            << " ms\n"
+            << "  max restoration:         "
+            << std::chrono::duration_cast<ms>(restoration_times.back()).count() << " ms\n";
+  EXPECT_GT(std::chrono::seconds(1), restoration_times.back());
+
+  // Stop waits in real time for pending operations, which need the simulation to keep running.
+  auto stopped(std::async(std::launch::async, [&] { nodes.clear(); }));
+  simulation.RunFor(std::chrono::hours(1), [&] { return IsReady(stopped); });
+  stopped.get();
+}
+
+namespace {
+
+struct RelayCounts {
+  RelayCounts() : responses(0), messages(0), ack_messages(0) {}
+  size_t responses, messages, ack_messages;
+};
+
+// Joins 'network_size' nodes over a SimulatedNetwork, then sends 'message_count' direct messages
+// between random nodes at once, counting the messages the network carries meanwhile.
+void RunRelayLoad(size_t network_size, size_t message_count, RelayCounts& counts) {
+  std::atomic<size_t> messages(0), ack_messages(0), responses(0);
+  std::atomic<bool> counting(false);
+  std::promise<void> all_responded;
+  SimulatedNetwork network;
+  network.set_delivery_observer([&](const NodeId&, const NodeId&, const std::string& message) {
+    if (!counting)
+      return;
+    ++messages;
+    protobuf::Message proto_message;
+    if (proto_message.ParseFromString(message) && IsAck(proto_message))
+      ++ack_messages;
+  });
+
+  std::vector<NodeInfoAndPrivateKey> keys;
+  std::map<NodeId, asymm::PublicKey> key_map;
+  for (size_t i(0); i != network_size; ++i) {
+    keys.push_back(MakeNodeInfoAndKeys());
+    key_map.insert(std::make_pair(keys.back().node_info.id, keys.back().node_info.public_key));
+  }
+  std::vector<std::unique_ptr<SimulatedNode>> nodes;
+  for (const auto& key : keys)
+    nodes.emplace_back(new SimulatedNode(network, key));
+
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = [](const std::string& message,
+                                                     ReplyFunctor reply_functor) {
+    reply_functor("response to " + message);
+  };
+  functors.request_public_key = [&key_map](const NodeId& node_id,
+                                           GivePublicKeyFunctor give_key) {
+    auto itr(key_map.find(node_id));
+    if (itr != key_map.end())
+      give_key(itr->second);
+  };
+
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 5000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 5001);
+  auto zero_state(std::async(std::launch::async, [&] {
+    return nodes.at(0)->impl->ZeroStateJoin(functors, endpoint0, endpoint1,
+                                            nodes.at(1)->node_info);
+  }));
+  ASSERT_EQ(kSuccess, nodes.at(1)->impl->ZeroStateJoin(functors, endpoint1, endpoint0,
+                                                       nodes.at(0)->node_info));
+  ASSERT_EQ(kSuccess, zero_state.get());
+  for (size_t i(2); i != network_size; ++i) {
+    auto joined(std::make_shared<std::promise<void>>());
+    auto once(std::make_shared<std::once_flag>());
+    const int kTarget(NetworkStatus(false, static_cast<int>(
+        std::min(static_cast<size_t>(Parameters::group_size), i))));
+    Functors node_functors(functors);
+    node_functors.network_status = [joined, once, kTarget](int result) {
+      if (result >= kTarget)
+        std::call_once(*once, [joined] { joined->set_value(); });
+    };
+    nodes.at(i)->impl->Join(node_functors);
+    ASSERT_EQ(std::future_status::ready,
+              joined->get_future().wait_for(std::chrono::seconds(20))) << "Node " << i;
+  }
+
+  // Let acks for the joins drain before counting.
+  Sleep(std::chrono::seconds(1));
+  counting = true;
+  for (size_t i(0); i != message_count; ++i) {
+    auto& sender(*nodes.at(RandomUint32() % network_size));
+    NodeId receiver_id(nodes.at(RandomUint32() % network_size)->node_info.id);
+    sender.impl->SendDirect(receiver_id, "message " + std::to_string(i), false,
+                            [&, message_count](std::string response) {
+                              if (response.empty())
+                                return;
+                              if (++responses == message_count)
+                                all_responded.set_value();
+                            });
+  }
+  all_responded.get_future().wait_for(std::chrono::seconds(60));
+  // Give acks held for the last responses time to go out.
+  Sleep(std::chrono::milliseconds(200) + Parameters::ack_batch_delay);
+  counting = false;
+  counts.responses = responses;
+  counts.messages = messages;
+  counts.ack_messages = ack_messages;
+  nodes.clear();
+}
+
+}  // unnamed namespace
+
+// Relays the same load with hop acks sent one per message and batched per peer, and checks that
+// batching cuts both the ack messages and all messages the network has to carry.
+TEST(SimulatedNetworkTest, FUNC_AckBatching) {
+  const char* const kEnvSize(std::getenv("MAIDSAFE_ROUTING_SIMULATED_NODES"));
+  const size_t kNetworkSize(std::max(kEnvSize ? std::strtoul(kEnvSize, nullptr, 10) : 20UL, 3UL));
+  const size_t kMessageCount(500);
+  const auto kAckBatchDelay(Parameters::ack_batch_delay);
+
+  RelayCounts unbatched, batched;
+  Parameters::ack_batch_delay = std::chrono::steady_clock::duration::zero();
+  RunRelayLoad(kNetworkSize, kMessageCount, unbatched);
+  Parameters::ack_batch_delay = kAckBatchDelay;
+  ASSERT_FALSE(HasFatalFailure());
+  RunRelayLoad(kNetworkSize, kMessageCount, batched);
+  ASSERT_FALSE(HasFatalFailure());
+
+  std::cout << "Relaying " << kMessageCount << " direct messages over " << kNetworkSize
+            << " nodes:\n"
+            << "                   unbatched    batched\n"
+            << "  responses:       " << std::setw(9) << unbatched.responses << std::setw(11)
+            << batched.responses << '\n'
+            << "  ack messages:    " << std::setw(9) << unbatched.ack_messages << std::setw(11)
+            << batched.ack_messages << '\n'
+            << "  network messages:" << std::setw(9) << unbatched.messages << std::setw(11)
+            << batched.messages << '\n';
+  EXPECT_EQ(kMessageCount, unbatched.responses);
+  EXPECT_EQ(kMessageCount, batched.responses);
+  // Batched acks are merged, or carried on other messages to the same peer, so fewer go out alone.
+  EXPECT_LT(0U, unbatched.ack_messages);
+  EXPECT_LT(batched.ack_messages, unbatched.ack_messages);
+  EXPECT_LT(batched.messages, unbatched.messages);
+}
+
+namespace {
+
+struct Footprint {
+  Footprint() : threads(0), rss_kb(0) {}
+  long threads, rss_kb;  // NOLINT
+};
+
+// Reads this process's thread count and resident set size; both are left 0 where /proc is absent.
+Footprint ProcessFootprint() {
+  Footprint footprint;
+  std::ifstream status("/proc/self/status");
+  std::string field;
+  while (status >> field) {
+    if (field == "Threads:")
+      status >> footprint.threads;
+    else if (field == "VmRSS:")
+      status >> footprint.rss_kb;
+  }
+  return footprint;
+}
+
+// Joins 'network_size' nodes over a SimulatedNetwork, each on its own threads or, if 'host' is
+// provided, on the host's.  Sends 'message_count' direct messages between random nodes, then
+// records the growth in threads and resident memory since before the nodes were created.
+void RunHostedNodes(size_t network_size, size_t message_count, RoutingHost* host,
+                    size_t& responses, Footprint& growth) {
+  std::vector<NodeInfoAndPrivateKey> keys;
+  std::map<NodeId, asymm::PublicKey> key_map;
+  for (size_t i(0); i != network_size; ++i) {
+    keys.push_back(MakeNodeInfoAndKeys());
+    key_map.insert(std::make_pair(keys.back().node_info.id, keys.back().node_info.public_key));
+  }
+  std::atomic<size_t> response_count(0);
+  std::promise<void> all_responded;
+  const Footprint kBefore(ProcessFootprint());
+  SimulatedNetwork network;
+  std::vector<std::unique_ptr<SimulatedNode>> nodes;
+  for (const auto& key : keys) {
+    nodes.emplace_back(host ? new SimulatedNode(network, key, *host)
+                            : new SimulatedNode(network, key));
+  }
+
+  Functors functors;
+  functors.network_status = [](int) {};  // NOLINT
+  functors.message_and_caching.message_received = [](const std::string& message,
+                                                     ReplyFunctor reply_functor) {
+    reply_functor("response to " + message);
+  };
+  functors.request_public_key = [&key_map](const NodeId& node_id,
+                                           GivePublicKeyFunctor give_key) {
+    auto itr(key_map.find(node_id));
+    if (itr != key_map.end())
+      give_key(itr->second);
+  };
+
+  Endpoint endpoint0(boost::asio::ip::address_v4::loopback(), 5000),
+      endpoint1(boost::asio::ip::address_v4::loopback(), 5001);
+  auto zero_state(std::async(std::launch::async, [&] {
+    return nodes.at(0)->impl->ZeroStateJoin(functors, endpoint0, endpoint1,
+                                            nodes.at(1)->node_info);
+  }));
+  ASSERT_EQ(kSuccess, nodes.at(1)->impl->ZeroStateJoin(functors, endpoint1, endpoint0,
+                                                       nodes.at(0)->node_info));
+  ASSERT_EQ(kSuccess, zero_state.get());
+  for (size_t i(2); i != network_size; ++i) {
+    auto joined(std::make_shared<std::promise<void>>());
+    auto once(std::make_shared<std::once_flag>());
+    const int kTarget(NetworkStatus(false, static_cast<int>(
+        std::min(static_cast<size_t>(Parameters::group_size), i))));
+    Functors node_functors(functors);
+    node_functors.network_status = [joined, once, kTarget](int result) {
+      if (result >= kTarget)
+        std::call_once(*once, [joined] { joined->set_value(); });
+    };
+    nodes.at(i)->impl->Join(node_functors);
+    ASSERT_EQ(std::future_status::ready,
+              joined->get_future().wait_for(std::chrono::seconds(20))) << "Node " << i;
+  }
+
+  for (size_t i(0); i != message_count; ++i) {
+    auto& sender(*nodes.at(RandomUint32() % network_size));
+    NodeId receiver_id(nodes.at(RandomUint32() % network_size)->node_info.id);
+    sender.impl->SendDirect(receiver_id, "message " + std::to_string(i), false,
+                            [&, message_count](std::string response) {
+                              if (!response.empty() && ++response_count == message_count)
+                                all_responded.set_value();
+                            });
+  }
+  all_responded.get_future().wait_for(std::chrono::seconds(60));
+  const Footprint kAfter(ProcessFootprint());
+  growth.threads = kAfter.threads - kBefore.threads;
+  growth.rss_kb = kAfter.rss_kb - kBefore.rss_kb;
+  responses = response_count;
+  nodes.clear();
+}
+
+}  // unnamed namespace
+
+// Compares the threads and memory per node of nodes running on their own threads with nodes
+// hosted on one shared RoutingHost, and bounds the threads each adds.  The shared run goes first:
+// memory it frees is reused by the other run, understating rather than overstating the saving.
+TEST(SimulatedNetworkTest, FUNC_SharedHostFootprint) {
+  const char* const kEnvSize(std::getenv("MAIDSAFE_ROUTING_SIMULATED_NODES"));
+  const size_t kNetworkSize(std::max(kEnvSize ? std::strtoul(kEnvSize, nullptr, 10) : 20UL, 3UL));
+  const size_t kMessageCount(100);
+
+  size_t shared_responses(0), own_responses(0);
+  Footprint shared, own;
+  {
+    RoutingHost host(Parameters::thread_count);
+    RunHostedNodes(kNetworkSize, kMessageCount, &host, shared_responses, shared);
+    ASSERT_FALSE(HasFatalFailure());
+  }
+  RunHostedNodes(kNetworkSize, kMessageCount, nullptr, own_responses, own);
+  ASSERT_FALSE(HasFatalFailure());
+
+  const double kNodes(static_cast<double>(kNetworkSize));
+  std::cout << "Hosting " << kNetworkSize << " nodes:\n"
+            << "                        own threads    shared host\n"
+            << std::fixed << std::setprecision(1)
+            << "  threads per node:   " << std::setw(13) << own.threads / kNodes
+            << std::setw(15) << shared.threads / kNodes << '\n'
+            << "  RSS per node (KB):  " << std::setw(13) << own.rss_kb / kNodes
+            << std::setw(15) << shared.rss_kb / kNodes << '\n'
+            << "  responses:          " << std::setw(13) << own_responses << std::setw(15)
+            << shared_responses << '\n';
+  EXPECT_EQ(kMessageCount, own_responses);
+  EXPECT_EQ(kMessageCount, shared_responses);
+  // Resident memory depends too much on the allocator to bound, but thread counts don't: a node on
+  // its own threads starts an AsioService of two, while hosted nodes share the host's and so must
+  // add fewer than one each.
+  if (own.threads != 0) {
+    EXPECT_LE(static_cast<long>(2 * kNetworkSize), own.threads);  // NOLINT
+    EXPECT_GT(static_cast<long>(kNetworkSize), shared.threads);  // NOLINT
+  }
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
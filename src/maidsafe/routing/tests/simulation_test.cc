@@ -0,0 +1,140 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/clock.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/simulated_transport.h"
+#include "maidsafe/routing/simulation.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+typedef std::vector<std::pair<std::string, Clock::duration>> Arrivals;
+
+// Sends 'count' messages between two simulated nodes in virtual time and returns what arrived when.
+Arrivals RunLossyExchange(uint32_t seed, int count) {
+  AsioService asio_service(1);
+  Simulation simulation(asio_service);
+  const Clock::time_point kStart(Clock::now());
+  Arrivals arrivals;
+  SimulatedNetwork::Config config;
+  config.latency = std::chrono::milliseconds(50);
+  config.jitter = std::chrono::milliseconds(20);
+  config.loss_rate = 0.3;
+  config.seed = seed;
+  SimulatedNetwork network(config, &asio_service);
+  std::unique_ptr<Transport> transport0(network.MakeTransport()),
+      transport1(network.MakeTransport());
+  std::string seed_string(std::to_string(seed));
+  NodeId id0(seed_string + std::string(NodeId::kSize - seed_string.size(), 'a')),
+      id1(seed_string + std::string(NodeId::kSize - seed_string.size(), 'b')), chosen0, chosen1;
+  rudp::NatType nat_type;
+  auto zero_state(std::async(std::launch::async, [&] {
+    return transport0->Bootstrap(BootstrapContacts(), [](const std::string&) {},
+                                 [](const NodeId&) {}, id0, nullptr, nullptr, chosen0, nat_type,
+                                 boost::asio::ip::udp::endpoint(
+                                     boost::asio::ip::address_v4::loopback(), 6000));
+  }));
+  rudp::NatType nat_type1;
+  EXPECT_EQ(kSuccess,
+            transport1->Bootstrap(BootstrapContacts(), [&](const std::string& message) {
+                                    arrivals.push_back(std::make_pair(message,
+                                                                      Clock::now() - kStart));
+                                  },
+                                  [](const NodeId&) {}, id1, nullptr, nullptr, chosen1, nat_type1,
+                                  boost::asio::ip::udp::endpoint(
+                                      boost::asio::ip::address_v4::loopback(), 6001)));
+  EXPECT_EQ(kSuccess, zero_state.get());
+
+  simulation.Schedule(std::chrono::seconds(1), [&] {
+    for (int i(0); i != count; ++i)
+      transport0->Send(id1, std::to_string(i), nullptr);
+  });
+  EXPECT_FALSE(simulation.RunFor(std::chrono::seconds(10)));
+  return arrivals;
+}
+
+}  // unnamed namespace
+
+TEST(SimulationTest, BEH_RunsHoursInSeconds) {
+  AsioService asio_service(1);
+  Simulation simulation(asio_service);
+  const Clock::time_point kStart(Clock::now());
+  std::vector<Clock::duration> fired;
+  for (int hour(3); hour != 0; --hour) {
+    simulation.Schedule(std::chrono::hours(hour), [&] {
+      fired.push_back(Clock::now() - kStart);
+      // Events may schedule further events.
+      simulation.Schedule(std::chrono::minutes(30),
+                          [&] { fired.push_back(Clock::now() - kStart); });
+    });
+  }
+
+  auto real_start(std::chrono::steady_clock::now());
+  EXPECT_FALSE(simulation.RunFor(std::chrono::hours(4)));
+  EXPECT_LT(std::chrono::steady_clock::now() - real_start, std::chrono::seconds(5));
+  EXPECT_EQ(kStart + std::chrono::hours(4), Clock::now());
+  std::vector<Clock::duration> expected;
+  for (int half_hours(2); half_hours != 8; ++half_hours)
+    expected.push_back(std::chrono::minutes(30 * half_hours));
+  EXPECT_EQ(expected, fired);
+
+  // Running stops as soon as the condition holds.
+  int count(0);
+  for (int minute(1); minute != 10; ++minute)
+    simulation.Schedule(std::chrono::minutes(minute), [&] { ++count; });
+  EXPECT_TRUE(simulation.RunFor(std::chrono::hours(1), [&] { return count == 3; }));
+  EXPECT_EQ(kStart + std::chrono::hours(4) + std::chrono::minutes(3), Clock::now());
+  EXPECT_FALSE(simulation.RunFor(std::chrono::hours(1)));
+  EXPECT_EQ(9, count);
+}
+
+TEST(SimulationTest, BEH_RepeatableFromSeed) {
+  const int kCount(200);
+  Arrivals first(RunLossyExchange(1, kCount));
+  EXPECT_LT(first.size(), static_cast<size_t>(kCount));
+  EXPECT_GT(first.size(), static_cast<size_t>(kCount / 2));
+  for (size_t i(1); i < first.size(); ++i)
+    EXPECT_LE(first.at(i - 1).second, first.at(i).second);
+  EXPECT_EQ(first, RunLossyExchange(1, kCount));
+  EXPECT_NE(first, RunLossyExchange(2, kCount));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
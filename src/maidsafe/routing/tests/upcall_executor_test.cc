@@ -0,0 +1,158 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/upcall_executor.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(UpcallExecutorTest, BEH_RunsInlineWithoutThreads) {
+  UpcallExecutor executor(0, 0);
+  std::thread::id ran_on;
+  EXPECT_TRUE(executor.Post([&ran_on] { ran_on = std::this_thread::get_id(); }));
+  EXPECT_EQ(std::this_thread::get_id(), ran_on);
+  EXPECT_EQ(0U, executor.overloaded());
+}
+
+TEST(UpcallExecutorTest, BEH_RunsOffCallerThread) {
+  UpcallExecutor executor(2, 16);
+  std::promise<std::thread::id> ran_on;
+  auto future(ran_on.get_future());
+  EXPECT_TRUE(executor.Post([&ran_on] { ran_on.set_value(std::this_thread::get_id()); }));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+  EXPECT_NE(std::this_thread::get_id(), future.get());
+}
+
+TEST(UpcallExecutorTest, BEH_BoundedQueue) {
+  const size_t kMaxQueued(4);
+  std::promise<void> started, release;
+  auto started_future(started.get_future());
+  auto release_future(release.get_future().share());
+  std::atomic<int> ran(0);
+  {
+    UpcallExecutor executor(1, kMaxQueued);
+    // Occupy the only thread with a slow upcall.
+    EXPECT_TRUE(executor.Post([&started, release_future, &ran] {
+      started.set_value();
+      release_future.wait();
+      ++ran;
+    }));
+    ASSERT_EQ(std::future_status::ready, started_future.wait_for(std::chrono::seconds(5)));
+
+    for (size_t i(0); i != kMaxQueued; ++i)
+      EXPECT_TRUE(executor.Post([&ran] { ++ran; }));
+    EXPECT_EQ(kMaxQueued, executor.queued());
+    EXPECT_FALSE(executor.Post([&ran] { ++ran; }));
+    EXPECT_FALSE(executor.Post([&ran] { ++ran; }));
+    EXPECT_EQ(2U, executor.overloaded());
+
+    release.set_value();
+    auto deadline(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    while (executor.queued() != 0 && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(0U, executor.queued());
+    EXPECT_TRUE(executor.Post([&ran] { ++ran; }));
+  }
+  // The destructor may discard the last upcall if it was still queued, but not one in progress.
+  EXPECT_GE(ran, static_cast<int>(kMaxQueued) + 1);
+  EXPECT_LE(ran, static_cast<int>(kMaxQueued) + 2);
+}
+
+TEST(UpcallExecutorTest, BEH_SurvivesThrowingUpcall) {
+  UpcallExecutor executor(1, 16);
+  std::promise<void> ran;
+  auto future(ran.get_future());
+  EXPECT_TRUE(executor.Post([] { throw std::runtime_error("upcall"); }));
+  EXPECT_TRUE(executor.Post([&ran] { ran.set_value(); }));
+  EXPECT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+}
+
+TEST(UpcallExecutorTest, BEH_ScopeSkipsQueuedUpcalls) {
+  UpcallExecutor executor(1, 16);
+  std::promise<void> started, release;
+  auto started_future(started.get_future());
+  auto release_future(release.get_future().share());
+  EXPECT_TRUE(executor.Post([&started, release_future] {
+    started.set_value();
+    release_future.wait();
+  }));
+  ASSERT_EQ(std::future_status::ready, started_future.wait_for(std::chrono::seconds(5)));
+
+  std::atomic<int> skipped(0), ran(0);
+  {
+    UpcallScope scope(executor);
+    for (int i(0); i != 3; ++i)
+      EXPECT_TRUE(scope.Post([&skipped] { ++skipped; }));
+  }
+  UpcallScope other_scope(executor);
+  std::promise<void> other_ran;
+  auto other_future(other_ran.get_future());
+  EXPECT_TRUE(other_scope.Post([&ran, &other_ran] {
+    ++ran;
+    other_ran.set_value();
+  }));
+  release.set_value();
+  ASSERT_EQ(std::future_status::ready, other_future.wait_for(std::chrono::seconds(5)));
+  EXPECT_EQ(0, skipped);
+  EXPECT_EQ(1, ran);
+}
+
+TEST(UpcallExecutorTest, BEH_ScopeWaitsForRunningUpcall) {
+  UpcallExecutor executor(2, 16);
+  std::promise<void> started;
+  auto started_future(started.get_future());
+  std::atomic<bool> finished(false);
+  {
+    UpcallScope scope(executor);
+    EXPECT_TRUE(scope.Post([&started, &finished] {
+      started.set_value();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      finished = true;
+    }));
+    ASSERT_EQ(std::future_status::ready, started_future.wait_for(std::chrono::seconds(5)));
+  }
+  EXPECT_TRUE(finished);
+
+  // An upcall may destroy its own scope without waiting for itself.
+  std::promise<void> destroyed;
+  auto destroyed_future(destroyed.get_future());
+  std::unique_ptr<UpcallScope> scope(new UpcallScope(executor));
+  EXPECT_TRUE(scope->Post([&scope, &destroyed] {
+    scope.reset();
+    destroyed.set_value();
+  }));
+  EXPECT_EQ(std::future_status::ready, destroyed_future.wait_for(std::chrono::seconds(5)));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
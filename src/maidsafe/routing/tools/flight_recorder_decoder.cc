@@ -0,0 +1,155 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Prints a binary dump written by FlightRecorder::Dump (Routing::DumpFlightRecorder or the
+// Parameters::flight_recorder_dump_signal handler) as text, one record per line.
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "boost/program_options.hpp"
+
+#include "maidsafe/routing/flight_recorder.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+const char* EventString(maidsafe::routing::FlightEvent event) {
+  switch (event) {
+    case maidsafe::routing::FlightEvent::kReceived:
+      return "received";
+    case maidsafe::routing::FlightEvent::kDelivered:
+      return "delivered";
+    case maidsafe::routing::FlightEvent::kSent:
+      return "sent";
+    case maidsafe::routing::FlightEvent::kDropped:
+      return "dropped";
+  }
+  return "unknown";
+}
+
+const char* DropReasonString(uint8_t reason) {
+  static const char* const kReasons[] = {"parse_failure", "firewall", "invalid_message",
+                                         "hops_to_live", "client_to_client",
+                                         "client_over_budget", "vault_over_budget",
+                                         "upcall_overload", "send_queue_full"};
+  return reason < sizeof(kReasons) / sizeof(kReasons[0]) ? kReasons[reason] : "unknown";
+}
+
+const char* MessageTypeString(int32_t type) {
+  static const char* const kTypes[] = {"unknown", "ping", "connect", "find_nodes",
+                                       "connect_success", "connect_success_ack", "get_group",
+                                       "inform_client", "ack"};
+  if (type == 101)
+    return "node_level";
+  return (type > 0 && type < 9) ? kTypes[type] : kTypes[0];
+}
+
+std::string Hex(uint64_t prefix) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(prefix));
+  return buffer;
+}
+
+std::string WallTime(int64_t nanoseconds) {
+  std::time_t seconds(static_cast<std::time_t>(nanoseconds / 1000000000));
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::gmtime(&seconds));
+  char fraction[16];
+  std::snprintf(fraction, sizeof(fraction), ".%06d", static_cast<int>(nanoseconds % 1000000000 /
+                                                                      1000));
+  return std::string(buffer) + fraction;
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv) {
+  using maidsafe::routing::FlightRecord;
+  using maidsafe::routing::FlightRecordHeader;
+  try {
+    po::options_description options("Options");
+    options.add_options()("help,h", "Print this help message")(
+        "input,i", po::value<std::string>(), "Flight recorder dump to decode")(
+        "csv,c", "Print comma-separated values instead of aligned text");
+    po::positional_options_description positional;
+    positional.add("input", 1);
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv).options(options).positional(positional).run(),
+              variables_map);
+    po::notify(variables_map);
+    if (variables_map.count("help") || !variables_map.count("input")) {
+      std::cout << "Usage: " << argv[0] << " [options] <dump file>\n" << options << std::endl;
+      return 0;
+    }
+
+    std::ifstream stream(variables_map["input"].as<std::string>(), std::ios::binary);
+    FlightRecordHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != FlightRecordHeader::kMagic) {
+      std::cout << "Error: not a flight recorder dump." << std::endl;
+      return -1;
+    }
+    if (header.version != FlightRecordHeader::kVersion ||
+        header.record_size != sizeof(FlightRecord)) {
+      std::cout << "Error: unsupported dump version " << header.version << "." << std::endl;
+      return -1;
+    }
+    std::vector<FlightRecord> records(static_cast<size_t>(header.record_count));
+    if (!records.empty() &&
+        !stream.read(reinterpret_cast<char*>(records.data()),
+                     static_cast<std::streamsize>(records.size() * sizeof(FlightRecord)))) {
+      std::cout << "Error: dump is truncated." << std::endl;
+      return -1;
+    }
+
+    bool csv(variables_map.count("csv") != 0);
+    if (csv)
+      std::cout << "time,thread,node,event,type,id,source,destination,next_hop,drop_reason\n";
+    for (const auto& record : records) {
+      std::string time(WallTime(header.system_time - (header.steady_time - record.timestamp)));
+      bool dropped(record.event == maidsafe::routing::FlightEvent::kDropped);
+      if (csv) {
+        std::cout << time << ',' << record.thread << ',' << Hex(record.node) << ','
+                  << EventString(record.event) << ',' << MessageTypeString(record.message_type)
+                  << ',' << record.message_id << ',' << Hex(record.source) << ','
+                  << Hex(record.destination) << ',' << Hex(record.next_hop) << ','
+                  << (dropped ? DropReasonString(record.drop_reason) : "") << '\n';
+      } else {
+        std::cout << time << "  [" << record.thread << "] " << Hex(record.node) << ' '
+                  << EventString(record.event) << ' ' << MessageTypeString(record.message_type)
+                  << " id " << record.message_id << "  " << Hex(record.source) << " -> "
+                  << Hex(record.destination);
+        if (record.next_hop != 0)
+          std::cout << " via " << Hex(record.next_hop);
+        if (dropped)
+          std::cout << " (" << DropReasonString(record.drop_reason) << ')';
+        std::cout << '\n';
+      }
+    }
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    return -2;
+  }
+  return 0;
+}
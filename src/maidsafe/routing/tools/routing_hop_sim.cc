@@ -0,0 +1,447 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Compares routing table configurations by simulating greedy XOR forwarding across a network of
+// vault routing tables.  Each table is built with the vaults' own admission and eviction rules
+// (BucketOccupancy) from the ids offered to it: its close nodes first, as joining finds them, then
+// a random sample of the network.  No connections or keys are involved, so networks of tens of
+// thousands of nodes are practical.  A message hops to the peer closest to its destination until
+// it arrives or no peer is closer.  One-way link latency is modelled from random positions on a
+// unit square.
+//
+// Each message is a request from a random node, to one of a few hot destinations or else to a
+// random node, followed by the reply.  With --proximity, each run is repeated with proximity
+// routing: a node chooses among its closest candidates using
+// PeerStatistics, fed with the modelled hop ack round trip time of each send.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>  // NOLINT
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/bucket_occupancy.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/peer_statistics.h"
+#include "maidsafe/routing/peer_trie.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+using maidsafe::NodeId;
+using maidsafe::routing::BucketOccupancy;
+using maidsafe::routing::Parameters;
+using maidsafe::routing::PeerStatistics;
+using maidsafe::routing::PeerTrie;
+using maidsafe::routing::PeerView;
+
+struct Config {
+  unsigned int table_size, bucket_target_size;
+};
+
+struct SimulatedNetwork {
+  std::vector<NodeId> ids;
+  std::map<NodeId, uint32_t> indices;
+  std::vector<std::pair<double, double>> positions;
+  PeerTrie all_peers;
+};
+
+struct Workload {
+  size_t requests, hot_destinations;
+  double hot_fraction;
+  bool proximity_routing;
+  uint32_t seed;
+};
+
+struct Result {
+  Result()
+      : config(), proximity_routing(false), mean_table_size(0), lookups(0), delivered(0),
+        hop_samples(), latency_samples() {}
+  Config config;
+  bool proximity_routing;
+  double mean_table_size;
+  size_t lookups, delivered;
+  std::vector<unsigned int> hop_samples;
+  std::vector<double> latency_samples;
+};
+
+// Parses e.g. "64:1,2048:32" into table size and bucket target size pairs.
+std::vector<Config> ParseConfigs(const std::string& configs) {
+  std::vector<Config> parsed;
+  size_t begin(0);
+  while (begin < configs.size()) {
+    size_t end(std::min(configs.find(',', begin), configs.size()));
+    std::string entry(configs.substr(begin, end - begin));
+    size_t colon(entry.find(':'));
+    if (colon == std::string::npos)
+      throw std::logic_error("Invalid config entry '" + entry + "'.");
+    Config config = {static_cast<unsigned int>(std::stoul(entry.substr(0, colon))),
+                     static_cast<unsigned int>(std::stoul(entry.substr(colon + 1)))};
+    if (config.table_size <= Parameters::unidirectional_interest_range ||
+        config.bucket_target_size == 0)
+      throw std::logic_error("Table size must exceed unidirectional_interest_range and bucket "
+                             "target size must be positive in '" + entry + "'.");
+    parsed.push_back(config);
+    begin = end + 1;
+  }
+  if (parsed.empty())
+    throw std::logic_error("No configs given.");
+  return parsed;
+}
+
+void MakeNetwork(size_t size, std::mt19937& random, SimulatedNetwork& network) {
+  std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+  while (network.ids.size() != size) {
+    NodeId node_id(NodeId::IdType::kRandomId);
+    if (!network.indices.insert(std::make_pair(node_id, network.ids.size())).second)
+      continue;
+    network.ids.push_back(node_id);
+    network.positions.push_back(std::make_pair(coordinate(random), coordinate(random)));
+    PeerView peer;
+    peer.id = node_id;
+    network.all_peers.Insert(peer);
+  }
+}
+
+// Builds the routing table of node 'index' from 'offers' candidates, returning the indices of the
+// nodes it holds.  'positions' maps node index to position in the returned table, or -1, and is
+// left as it was found.
+std::vector<uint32_t> BuildTable(const SimulatedNetwork& network, uint32_t index,
+                                 const Config& config, size_t offers, std::mt19937& random,
+                                 std::vector<int32_t>& positions) {
+  const NodeId& kNodeId(network.ids[index]);
+  BucketOccupancy buckets(kNodeId);
+  std::vector<uint32_t> table;
+  table.reserve(config.table_size);
+
+  auto offer([&](uint32_t candidate) {
+    if (candidate == index || positions[candidate] != -1)
+      return;
+    const NodeId& kCandidateId(network.ids[candidate]);
+    int32_t bucket(BucketOccupancy::BucketIndex(kNodeId, kCandidateId));
+    if (table.size() == config.table_size) {
+      NodeId evictee;
+      if (!buckets.ChooseEviction(kCandidateId, bucket, evictee))
+        return;
+      uint32_t evicted(network.indices.at(evictee));
+      buckets.Remove(evictee, BucketOccupancy::BucketIndex(kNodeId, evictee));
+      int32_t gap(positions[evicted]);
+      table[gap] = table.back();
+      positions[table[gap]] = gap;
+      table.pop_back();
+      positions[evicted] = -1;
+    }
+    buckets.Add(kCandidateId, bucket);
+    positions[candidate] = static_cast<int32_t>(table.size());
+    table.push_back(candidate);
+  });
+
+  std::vector<PeerView> close_nodes;
+  network.all_peers.GetClosest(kNodeId,
+                               Parameters::unidirectional_interest_range + 1, close_nodes);
+  for (const auto& close_node : close_nodes)
+    offer(network.indices.at(close_node.id));
+  std::uniform_int_distribution<uint32_t> choose_node(
+      0, static_cast<uint32_t>(network.ids.size() - 1));
+  for (size_t i(0); i != offers; ++i)
+    offer(choose_node(random));
+
+  for (uint32_t held : table)
+    positions[held] = -1;
+  return table;
+}
+
+double LinkLatencyMs(const SimulatedNetwork& network, uint32_t from, uint32_t to) {
+  double dx(network.positions[from].first - network.positions[to].first),
+      dy(network.positions[from].second - network.positions[to].second);
+  return 2.0 + 100.0 * std::sqrt(dx * dx + dy * dy);
+}
+
+struct RoutingTables {
+  std::vector<std::vector<uint32_t>> tables;  // Sorted by node index.
+  double mean_table_size;
+};
+
+void BuildTables(const SimulatedNetwork& network, const Config& config, size_t offers,
+                 std::mt19937& random, RoutingTables& routing_tables) {
+  auto bucket_target_size(Parameters::bucket_target_size);
+  Parameters::bucket_target_size = config.bucket_target_size;
+  std::vector<int32_t> positions(network.ids.size(), -1);
+  size_t total_size(0);
+  for (uint32_t i(0); i != network.ids.size(); ++i) {
+    routing_tables.tables.push_back(BuildTable(network, i, config, offers, random, positions));
+    std::sort(routing_tables.tables.back().begin(), routing_tables.tables.back().end());
+    total_size += routing_tables.tables.back().size();
+  }
+  Parameters::bucket_target_size = bucket_target_size;
+  routing_tables.mean_table_size = static_cast<double>(total_size) / network.ids.size();
+}
+
+// Per-node choice of next hop from the routing table: the peer closest to the target or, with
+// proximity routing, as Network::GetProximityPeer chooses.
+class NextHops {
+ public:
+  NextHops(const SimulatedNetwork& network, const RoutingTables& routing_tables,
+           bool proximity_routing)
+      : network_(network), routing_tables_(routing_tables), peer_statistics_(),
+        kProximityRouting_(proximity_routing) {
+    if (kProximityRouting_)
+      peer_statistics_.resize(network.ids.size());
+  }
+
+  // Returns 'node' if no peer is closer to the target.
+  uint32_t Choose(uint32_t node, const NodeId& target) {
+    std::vector<uint32_t> candidates;
+    for (uint32_t peer : routing_tables_.tables[node]) {
+      if (NodeId::CloserToTarget(network_.ids[peer], network_.ids[node], target))
+        candidates.push_back(peer);
+    }
+    if (candidates.empty())
+      return node;
+    auto closer([&](uint32_t lhs, uint32_t rhs) {
+      return NodeId::CloserToTarget(network_.ids[lhs], network_.ids[rhs], target);
+    });
+    if (!kProximityRouting_)
+      return *std::min_element(candidates.begin(), candidates.end(), closer);
+
+    size_t count(std::min(candidates.size(),
+                          static_cast<size_t>(Parameters::proximity_routing_candidates)));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), closer);
+    if (network_.ids[candidates.front()] == target)
+      return candidates.front();
+    candidates.resize(count);
+    auto& peer_statistics(peer_statistics_[node]);
+    if (!peer_statistics)
+      peer_statistics.reset(new PeerStatistics);
+    std::vector<NodeId> connection_ids;
+    for (uint32_t candidate : candidates) {
+      peer_statistics->Add(network_.ids[candidate]);
+      connection_ids.push_back(network_.ids[candidate]);
+    }
+    uint32_t chosen(candidates.at(peer_statistics->SelectLowestCost(connection_ids)));
+    auto round_trip(std::chrono::microseconds(
+        static_cast<int64_t>(2000.0 * LinkLatencyMs(network_, node, chosen))));
+    peer_statistics->AddSendStart(network_.ids[chosen]);
+    peer_statistics->AddSendResult(network_.ids[chosen]);
+    peer_statistics->AddRoundTrip(network_.ids[chosen], round_trip);
+    return chosen;
+  }
+
+ private:
+  const SimulatedNetwork& network_;
+  const RoutingTables& routing_tables_;
+  std::vector<std::unique_ptr<PeerStatistics>> peer_statistics_;
+  const bool kProximityRouting_;
+};
+
+// Routes a message from 'source' to 'destination'.  Returns false if it isn't delivered.
+bool Route(const SimulatedNetwork& network, uint32_t source, uint32_t destination,
+           NextHops& next_hops, Result& result) {
+  const NodeId& kTarget(network.ids[destination]);
+  uint32_t current(source);
+  unsigned int hops(0);
+  double latency(0.0);
+  while (current != destination && hops != Parameters::hops_to_live) {
+    uint32_t next(next_hops.Choose(current, kTarget));
+    if (next == current)
+      break;
+    latency += LinkLatencyMs(network, current, next);
+    current = next;
+    ++hops;
+  }
+  ++result.lookups;
+  if (current != destination)
+    return false;
+  ++result.delivered;
+  result.hop_samples.push_back(hops);
+  result.latency_samples.push_back(latency);
+  return true;
+}
+
+Result Simulate(const SimulatedNetwork& network, const RoutingTables& routing_tables,
+                const Config& config, const Workload& workload) {
+  Result result;
+  result.config = config;
+  result.proximity_routing = workload.proximity_routing;
+  result.mean_table_size = routing_tables.mean_table_size;
+  NextHops next_hops(network, routing_tables, workload.proximity_routing);
+
+  std::mt19937 random(workload.seed);
+  std::uniform_int_distribution<uint32_t> choose_node(
+      0, static_cast<uint32_t>(network.ids.size() - 1));
+  std::uniform_int_distribution<uint32_t> choose_hot(
+      0, static_cast<uint32_t>(std::min(workload.hot_destinations, network.ids.size()) - 1));
+  std::bernoulli_distribution hot(workload.hot_fraction);
+  for (size_t i(0); i != workload.requests; ++i) {
+    uint32_t source(choose_node(random));
+    uint32_t destination(hot(random) ? choose_hot(random) : choose_node(random));
+    if (source == destination)
+      continue;
+    if (Route(network, source, destination, next_hops, result))
+      Route(network, destination, source, next_hops, result);
+  }
+  std::sort(result.hop_samples.begin(), result.hop_samples.end());
+  std::sort(result.latency_samples.begin(), result.latency_samples.end());
+  return result;
+}
+
+template <typename T>
+T Percentile(const std::vector<T>& sorted, double percentile) {
+  if (sorted.empty())
+    return T();
+  size_t index(static_cast<size_t>(percentile * sorted.size()));
+  return sorted.at(std::min(index, sorted.size() - 1));
+}
+
+template <typename T>
+double Mean(const std::vector<T>& samples) {
+  double total(0.0);
+  for (const auto& sample : samples)
+    total += sample;
+  return samples.empty() ? 0.0 : total / samples.size();
+}
+
+void WriteReport(const std::vector<Result>& results, size_t network_size, bool json,
+                 std::ostream& stream) {
+  if (json)
+    stream << "{\"nodes\":" << network_size << ",\"configs\":[";
+  else
+    stream << "table_size,bucket_target_size,proximity_routing,mean_table_size,lookups,"
+              "delivered,mean_hops,p50_hops,p99_hops,mean_latency_ms,p50_latency_ms,"
+              "p99_latency_ms\n";
+  for (size_t i(0); i != results.size(); ++i) {
+    const auto& result(results[i]);
+    if (json) {
+      stream << (i == 0 ? "" : ",") << "{\"table_size\":" << result.config.table_size
+             << ",\"bucket_target_size\":" << result.config.bucket_target_size
+             << ",\"proximity_routing\":" << (result.proximity_routing ? "true" : "false")
+             << ",\"mean_table_size\":" << result.mean_table_size
+             << ",\"lookups\":" << result.lookups << ",\"delivered\":" << result.delivered
+             << ",\"mean_hops\":" << Mean(result.hop_samples)
+             << ",\"p50_hops\":" << Percentile(result.hop_samples, 0.5)
+             << ",\"p99_hops\":" << Percentile(result.hop_samples, 0.99)
+             << ",\"mean_latency_ms\":" << Mean(result.latency_samples)
+             << ",\"p50_latency_ms\":" << Percentile(result.latency_samples, 0.5)
+             << ",\"p99_latency_ms\":" << Percentile(result.latency_samples, 0.99) << '}';
+    } else {
+      stream << result.config.table_size << ',' << result.config.bucket_target_size << ','
+             << result.proximity_routing << ',' << result.mean_table_size << ','
+             << result.lookups << ',' << result.delivered << ','
+             << Mean(result.hop_samples) << ',' << Percentile(result.hop_samples, 0.5) << ','
+             << Percentile(result.hop_samples, 0.99) << ',' << Mean(result.latency_samples)
+             << ',' << Percentile(result.latency_samples, 0.5) << ','
+             << Percentile(result.latency_samples, 0.99) << '\n';
+    }
+  }
+  if (json)
+    stream << "]}\n";
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+
+  try {
+    po::options_description options_description("Options");
+    options_description.add_options()("help,h", "Print this help message")(
+        "nodes,n", po::value<size_t>()->default_value(10000), "Number of vaults in the network")(
+        "configs,c", po::value<std::string>()->default_value("64:1,512:8,2048:32"),
+        "Comma-separated table_size:bucket_target_size pairs to compare; 64:1 is the default")(
+        "offers", po::value<size_t>()->default_value(8192),
+        "Random nodes offered to each table after its close nodes")(
+        "lookups,l", po::value<size_t>()->default_value(10000),
+        "Requests routed per config, each followed by its reply")(
+        "hot-destinations", po::value<size_t>()->default_value(100),
+        "Number of nodes which hot requests are sent to")(
+        "hot-fraction", po::value<double>()->default_value(0.8),
+        "Fraction of requests sent to a hot destination")(
+        "proximity", "Also run every config with proximity routing")(
+        "seed", po::value<uint32_t>()->default_value(0), "Seed for the simulation")(
+        "format,f", po::value<std::string>()->default_value("csv"), "Report format: csv or json")(
+        "output,o", po::value<std::string>(), "Report file (default is stdout)");
+
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv).options(options_description)
+                  .allow_unregistered().run(), variables_map);
+    po::notify(variables_map);
+    if (variables_map.count("help")) {
+      std::cout << options_description << std::endl;
+      return 0;
+    }
+
+    const size_t kNetworkSize(variables_map["nodes"].as<size_t>());
+    const std::string kFormat(variables_map["format"].as<std::string>());
+    const std::vector<Config> kConfigs(ParseConfigs(variables_map["configs"].as<std::string>()));
+    if (kNetworkSize < 2 || (kFormat != "csv" && kFormat != "json"))
+      throw std::logic_error("Invalid network size or format.");
+
+    std::mt19937 random(variables_map["seed"].as<uint32_t>());
+    SimulatedNetwork network;
+    MakeNetwork(kNetworkSize, random, network);
+    std::vector<Result> results;
+    Workload workload = {variables_map["lookups"].as<size_t>(),
+                         variables_map["hot-destinations"].as<size_t>(),
+                         variables_map["hot-fraction"].as<double>(), false,
+                         static_cast<uint32_t>(random())};
+    if (workload.hot_destinations == 0 || workload.hot_fraction < 0.0 ||
+        workload.hot_fraction > 1.0)
+      throw std::logic_error("Invalid hot destinations or fraction.");
+    std::vector<bool> proximity_routing(1, false);
+    if (variables_map.count("proximity"))
+      proximity_routing.push_back(true);
+    for (const auto& config : kConfigs) {
+      auto start(std::chrono::steady_clock::now());
+      RoutingTables routing_tables;
+      BuildTables(network, config, variables_map["offers"].as<size_t>(), random, routing_tables);
+      for (bool proximity : proximity_routing) {
+        workload.proximity_routing = proximity;
+        results.push_back(Simulate(network, routing_tables, config, workload));
+      }
+      std::cerr << "Simulated " << config.table_size << ':' << config.bucket_target_size
+                << " in " << std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::steady_clock::now() - start).count() << " s"
+                << std::endl;
+    }
+
+    if (variables_map.count("output")) {
+      std::ofstream stream(variables_map["output"].as<std::string>());
+      WriteReport(results, kNetworkSize, kFormat == "json", stream);
+    } else {
+      WriteReport(results, kNetworkSize, kFormat == "json", std::cout);
+    }
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
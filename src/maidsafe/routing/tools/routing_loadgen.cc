@@ -0,0 +1,502 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Open-loop load generator for a running routing network, e.g. one started with routing_node.
+// Requests are issued at a fixed rate regardless of how many are outstanding, and each latency is
+// measured from the time the request was due to be sent, so a stalled network shows up in the
+// percentiles rather than silently lowering the offered load.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/asio/ip/address.hpp"
+#include "boost/asio/ip/udp.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/crypto.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/types.h"
+#include "maidsafe/passport/detail/fob.h"
+
+#include "maidsafe/routing/bootstrap_file_operations.h"
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_api.h"
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace {
+
+using maidsafe::NodeId;
+using maidsafe::routing::Routing;
+
+typedef std::vector<maidsafe::passport::detail::AnmaidToPmid> KeysVector;
+typedef std::chrono::steady_clock::duration Duration;
+typedef std::chrono::steady_clock::time_point TimePoint;
+
+enum Operation : size_t { kDirect = 0, kGroup, kTyped, kCachedGet, kOperationCount };
+
+const char* const kOperationNames[kOperationCount] = {"direct", "group", "typed", "cached_get"};
+
+// Counts and latency samples for one operation.  Samples are kept in full so that the tail
+// percentiles are exact.
+struct OperationStats {
+  OperationStats() : sent(0), completed(0), failed(0), shed(0), samples() {}
+  uint64_t sent, completed, failed, shed;
+  std::vector<Duration> samples;
+};
+
+class LoadStats {
+ public:
+  LoadStats() : mutex_(), stats_(kOperationCount) {}
+  void AddSent(Operation operation) { Update(operation, [](OperationStats& s) { ++s.sent; }); }
+  void AddShed(Operation operation) { Update(operation, [](OperationStats& s) { ++s.shed; }); }
+  void AddFailed(Operation operation) {
+    Update(operation, [](OperationStats& s) { ++s.failed; });
+  }
+  void AddCompleted(Operation operation, Duration latency) {
+    Update(operation, [latency](OperationStats& s) {
+      ++s.completed;
+      s.samples.push_back(latency);
+    });
+  }
+  // Returns the stats for each operation followed by their total.
+  std::vector<OperationStats> Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<OperationStats> snapshot(stats_);
+    OperationStats total;
+    for (auto& stats : snapshot) {
+      std::sort(stats.samples.begin(), stats.samples.end());
+      total.sent += stats.sent;
+      total.completed += stats.completed;
+      total.failed += stats.failed;
+      total.shed += stats.shed;
+      total.samples.insert(total.samples.end(), stats.samples.begin(), stats.samples.end());
+    }
+    std::sort(total.samples.begin(), total.samples.end());
+    snapshot.push_back(total);
+    return snapshot;
+  }
+
+ private:
+  template <typename Functor>
+  void Update(Operation operation, Functor functor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    functor(stats_[operation]);
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<OperationStats> stats_;
+};
+
+int64_t PercentileMicroseconds(const std::vector<Duration>& sorted, double percentile) {
+  if (sorted.empty())
+    return 0;
+  size_t index(static_cast<size_t>(percentile * sorted.size()));
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             sorted.at(std::min(index, sorted.size() - 1))).count();
+}
+
+void WriteReport(const std::vector<OperationStats>& snapshot, Duration elapsed, bool json,
+                 std::ostream& stream) {
+  double seconds(std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count());
+  if (json)
+    stream << "{\"elapsed_s\":" << seconds << ",\"operations\":[";
+  else
+    stream << "operation,sent,completed,failed,shed,throughput_per_s,p50_us,p99_us,p999_us,"
+              "max_us\n";
+  for (size_t i(0); i != snapshot.size(); ++i) {
+    const auto& stats(snapshot[i]);
+    const std::string kName(i < kOperationCount ? kOperationNames[i] : "all");
+    double throughput(seconds > 0 ? stats.completed / seconds : 0.0);
+    int64_t p50(PercentileMicroseconds(stats.samples, 0.5)),
+        p99(PercentileMicroseconds(stats.samples, 0.99)),
+        p999(PercentileMicroseconds(stats.samples, 0.999)),
+        max(PercentileMicroseconds(stats.samples, 1.0));
+    if (json) {
+      stream << (i == 0 ? "" : ",") << "{\"operation\":\"" << kName << "\",\"sent\":" << stats.sent
+             << ",\"completed\":" << stats.completed << ",\"failed\":" << stats.failed
+             << ",\"shed\":" << stats.shed << ",\"throughput_per_s\":" << throughput
+             << ",\"p50_us\":" << p50 << ",\"p99_us\":" << p99 << ",\"p999_us\":" << p999
+             << ",\"max_us\":" << max << '}';
+    } else {
+      stream << kName << ',' << stats.sent << ',' << stats.completed << ',' << stats.failed << ','
+             << stats.shed << ',' << throughput << ',' << p50 << ',' << p99 << ',' << p999 << ','
+             << max << '\n';
+    }
+  }
+  if (json)
+    stream << "]}\n";
+}
+
+// Parses e.g. "direct:60,group:20,typed:10,cached_get:10" into a weight per operation.
+std::vector<double> ParseMix(const std::string& mix) {
+  std::vector<double> weights(kOperationCount, 0.0);
+  size_t begin(0);
+  while (begin < mix.size()) {
+    size_t end(std::min(mix.find(',', begin), mix.size()));
+    std::string entry(mix.substr(begin, end - begin));
+    size_t colon(entry.find(':'));
+    auto name(std::find(std::begin(kOperationNames), std::end(kOperationNames),
+                        entry.substr(0, colon)));
+    if (colon == std::string::npos || name == std::end(kOperationNames))
+      throw std::logic_error("Invalid mix entry '" + entry + "'.");
+    weights[name - std::begin(kOperationNames)] = std::stod(entry.substr(colon + 1));
+    begin = end + 1;
+  }
+  if (std::all_of(weights.begin(), weights.end(), [](double weight) { return weight <= 0; }))
+    throw std::logic_error("Mix '" + mix + "' has no positive weights.");
+  return weights;
+}
+
+maidsafe::routing::Functors MakeFunctors(const KeysVector& all_keys, int& health,
+                                         std::mutex& mutex, std::condition_variable& cond_var,
+                                         const NodeId& node_id) {
+  maidsafe::routing::Functors functors;
+  functors.network_status = [&health, &mutex, &cond_var, node_id](int updated_health) {
+    maidsafe::routing::UpdateNetworkHealth(updated_health, health, mutex, cond_var, node_id);
+  };
+  functors.request_public_key = [&all_keys](const NodeId& peer_id,
+                                            maidsafe::routing::GivePublicKeyFunctor give_key) {
+    for (const auto& keys : all_keys) {
+      if (NodeId(keys.pmid.name()->string()) == peer_id)
+        return give_key(keys.pmid.public_key());
+    }
+  };
+  return functors;
+}
+
+// A vault joined to the network, using the typed message API if 'typed_receiver' is set and the
+// string one otherwise.
+class LoadNode {
+ public:
+  typedef std::function<void(const maidsafe::routing::SingleToSingleMessage&)> TypedReceiver;
+
+  LoadNode(const KeysVector& all_keys, size_t identity_index, TypedReceiver typed_receiver)
+      : mutex_(), cond_var_(), health_(0), routing_(new Routing(all_keys.at(identity_index).pmid)) {
+    auto functors(MakeFunctors(all_keys, health_, mutex_, cond_var_, routing_->kNodeId()));
+    if (typed_receiver) {
+      auto& typed(functors.typed_message_and_caching);
+      typed.single_to_single.message_received = typed_receiver;
+      typed.single_to_group.message_received = [](
+          const maidsafe::routing::SingleToGroupMessage&) {};
+      typed.group_to_single.message_received = [](
+          const maidsafe::routing::GroupToSingleMessage&) {};
+      typed.group_to_group.message_received = [](
+          const maidsafe::routing::GroupToGroupMessage&) {};
+      typed.single_to_group_relay.message_received = [](
+          const maidsafe::routing::SingleToGroupRelayMessage&) {};
+    } else {
+      functors.message_and_caching.message_received = [](
+          const std::string& message, maidsafe::routing::ReplyFunctor reply_functor) {
+        reply_functor("loadgen reply to " + message.substr(0, 16));
+      };
+    }
+    routing_->Join(functors);
+  }
+
+  bool WaitForHealth(int min_health, std::chrono::seconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_var_.wait_for(lock, timeout, [&] { return health_ >= min_health; });
+  }
+
+  Routing& routing() { return *routing_; }
+
+ private:
+  LoadNode(const LoadNode&);
+  LoadNode(const LoadNode&&);
+  LoadNode& operator=(const LoadNode&);
+
+  std::mutex mutex_;
+  std::condition_variable cond_var_;
+  int health_;
+  std::unique_ptr<Routing> routing_;  // last, so that it stops before the members it calls into
+};
+
+// Typed messages get no response, so their latency is measured from the sending LoadNode to a
+// second, receiving LoadNode in this process.  Each message's contents start with its sequence
+// number.
+class TypedTracker {
+ public:
+  TypedTracker(LoadStats& stats, std::atomic<size_t>& outstanding)
+      : stats_(stats), outstanding_(outstanding), mutex_(), pending_() {}
+  void Add(uint64_t sequence, TimePoint due) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.insert(std::make_pair(sequence, due));
+  }
+  void OnReceived(const maidsafe::routing::SingleToSingleMessage& message) {
+    TimePoint due;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto itr(pending_.find(std::strtoull(message.payload().c_str(), nullptr, 10)));
+      if (itr == pending_.end())
+        return;
+      due = itr->second;
+      pending_.erase(itr);
+    }
+    stats_.AddCompleted(kTyped, std::chrono::steady_clock::now() - due);
+    --outstanding_;
+  }
+  // Counts messages older than Parameters::default_response_timeout as failed.
+  void ExpireOld() {
+    TimePoint cutoff(std::chrono::steady_clock::now() -
+                     maidsafe::routing::Parameters::default_response_timeout);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto itr(pending_.begin()); itr != pending_.end();) {
+      if (itr->second < cutoff) {
+        stats_.AddFailed(kTyped);
+        --outstanding_;
+        itr = pending_.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+  }
+
+ private:
+  TypedTracker(const TypedTracker&);
+  TypedTracker(const TypedTracker&&);
+  TypedTracker& operator=(const TypedTracker&);
+
+  LoadStats& stats_;
+  std::atomic<size_t>& outstanding_;
+  std::mutex mutex_;
+  std::map<uint64_t, TimePoint> pending_;
+};
+
+void SetBootstrapPeer(const std::string& peer) {
+  size_t delimiter(peer.rfind(':'));
+  boost::asio::ip::udp::endpoint endpoint(
+      boost::asio::ip::address::from_string(peer.substr(0, delimiter)),
+      static_cast<uint16_t>(std::stoi(peer.substr(delimiter + 1))));
+  auto bootstrap_file_path(maidsafe::routing::detail::GetOverrideBootstrapFilePath<false>());
+  fs::remove(bootstrap_file_path);
+  maidsafe::routing::WriteBootstrapContacts(maidsafe::routing::BootstrapContacts{endpoint},
+                                            bootstrap_file_path);
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+
+  try {
+    boost::system::error_code error_code;
+    po::options_description options_description("Options");
+    options_description.add_options()("help,h", "Print this help message")(
+        "pmids_path", po::value<std::string>()->default_value(fs::path(
+                          fs::temp_directory_path(error_code) / "pmids_list.dat").string()),
+        "Path to pmids file, as written by routing_key_helper")(
+        "identity_index,i", po::value<int>()->default_value(2),
+        "Vault identity to send from; typed messages use the next two identities too")(
+        "peer,p", po::value<std::string>()->default_value(""),
+        "Endpoint of bootstrap peer, e.g. 127.0.0.1:5483")(
+        "rate,r", po::value<double>()->default_value(100.0), "Requests per second")(
+        "duration,d", po::value<int>()->default_value(30), "Seconds to generate load for")(
+        "mix,m", po::value<std::string>()->default_value("direct:60,group:20,typed:10,"
+                                                          "cached_get:10"),
+        "Weighted mix of direct, group, typed and cached_get requests")(
+        "min_payload", po::value<uint32_t>()->default_value(1024), "Smallest payload in bytes")(
+        "max_payload", po::value<uint32_t>()->default_value(1024),
+        "Largest payload in bytes, at most Parameters::max_data_size")(
+        "max_outstanding", po::value<size_t>()->default_value(10000),
+        "Requests beyond this many outstanding are shed rather than sent")(
+        "hot_keys", po::value<size_t>()->default_value(16),
+        "Number of distinct keys requested by cacheable GETs")(
+        "join_health", po::value<int>()->default_value(50),
+        "Network health (%) each node must reach before load starts")(
+        "format,f", po::value<std::string>()->default_value("csv"), "Report format: csv or json")(
+        "output,o", po::value<std::string>(), "Report file (default is stdout)");
+
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv).options(options_description)
+                  .allow_unregistered().run(), variables_map);
+    po::notify(variables_map);
+    if (variables_map.count("help")) {
+      std::cout << options_description << std::endl;
+      return 0;
+    }
+
+    const double kRate(variables_map["rate"].as<double>());
+    const std::string kFormat(variables_map["format"].as<std::string>());
+    const uint32_t kMaxPayload(std::min(variables_map["max_payload"].as<uint32_t>(),
+                                        maidsafe::routing::Parameters::max_data_size));
+    const uint32_t kMinPayload(std::min(variables_map["min_payload"].as<uint32_t>(), kMaxPayload));
+    const size_t kMaxOutstanding(variables_map["max_outstanding"].as<size_t>());
+    const size_t kHotKeys(std::max(variables_map["hot_keys"].as<size_t>(), size_t(1)));
+    const std::vector<double> kWeights(ParseMix(variables_map["mix"].as<std::string>()));
+    if (kRate <= 0 || (kFormat != "csv" && kFormat != "json"))
+      throw std::logic_error("Invalid rate or format.");
+
+    auto pmids_path(maidsafe::GetPathFromProgramOptions("pmids_path", variables_map, false, true));
+    const KeysVector kAllKeys(maidsafe::passport::detail::ReadKeyChainList(pmids_path));
+    const size_t kIdentity(static_cast<size_t>(variables_map["identity_index"].as<int>()));
+    const bool kTypedEnabled(kWeights[kTyped] > 0);
+    const size_t kIdentitiesUsed(kTypedEnabled ? 3 : 1);
+    // As for routing_node, the first half of the keys file holds vault identities.
+    if (kIdentity + kIdentitiesUsed > kAllKeys.size() / 2)
+      throw std::logic_error("identity_index leaves too few vault identities in the keys file.");
+    std::vector<NodeId> targets;
+    for (size_t i(0); i != kAllKeys.size() / 2; ++i) {
+      if (i < kIdentity || i >= kIdentity + kIdentitiesUsed)
+        targets.push_back(NodeId(kAllKeys[i].pmid.name()->string()));
+    }
+    if (targets.empty())
+      throw std::logic_error("No other vault identities to send to.");
+    std::vector<NodeId> hot_keys;
+    for (size_t i(0); i != kHotKeys; ++i)
+      hot_keys.push_back(NodeId(maidsafe::crypto::Hash<maidsafe::crypto::SHA512>(
+          "routing_loadgen key " + std::to_string(i)).string()));
+
+    std::string peer(variables_map["peer"].as<std::string>());
+    if (!peer.empty())
+      SetBootstrapPeer(peer);
+
+    LoadStats stats;
+    std::atomic<size_t> outstanding(0);
+    TypedTracker typed_tracker(stats, outstanding);
+    std::vector<std::unique_ptr<LoadNode>> nodes;
+    nodes.emplace_back(new LoadNode(kAllKeys, kIdentity, nullptr));
+    if (kTypedEnabled) {
+      nodes.emplace_back(new LoadNode(kAllKeys, kIdentity + 1, [](
+          const maidsafe::routing::SingleToSingleMessage&) {}));
+      nodes.emplace_back(new LoadNode(kAllKeys, kIdentity + 2, [&typed_tracker](
+          const maidsafe::routing::SingleToSingleMessage& message) {
+        typed_tracker.OnReceived(message);
+      }));
+    }
+    for (auto& node : nodes) {
+      if (!node->WaitForHealth(variables_map["join_health"].as<int>(), std::chrono::seconds(60)))
+        throw std::runtime_error("Timed out joining the network.");
+    }
+    std::cerr << "Joined; generating " << kRate << " requests/s for "
+              << variables_map["duration"].as<int>() << " s" << std::endl;
+
+    std::mt19937 random(maidsafe::RandomUint32());
+    std::discrete_distribution<size_t> choose_operation(kWeights.begin(), kWeights.end());
+    std::uniform_int_distribution<uint32_t> choose_size(kMinPayload, kMaxPayload);
+    const std::string kPadding(maidsafe::RandomAlphaNumericString(kMaxPayload));
+    const Duration kInterval(std::chrono::duration_cast<Duration>(
+        std::chrono::duration<double>(1.0 / kRate)));
+    const TimePoint kStart(std::chrono::steady_clock::now());
+    const TimePoint kEnd(kStart + std::chrono::seconds(variables_map["duration"].as<int>()));
+    Routing& sender(nodes.front()->routing());
+    uint64_t sequence(0);
+
+    for (TimePoint due(kStart); due < kEnd; due += kInterval, ++sequence) {
+      std::this_thread::sleep_until(due);
+      const Operation kOperation(static_cast<Operation>(choose_operation(random)));
+      if (outstanding >= kMaxOutstanding) {
+        stats.AddShed(kOperation);
+        continue;
+      }
+      ++outstanding;
+      stats.AddSent(kOperation);
+      std::string payload(std::to_string(sequence) + ':' + kPadding.substr(0, choose_size(random)));
+      const NodeId kTarget(targets[random() % targets.size()]);
+      switch (kOperation) {
+        case kDirect:
+          sender.SendDirect(kTarget, payload, false, [&stats, &outstanding, due](
+              std::string response) {
+            if (response.empty())
+              stats.AddFailed(kDirect);
+            else
+              stats.AddCompleted(kDirect, std::chrono::steady_clock::now() - due);
+            --outstanding;
+          });
+          break;
+        case kGroup:
+        case kCachedGet: {
+          // A group request completes with the last of its Parameters::group_size responses.
+          auto remaining(std::make_shared<std::atomic<unsigned int>>(
+              maidsafe::routing::Parameters::group_size));
+          auto failed(std::make_shared<std::atomic<bool>>(false));
+          const bool kCacheable(kOperation == kCachedGet);
+          if (kCacheable)
+            payload = "GET " + std::to_string(random() % kHotKeys);
+          sender.SendGroup(kCacheable ? hot_keys[random() % kHotKeys] : kTarget, payload,
+                           kCacheable, [&stats, &outstanding, due, kOperation, remaining, failed](
+                               std::string response) {
+            if (response.empty())
+              *failed = true;
+            if (--*remaining != 0)
+              return;
+            if (*failed)
+              stats.AddFailed(kOperation);
+            else
+              stats.AddCompleted(kOperation, std::chrono::steady_clock::now() - due);
+            --outstanding;
+          });
+          break;
+        }
+        case kTyped: {
+          typed_tracker.Add(sequence, due);
+          maidsafe::routing::SingleToSingleMessage message(
+              payload, maidsafe::routing::SingleSource(nodes.at(1)->routing().kNodeId()),
+              maidsafe::routing::SingleId(nodes.at(2)->routing().kNodeId()));
+          nodes.at(1)->routing().Send(message);
+          break;
+        }
+        default:
+          break;
+      }
+      if (sequence % 1024 == 0)
+        typed_tracker.ExpireOld();
+    }
+    const Duration kElapsed(std::chrono::steady_clock::now() - kStart);
+
+    // Give outstanding requests until their response timeout to finish.
+    const TimePoint kDrainEnd(std::chrono::steady_clock::now() +
+                              maidsafe::routing::Parameters::default_response_timeout +
+                              std::chrono::seconds(1));
+    while (outstanding != 0 && std::chrono::steady_clock::now() < kDrainEnd) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      typed_tracker.ExpireOld();
+    }
+
+    auto snapshot(stats.Snapshot());
+    if (variables_map.count("output")) {
+      std::ofstream stream(variables_map["output"].as<std::string>());
+      WriteReport(snapshot, kElapsed, kFormat == "json", stream);
+    } else {
+      WriteReport(snapshot, kElapsed, kFormat == "json", std::cout);
+    }
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/upcall_executor.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "maidsafe/routing/routing_log.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+UpcallExecutor::UpcallExecutor(unsigned int threads, size_t max_queued)
+    : kMaxQueued_(max_queued), state_(std::make_shared<State>()), threads_() {
+  for (unsigned int i(0); i != threads; ++i)
+    threads_.emplace_back(&UpcallExecutor::Run, state_);
+}
+
+UpcallExecutor::~UpcallExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+    state_->upcalls.clear();
+  }
+  state_->cond_var.notify_all();
+  for (auto& thread : threads_) {
+    // An upcall which destroys its routing object can't wait for its own thread.
+    if (thread.get_id() == std::this_thread::get_id())
+      thread.detach();
+    else
+      thread.join();
+  }
+}
+
+bool UpcallExecutor::Post(Upcall upcall) {
+  if (threads_.empty()) {
+    upcall();
+    return true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->stopped)
+      return false;
+    if (state_->upcalls.size() >= kMaxQueued_) {
+      ++state_->overloaded;
+      return false;
+    }
+    state_->upcalls.push_back(std::move(upcall));
+  }
+  state_->cond_var.notify_one();
+  return true;
+}
+
+size_t UpcallExecutor::queued() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->upcalls.size();
+}
+
+uint64_t UpcallExecutor::overloaded() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->overloaded;
+}
+
+void UpcallExecutor::Run(std::shared_ptr<State> state) {
+  for (;;) {
+    Upcall upcall;
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->cond_var.wait(lock, [&state] { return state->stopped || !state->upcalls.empty(); });
+      if (state->stopped)
+        return;
+      upcall = std::move(state->upcalls.front());
+      state->upcalls.pop_front();
+    }
+    try {
+      upcall();
+    }
+    catch (const std::exception& e) {
+      ROUTING_LOG(kError) << "Upcall threw: " << e.what();
+    }
+    catch (...) {
+      ROUTING_LOG(kError) << "Upcall threw an unknown exception";
+    }
+  }
+}
+
+UpcallScope::UpcallScope(UpcallExecutor& executor)
+    : executor_(executor), state_(std::make_shared<State>()) {}
+
+UpcallScope::~UpcallScope() {
+  const std::thread::id kThisThread(std::this_thread::get_id());
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->stopped = true;
+  // An upcall which destroys its owner can't wait for itself.
+  state_->cond_var.wait(lock, [&] {
+    return std::all_of(state_->running.begin(), state_->running.end(),
+                       [&kThisThread](const std::thread::id& id) { return id == kThisThread; });
+  });
+}
+
+bool UpcallScope::Post(UpcallExecutor::Upcall upcall) {
+  std::shared_ptr<State> state(state_);
+  return executor_.Post([state, upcall] {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->stopped)
+        return;
+      state->running.push_back(std::this_thread::get_id());
+    }
+    try {
+      upcall();
+    }
+    catch (...) {
+      Finish(*state);
+      throw;
+    }
+    Finish(*state);
+  });
+}
+
+void UpcallScope::Finish(State& state) {
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running.erase(
+        std::find(state.running.begin(), state.running.end(), std::this_thread::get_id()));
+  }
+  state.cond_var.notify_all();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
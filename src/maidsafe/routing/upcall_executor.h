@@ -0,0 +1,107 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_UPCALL_EXECUTOR_H_
+#define MAIDSAFE_ROUTING_UPCALL_EXECUTOR_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Runs calls into the upper layer's functors (message received, cache get/put) on a pool of its
+// own, so that a slow handler delays only other upcalls and never the routing threads.  At most
+// 'max_queued' upcalls wait for a free thread; beyond that Post refuses the upcall and counts it as
+// an overload, leaving the caller to decide what to drop.  With no threads, upcalls run inline on
+// the posting thread, as they did before this class existed.
+class UpcallExecutor {
+ public:
+  typedef std::function<void()> Upcall;
+
+  UpcallExecutor(unsigned int threads, size_t max_queued);
+  // Upcalls still queued are discarded; ones already running are waited for.
+  ~UpcallExecutor();
+  // Returns false, without running 'upcall', if the queue is full.
+  bool Post(Upcall upcall);
+  size_t queued() const;
+  uint64_t overloaded() const;
+
+ private:
+  UpcallExecutor(const UpcallExecutor&);
+  UpcallExecutor(const UpcallExecutor&&);
+  UpcallExecutor& operator=(const UpcallExecutor&);
+
+  // Shared with the threads, so that one detached by the destructor can still see it stopped.
+  struct State {
+    State() : mutex(), cond_var(), upcalls(), overloaded(0), stopped(false) {}
+    std::mutex mutex;
+    std::condition_variable cond_var;
+    std::deque<Upcall> upcalls;
+    uint64_t overloaded;
+    bool stopped;
+  };
+
+  static void Run(std::shared_ptr<State> state);
+
+  const size_t kMaxQueued_;
+  const std::shared_ptr<State> state_;
+  std::vector<std::thread> threads_;
+};
+
+// Posts the upcalls of one owner, e.g. one node's MessageHandler, to an UpcallExecutor which may be
+// shared with other owners.  Once this is destroyed, its upcalls still queued are skipped, and the
+// destructor waits for any already running, so upcalls may safely refer to the owner.
+class UpcallScope {
+ public:
+  explicit UpcallScope(UpcallExecutor& executor);
+  ~UpcallScope();
+  bool Post(UpcallExecutor::Upcall upcall);
+
+ private:
+  UpcallScope(const UpcallScope&);
+  UpcallScope(const UpcallScope&&);
+  UpcallScope& operator=(const UpcallScope&);
+
+  struct State {
+    State() : mutex(), cond_var(), running(), stopped(false) {}
+    std::mutex mutex;
+    std::condition_variable cond_var;
+    std::vector<std::thread::id> running;
+    bool stopped;
+  };
+
+  static void Finish(State& state);
+
+  UpcallExecutor& executor_;
+  const std::shared_ptr<State> state_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_UPCALL_EXECUTOR_H_
@@ -24,6 +24,8 @@
 
 #include <string>
 #include <algorithm>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "boost/filesystem/operations.hpp"
@@ -39,6 +41,7 @@
 #include "maidsafe/routing/network.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_log.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/rpcs.h"
 
@@ -49,7 +52,8 @@ namespace routing {
 int AddToRudp(Network& network, const NodeId& this_node_id, const NodeId& this_connection_id,
               const NodeId& peer_id, const NodeId& peer_connection_id,
               rudp::EndpointPair peer_endpoint_pair, bool requestor, bool client) {
-  LOG(kVerbose) << "AddToRudp. peer_id: " << peer_id << " ,connection id: " << peer_connection_id;
+  ROUTING_LOG(kVerbose) << "AddToRudp. peer_id: " << peer_id << " ,connection id: "
+                        << peer_connection_id;
   protobuf::Message connect_success(
       rpcs::ConnectSuccess(peer_id, this_node_id, this_connection_id, requestor, client));
   int result =
@@ -57,11 +61,11 @@ int AddToRudp(Network& network, const NodeId& this_node_id, const NodeId& this_c
   if (result == rudp::kConnectionAlreadyExists) {
     network.SendToDirect(connect_success, peer_id, peer_connection_id);
   } else if (result == kSuccess) {
-    LOG(kVerbose) << "rudp.Add succeeded for peer node [" << peer_id
-                  << "]. Connection id : " << peer_connection_id;
+    ROUTING_LOG(kVerbose) << "rudp.Add succeeded for peer node [" << peer_id
+                          << "]. Connection id : " << peer_connection_id;
   } else {
-    LOG(kError) << "rudp add failed for peer node [" << peer_id << "]. Connection id : "
-                << peer_connection_id << ". result : " << result;
+    ROUTING_LOG(kError) << "rudp add failed for peer node [" << peer_id << "]. Connection id : "
+                        << peer_connection_id << ". result : " << result;
   }
   return result;
 }
@@ -71,9 +75,9 @@ bool ValidateAndAddToRoutingTable(Network& network, RoutingTable& routing_table,
                                   const NodeId& peer_id, const NodeId& connection_id,
                                   const asymm::PublicKey& public_key, bool client) {
   if (network.MarkConnectionAsValid(connection_id) != kSuccess) {
-    LOG(kError) << "[" << routing_table.kNodeId()
-                << "]  Rudp failed to validate connection with  Peer id : " << peer_id
-                << " , Connection id : " << connection_id;
+    ROUTING_LOG(kError) << "[" << routing_table.kNodeId()
+                        << "]  Rudp failed to validate connection with  Peer id : " << peer_id
+                        << " , Connection id : " << connection_id;
     return false;
   }
 
@@ -95,16 +99,18 @@ bool ValidateAndAddToRoutingTable(Network& network, RoutingTable& routing_table,
   }
 
   if (routing_accepted_node) {
-    LOG(kVerbose) << "[" << routing_table.kNodeId() << "] "
-                  << "added " << (client ? "client-" : "") << "node to " << (client ? "non-" : "")
-                  << "routing table.  Node ID: " << HexSubstr(peer_id.string());
+    ROUTING_LOG(kVerbose) << "[" << routing_table.kNodeId() << "] "
+                          << "added " << (client ? "client-" : "") << "node to "
+                          << (client ? "non-" : "")
+                          << "routing table.  Node ID: " << HexSubstr(peer_id.string());
     return true;
   }
 
-  LOG(kInfo) << "[" << routing_table.kNodeId() << "] "
-             << "failed to add " << (client ? "client-" : "") << "node to "
-             << (client ? "non-" : "") << "routing table.  Node ID: " << HexSubstr(peer_id.string())
-             << ". Added rudp connection will be removed.";
+  ROUTING_LOG(kInfo) << "[" << routing_table.kNodeId() << "] "
+                     << "failed to add " << (client ? "client-" : "") << "node to "
+                     << (client ? "non-" : "") << "routing table.  Node ID: "
+                     << HexSubstr(peer_id.string())
+                     << ". Added rudp connection will be removed.";
   network.Remove(connection_id);
   return false;
 }
@@ -181,9 +187,20 @@ bool IsClientToClientMessageWithDifferentNodeIds(const protobuf::Message& messag
 
 bool CheckId(const std::string& id_to_test) { return id_to_test.size() == NodeId::kSize; }
 
+// Each forwarding node appends itself to the route history, except a message's originator on the
+// first hop.  A relayed client request has no source ID until its relay node adopts it, so until
+// then the client is known only by its connection ID.
+std::string PreviousHop(const protobuf::Message& message, const NodeId& this_node_id) {
+  if (message.route_history_size() != 0)
+    return message.route_history(message.route_history_size() - 1);
+  if (message.source_id().empty() || message.source_id() == this_node_id.string())
+    return message.relay_connection_id();
+  return message.source_id();
+}
+
 bool ValidateMessage(const protobuf::Message& message) {
   if (!message.IsInitialized()) {
-    LOG(kWarning) << "Uninitialised message dropped.";
+    ROUTING_LOG(kWarning) << "Uninitialised message dropped.";
     return false;
   }
 
@@ -192,52 +209,53 @@ bool ValidateMessage(const protobuf::Message& message) {
     std::string route_history;
     for (const auto& route : message.route_history())
       route_history += HexSubstr(route) + ", ";
-    LOG(kError) << "Message has traversed more hops than expected. "
-                << Parameters::max_route_history
-                << " last hops in route history are: " << route_history
-                << " \nMessage source: " << HexSubstr(message.source_id())
-                << ", \nMessage destination: " << HexSubstr(message.destination_id())
-                << ", \nMessage type: " << message.type() << ", \nMessage id: " << message.id();
+    ROUTING_LOG(kError) << "Message has traversed more hops than expected. "
+                        << Parameters::max_route_history
+                        << " last hops in route history are: " << route_history
+                        << " \nMessage source: " << HexSubstr(message.source_id())
+                        << ", \nMessage destination: " << HexSubstr(message.destination_id())
+                        << ", \nMessage type: " << message.type() << ", \nMessage id: "
+                        << message.id();
     return false;
   }
   // Invalid destination id, unknown message
   if (!CheckId(message.destination_id())) {
-    LOG(kWarning) << "Stray message dropped, need destination ID for processing."
-                  << " id: " << message.id();
+    ROUTING_LOG(kWarning) << "Stray message dropped, need destination ID for processing."
+                          << " id: " << message.id();
     return false;
   }
 
   if (!(message.has_source_id() || (message.has_relay_id() && message.has_relay_connection_id()))) {
-    LOG(kWarning) << "Message should have either src id or relay information.";
+    ROUTING_LOG(kWarning) << "Message should have either src id or relay information.";
     assert(false && "Message should have either src id or relay information.");
     return false;
   }
 
   if (message.has_source_id() && !CheckId(message.source_id())) {
-    LOG(kWarning) << "Invalid source id field.";
+    ROUTING_LOG(kWarning) << "Invalid source id field.";
     return false;
   }
 
   if (message.has_relay_id() && NodeId(message.relay_id()).IsZero()) {
-    LOG(kWarning) << "Invalid relay id field.";
+    ROUTING_LOG(kWarning) << "Invalid relay id field.";
     return false;
   }
 
   if (message.has_relay_connection_id() && NodeId(message.relay_connection_id()).IsZero()) {
-    LOG(kWarning) << "Invalid relay connection id field.";
+    ROUTING_LOG(kWarning) << "Invalid relay connection id field.";
     return false;
   }
 
   if (static_cast<MessageType>(message.type()) == MessageType::kConnect)
     if (!message.direct()) {
-      LOG(kWarning) << "kConnectRequest type message must be direct.";
+      ROUTING_LOG(kWarning) << "kConnectRequest type message must be direct.";
       return false;
     }
 
   if (static_cast<MessageType>(message.type()) == MessageType::kFindNodes &&
       (message.request() == false))
     if ((!message.direct())) {
-      LOG(kWarning) << "kFindNodesResponse type message must be direct.";
+      ROUTING_LOG(kWarning) << "kFindNodesResponse type message must be direct.";
       return false;
     }
 
@@ -389,37 +407,65 @@ std::string SerializeNodeIdList(const std::vector<NodeId>& node_list) {
   return node_list_msg.SerializeAsString();
 }
 
-SingleToSingleMessage CreateSingleToSingleMessage(const protobuf::Message& proto_message) {
-  return SingleToSingleMessage(proto_message.data(0),
-                               SingleSource(NodeId(proto_message.source_id())),
-                               SingleId(NodeId(proto_message.destination_id())),
-                               static_cast<Cacheable>(proto_message.cacheable()));
+namespace {
+
+// Gives 'message' the payload of 'proto_message': 'contents' if provided, otherwise data(0).  It is
+// copied into 'contents' alone if Parameters::copy_message_contents is set, and otherwise shared
+// through 'shared_contents' alone, so that payload() always returns the one the message holds.
+template <typename MessageType>
+MessageType SetContents(MessageType message, const protobuf::Message& proto_message,
+                        SharedContents contents) {
+  if (Parameters::copy_message_contents) {
+    message.contents = contents ? *contents : proto_message.data(0);
+    return message;
+  }
+  message.shared_contents =
+      contents ? std::move(contents) : std::make_shared<const std::string>(proto_message.data(0));
+  return message;
+}
+
+}  // unnamed namespace
+
+SingleToSingleMessage CreateSingleToSingleMessage(const protobuf::Message& proto_message,
+                                                  SharedContents contents) {
+  return SetContents(SingleToSingleMessage(std::string(),
+                                           SingleSource(NodeId(proto_message.source_id())),
+                                           SingleId(NodeId(proto_message.destination_id())),
+                                           static_cast<Cacheable>(proto_message.cacheable())),
+                     proto_message, std::move(contents));
 }
 
-SingleToGroupMessage CreateSingleToGroupMessage(const protobuf::Message& proto_message) {
-  return SingleToGroupMessage(proto_message.data(0),
-                              SingleSource(NodeId(proto_message.source_id())),
-                              GroupId(NodeId(proto_message.group_destination())),
-                              static_cast<Cacheable>(proto_message.cacheable()));
+SingleToGroupMessage CreateSingleToGroupMessage(const protobuf::Message& proto_message,
+                                                SharedContents contents) {
+  return SetContents(SingleToGroupMessage(std::string(),
+                                          SingleSource(NodeId(proto_message.source_id())),
+                                          GroupId(NodeId(proto_message.group_destination())),
+                                          static_cast<Cacheable>(proto_message.cacheable())),
+                     proto_message, std::move(contents));
 }
 
-GroupToSingleMessage CreateGroupToSingleMessage(const protobuf::Message& proto_message) {
-  return GroupToSingleMessage(proto_message.data(0),
-                              GroupSource(GroupId(NodeId(proto_message.group_source())),
-                                          SingleId(NodeId(proto_message.source_id()))),
-                              SingleId(NodeId(proto_message.destination_id())),
-                              static_cast<Cacheable>(proto_message.cacheable()));
+GroupToSingleMessage CreateGroupToSingleMessage(const protobuf::Message& proto_message,
+                                                SharedContents contents) {
+  return SetContents(GroupToSingleMessage(std::string(),
+                                          GroupSource(GroupId(NodeId(proto_message.group_source())),
+                                                      SingleId(NodeId(proto_message.source_id()))),
+                                          SingleId(NodeId(proto_message.destination_id())),
+                                          static_cast<Cacheable>(proto_message.cacheable())),
+                     proto_message, std::move(contents));
 }
 
-GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_message) {
-  return GroupToGroupMessage(proto_message.data(0),
-                             GroupSource(GroupId(NodeId(proto_message.group_source())),
-                                         SingleId(NodeId(proto_message.source_id()))),
-                             GroupId(NodeId(proto_message.group_destination())),
-                             static_cast<Cacheable>(proto_message.cacheable()));
+GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_message,
+                                              SharedContents contents) {
+  return SetContents(GroupToGroupMessage(std::string(),
+                                         GroupSource(GroupId(NodeId(proto_message.group_source())),
+                                                     SingleId(NodeId(proto_message.source_id()))),
+                                         GroupId(NodeId(proto_message.group_destination())),
+                                         static_cast<Cacheable>(proto_message.cacheable())),
+                     proto_message, std::move(contents));
 }
 
-SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Message& proto_message) {
+SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Message& proto_message,
+                                                          SharedContents contents) {
   SingleSource single_src(NodeId(proto_message.relay_id()));
   NodeId connection_id(proto_message.relay_connection_id());
   SingleSource single_src_relay_node(NodeId(proto_message.source_id()));
@@ -427,10 +473,11 @@ SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Messag
                                      connection_id,
                                      single_src_relay_node);
 
-  return SingleToGroupRelayMessage(proto_message.data(0),
+  return SetContents(SingleToGroupRelayMessage(std::string(),
       single_relay_src,  // relay node
           GroupId(NodeId(proto_message.group_destination())),
-              static_cast<Cacheable>(proto_message.cacheable()));
+              static_cast<Cacheable>(proto_message.cacheable())),
+                     proto_message, std::move(contents));
 
 //  return SingleToGroupRelayMessage(proto_message.data(0),
 //      SingleSourceRelay(SingleSource(NodeId(proto_message.relay_id())), // original sender
@@ -80,6 +80,8 @@ bool IsConnectSuccessAcknowledgement(const protobuf::Message& message);
 bool IsClientToClientMessageWithDifferentNodeIds(const protobuf::Message& message,
                                                  const bool is_destination_client);
 bool CheckId(const std::string& id_to_test);
+// ID of the node, or for a client the connection, which handed 'message' to this node.
+std::string PreviousHop(const protobuf::Message& message, const NodeId& this_node_id);
 bool ValidateMessage(const protobuf::Message& message);
 NodeId NodeInNthBucket(const NodeId& node_id, int bucket);
 void SetProtobufEndpoint(const boost::asio::ip::udp::endpoint& endpoint,
@@ -93,11 +95,19 @@ rudp::NatType NatTypeFromProtobuf(const protobuf::NatType& nat_type_proto);
 std::string PrintMessage(const protobuf::Message& message);
 std::vector<NodeId> DeserializeNodeIdList(const std::string& node_list_str);
 std::string SerializeNodeIdList(const std::vector<NodeId>& node_list);
-SingleToSingleMessage CreateSingleToSingleMessage(const protobuf::Message& proto_message);
-SingleToGroupMessage CreateSingleToGroupMessage(const protobuf::Message& proto_message);
-GroupToSingleMessage CreateGroupToSingleMessage(const protobuf::Message& proto_message);
-GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_message);
-SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(const protobuf::Message& proto_message);
+// The typed message carrying 'proto_message'.  Its payload is 'contents' if provided, otherwise
+// proto_message.data(0).  It is copied into Message::contents if Parameters::copy_message_contents
+// is set, and otherwise shared through Message::shared_contents instead.
+SingleToSingleMessage CreateSingleToSingleMessage(const protobuf::Message& proto_message,
+                                                  SharedContents contents = SharedContents());
+SingleToGroupMessage CreateSingleToGroupMessage(const protobuf::Message& proto_message,
+                                                SharedContents contents = SharedContents());
+GroupToSingleMessage CreateGroupToSingleMessage(const protobuf::Message& proto_message,
+                                                SharedContents contents = SharedContents());
+GroupToGroupMessage CreateGroupToGroupMessage(const protobuf::Message& proto_message,
+                                              SharedContents contents = SharedContents());
+SingleToGroupRelayMessage CreateSingleToGroupRelayMessage(
+    const protobuf::Message& proto_message, SharedContents contents = SharedContents());
 }  // namespace routing
 
 }  // namespace maidsafe